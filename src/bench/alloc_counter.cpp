@@ -0,0 +1,133 @@
+#include "bench/alloc_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace qc::bench {
+    namespace {
+        thread_local std::uint64_t allocations = 0;
+
+        void* allocate(std::size_t size, std::size_t alignment) {
+            allocations++;
+            size = size == 0 ? 1 : size;
+            if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                return std::malloc(size);
+            }
+#if defined(_MSC_VER)
+            return _aligned_malloc(size, alignment);
+#else
+            // aligned_alloc wants the size to be a multiple of the alignment.
+            return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+        }
+
+        void release(void* p, std::size_t alignment) {
+#if defined(_MSC_VER)
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                _aligned_free(p);
+                return;
+            }
+#else
+            (void)alignment;
+#endif
+            std::free(p);
+        }
+
+        void* allocate_or_throw(std::size_t size, std::size_t alignment) {
+            void* p = allocate(size, alignment);
+            if (p == nullptr) {
+                throw std::bad_alloc();
+            }
+            return p;
+        }
+    }  // namespace
+
+    std::uint64_t thread_heap_allocations() {
+        return allocations;
+    }
+
+    bool heap_allocations_counted() {
+        return true;
+    }
+}  // namespace qc::bench
+
+void* operator new(std::size_t size) {
+    return qc::bench::allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size) {
+    return qc::bench::allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return qc::bench::allocate_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return qc::bench::allocate_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return qc::bench::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return qc::bench::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return qc::bench::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+    return qc::bench::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    qc::bench::release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* p) noexcept {
+    qc::bench::release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    qc::bench::release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    qc::bench::release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+    qc::bench::release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept {
+    qc::bench::release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+    qc::bench::release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept {
+    qc::bench::release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    qc::bench::release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    qc::bench::release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    qc::bench::release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    qc::bench::release(p, static_cast<std::size_t>(alignment));
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace qc::bench {
+    // Heap allocations made by the calling thread so far. Only quadcraft_bench links
+    // alloc_counter.cpp, which replaces the global operator new and delete with counting
+    // versions on top of malloc and free; the game links no_alloc_counter.cpp instead, so its
+    // allocations go through the standard library's, and this stays at 0.
+    std::uint64_t thread_heap_allocations();
+
+    // Whether thread_heap_allocations() counts anything in this executable.
+    bool heap_allocations_counted();
+}  // namespace qc::bench
@@ -0,0 +1,98 @@
+#include "bench/bench.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "core/json.hpp"
+
+namespace qc::bench {
+    namespace {
+        volatile std::uint64_t g_sink;
+    }  // namespace
+
+    void context::report(const std::string& name, double value, const std::string& unit) {
+        spdlog::info("  {:<40} {:>14.2f} {}", name, value, unit);
+        m_results.push_back({name, value, unit});
+    }
+
+    void context::check(bool condition, const char* what) {
+        if (!condition) {
+            spdlog::error("  check failed: {}", what);
+            m_failed = true;
+        }
+    }
+
+    void suite::add(const char* name, bench_fn fn) {
+        m_entries.push_back({name, fn});
+    }
+
+    int suite::run(const char* filter) {
+        context ctx;
+        return run(filter, ctx);
+    }
+
+    int suite::run(const char* filter, context& ctx) {
+        int ran = 0;
+        for (const entry& e : m_entries) {
+            if (filter != nullptr && std::strstr(e.name, filter) == nullptr) {
+                continue;
+            }
+
+            spdlog::info("{}", e.name);
+            e.fn(ctx);
+            ran++;
+        }
+
+        if (ran == 0) {
+            spdlog::error("no benchmark matches '{}'", filter != nullptr ? filter : "");
+            return 1;
+        }
+
+        return ctx.failed() ? 1 : 0;
+    }
+
+    bool write_json(const std::string& path,
+                    const std::vector<std::pair<std::string, std::string>>& info,
+                    const std::vector<result>& results) {
+        fmt::memory_buffer out;
+        fmt::format_to(std::back_inserter(out), "{{\n  \"info\": {{");
+        for (std::size_t i = 0; i < info.size(); i++) {
+            fmt::format_to(std::back_inserter(out), "{}\n    ", i == 0 ? "" : ",");
+            append_json_string(out, info[i].first);
+            fmt::format_to(std::back_inserter(out), ": ");
+            append_json_string(out, info[i].second);
+        }
+        fmt::format_to(std::back_inserter(out), "\n  }},\n  \"results\": [");
+        for (std::size_t i = 0; i < results.size(); i++) {
+            fmt::format_to(std::back_inserter(out), "{}\n    {{\"name\": ", i == 0 ? "" : ",");
+            append_json_string(out, results[i].name);
+            // Shortest round-trip form, so checksums survive exactly. JSON has no NaN.
+            if (std::isfinite(results[i].value)) {
+                fmt::format_to(std::back_inserter(out), ", \"value\": {}, \"unit\": ",
+                               results[i].value);
+            } else {
+                fmt::format_to(std::back_inserter(out), ", \"value\": null, \"unit\": ");
+            }
+            append_json_string(out, results[i].unit);
+            out.push_back('}');
+        }
+        fmt::format_to(std::back_inserter(out), "\n  ]\n}}\n");
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) {
+            spdlog::error("cannot write {}", path);
+            return false;
+        }
+        return true;
+    }
+
+    void consume(std::uint64_t value) {
+        g_sink = g_sink + value;
+    }
+}  // namespace qc::bench
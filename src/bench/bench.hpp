@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qc::bench {
+    // A single named measurement produced by a benchmark.
+    struct result {
+        std::string name;
+        double value;
+        std::string unit;
+    };
+
+    class context {
+    public:
+        void report(const std::string& name, double value, const std::string& unit);
+
+        // Aborts the run when a benchmark's self-check fails.
+        void check(bool condition, const char* what);
+
+        const std::vector<result>& results() const {
+            return m_results;
+        }
+
+        bool failed() const {
+            return m_failed;
+        }
+
+    private:
+        std::vector<result> m_results;
+        bool m_failed = false;
+    };
+
+    using bench_fn = void (*)(context&);
+
+    class suite {
+    public:
+        void add(const char* name, bench_fn fn);
+
+        // Runs every benchmark whose name contains `filter` (all of them when null).
+        // Returns a process exit code.
+        int run(const char* filter);
+        int run(const char* filter, context& ctx);
+
+    private:
+        struct entry {
+            const char* name;
+            bench_fn fn;
+        };
+
+        std::vector<entry> m_entries;
+    };
+
+    // Writes results as JSON for regression tracking:
+    //     {"info": {"seed": "42", ...}, "results": [{"name": ..., "value": ..., "unit": ...}]}
+    // `info` describes the run, such as the options it was started with.
+    bool write_json(const std::string& path,
+                    const std::vector<std::pair<std::string, std::string>>& info,
+                    const std::vector<result>& results);
+
+    // Keeps the optimizer from discarding a computed value.
+    void consume(std::uint64_t value);
+
+    // Calls `fn` `iterations` times and returns the mean nanoseconds per call.
+    template <typename F>
+    double time_ns(int iterations, F&& fn) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            fn();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+}  // namespace qc::bench
@@ -0,0 +1,27 @@
+#include "bench/benchmarks.hpp"
+
+namespace qc::bench {
+    void add_all_benchmarks(suite& s) {
+        add_chunk_benchmarks(s);
+        add_mesh_benchmarks(s);
+        add_jobs_benchmarks(s);
+        add_noise_benchmarks(s);
+        add_storage_benchmarks(s);
+        add_light_benchmarks(s);
+        add_profile_benchmarks(s);
+        add_render_benchmarks(s);
+        add_occlusion_benchmarks(s);
+        add_visibility_benchmarks(s);
+        add_frustum_benchmarks(s);
+        add_streaming_benchmarks(s);
+        add_log_benchmarks(s);
+        add_lod_benchmarks(s);
+        add_snapshot_benchmarks(s);
+        add_server_benchmarks(s);
+        add_raycast_benchmarks(s);
+        add_collision_benchmarks(s);
+        add_ecs_benchmarks(s);
+        add_path_benchmarks(s);
+        add_fluid_benchmarks(s);
+    }
+}  // namespace qc::bench
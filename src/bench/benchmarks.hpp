@@ -0,0 +1,30 @@
+#pragma once
+
+#include "bench/bench.hpp"
+
+namespace qc::bench {
+    // Every benchmark below, in the order they run.
+    void add_all_benchmarks(suite& s);
+
+    void add_chunk_benchmarks(suite& s);
+    void add_mesh_benchmarks(suite& s);
+    void add_jobs_benchmarks(suite& s);
+    void add_noise_benchmarks(suite& s);
+    void add_storage_benchmarks(suite& s);
+    void add_light_benchmarks(suite& s);
+    void add_profile_benchmarks(suite& s);
+    void add_render_benchmarks(suite& s);
+    void add_occlusion_benchmarks(suite& s);
+    void add_visibility_benchmarks(suite& s);
+    void add_frustum_benchmarks(suite& s);
+    void add_streaming_benchmarks(suite& s);
+    void add_log_benchmarks(suite& s);
+    void add_lod_benchmarks(suite& s);
+    void add_snapshot_benchmarks(suite& s);
+    void add_server_benchmarks(suite& s);
+    void add_raycast_benchmarks(suite& s);
+    void add_collision_benchmarks(suite& s);
+    void add_ecs_benchmarks(suite& s);
+    void add_path_benchmarks(suite& s);
+    void add_fluid_benchmarks(suite& s);
+}  // namespace qc::bench
@@ -0,0 +1,161 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/scenes.hpp"
+#include "world/chunk.hpp"
+
+namespace qc::bench {
+    namespace {
+        void check_against_reference(context& ctx) {
+            std::mt19937 rng(1234);
+            chunk c;
+            std::vector<block_id> reference(CHUNK_VOLUME, BLOCK_AIR);
+
+            // Walk the palette through every width, including direct storage, round-tripping
+            // the encoding at each.
+            bool decodes = true;
+            for (int distinct : {2, 3, 5, 17, 300}) {
+                std::uniform_int_distribution<int> pick(0, distinct - 1);
+                std::uniform_int_distribution<int> where(0, CHUNK_VOLUME - 1);
+                for (int i = 0; i < 20000; i++) {
+                    const int index = where(rng);
+                    const block_id block = static_cast<block_id>(pick(rng));
+                    c.set(index, block);
+                    reference[index] = block;
+                }
+                std::vector<std::uint8_t> bytes;
+                c.encode(bytes);
+                chunk copy;
+                decodes &= copy.decode(bytes.data(), bytes.size());
+                for (int i = 0; i < CHUNK_VOLUME; i++) {
+                    decodes &= copy.get(i) == reference[i];
+                }
+            }
+            ctx.check(decodes, "every index width decodes what it encoded");
+
+            bool same = true;
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                same &= c.get(i) == reference[i];
+            }
+            ctx.check(same, "random set/get matches a flat array");
+            ctx.check(c.bits_per_index() == chunk::DIRECT_BITS, "palette overflow goes direct");
+
+            // Shrink back below the palette limit and compact.
+            c.fill(0, 0, 0, CHUNK_SIZE - 1, CHUNK_SIZE / 2 - 1, CHUNK_SIZE - 1, BLOCK_STONE);
+            c.fill(0, CHUNK_SIZE / 2, 0, CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1, BLOCK_AIR);
+            c.set(5, 5, 5, BLOCK_DIRT);
+            c.compact();
+            ctx.check(c.palette_size() == 3, "compacted palette holds three blocks");
+            ctx.check(c.bits_per_index() == 2, "compacted width is two bits");
+            ctx.check(c.get(5, 5, 5) == BLOCK_DIRT && c.get(0, 31, 0) == BLOCK_AIR &&
+                          c.get(31, 0, 31) == BLOCK_STONE,
+                      "compaction preserves contents");
+
+            // decode() checks the palette count against the index width and the bytes left, and
+            // the reference counts against the indices.
+            std::vector<std::uint8_t> encoded;
+            c.encode(encoded);
+            chunk decoded;
+            const bool round_trip = decoded.decode(encoded.data(), encoded.size()) &&
+                                    decoded.get(5, 5, 5) == BLOCK_DIRT &&
+                                    decoded.palette_size() == 3;
+            std::vector<std::uint8_t> truncated(encoded.begin(), encoded.begin() + 7);
+            std::vector<std::uint8_t> oversized = encoded;
+            oversized[1] = 5;
+            std::vector<std::uint8_t> miscounted = encoded;
+            miscounted[5]++;
+            ctx.check(round_trip && !decoded.decode(truncated.data(), truncated.size()) &&
+                          !decoded.decode(oversized.data(), oversized.size()) &&
+                          !decoded.decode(miscounted.data(), miscounted.size()) &&
+                          decoded.get(5, 5, 5) == BLOCK_DIRT,
+                      "decode rejects a malformed palette");
+
+            const auto unpacked = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            c.unpack(unpacked.get());
+            same = true;
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                same &= unpacked[i] == c.get(i);
+            }
+            ctx.check(same, "unpack matches get");
+
+            // assign() is the inverse of unpack(), palette or direct.
+            chunk assigned;
+            assigned.assign(unpacked.get());
+            ctx.check(assigned.bits_per_index() == 2 && assigned.get(5, 5, 5) == BLOCK_DIRT,
+                      "assign rebuilds a minimal palette");
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                unpacked[i] = static_cast<block_id>(i % 300);
+            }
+            assigned.assign(unpacked.get());
+            same = assigned.bits_per_index() == chunk::DIRECT_BITS;
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                same &= assigned.get(i) == unpacked[i];
+            }
+            ctx.check(same, "assign falls back to direct storage");
+
+            c.fill(BLOCK_AIR);
+            ctx.check(c.is_uniform() && c.memory_usage() < 128, "fill collapses storage");
+        }
+
+        void bench_chunk_storage(context& ctx) {
+            check_against_reference(ctx);
+
+            // 16 columns of four chunks each: bedrock-deep stone, the surface, and open sky.
+            constexpr int CHUNKS = 64;
+            std::vector<chunk> chunks(CHUNKS);
+            for (int i = 0; i < CHUNKS; i++) {
+                make_terrain(chunks[i], i / 4, i % 4);
+                chunks[i].compact();
+            }
+
+            std::size_t packed = 0;
+            for (const chunk& c : chunks) {
+                packed += c.memory_usage();
+            }
+            const double naive = static_cast<double>(CHUNKS) * CHUNK_VOLUME * sizeof(block_id);
+            ctx.report("chunk.terrain.bytes_per_chunk", static_cast<double>(packed) / CHUNKS, "B");
+            ctx.report("chunk.terrain.compression", naive / static_cast<double>(packed), "x");
+
+            std::mt19937 rng(99);
+            std::vector<int> indices(1 << 16);
+            for (int& i : indices) {
+                i = static_cast<int>(rng() % CHUNK_VOLUME);
+            }
+
+            std::uint64_t sum = 0;
+            const double get_ns = time_ns(100, [&] {
+                for (int i : indices) {
+                    sum += chunks[i & (CHUNKS - 1)].get(i);
+                }
+            });
+            consume(sum);
+            ctx.report("chunk.get", get_ns / indices.size(), "ns/op");
+
+            const double set_ns = time_ns(20, [&] {
+                for (int i : indices) {
+                    chunk& c = chunks[i & (CHUNKS - 1)];
+                    c.set(i, c.get(i) == BLOCK_AIR ? BLOCK_STONE : BLOCK_AIR);
+                }
+            });
+            ctx.report("chunk.set", set_ns / indices.size(), "ns/op");
+
+            const auto out = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            const double unpack_ns = time_ns(1000, [&] { chunks[7].unpack(out.get()); });
+            consume(out[CHUNK_VOLUME - 1]);
+            ctx.report("chunk.unpack", unpack_ns / 1000.0, "us/chunk");
+
+            const double fill_ns = time_ns(1000, [&] {
+                chunk& c = chunks[3];
+                c.fill(4, 4, 4, 27, 27, 27, BLOCK_SAND);
+                c.fill(4, 4, 4, 27, 27, 27, BLOCK_AIR);
+            });
+            ctx.report("chunk.fill_box_24", fill_ns / 2000.0, "us/op");
+        }
+    }  // namespace
+
+    void add_chunk_benchmarks(suite& s) {
+        s.add("chunk.storage", bench_chunk_storage);
+    }
+}  // namespace qc::bench
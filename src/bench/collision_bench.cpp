@@ -0,0 +1,232 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "world/collision.hpp"
+#include "world/raycast.hpp"
+#include "world/terrain.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int RADIUS = 5;
+        constexpr int LAYERS = 4;
+        constexpr int ENTITIES = 4000;
+        // Ten seconds at 20 ticks a second.
+        constexpr int TICKS = 200;
+        constexpr float TICK_S = 0.05f;
+        constexpr float GRAVITY = 32.0f;
+        constexpr float WALK_SPEED = 4.3f;
+        // Walkers climb single blocks without jumping.
+        constexpr float STEP_HEIGHT = 1.0f;
+        constexpr float HALF_WIDTH = 0.3f;
+        constexpr float HEIGHT = 1.8f;
+
+        struct walker {
+            aabb box;
+            glm::vec3 velocity{0.0f};
+        };
+
+        // The blocks in `region` one world lookup at a time, as the collider should see them.
+        std::vector<aabb> reference_gather(const world& w, const aabb& region) {
+            std::vector<aabb> blocks;
+            glm::ivec3 lo(0);
+            glm::ivec3 hi(0);
+            for (int a = 0; a < 3; a++) {
+                lo[a] = static_cast<int>(std::floor(region.min[a]));
+                hi[a] = static_cast<int>(std::ceil(region.max[a])) - 1;
+            }
+            for (int y = lo.y; y <= hi.y; y++) {
+                for (int z = lo.z; z <= hi.z; z++) {
+                    for (int x = lo.x; x <= hi.x; x++) {
+                        if (block_solid(w.get_block(glm::ivec3(x, y, z)))) {
+                            const glm::vec3 corner(glm::ivec3(x, y, z));
+                            blocks.push_back({corner, corner + glm::vec3(1.0f)});
+                        }
+                    }
+                }
+            }
+            return blocks;
+        }
+
+        bool same_blocks(std::vector<aabb> a, std::vector<aabb> b) {
+            const auto order = [](const aabb& p, const aabb& q) {
+                return std::tie(p.min.y, p.min.z, p.min.x) < std::tie(q.min.y, q.min.z, q.min.x);
+            };
+            std::sort(a.begin(), a.end(), order);
+            std::sort(b.begin(), b.end(), order);
+            if (a.size() != b.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < a.size(); i++) {
+                if (a[i].min != b[i].min) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Whether `box` sinks into a solid block further than the collider lets it touch one.
+        bool inside_block(const world& w, const aabb& box) {
+            const float e = collider::EPSILON;
+            const aabb shrunk{box.min + glm::vec3(e), box.max - glm::vec3(e)};
+            return !reference_gather(w, shrunk).empty();
+        }
+
+        // Thousands of walkers on generated terrain, as a server full of mobs would move them
+        // every tick: gravity, walking, climbing single blocks and turning at walls.
+        void bench_collision(context& ctx) {
+            world w;
+            terrain_generator generator(7);
+            for (int z = -RADIUS; z <= RADIUS; z++) {
+                for (int x = -RADIUS; x <= RADIUS; x++) {
+                    for (int y = 0; y < LAYERS; y++) {
+                        auto c = std::make_unique<chunk>();
+                        generator.generate(*c, glm::ivec3(x, y, z));
+                        w.insert(glm::ivec3(x, y, z), std::move(c));
+                    }
+                }
+            }
+
+            std::mt19937 rng(3);
+            std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+            const float span = static_cast<float>((RADIUS - 1) * CHUNK_SIZE);
+            const float top = static_cast<float>(LAYERS * CHUNK_SIZE);
+            const auto heading = [&] {
+                const float angle = 3.14159265f * unit(rng);
+                return glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * WALK_SPEED;
+            };
+
+            std::vector<walker> walkers;
+            while (walkers.size() < ENTITIES) {
+                const glm::vec3 above(span * unit(rng), top, span * unit(rng));
+                ray_hit ground;
+                if (!raycast(w, above, glm::vec3(0.0f, -1.0f, 0.0f), top, RAY_SOLID, ground)) {
+                    continue;
+                }
+                const glm::vec3 feet(above.x, static_cast<float>(ground.voxel.y + 1), above.z);
+                walker e;
+                e.box = {feet - glm::vec3(HALF_WIDTH, 0.0f, HALF_WIDTH),
+                         feet + glm::vec3(HALF_WIDTH, HEIGHT, HALF_WIDTH)};
+                e.velocity = heading();
+                // Spawn only where the walker fits, beside taller columns too.
+                if (!inside_block(w, e.box)) {
+                    walkers.push_back(e);
+                }
+            }
+            std::vector<glm::vec3> start;
+            for (const walker& e : walkers) {
+                start.push_back(e.box.min);
+            }
+
+            collider physics(w);
+            double tick_ms = 0.0;
+            double worst_ms = 0.0;
+            std::size_t climbs = 0;
+            std::size_t turns = 0;
+            bool clear = true;
+            for (int t = 0; t < TICKS; t++) {
+                const auto tick_start = std::chrono::steady_clock::now();
+                for (walker& e : walkers) {
+                    e.velocity.y -= GRAVITY * TICK_S;
+                    const glm::vec3 motion = e.velocity * TICK_S;
+                    const glm::vec3 moved = physics.move(e.box, motion, STEP_HEIGHT);
+                    if (moved.y != motion.y) {
+                        e.velocity.y = 0.0f;
+                    }
+                    climbs += motion.y < 0.0f && moved.y > 0.0f ? 1 : 0;
+
+                    // Turn at walls, and back towards the middle before walking off the world.
+                    const glm::vec3 center = 0.5f * (e.box.min + e.box.max);
+                    const bool blocked = moved.x != motion.x || moved.z != motion.z;
+                    if (blocked || std::abs(center.x) > span || std::abs(center.z) > span) {
+                        const float fall = e.velocity.y;
+                        e.velocity = std::abs(center.x) > span || std::abs(center.z) > span
+                                         ? glm::normalize(glm::vec3(-center.x, 0.0f, -center.z)) *
+                                               WALK_SPEED
+                                         : heading();
+                        e.velocity.y = fall;
+                        turns++;
+                    }
+                }
+                const double ms = std::chrono::duration<double, std::milli>(
+                                      std::chrono::steady_clock::now() - tick_start)
+                                      .count();
+                tick_ms += ms;
+                worst_ms = std::max(worst_ms, ms);
+
+                if (t % 20 == 19) {
+                    for (const walker& e : walkers) {
+                        clear = clear && !inside_block(w, e.box) && e.box.min.y > 0.0f;
+                    }
+                }
+            }
+            ctx.check(clear, "no walker ends a tick inside a block or falls out of the world");
+            ctx.check(climbs > 0, "walkers climb single blocks");
+
+            double walked = 0.0;
+            for (std::size_t i = 0; i < walkers.size(); i++) {
+                const glm::vec3 d = walkers[i].box.min - start[i];
+                walked += std::sqrt(d.x * d.x + d.z * d.z);
+            }
+            walked /= static_cast<double>(walkers.size());
+            ctx.check(walked > 4.0, "walkers get somewhere");
+
+            // Gathering the blocks around a walker out of the packed chunks against looking each
+            // one up in the world.
+            std::vector<aabb> regions;
+            for (const walker& e : walkers) {
+                regions.push_back({e.box.min - glm::vec3(0.3f, 0.8f, 0.3f),
+                                   e.box.max + glm::vec3(0.3f, STEP_HEIGHT, 0.3f)});
+            }
+            bool same = true;
+            std::size_t gathered = 0;
+            for (const aabb& region : regions) {
+                const std::vector<aabb>& blocks = physics.gather(region);
+                gathered += blocks.size();
+                same = same && same_blocks(blocks, reference_gather(w, region));
+            }
+            ctx.check(same, "the collider gathers the solid blocks a world lookup finds");
+            const double gather_ns = time_ns(5, [&] {
+                std::size_t n = 0;
+                for (const aabb& region : regions) {
+                    n += physics.gather(region).size();
+                }
+                consume(n);
+            });
+            const double reference_ns = time_ns(5, [&] {
+                std::size_t n = 0;
+                for (const aabb& region : regions) {
+                    n += reference_gather(w, region).size();
+                }
+                consume(n);
+            });
+
+            const double mean_ms = tick_ms / TICKS;
+            ctx.report("collision.entities", ENTITIES, "entities");
+            ctx.report("collision.tick", mean_ms, "ms");
+            ctx.report("collision.tick.max", worst_ms, "ms");
+            ctx.report("collision.ticks_per_s", 1000.0 / mean_ms, "ticks/s");
+            ctx.report("collision.move", mean_ms * 1e6 / ENTITIES, "ns/entity");
+            ctx.report("collision.walked", walked, "blocks");
+            ctx.report("collision.climbs", static_cast<double>(climbs), "steps");
+            ctx.report("collision.turns", static_cast<double>(turns), "turns");
+            ctx.report("collision.gather.blocks",
+                       static_cast<double>(gathered) / static_cast<double>(regions.size()),
+                       "blocks");
+            ctx.report("collision.gather", gather_ns / regions.size(), "ns/op");
+            ctx.report("collision.gather.reference", reference_ns / regions.size(), "ns/op");
+        }
+    }  // namespace
+
+    void add_collision_benchmarks(suite& s) {
+        s.add("collision", bench_collision);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,261 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "core/job_system.hpp"
+#include "ecs/components.hpp"
+#include "ecs/registry.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int ENTITIES = 100000;
+        // Every fifth entity also has health, so the query spans two archetypes; a few more
+        // have no velocity and must be left alone.
+        constexpr int WITH_HEALTH_EVERY = 5;
+        constexpr int STATIC = 5000;
+        constexpr int TICKS = 100;
+        constexpr float TICK_S = 0.05f;
+        // Entities bounce around inside a box this far out from the origin.
+        constexpr float BOUND = 512.0f;
+
+        struct health {
+            int value;
+        };
+
+        // Bigger than a whole block.
+        struct inventory {
+            int slots[6000];
+        };
+
+        // The tick every version runs.
+        void step(glm::vec3& p, glm::vec3& v) {
+            p += v * TICK_S;
+            for (int a = 0; a < 3; a++) {
+                if (std::abs(p[a]) > BOUND) {
+                    v[a] = -v[a];
+                }
+            }
+        }
+
+        // What the registry replaces: an object per entity behind a virtual update.
+        class mob {
+        public:
+            virtual ~mob() = default;
+            virtual void update() = 0;
+
+            glm::vec3 position{0.0f};
+            glm::vec3 velocity{0.0f};
+        };
+
+        class walker : public mob {
+        public:
+            void update() override {
+                step(position, velocity);
+            }
+
+            std::string name = "walker";
+            int hit_points = 20;
+        };
+
+        void move_all(std::size_t count, const entity*, position* p, velocity* v) {
+            for (std::size_t i = 0; i < count; i++) {
+                step(p[i].value, v[i].value);
+            }
+        }
+
+        double tick_ms(const std::chrono::steady_clock::time_point& start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             start)
+                .count();
+        }
+
+        // Handles go stale, components survive moves between archetypes and queries see
+        // exactly the entities that match.
+        void check_structure(context& ctx) {
+            registry r;
+            std::vector<entity> all;
+            for (int i = 0; i < 10000; i++) {
+                const glm::vec3 p(static_cast<float>(i), 0.0f, 0.0f);
+                all.push_back(r.create(position{p}, velocity{glm::vec3(1.0f)}));
+            }
+            std::size_t destroyed = 0;
+            for (std::size_t i = 0; i < all.size(); i += 3) {
+                r.destroy(all[i]);
+                destroyed++;
+            }
+            std::size_t with_health = 0;
+            std::size_t moving = 0;
+            for (std::size_t i = 0; i < all.size(); i++) {
+                if (i % 3 == 0) {
+                    continue;
+                }
+                if (i % 5 == 0) {
+                    r.add(all[i], health{static_cast<int>(i)});
+                    with_health++;
+                }
+                if (i % 7 == 0) {
+                    r.remove<velocity>(all[i]);
+                } else {
+                    moving++;
+                }
+            }
+
+            bool intact = r.size() == all.size() - destroyed;
+            for (std::size_t i = 0; i < all.size(); i++) {
+                const position* p = r.get<position>(all[i]);
+                const health* h = r.get<health>(all[i]);
+                if (i % 3 == 0) {
+                    intact = intact && !r.alive(all[i]) && p == nullptr;
+                    continue;
+                }
+                intact = intact && p != nullptr && p->value.x == static_cast<float>(i) &&
+                         r.has<velocity>(all[i]) == (i % 7 != 0) &&
+                         (i % 5 == 0 ? h != nullptr && h->value == static_cast<int>(i)
+                                     : h == nullptr);
+            }
+            ctx.check(intact, "components survive destroying others and changing archetype");
+
+            std::size_t seen_moving = 0;
+            std::size_t seen_health = 0;
+            bool handles = true;
+            r.each<position, velocity>([&](std::size_t count, const entity* e, position*,
+                                           velocity*) {
+                seen_moving += count;
+                for (std::size_t i = 0; i < count; i++) {
+                    handles = handles && r.has<velocity>(e[i]);
+                }
+            });
+            r.each<health>([&](std::size_t count, const entity*, health*) {
+                seen_health += count;
+            });
+            ctx.check(handles && seen_moving == moving && seen_health == with_health,
+                      "queries visit every matching entity once");
+
+            const entity reused = r.create(position{glm::vec3(0.0f)});
+            // Indices were handed out in creation order, so all[i] held slot i.
+            ctx.check(reused.generation == all[reused.index].generation + 1,
+                      "a reused slot gets a new generation");
+            bool stale = true;
+            for (std::size_t i = 0; i < all.size(); i += 3) {
+                stale = stale && !r.alive(all[i]) && r.get<position>(all[i]) == nullptr;
+            }
+            ctx.check(stale && r.alive(reused), "handles to destroyed entities stay dead");
+
+            std::vector<entity> carriers;
+            for (int i = 0; i < 3; i++) {
+                auto held = std::make_unique<inventory>();
+                std::fill(std::begin(held->slots), std::end(held->slots), i);
+                carriers.push_back(r.create(position{glm::vec3(static_cast<float>(i))}, *held));
+            }
+            bool whole = true;
+            for (int i = 0; i < 3; i++) {
+                const inventory* held = r.get<inventory>(carriers[i]);
+                const position* p = r.get<position>(carriers[i]);
+                whole = whole && held != nullptr && held->slots[0] == i &&
+                        held->slots[5999] == i && p != nullptr &&
+                        p->value.x == static_cast<float>(i);
+            }
+            ctx.check(whole, "components bigger than a block fit one to a block");
+        }
+
+        // 100k moving entities, ticked serially, over the job system and as virtual objects.
+        void bench_ecs(context& ctx) {
+            check_structure(ctx);
+
+            std::mt19937 rng(5);
+            std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+            registry serial;
+            registry parallel;
+            std::vector<entity> handles;
+            std::vector<std::unique_ptr<walker>> mobs;
+            for (int i = 0; i < ENTITIES; i++) {
+                const glm::vec3 p(BOUND * unit(rng), BOUND * unit(rng), BOUND * unit(rng));
+                const glm::vec3 v(8.0f * unit(rng), 8.0f * unit(rng), 8.0f * unit(rng));
+                if (i % WITH_HEALTH_EVERY == 0) {
+                    handles.push_back(serial.create(position{p}, velocity{v}, health{20}));
+                    parallel.create(position{p}, velocity{v}, health{20});
+                } else {
+                    handles.push_back(serial.create(position{p}, velocity{v}));
+                    parallel.create(position{p}, velocity{v});
+                }
+                auto m = std::make_unique<walker>();
+                m->position = p;
+                m->velocity = v;
+                mobs.push_back(std::move(m));
+            }
+            for (int i = 0; i < STATIC; i++) {
+                serial.create(position{glm::vec3(0.0f)});
+                parallel.create(position{glm::vec3(0.0f)});
+            }
+            // Mobs spawn and despawn all game long, so by now they are updated in no
+            // particular order as far as memory goes.
+            std::vector<mob*> order;
+            for (const std::unique_ptr<walker>& m : mobs) {
+                order.push_back(m.get());
+            }
+            std::shuffle(order.begin(), order.end(), rng);
+
+            job_system jobs;
+            double serial_ms = 0.0;
+            double parallel_ms = 0.0;
+            double virtual_ms = 0.0;
+            double parallel_max_ms = 0.0;
+            for (int t = 0; t < TICKS; t++) {
+                auto start = std::chrono::steady_clock::now();
+                serial.each<position, velocity>(move_all);
+                serial_ms += tick_ms(start);
+
+                start = std::chrono::steady_clock::now();
+                parallel.parallel_each<position, velocity>(jobs, move_all);
+                const double ms = tick_ms(start);
+                parallel_ms += ms;
+                parallel_max_ms = std::max(parallel_max_ms, ms);
+
+                start = std::chrono::steady_clock::now();
+                for (mob* m : order) {
+                    m->update();
+                }
+                virtual_ms += tick_ms(start);
+            }
+
+            // Same arithmetic everywhere; only the virtual version may be compiled to fuse it
+            // differently.
+            bool same = true;
+            bool close = true;
+            std::size_t index = 0;
+            parallel.each<position>([&](std::size_t count, const entity* e, position* p) {
+                for (std::size_t i = 0; i < count; i++) {
+                    const position* expected = serial.get<position>(e[i]);
+                    same = same && expected != nullptr && expected->value == p[i].value;
+                }
+            });
+            for (const entity& e : handles) {
+                const glm::vec3 d = serial.get<position>(e)->value - mobs[index++]->position;
+                close = close && glm::dot(d, d) < 1e-4f;
+            }
+            ctx.check(same, "parallel ticks match serial ticks");
+            ctx.check(close, "the registry moves entities like the virtual update does");
+
+            ctx.report("ecs.entities", ENTITIES, "entities");
+            ctx.report("ecs.archetypes", static_cast<double>(serial.archetype_count()),
+                       "archetypes");
+            ctx.report("ecs.threads", jobs.thread_count(), "threads");
+            ctx.report("ecs.tick", serial_ms / TICKS, "ms");
+            ctx.report("ecs.tick.parallel", parallel_ms / TICKS, "ms");
+            ctx.report("ecs.tick.parallel.max", parallel_max_ms, "ms");
+            ctx.report("ecs.tick.virtual", virtual_ms / TICKS, "ms");
+            ctx.report("ecs.speedup", virtual_ms / serial_ms, "x");
+        }
+    }  // namespace
+
+    void add_ecs_benchmarks(suite& s) {
+        s.add("ecs", bench_ecs);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,262 @@
+#include "bench/fake_gl.hpp"
+
+#include <cassert>
+#include <cstring>
+
+namespace qc::bench {
+    namespace {
+        fake_gl* g_current = nullptr;
+    }  // namespace
+
+    // The table entries; a struct so they can reach fake_gl's privates as one friend.
+    struct fake_gl_calls {
+        static fake_gl& current() {
+            assert(g_current != nullptr);
+            g_current->m_calls++;
+            return *g_current;
+        }
+
+        // The buffer bound to `target`, or null after counting an error.
+        static std::vector<std::uint8_t>* bound(fake_gl& gl, std::uint32_t target) {
+            const auto binding = gl.m_bindings.find(target);
+            if (binding != gl.m_bindings.end()) {
+                const auto it = gl.m_buffers.find(binding->second);
+                if (it != gl.m_buffers.end()) {
+                    return &it->second;
+                }
+            }
+            gl.m_errors++;
+            return nullptr;
+        }
+
+        static bool in_range(const std::vector<std::uint8_t>& buffer, std::ptrdiff_t offset,
+                             std::ptrdiff_t size) {
+            return offset >= 0 && size >= 0 &&
+                   static_cast<std::size_t>(offset + size) <= buffer.size();
+        }
+
+        static void gen_buffers(int n, std::uint32_t* buffers) {
+            fake_gl& gl = current();
+            for (int i = 0; i < n; i++) {
+                buffers[i] = gl.m_next_name++;
+                gl.m_buffers[buffers[i]];
+            }
+        }
+
+        static void delete_buffers(int n, const std::uint32_t* buffers) {
+            fake_gl& gl = current();
+            for (int i = 0; i < n; i++) {
+                if (gl.m_buffers.erase(buffers[i]) == 0) {
+                    gl.m_errors++;
+                }
+                for (auto& binding : gl.m_bindings) {
+                    if (binding.second == buffers[i]) {
+                        binding.second = 0;
+                    }
+                }
+            }
+        }
+
+        static void bind_buffer(std::uint32_t target, std::uint32_t buffer) {
+            fake_gl& gl = current();
+            if (buffer != 0 && gl.m_buffers.count(buffer) == 0) {
+                gl.m_errors++;
+            }
+            gl.m_bindings[target] = buffer;
+        }
+
+        static void bind_buffer_base(std::uint32_t target, std::uint32_t index,
+                                     std::uint32_t buffer) {
+            fake_gl& gl = current();
+            if (target != gl::SHADER_STORAGE_BUFFER || gl.m_buffers.count(buffer) == 0) {
+                gl.m_errors++;
+            }
+            gl.m_storage_bindings[index] = buffer;
+            gl.m_bindings[target] = buffer;
+        }
+
+        static void buffer_data(std::uint32_t target, std::ptrdiff_t size, const void* data,
+                                std::uint32_t) {
+            fake_gl& gl = current();
+            std::vector<std::uint8_t>* buffer = bound(gl, target);
+            if (buffer == nullptr || size < 0) {
+                return;
+            }
+            buffer->assign(static_cast<std::size_t>(size), 0);
+            if (data != nullptr) {
+                std::memcpy(buffer->data(), data, static_cast<std::size_t>(size));
+            }
+        }
+
+        static void buffer_sub_data(std::uint32_t target, std::ptrdiff_t offset,
+                                    std::ptrdiff_t size, const void* data) {
+            fake_gl& gl = current();
+            std::vector<std::uint8_t>* buffer = bound(gl, target);
+            if (buffer == nullptr) {
+                return;
+            }
+            if (!in_range(*buffer, offset, size)) {
+                gl.m_errors++;
+                return;
+            }
+            std::memcpy(buffer->data() + offset, data, static_cast<std::size_t>(size));
+            gl.m_bytes_uploaded += static_cast<std::size_t>(size);
+        }
+
+        static void copy_buffer_sub_data(std::uint32_t read_target, std::uint32_t write_target,
+                                         std::ptrdiff_t read_offset, std::ptrdiff_t write_offset,
+                                         std::ptrdiff_t size) {
+            fake_gl& gl = current();
+            std::vector<std::uint8_t>* from = bound(gl, read_target);
+            std::vector<std::uint8_t>* to = bound(gl, write_target);
+            if (from == nullptr || to == nullptr) {
+                return;
+            }
+            if (from == to || !in_range(*from, read_offset, size) ||
+                !in_range(*to, write_offset, size)) {
+                gl.m_errors++;
+                return;
+            }
+            std::memcpy(to->data() + write_offset, from->data() + read_offset,
+                        static_cast<std::size_t>(size));
+        }
+
+        static void gen_vertex_arrays(int n, std::uint32_t* arrays) {
+            fake_gl& gl = current();
+            for (int i = 0; i < n; i++) {
+                arrays[i] = gl.m_next_name++;
+                gl.m_vertex_arrays[arrays[i]];
+            }
+        }
+
+        static void delete_vertex_arrays(int n, const std::uint32_t* arrays) {
+            fake_gl& gl = current();
+            for (int i = 0; i < n; i++) {
+                if (gl.m_vertex_arrays.erase(arrays[i]) == 0) {
+                    gl.m_errors++;
+                }
+            }
+        }
+
+        static void bind_vertex_array(std::uint32_t array) {
+            fake_gl& gl = current();
+            if (array != 0 && gl.m_vertex_arrays.count(array) == 0) {
+                gl.m_errors++;
+            }
+            gl.m_bound_vertex_array = array;
+        }
+
+        // Only attribute 0 exists; the renderer has no other.
+        static fake_gl::vertex_array* attribute(fake_gl& gl, std::uint32_t index) {
+            const auto it = gl.m_vertex_arrays.find(gl.m_bound_vertex_array);
+            if (index != 0 || it == gl.m_vertex_arrays.end()) {
+                gl.m_errors++;
+                return nullptr;
+            }
+            return &it->second;
+        }
+
+        static void enable_vertex_attrib_array(std::uint32_t index) {
+            fake_gl& gl = current();
+            if (fake_gl::vertex_array* array = attribute(gl, index)) {
+                array->enabled = true;
+            }
+        }
+
+        static void vertex_attrib_i_pointer(std::uint32_t index, int size, std::uint32_t type,
+                                            int stride, const void* pointer) {
+            fake_gl& gl = current();
+            fake_gl::vertex_array* array = attribute(gl, index);
+            if (array == nullptr || bound(gl, gl::ARRAY_BUFFER) == nullptr) {
+                return;
+            }
+            // The renderer's one layout: tightly packed ivec3s from the start of the buffer.
+            if (size != 3 || type != gl::INT || stride != 12 || pointer != nullptr) {
+                gl.m_errors++;
+            }
+            array->buffer = gl.m_bindings[gl::ARRAY_BUFFER];
+        }
+
+        static void vertex_attrib_divisor(std::uint32_t index, std::uint32_t divisor) {
+            fake_gl& gl = current();
+            if (fake_gl::vertex_array* array = attribute(gl, index)) {
+                array->divisor = divisor;
+            }
+        }
+
+        static void multi_draw_arrays_indirect(std::uint32_t mode, const void* indirect,
+                                               int draw_count, int stride) {
+            fake_gl& gl = current();
+            fake_gl::vertex_array* array = attribute(gl, 0);
+            const std::vector<std::uint8_t>* commands = bound(gl, gl::DRAW_INDIRECT_BUFFER);
+            const auto storage = gl.m_storage_bindings.find(0);
+            if (array == nullptr || commands == nullptr || storage == gl.m_storage_bindings.end() ||
+                gl.m_buffers.count(storage->second) == 0) {
+                gl.m_errors++;
+                return;
+            }
+            const std::vector<std::uint8_t>& quads = gl.m_buffers[storage->second];
+            const std::vector<std::uint8_t>* origins = nullptr;
+            if (array->enabled && array->divisor == 1 && gl.m_buffers.count(array->buffer) != 0) {
+                origins = &gl.m_buffers[array->buffer];
+            }
+
+            fake_gl::draw_call call{mode, {}, storage->second, array->buffer};
+            const std::ptrdiff_t step =
+                stride == 0 ? sizeof(draw_arrays_indirect_command) : stride;
+            const std::ptrdiff_t offset = reinterpret_cast<std::ptrdiff_t>(indirect);
+            for (int i = 0; i < draw_count; i++) {
+                draw_arrays_indirect_command command;
+                if (!in_range(*commands, offset + i * step, sizeof(command))) {
+                    gl.m_errors++;
+                    return;
+                }
+                std::memcpy(&command, commands->data() + offset + i * step, sizeof(command));
+                // Vertices past the storage buffer, or an origin past the attribute's buffer,
+                // would be undefined reads on a GPU.
+                const std::size_t vertices = quads.size() / 8 * 6;
+                const std::size_t origin_end = (command.base_instance + std::size_t{1}) * 12;
+                if (command.first + std::size_t{command.count} > vertices ||
+                    command.count % 6 != 0 || command.first % 6 != 0 || origins == nullptr ||
+                    origin_end > origins->size()) {
+                    gl.m_errors++;
+                }
+                call.commands.push_back(command);
+            }
+            gl.m_draws.push_back(std::move(call));
+        }
+    };
+
+    fake_gl::fake_gl() {
+        assert(g_current == nullptr);
+        g_current = this;
+    }
+
+    fake_gl::~fake_gl() {
+        g_current = nullptr;
+    }
+
+    gl_functions fake_gl::functions() const {
+        gl_functions gl;
+        gl.gen_buffers = fake_gl_calls::gen_buffers;
+        gl.delete_buffers = fake_gl_calls::delete_buffers;
+        gl.bind_buffer = fake_gl_calls::bind_buffer;
+        gl.bind_buffer_base = fake_gl_calls::bind_buffer_base;
+        gl.buffer_data = fake_gl_calls::buffer_data;
+        gl.buffer_sub_data = fake_gl_calls::buffer_sub_data;
+        gl.copy_buffer_sub_data = fake_gl_calls::copy_buffer_sub_data;
+        gl.gen_vertex_arrays = fake_gl_calls::gen_vertex_arrays;
+        gl.delete_vertex_arrays = fake_gl_calls::delete_vertex_arrays;
+        gl.bind_vertex_array = fake_gl_calls::bind_vertex_array;
+        gl.enable_vertex_attrib_array = fake_gl_calls::enable_vertex_attrib_array;
+        gl.vertex_attrib_i_pointer = fake_gl_calls::vertex_attrib_i_pointer;
+        gl.vertex_attrib_divisor = fake_gl_calls::vertex_attrib_divisor;
+        gl.multi_draw_arrays_indirect = fake_gl_calls::multi_draw_arrays_indirect;
+        return gl;
+    }
+
+    const std::vector<std::uint8_t>* fake_gl::buffer(std::uint32_t name) const {
+        const auto it = m_buffers.find(name);
+        return it != m_buffers.end() ? &it->second : nullptr;
+    }
+}  // namespace qc::bench
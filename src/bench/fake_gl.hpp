@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "render/gl_api.hpp"
+
+namespace qc::bench {
+    // A GL function table backed by memory instead of a driver, so renderer code can be checked
+    // without a context. Buffers hold real bytes, copies and uploads are applied to them, and
+    // every indirect draw is recorded with the commands it read. Misuse a driver would reject or
+    // that would read out of bounds is counted in errors() rather than crashing.
+    //
+    // The table's functions reach the fake through a global, so only one may exist at a time.
+    class fake_gl {
+    public:
+        struct draw_call {
+            std::uint32_t mode;
+            std::vector<draw_arrays_indirect_command> commands;
+            // Buffers bound at draw time: shader storage binding 0 and vertex attribute 0.
+            std::uint32_t storage_buffer;
+            std::uint32_t origin_buffer;
+        };
+
+        fake_gl();
+        ~fake_gl();
+
+        fake_gl(const fake_gl&) = delete;
+        fake_gl& operator=(const fake_gl&) = delete;
+
+        gl_functions functions() const;
+
+        // Contents of buffer `name`, or null if it does not exist.
+        const std::vector<std::uint8_t>* buffer(std::uint32_t name) const;
+
+        std::size_t buffer_count() const {
+            return m_buffers.size();
+        }
+
+        const std::vector<draw_call>& draws() const {
+            return m_draws;
+        }
+
+        void clear_draws() {
+            m_draws.clear();
+        }
+
+        // Every GL call made so far.
+        std::size_t calls() const {
+            return m_calls;
+        }
+
+        std::size_t errors() const {
+            return m_errors;
+        }
+
+        // Bytes passed to glBufferSubData so far.
+        std::size_t bytes_uploaded() const {
+            return m_bytes_uploaded;
+        }
+
+    private:
+        struct vertex_array {
+            bool enabled = false;
+            std::uint32_t divisor = 0;
+            std::uint32_t buffer = 0;
+        };
+
+        friend struct fake_gl_calls;
+
+        std::unordered_map<std::uint32_t, std::vector<std::uint8_t>> m_buffers;
+        std::unordered_map<std::uint32_t, vertex_array> m_vertex_arrays;
+        std::unordered_map<std::uint32_t, std::uint32_t> m_bindings;
+        std::unordered_map<std::uint32_t, std::uint32_t> m_storage_bindings;
+        std::uint32_t m_bound_vertex_array = 0;
+        std::uint32_t m_next_name = 1;
+
+        std::vector<draw_call> m_draws;
+        std::size_t m_calls = 0;
+        std::size_t m_errors = 0;
+        std::size_t m_bytes_uploaded = 0;
+    };
+}  // namespace qc::bench
@@ -0,0 +1,304 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "world/block_ticks.hpp"
+#include "world/fluid.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        // Chunks of stone, CHUNKS x 1 x CHUNKS, for the scheduler runs.
+        constexpr int CHUNKS = 4;
+        constexpr int CHECKED_TICKS = 200000;
+        constexpr int STEADY_PENDING = 400000;
+        constexpr int STEADY_TICKS = 3000;
+        constexpr std::uint32_t STEADY_DELAY = 1000;
+
+        // A basin BASIN blocks across and DEPTH deep on a stone floor, fed by a grid of
+        // springs above it until half full.
+        constexpr int BASIN = 40;
+        constexpr int DEPTH = 8;
+        constexpr int FLOOR = 4;
+        constexpr int SPRING_Y = FLOOR + DEPTH + 3;
+        constexpr int MAX_TICKS = 20000;
+
+        double elapsed_ms(const std::chrono::steady_clock::time_point& start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             start)
+                .count();
+        }
+
+        void fill_stone(world& w) {
+            for (int z = 0; z < CHUNKS; z++) {
+                for (int x = 0; x < CHUNKS; x++) {
+                    w.insert(glm::ivec3(x, 0, z), std::make_unique<chunk>(BLOCK_STONE));
+                }
+            }
+        }
+
+        glm::ivec3 random_voxel(std::mt19937& rng) {
+            std::uniform_int_distribution<int> coord(0, CHUNKS * CHUNK_SIZE - 1);
+            std::uniform_int_distribution<int> height(0, CHUNK_SIZE - 1);
+            return glm::ivec3(coord(rng), height(rng), coord(rng));
+        }
+
+        // Delays from a tick to past the coarsest wheel, mostly short as in play.
+        std::uint32_t random_delay(std::mt19937& rng) {
+            const std::uint32_t r = rng();
+            const std::uint32_t reach = r % 100 < 70   ? 64
+                                        : r % 100 < 90 ? 4096
+                                        : r % 100 < 99 ? 262144
+                                                       : 600000;
+            return 1 + (rng() % reach);
+        }
+
+        // Every tick fires exactly when it was due, whether scheduled up front or from a
+        // handler, and a block never has two pending.
+        void check_timing(context& ctx) {
+            world w;
+            fill_stone(w);
+            block_scheduler scheduler(w);
+            std::mt19937 rng(1);
+            std::unordered_map<glm::ivec3, std::uint64_t, chunk_pos_hash> due;
+            bool on_time = true;
+            scheduler.on(BLOCK_STONE, TICK_SCHEDULED, [&](const glm::ivec3& v) {
+                const auto it = due.find(v);
+                on_time = on_time && it != due.end() && it->second == scheduler.now() &&
+                          !scheduler.scheduled(v);
+                if (it != due.end()) {
+                    due.erase(it);
+                }
+                if (rng() % 3 == 0) {
+                    const std::uint32_t delay = random_delay(rng);
+                    scheduler.schedule(v, delay);
+                    due[v] = scheduler.now() + delay;
+                }
+            });
+            for (int i = 0; i < CHECKED_TICKS; i++) {
+                const glm::ivec3 v = random_voxel(rng);
+                const std::uint32_t delay = random_delay(rng);
+                scheduler.schedule(v, delay);
+                // Only the first of two ticks for the same block counts.
+                due.emplace(v, delay);
+            }
+            ctx.check(scheduler.pending() == due.size(), "a block has at most one tick pending");
+            while (scheduler.pending() > 0) {
+                scheduler.tick();
+            }
+            ctx.check(on_time && due.empty(), "delayed ticks fire on the tick they are due");
+            ctx.report("fluid.wheels.ticks", static_cast<double>(scheduler.now()), "ticks");
+        }
+
+        // The same churn of ticks through the wheels and through one global priority queue:
+        // every tick fires what is due and schedules each of them again.
+        void bench_scheduling(context& ctx) {
+            world w;
+            fill_stone(w);
+            std::mt19937 rng(2);
+            std::vector<glm::ivec3> voxels;
+            block_scheduler scheduler(w);
+            std::size_t fired = 0;
+            scheduler.on(BLOCK_STONE, TICK_SCHEDULED, [&](const glm::ivec3& v) {
+                fired++;
+                scheduler.schedule(v, 1 + rng() % STEADY_DELAY);
+            });
+            for (int i = 0; i < STEADY_PENDING; i++) {
+                const glm::ivec3 v = random_voxel(rng);
+                if (!scheduler.scheduled(v)) {
+                    scheduler.schedule(v, 1 + rng() % STEADY_DELAY);
+                    voxels.push_back(v);
+                }
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (int t = 0; t < STEADY_TICKS; t++) {
+                scheduler.tick();
+            }
+            const double wheels_ms = elapsed_ms(start);
+
+            using entry = std::pair<std::uint64_t, glm::ivec3>;
+            const auto later = [](const entry& a, const entry& b) { return a.first > b.first; };
+            std::priority_queue<entry, std::vector<entry>, decltype(later)> queue(later);
+            for (const glm::ivec3& v : voxels) {
+                queue.push({1 + rng() % STEADY_DELAY, v});
+            }
+            std::size_t popped = 0;
+            start = std::chrono::steady_clock::now();
+            for (std::uint64_t now = 1; now <= STEADY_TICKS; now++) {
+                while (queue.top().first == now) {
+                    const glm::ivec3 v = queue.top().second;
+                    queue.pop();
+                    popped += w.get_block(v) == BLOCK_STONE ? 1 : 0;
+                    queue.push({now + 1 + rng() % STEADY_DELAY, v});
+                }
+            }
+            const double queue_ms = elapsed_ms(start);
+            consume(popped);
+
+            ctx.report("fluid.wheels.pending", static_cast<double>(voxels.size()), "ticks");
+            ctx.report("fluid.wheels.tick", wheels_ms * 1e6 / static_cast<double>(fired), "ns/op");
+            ctx.report("fluid.queue.tick", queue_ms * 1e6 / static_cast<double>(popped), "ns/op");
+        }
+
+        // Uniform chunks without random-ticking blocks are skipped whole; the rest get the
+        // same number of picks each tick.
+        void check_random(context& ctx) {
+            world w;
+            for (int x = 0; x < 4; x++) {
+                w.insert(glm::ivec3(x, 0, 0), std::make_unique<chunk>(BLOCK_GRASS));
+                w.insert(glm::ivec3(x, 0, 1), std::make_unique<chunk>(BLOCK_STONE));
+            }
+            auto mixed = std::make_unique<chunk>(BLOCK_STONE);
+            mixed->fill(0, 0, 0, CHUNK_SIZE - 1, CHUNK_SIZE / 2 - 1, CHUNK_SIZE - 1, BLOCK_GRASS);
+            w.insert(glm::ivec3(0, 1, 0), std::move(mixed));
+
+            block_scheduler scheduler(w);
+            std::size_t grass = 0;
+            scheduler.on(BLOCK_GRASS, TICK_RANDOM, [&](const glm::ivec3&) { grass++; });
+            constexpr int TICKS = 100;
+            constexpr int PER_CHUNK = block_scheduler::RANDOM_TICKS * 8;
+            for (int t = 0; t < TICKS; t++) {
+                scheduler.tick();
+            }
+            const std::size_t uniform = TICKS * 4 * PER_CHUNK;
+            const std::size_t half = TICKS * PER_CHUNK / 2;
+            ctx.check(grass >= uniform + half * 8 / 10 && grass <= uniform + half * 12 / 10,
+                      "random ticks pick blocks evenly and only ones that take them");
+        }
+
+        // Sum of water over the basin chunks, and whether all of it is inside the basin.
+        std::uint64_t total_water(const fluid_sim& water, bool& contained) {
+            std::uint64_t units = 0;
+            contained = true;
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                for (int z = -CHUNK_SIZE; z < CHUNK_SIZE; z++) {
+                    for (int x = -CHUNK_SIZE; x < CHUNK_SIZE; x++) {
+                        const int level = water.level(glm::ivec3(x, y, z));
+                        const int half = BASIN / 2;
+                        const bool inside = x >= -half && x < half && z >= -half && z < half &&
+                                            y >= FLOOR && y < FLOOR + DEPTH;
+                        contained = contained && (inside || level == 0);
+                        units += static_cast<std::uint64_t>(level);
+                    }
+                }
+            }
+            return units;
+        }
+
+        // Settled water rests on full water or the floor and differs by at most one unit from
+        // the water beside it.
+        bool settled(const world& w, const fluid_sim& water) {
+            const int half = BASIN / 2;
+            bool ok = true;
+            for (int y = FLOOR; y < FLOOR + DEPTH; y++) {
+                for (int z = -half; z < half; z++) {
+                    for (int x = -half; x < half; x++) {
+                        const glm::ivec3 v(x, y, z);
+                        const int level = water.level(v);
+                        if (level == 0) {
+                            continue;
+                        }
+                        ok = ok && (y == FLOOR ||
+                                    water.level(v - glm::ivec3(0, 1, 0)) == fluid_sim::MAX_LEVEL);
+                        for (const glm::ivec3& d : {glm::ivec3(1, 0, 0), glm::ivec3(0, 0, 1)}) {
+                            const glm::ivec3 n = v + d;
+                            ok = ok && (block_solid(w.get_block(n)) ||
+                                        std::abs(water.level(n) - level) <= 1);
+                        }
+                    }
+                }
+            }
+            return ok;
+        }
+
+        // Springs pour into an empty basin until it is half full, then the water settles.
+        void bench_flood(context& ctx) {
+            world w;
+            for (int z = -1; z <= 0; z++) {
+                for (int x = -1; x <= 0; x++) {
+                    auto c = std::make_unique<chunk>();
+                    c->fill(0, 0, 0, CHUNK_SIZE - 1, FLOOR - 1, CHUNK_SIZE - 1, BLOCK_STONE);
+                    w.insert(glm::ivec3(x, 0, z), std::move(c));
+                }
+            }
+            const int half = BASIN / 2;
+            for (int y = FLOOR; y <= FLOOR + DEPTH; y++) {
+                for (int i = -half - 1; i <= half; i++) {
+                    w.set_block(glm::ivec3(i, y, -half - 1), BLOCK_STONE);
+                    w.set_block(glm::ivec3(i, y, half), BLOCK_STONE);
+                    w.set_block(glm::ivec3(-half - 1, y, i), BLOCK_STONE);
+                    w.set_block(glm::ivec3(half, y, i), BLOCK_STONE);
+                }
+            }
+
+            block_scheduler scheduler(w);
+            fluid_sim water(scheduler, w);
+            std::vector<glm::ivec3> springs;
+            for (int z = -1; z <= 1; z++) {
+                for (int x = -1; x <= 1; x++) {
+                    springs.push_back(glm::ivec3(x * BASIN / 3, SPRING_Y, z * BASIN / 3));
+                    water.add_spring(springs.back());
+                }
+            }
+
+            const std::uint64_t target =
+                static_cast<std::uint64_t>(BASIN * BASIN * DEPTH * fluid_sim::MAX_LEVEL / 2);
+            std::size_t fired = 0;
+            double worst_ms = 0.0;
+            int ticks = 0;
+            const auto start = std::chrono::steady_clock::now();
+            while (ticks < MAX_TICKS && (water.sprung() < target || scheduler.pending() > 0)) {
+                if (water.sprung() >= target) {
+                    for (const glm::ivec3& s : springs) {
+                        water.remove_spring(s);
+                    }
+                }
+                const auto tick_start = std::chrono::steady_clock::now();
+                scheduler.tick();
+                worst_ms = std::max(worst_ms, elapsed_ms(tick_start));
+                fired += scheduler.fired(TICK_SCHEDULED) + scheduler.fired(TICK_NEIGHBOR);
+                ticks++;
+            }
+            const double total_ms = elapsed_ms(start);
+            std::vector<glm::ivec3> changes;
+            scheduler.take_changes(changes);
+
+            bool contained = false;
+            const std::uint64_t units = total_water(water, contained);
+            ctx.check(water.sprung() >= target && scheduler.pending() == 0,
+                      "the basin fills and the water comes to rest");
+            ctx.check(units == water.sprung(), "flowing water is conserved");
+            ctx.check(contained, "the water stays inside the basin");
+            ctx.check(settled(w, water), "resting water is level");
+
+            ctx.report("fluid.flood.units", static_cast<double>(units), "units");
+            ctx.report("fluid.flood.ticks", ticks, "ticks");
+            ctx.report("fluid.flood", total_ms, "ms");
+            ctx.report("fluid.flood.tick", total_ms / ticks, "ms");
+            ctx.report("fluid.flood.tick.max", worst_ms, "ms");
+            ctx.report("fluid.flood.updates", static_cast<double>(fired) / ticks, "ticks/tick");
+            ctx.report("fluid.flood.changes", static_cast<double>(changes.size()), "blocks");
+        }
+
+        void bench_fluid(context& ctx) {
+            check_timing(ctx);
+            check_random(ctx);
+            bench_scheduling(ctx);
+            bench_flood(ctx);
+        }
+    }  // namespace
+
+    void add_fluid_benchmarks(suite& s) {
+        s.add("fluid", bench_fluid);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,106 @@
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "render/frustum.hpp"
+#include "render/visibility.hpp"
+
+namespace qc::bench {
+    namespace {
+        // A 64-chunk render distance, four chunks deep, split into sections.
+        constexpr int RADIUS = 64;
+        constexpr int LAYERS = 4;
+        constexpr int FRAMES = 16;
+
+        glm::mat4 camera(float angle) {
+            const glm::vec3 eye(0.0f, 80.0f, 0.0f);
+            const glm::vec3 forward(std::sin(angle), -0.3f, std::cos(angle));
+            return glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 2048.0f) *
+                   glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+
+        // The reference: one glm box at a time.
+        void naive_cull(const frustum& view, const std::vector<aabb>& boxes,
+                        std::vector<std::uint32_t>& visible) {
+            visible.clear();
+            for (std::size_t i = 0; i < boxes.size(); i++) {
+                if (view.intersects(boxes[i])) {
+                    visible.push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+        }
+
+        void bench_frustum(context& ctx) {
+            bounds_table table;
+            std::vector<aabb> boxes;
+            const float size = static_cast<float>(SECTION_SIZE);
+            const int sections = RADIUS * CHUNK_SECTIONS;
+            for (int z = -sections; z < sections; z++) {
+                for (int x = -sections; x < sections; x++) {
+                    if (x * x + z * z > sections * sections) {
+                        continue;
+                    }
+                    for (int y = 0; y < LAYERS * CHUNK_SECTIONS; y++) {
+                        const glm::vec3 min(glm::vec3(glm::ivec3(x, y, z)) * size);
+                        boxes.push_back({min, min + glm::vec3(size)});
+                        table.insert(glm::ivec3(x, y, z), boxes.back());
+                    }
+                }
+            }
+
+            // Erasing moves boxes around; the table must still hold exactly the boxes kept.
+            {
+                bounds_table edited;
+                for (std::size_t i = 0; i < 1000; i++) {
+                    edited.insert(glm::ivec3(static_cast<int>(i), 0, 0), boxes[i]);
+                }
+                for (std::size_t i = 0; i < 1000; i += 3) {
+                    edited.erase(glm::ivec3(static_cast<int>(i), 0, 0));
+                }
+                bool kept = edited.size() == 666;
+                for (std::size_t i = 0; i < edited.size(); i++) {
+                    const aabb box = edited.box(i);
+                    const aabb& expected = boxes[static_cast<std::size_t>(edited.key(i).x)];
+                    kept = kept && edited.key(i).x % 3 != 0 && box.min == expected.min &&
+                           box.max == expected.max;
+                }
+                ctx.check(kept, "erase keeps the other boxes under their keys");
+            }
+
+            const char* names[SIMD_LEVEL_COUNT] = {"frustum.scalar", "frustum.sse2",
+                                                   "frustum.avx2"};
+            const int levels = best_simd_level() + 1;
+            std::vector<std::uint32_t> expected;
+            std::vector<std::uint32_t> visible;
+            double naive_ns = 0.0;
+            double table_ns[SIMD_LEVEL_COUNT] = {};
+            std::size_t kept = 0;
+            bool agree = true;
+            for (int frame = 0; frame < FRAMES; frame++) {
+                const frustum view(camera(glm::radians(360.0f * frame / FRAMES)));
+                naive_ns += time_ns(1, [&] { naive_cull(view, boxes, expected); });
+                kept += expected.size();
+                for (int level = 0; level < levels; level++) {
+                    table_ns[level] += time_ns(
+                        1, [&] { view.cull(table, visible, static_cast<simd_level>(level)); });
+                    agree = agree && visible == expected;
+                }
+            }
+            ctx.check(agree, "every SIMD path keeps exactly the boxes intersects() keeps");
+
+            ctx.report("frustum.boxes", static_cast<double>(boxes.size()), "sections");
+            ctx.report("frustum.visible", 100.0 * kept / FRAMES / boxes.size(), "%");
+            ctx.report("frustum.naive", naive_ns / FRAMES / 1e6, "ms/frame");
+            for (int level = 0; level < levels; level++) {
+                ctx.report(names[level], table_ns[level] / FRAMES / 1e6, "ms/frame");
+            }
+            ctx.report("frustum.speedup", naive_ns / table_ns[levels - 1], "x");
+        }
+    }  // namespace
+
+    void add_frustum_benchmarks(suite& s) {
+        s.add("render.frustum", bench_frustum);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,84 @@
+#include "bench/image.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+// Set by the build to the source tree's fixture directory; the fallback works when running
+// from the repository root.
+#if !defined(QC_FIXTURE_DIR)
+#define QC_FIXTURE_DIR "src/bench/fixtures"
+#endif
+
+namespace qc::bench {
+    bool write_pgm(const std::string& path, const gray_image& image) {
+        std::ofstream file(path, std::ios::binary);
+        file << "P5\n" << image.width << ' ' << image.height << "\n255\n";
+        file.write(reinterpret_cast<const char*>(image.pixels.data()),
+                   static_cast<std::streamsize>(image.pixels.size()));
+        if (!file) {
+            spdlog::error("cannot write {}", path);
+            return false;
+        }
+        return true;
+    }
+
+    bool read_pgm(const std::string& path, gray_image& image) {
+        std::ifstream file(path, std::ios::binary);
+        std::string magic;
+        int max_value = 0;
+        file >> magic >> image.width >> image.height >> max_value;
+        if (!file || magic != "P5" || max_value != 255 || image.width <= 0 || image.height <= 0) {
+            return false;
+        }
+        file.get();
+        image.pixels.resize(static_cast<std::size_t>(image.width) * image.height);
+        file.read(reinterpret_cast<char*>(image.pixels.data()),
+                  static_cast<std::streamsize>(image.pixels.size()));
+        return static_cast<bool>(file);
+    }
+
+    void check_fixture(context& ctx, const std::string& name, const gray_image& actual,
+                       int tolerance) {
+        const std::string path = std::string(QC_FIXTURE_DIR) + "/" + name + ".pgm";
+        if (std::getenv("QC_UPDATE_FIXTURES") != nullptr) {
+            ctx.check(write_pgm(path, actual), "fixtures are rewritten");
+            spdlog::info("  updated {}", path);
+            return;
+        }
+
+        gray_image expected;
+        if (!read_pgm(path, expected)) {
+            spdlog::error("  cannot read fixture {}", path);
+            ctx.check(false, "fixtures are readable");
+            return;
+        }
+        int differing = 0;
+        gray_image diff{actual.width, actual.height,
+                        std::vector<std::uint8_t>(actual.pixels.size(), 0)};
+        if (expected.width == actual.width && expected.height == actual.height) {
+            for (std::size_t i = 0; i < actual.pixels.size(); i++) {
+                if (std::abs(actual.pixels[i] - expected.pixels[i]) > tolerance) {
+                    diff.pixels[i] = 255;
+                    differing++;
+                }
+            }
+        } else {
+            differing = actual.width * actual.height;
+        }
+        if (differing == 0) {
+            return;
+        }
+
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        const std::string actual_path = (directory / (name + ".actual.pgm")).string();
+        const std::string diff_path = (directory / (name + ".diff.pgm")).string();
+        write_pgm(actual_path, actual);
+        write_pgm(diff_path, diff);
+        spdlog::error("  {} pixels differ from {}; see {} and {}", differing, path, actual_path,
+                      diff_path);
+        ctx.check(false, "images match their fixtures");
+    }
+}  // namespace qc::bench
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bench/bench.hpp"
+
+namespace qc::bench {
+    // An 8-bit greyscale image, row 0 at the top.
+    struct gray_image {
+        int width = 0;
+        int height = 0;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    // Binary PGM (P5) with a maximum value of 255.
+    bool write_pgm(const std::string& path, const gray_image& image);
+    bool read_pgm(const std::string& path, gray_image& image);
+
+    // Compares `actual` with the fixture src/bench/fixtures/<name>.pgm, allowing each pixel to
+    // differ by `tolerance` levels. On a mismatch the actual image and a diff marking the
+    // differing pixels are written to the temp directory and the check fails. Setting the
+    // QC_UPDATE_FIXTURES environment variable rewrites the fixture instead.
+    void check_fixture(context& ctx, const std::string& name, const gray_image& actual,
+                       int tolerance);
+}  // namespace qc::bench
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "core/job_system.hpp"
+#include "world/terrain.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int WORLD_RADIUS = 8;
+        constexpr int WORLD_LAYERS = 3;
+        constexpr std::uint32_t WORLD_SEED = 42;
+
+        void check_dependencies(context& ctx) {
+            // A random DAG: every job must finish after all of its dependencies.
+            constexpr int JOBS = 2000;
+            std::mt19937 rng(17);
+            std::vector<std::vector<int>> deps(JOBS);
+            std::vector<int> finished(JOBS, 0);
+            std::atomic<int> sequence{0};
+
+            job_system jobs(4);
+            std::vector<job_handle> handles;
+            for (int i = 0; i < JOBS; i++) {
+                std::vector<job_handle> on;
+                for (int k = 0; k < 3 && i > 0; k++) {
+                    const int d = static_cast<int>(rng() % static_cast<std::uint32_t>(i));
+                    deps[i].push_back(d);
+                    on.push_back(handles[d]);
+                }
+                const job_priority priority = static_cast<job_priority>(rng() % PRIORITY_COUNT);
+                handles.push_back(jobs.submit([&, i] { finished[i] = ++sequence; }, priority, on));
+            }
+            jobs.wait_idle();
+
+            bool ordered = true;
+            for (int i = 0; i < JOBS; i++) {
+                for (int d : deps[i]) {
+                    ordered &= finished[i] > finished[d] && finished[d] > 0;
+                }
+            }
+            ctx.check(ordered, "jobs run after their dependencies");
+
+            // With the only worker held up, queued jobs must come out most urgent first.
+            job_system single(1);
+            std::atomic<bool> release{false};
+            std::vector<int> order;
+            single.submit([&] {
+                while (!release.load()) {
+                    std::this_thread::yield();
+                }
+            });
+            single.submit([&] { order.push_back(PRIORITY_LOW); }, PRIORITY_LOW);
+            single.submit([&] { order.push_back(PRIORITY_NORMAL); }, PRIORITY_NORMAL);
+            single.submit([&] { order.push_back(PRIORITY_CRITICAL); }, PRIORITY_CRITICAL);
+            single.submit([&] { order.push_back(PRIORITY_HIGH); }, PRIORITY_HIGH);
+            release = true;
+            single.wait_idle();
+            ctx.check(order == std::vector<int>{PRIORITY_CRITICAL, PRIORITY_HIGH, PRIORITY_NORMAL,
+                                                PRIORITY_LOW},
+                      "queued jobs run in priority order");
+        }
+
+        struct world_run {
+            double ms = 0.0;
+            std::size_t chunks = 0;
+            std::size_t quads = 0;
+            // Mean horizontal distance of the first and last quarter of chunks meshed.
+            double early_distance = 0.0;
+            double late_distance = 0.0;
+        };
+
+        // Generates and meshes every chunk within WORLD_RADIUS columns of the origin. Chunks are
+        // submitted nearest first with priority falling off with distance, and each mesh job
+        // waits for the generation of its chunk and the six neighbours it reads borders from.
+        world_run generate_and_mesh(unsigned threads) {
+            world w;
+            std::vector<glm::ivec3> positions;
+            for (int z = -WORLD_RADIUS; z <= WORLD_RADIUS; z++) {
+                for (int x = -WORLD_RADIUS; x <= WORLD_RADIUS; x++) {
+                    if (x * x + z * z > WORLD_RADIUS * WORLD_RADIUS) {
+                        continue;
+                    }
+                    for (int y = 0; y < WORLD_LAYERS; y++) {
+                        positions.emplace_back(x, y, z);
+                        w.get_or_create(positions.back());
+                    }
+                }
+            }
+
+            const auto distance = [](const glm::ivec3& p) {
+                return std::sqrt(static_cast<float>(p.x * p.x + p.z * p.z));
+            };
+            std::stable_sort(positions.begin(), positions.end(),
+                             [&](const glm::ivec3& a, const glm::ivec3& b) {
+                                 return distance(a) < distance(b);
+                             });
+            const auto priority_of = [&](const glm::ivec3& p) {
+                const int level = static_cast<int>(distance(p) * PRIORITY_COUNT /
+                                                   (WORLD_RADIUS + 1.0f));
+                return static_cast<job_priority>(std::min(level, PRIORITY_COUNT - 1));
+            };
+
+            job_system jobs(threads);
+            std::vector<std::unique_ptr<terrain_generator>> generators;
+            std::vector<std::unique_ptr<mesher>> meshers;
+            for (unsigned i = 0; i < jobs.thread_count(); i++) {
+                generators.push_back(std::make_unique<terrain_generator>(WORLD_SEED));
+                meshers.push_back(std::make_unique<mesher>());
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+
+            std::unordered_map<glm::ivec3, job_handle, chunk_pos_hash> generated;
+            for (const glm::ivec3& p : positions) {
+                chunk* c = w.find(p);
+                generated[p] = jobs.submit(
+                    [&, c, p] { generators[jobs.current_worker()]->generate(*c, p); },
+                    priority_of(p));
+            }
+
+            std::vector<std::vector<packed_quad>> meshes(positions.size());
+            std::vector<int> mesh_order;
+            mesh_order.reserve(positions.size());
+            std::mutex order_mutex;
+            for (std::size_t i = 0; i < positions.size(); i++) {
+                const glm::ivec3 p = positions[i];
+                // The mesher reads all 26 neighbours for ambient occlusion, so every one of
+                // them must be generated first.
+                std::vector<job_handle> deps;
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dz = -1; dz <= 1; dz++) {
+                        for (int dx = -1; dx <= 1; dx++) {
+                            const auto it = generated.find(p + glm::ivec3(dx, dy, dz));
+                            if (it != generated.end()) {
+                                deps.push_back(it->second);
+                            }
+                        }
+                    }
+                }
+
+                const chunk_neighborhood n = w.neighborhood(p);
+                jobs.submit(
+                    [&, n, i] {
+                        meshers[jobs.current_worker()]->build(n, meshes[i]);
+                        std::lock_guard<std::mutex> lock(order_mutex);
+                        mesh_order.push_back(static_cast<int>(i));
+                    },
+                    priority_of(p), deps);
+            }
+            jobs.wait_idle();
+            const auto end = std::chrono::steady_clock::now();
+
+            world_run run;
+            run.ms = std::chrono::duration<double, std::milli>(end - start).count();
+            run.chunks = positions.size();
+            for (const std::vector<packed_quad>& mesh : meshes) {
+                run.quads += mesh.size();
+            }
+            const std::size_t quarter = mesh_order.size() / 4;
+            for (std::size_t i = 0; i < quarter; i++) {
+                run.early_distance += distance(positions[mesh_order[i]]) / quarter;
+                run.late_distance +=
+                    distance(positions[mesh_order[mesh_order.size() - 1 - i]]) / quarter;
+            }
+            return run;
+        }
+
+        void bench_jobs_world(context& ctx) {
+            check_dependencies(ctx);
+            if (ctx.failed()) {
+                return;
+            }
+
+            const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+            std::vector<unsigned> counts;
+            for (unsigned t = 1; t < hardware; t *= 2) {
+                counts.push_back(t);
+            }
+            counts.push_back(hardware);
+
+            const world_run baseline = generate_and_mesh(1);
+            ctx.check(baseline.early_distance < baseline.late_distance,
+                      "nearby chunks are meshed before distant ones");
+            ctx.report("jobs.world.chunks", static_cast<double>(baseline.chunks), "chunks");
+
+            for (unsigned t : counts) {
+                const world_run run = t == 1 ? baseline : generate_and_mesh(t);
+                ctx.check(run.quads == baseline.quads, "thread count does not change the meshes");
+                const std::string name = "jobs.world.threads_" + std::to_string(t);
+                ctx.report(name, run.ms, "ms");
+                ctx.report(name + ".speedup", baseline.ms / run.ms, "x");
+            }
+        }
+    }  // namespace
+
+    void add_jobs_benchmarks(suite& s) {
+        s.add("jobs.world", bench_jobs_world);
+    }
+}  // namespace qc::bench
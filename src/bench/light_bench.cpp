@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/scenes.hpp"
+#include "world/lighting.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int TERRAIN_RADIUS = 2;
+        constexpr int TERRAIN_LAYERS = 4;
+        constexpr int EDITS = 400;
+
+        // Voxels within 14 steps of a level-15 source, the most one light can reach.
+        constexpr std::size_t LAMP_REACH = 4089;
+
+        void copy_blocks(const world& from, world& to) {
+            const auto blocks = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            from.for_each([&](const glm::ivec3& pos, const chunk& c) {
+                c.unpack(blocks.get());
+                to.get_or_create(pos).assign(blocks.get());
+            });
+        }
+
+        bool same_light(const world& a, const world& b) {
+            bool same = true;
+            a.for_each([&](const glm::ivec3& pos, const chunk&) {
+                const chunk_light* left = a.find_light(pos);
+                const chunk_light* right = b.find_light(pos);
+                if (left == nullptr || right == nullptr) {
+                    same = false;
+                    return;
+                }
+                for (int c = 0; c < LIGHT_CHANNEL_COUNT; c++) {
+                    for (int i = 0; i < CHUNK_VOLUME && same; i++) {
+                        same = left->channels[c].get(i) == right->channels[c].get(i);
+                    }
+                }
+            });
+            return same;
+        }
+
+        // Incremental results must match lighting the same blocks from scratch.
+        void check_incremental(context& ctx, world& lit, light_engine& engine) {
+            // Chunks lit one at a time in any order, bottom-up included, end up the same.
+            world loaded;
+            copy_blocks(lit, loaded);
+            std::vector<glm::ivec3> order;
+            loaded.for_each([&](const glm::ivec3& pos, const chunk&) { order.push_back(pos); });
+            std::shuffle(order.begin(), order.end(), std::mt19937(5));
+            light_engine loading(loaded);
+            for (const glm::ivec3& pos : order) {
+                loading.light_chunk(pos);
+            }
+            ctx.check(same_light(lit, loaded), "chunks lit in any order match a full relight");
+
+            std::mt19937 rng(11);
+            std::uniform_int_distribution<int> horizontal(-TERRAIN_RADIUS * CHUNK_SIZE,
+                                                          (TERRAIN_RADIUS + 1) * CHUNK_SIZE - 1);
+            std::uniform_int_distribution<int> vertical(32, TERRAIN_LAYERS * CHUNK_SIZE - 1);
+            const block_id choices[] = {BLOCK_AIR, BLOCK_AIR, BLOCK_STONE, BLOCK_WATER,
+                                        BLOCK_LAMP};
+            for (int i = 0; i < EDITS; i++) {
+                const glm::ivec3 v(horizontal(rng), vertical(rng), horizontal(rng));
+                engine.set_block(v, choices[rng() % 5]);
+            }
+
+            world fresh;
+            copy_blocks(lit, fresh);
+            light_engine(fresh).relight_all();
+            ctx.check(same_light(lit, fresh), "incremental edits match a full relight");
+        }
+
+        void bench_light_bfs(context& ctx) {
+            world w;
+            const std::vector<glm::ivec3> positions = generate_terrain(w, TERRAIN_RADIUS, TERRAIN_LAYERS);
+            light_engine engine(w);
+            const double relight_ns = time_ns(3, [&] { engine.relight_all(); });
+            ctx.report("light.relight", relight_ns / positions.size() / 1000.0, "us/chunk");
+
+            check_incremental(ctx, w, engine);
+            if (ctx.failed()) {
+                return;
+            }
+
+            // A block at the top of the world shades its whole column down to the ground.
+            const glm::ivec3 shaft(0, TERRAIN_LAYERS * CHUNK_SIZE - 1, 0);
+            std::size_t shaft_visits = 0;
+            const double shaft_ns = time_ns(100, [&] {
+                engine.set_block(shaft, BLOCK_STONE);
+                shaft_visits = engine.last_visits();
+                engine.set_block(shaft, BLOCK_AIR);
+            });
+            ctx.check(engine.light(shaft - glm::ivec3(0, 1, 0), LIGHT_SKY) == MAX_LIGHT,
+                      "reopening a shaft restores full sky light");
+            ctx.report("light.sky_shaft", shaft_ns / 2000.0, "us/op");
+            ctx.report("light.sky_shaft.visits", static_cast<double>(shaft_visits), "voxels");
+
+            // Worst case for block light: a lamp in a dark cavern, on the corner where eight
+            // chunks meet, so the fill crosses every border.
+            world cave;
+            for (int z = -1; z <= 0; z++) {
+                for (int x = -1; x <= 0; x++) {
+                    cave.get_or_create(glm::ivec3(x, -1, z));
+                    cave.get_or_create(glm::ivec3(x, 0, z));
+                    cave.get_or_create(glm::ivec3(x, 1, z)).fill(BLOCK_STONE);
+                }
+            }
+            light_engine cave_engine(cave);
+            cave_engine.relight_all();
+            const glm::ivec3 corner(0, 0, 0);
+            std::size_t place_visits = 0;
+            std::size_t remove_visits = 0;
+            double place_ns = 0.0;
+            double remove_ns = 0.0;
+            for (int i = 0; i < 100; i++) {
+                place_ns += time_ns(1, [&] { cave_engine.set_block(corner, BLOCK_LAMP); });
+                place_visits = cave_engine.last_visits();
+                remove_ns += time_ns(1, [&] { cave_engine.set_block(corner, BLOCK_AIR); });
+                remove_visits = cave_engine.last_visits();
+            }
+            ctx.check(cave_engine.light(glm::ivec3(-6, 0, 7), LIGHT_BLOCK) == 0,
+                      "removing the lamp leaves the cavern dark");
+            cave_engine.set_block(corner, BLOCK_LAMP);
+            ctx.check(cave_engine.light(glm::ivec3(-6, 0, 7), LIGHT_BLOCK) == 2 &&
+                          cave_engine.light(glm::ivec3(0, -14, 0), LIGHT_BLOCK) == 1 &&
+                          cave_engine.light(glm::ivec3(15, 0, 0), LIGHT_BLOCK) == 0,
+                      "lamp light falls off one level per block");
+            ctx.check(place_visits <= LAMP_REACH && remove_visits <= LAMP_REACH,
+                      "lamp updates only visit the voxels it can reach");
+            ctx.report("light.lamp.place", place_ns / 100.0 / 1000.0, "us/op");
+            ctx.report("light.lamp.remove", remove_ns / 100.0 / 1000.0, "us/op");
+            ctx.report("light.lamp.visits", static_cast<double>(place_visits), "voxels");
+        }
+    }  // namespace
+
+    void add_light_benchmarks(suite& s) {
+        s.add("light.bfs", bench_light_bfs);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/scenes.hpp"
+#include "world/lod.hpp"
+
+namespace qc::bench {
+    namespace {
+        // 16 x 16 chunks: half a kilometre on a side.
+        constexpr int TERRAIN_CHUNKS = 16;
+        constexpr int TERRAIN_LAYERS = 4;
+        constexpr int EDITS = 2000;
+
+        // The block a brute-force mip pyramid gives cell `cell` of `level`.
+        block_id reference_cell(const world& w, int level, const glm::ivec3& cell) {
+            block_id children[8];
+            for (int c = 0; c < 8; c++) {
+                const glm::ivec3 child =
+                    cell * 2 + glm::ivec3(c & 1, (c >> 1) & 1, (c >> 2) & 1);
+                children[c] = level == 1 ? w.get_block(child) : reference_cell(w, level - 1, child);
+            }
+            return lod_downsample(children);
+        }
+
+        // Compares every cell of levels 1 to LOD_MESH_LEVELS below `size` blocks.
+        bool same_cells(const lod_world& a, const lod_world& b, const glm::ivec3& size) {
+            for (int level = 1; level <= LOD_MESH_LEVELS; level++) {
+                for (int z = 0; z < size.z >> level; z++) {
+                    for (int y = 0; y < size.y >> level; y++) {
+                        for (int x = 0; x < size.x >> level; x++) {
+                            const glm::ivec3 cell(x, y, z);
+                            if (a.get(level, cell) != b.get(level, cell)) {
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        void build_lod(const world& w, lod_world& lod) {
+            w.for_each([&](const glm::ivec3& pos, const chunk& c) { lod.insert_chunk(pos, c); });
+        }
+
+        void bench_lod(context& ctx) {
+            world w;
+            generate_terrain(w, glm::ivec3(0),
+                             glm::ivec3(TERRAIN_CHUNKS - 1, TERRAIN_LAYERS - 1, TERRAIN_CHUNKS - 1));
+            std::size_t full_bytes = 0;
+            w.for_each([&](const glm::ivec3&, const chunk& c) { full_bytes += c.memory_usage(); });
+
+            lod_world lod;
+            const auto build_start = std::chrono::steady_clock::now();
+            build_lod(w, lod);
+            const double build_ms = std::chrono::duration<double, std::milli>(
+                                        std::chrono::steady_clock::now() - build_start)
+                                        .count();
+            std::vector<lod_key> keys;
+            lod.take_dirty(keys);
+
+            // The first region against a pyramid built the slow way.
+            const glm::ivec3 checked(1 << LOD_REGION_SIZE_LOG2, TERRAIN_LAYERS * CHUNK_SIZE,
+                                     1 << LOD_REGION_SIZE_LOG2);
+            bool matches = true;
+            for (int level = 1; level <= LOD_MESH_LEVELS && matches; level++) {
+                for (int z = 0; z < checked.z >> level && matches; z++) {
+                    for (int y = 0; y < checked.y >> level && matches; y++) {
+                        for (int x = 0; x < checked.x >> level && matches; x++) {
+                            const glm::ivec3 cell(x, y, z);
+                            matches = lod.get(level, cell) == reference_cell(w, level, cell);
+                        }
+                    }
+                }
+            }
+            ctx.check(matches, "octree cells match a brute-force mip pyramid");
+
+            // A 2 x 2 x 2 cube in open air fills one level 1 cell and nothing above it, well
+            // inside a single level 1 mesh.
+            const glm::ivec3 cube(100, 124, 100);
+            bool open_air = true;
+            for (int i = 0; i < 64; i++) {
+                const glm::ivec3 v = cube + glm::ivec3(i & 3, (i >> 2) & 3, i >> 4) - glm::ivec3(1);
+                open_air = open_air && w.get_block(v) == BLOCK_AIR;
+            }
+            ctx.check(open_air, "the test cube is placed in open air");
+            for (int i = 0; i < 8; i++) {
+                const glm::ivec3 v = cube + glm::ivec3(i & 1, (i >> 1) & 1, i >> 2);
+                w.set_block(v, BLOCK_STONE);
+                lod.set_block(w, v);
+            }
+            std::vector<lod_key> dirty;
+            lod.take_dirty(dirty);
+            ctx.check(dirty.size() == 1 && dirty[0] == lod_key{glm::ivec3(1, 1, 1), 1},
+                      "an edit marks only the meshes whose cells changed");
+
+            // Random edits near the surface, against rebuilding from the edited chunks.
+            std::mt19937 rng(7);
+            std::uniform_int_distribution<int> horizontal(0, TERRAIN_CHUNKS * CHUNK_SIZE - 1);
+            std::uniform_int_distribution<int> vertical(32, TERRAIN_LAYERS * CHUNK_SIZE - 1);
+            const block_id choices[] = {BLOCK_AIR, BLOCK_AIR, BLOCK_STONE, BLOCK_DIRT, BLOCK_SAND};
+            std::vector<glm::ivec3> edits;
+            for (int i = 0; i < EDITS; i++) {
+                const glm::ivec3 v(horizontal(rng), vertical(rng), horizontal(rng));
+                w.set_block(v, choices[i % 5]);
+                edits.push_back(v);
+            }
+            const double edit_ns = time_ns(EDITS, [&, i = 0]() mutable {
+                lod.set_block(w, edits[i++]);
+            });
+            lod_world rebuilt;
+            build_lod(w, rebuilt);
+            const glm::ivec3 area(TERRAIN_CHUNKS * CHUNK_SIZE, TERRAIN_LAYERS * CHUNK_SIZE,
+                                  TERRAIN_CHUNKS * CHUNK_SIZE);
+            ctx.check(same_cells(lod, rebuilt, area), "incremental edits match a rebuild");
+            ctx.check(lod.node_count() == rebuilt.node_count(),
+                      "incremental edits leave no uniform subtree behind");
+
+            // Every mesh of every level, against meshing the chunks at full resolution.
+            mesher m;
+            std::vector<packed_quad> quads;
+            std::size_t full_quads = 0;
+            const auto full_start = std::chrono::steady_clock::now();
+            w.for_each([&](const glm::ivec3& pos, const chunk&) {
+                quads.clear();
+                m.build(w.neighborhood(pos), quads);
+                full_quads += quads.size();
+            });
+            const double full_ms = std::chrono::duration<double, std::milli>(
+                                       std::chrono::steady_clock::now() - full_start)
+                                       .count();
+
+            keys.clear();
+            rebuilt.take_dirty(keys);
+            std::size_t level_quads[LOD_MESH_LEVELS + 1] = {full_quads};
+            double level_ms[LOD_MESH_LEVELS + 1] = {full_ms};
+            for (int level = 1; level <= LOD_MESH_LEVELS; level++) {
+                const auto start = std::chrono::steady_clock::now();
+                for (const lod_key& key : keys) {
+                    if (key.level == level) {
+                        quads.clear();
+                        rebuilt.build_mesh(key, m, quads);
+                        level_quads[level] += quads.size();
+                    }
+                }
+                level_ms[level] = std::chrono::duration<double, std::milli>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count();
+            }
+            ctx.check(level_quads[1] < level_quads[0] && level_quads[2] < level_quads[1] &&
+                          level_quads[3] < level_quads[2],
+                      "every level needs fewer quads than the one below");
+
+            const double km2 = (TERRAIN_CHUNKS * CHUNK_SIZE / 1000.0) *
+                               (TERRAIN_CHUNKS * CHUNK_SIZE / 1000.0);
+            const double chunks = TERRAIN_CHUNKS * TERRAIN_CHUNKS * TERRAIN_LAYERS;
+            ctx.report("lod.build", build_ms * 1000.0 / chunks, "us/chunk");
+            ctx.report("lod.edit", edit_ns, "ns/edit");
+            ctx.report("lod.memory", rebuilt.memory_usage() / (1024.0 * 1024.0) / km2,
+                       "MiB/km2");
+            ctx.report("lod.full_memory", full_bytes / (1024.0 * 1024.0) / km2, "MiB/km2");
+            ctx.report("lod.nodes", static_cast<double>(rebuilt.node_count()), "nodes");
+            for (int level = 0; level <= LOD_MESH_LEVELS; level++) {
+                const std::string name = "lod.mesh.x" + std::to_string(1 << level);
+                ctx.report(name + ".quads", static_cast<double>(level_quads[level]), "quads");
+                ctx.report(name + ".time", level_ms[level], "ms");
+            }
+        }
+    }  // namespace
+
+    void add_lod_benchmarks(suite& s) {
+        s.add("world.lod", bench_lod);
+    }
+}  // namespace qc::bench
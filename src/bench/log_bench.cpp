@@ -0,0 +1,201 @@
+#include <spdlog/sinks/ostream_sink.h>
+#include <spdlog/sinks/sink.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "core/log.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int MESSAGES = 20000;
+
+        // Holds the logging thread inside its first message until opened, so the queue behind
+        // it fills up.
+        class gate_sink final : public spdlog::sinks::sink {
+        public:
+            void log(const spdlog::details::log_msg&) override {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_opened.wait(lock, [&] { return m_open; });
+                m_count++;
+            }
+
+            void flush() override {
+            }
+
+            void set_pattern(const std::string&) override {
+            }
+
+            void set_formatter(std::unique_ptr<spdlog::formatter>) override {
+            }
+
+            void open() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_open = true;
+                }
+                m_opened.notify_all();
+            }
+
+            std::uint64_t count() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_count;
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_opened;
+            bool m_open = false;
+            std::uint64_t m_count = 0;
+        };
+
+        struct flood_result {
+            log_counters counters;
+            std::uint64_t written = 0;
+            // All producers finished while the gate was still closed.
+            bool finished_while_stuck = false;
+            double ns_per_message = 0.0;
+            double worst_us = 0.0;
+        };
+
+        // Floods every subsystem logger from `threads` threads while the logging thread is
+        // stuck for up to `stuck`, then lets it drain.
+        flood_result flood(unsigned threads, log_overflow overflow,
+                           std::chrono::milliseconds stuck) {
+            const auto gate = std::make_shared<gate_sink>();
+            log_settings settings;
+            settings.queue_size = 1024;
+            settings.overflow = overflow;
+            settings.sinks.push_back(gate);
+            start_logging(settings);
+
+            std::atomic<unsigned> done{0};
+            std::vector<double> worst(threads, 0.0);
+            std::vector<double> total(threads, 0.0);
+            std::vector<std::thread> producers;
+            for (unsigned t = 0; t < threads; t++) {
+                producers.emplace_back([&, t] {
+                    for (int i = 0; i < MESSAGES; i++) {
+                        const auto start = std::chrono::steady_clock::now();
+                        subsystem_logger(static_cast<log_subsystem>(i % LOG_SUBSYSTEM_COUNT))
+                            .info("flood from thread {} message {}", t, i);
+                        const double ns = std::chrono::duration<double, std::nano>(
+                                              std::chrono::steady_clock::now() - start)
+                                              .count();
+                        total[t] += ns;
+                        worst[t] = std::max(worst[t], ns);
+                    }
+                    done++;
+                });
+            }
+
+            const auto deadline = std::chrono::steady_clock::now() + stuck;
+            while (done < threads && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            flood_result result;
+            result.finished_while_stuck = done == threads;
+            gate->open();
+            for (std::thread& producer : producers) {
+                producer.join();
+            }
+            flush_logging();
+            result.counters = logging_counters();
+            result.written = gate->count();
+            stop_logging();
+
+            for (unsigned t = 0; t < threads; t++) {
+                result.ns_per_message += total[t] / (static_cast<double>(threads) * MESSAGES);
+                result.worst_us = std::max(result.worst_us, worst[t] / 1000.0);
+            }
+            return result;
+        }
+
+        // Mean nanoseconds per message for `threads` threads logging through `logger` at once.
+        double contended_ns(spdlog::logger& logger, unsigned threads) {
+            std::vector<std::thread> producers;
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned t = 0; t < threads; t++) {
+                producers.emplace_back([&, t] {
+                    for (int i = 0; i < MESSAGES; i++) {
+                        logger.info("flood from thread {} message {}", t, i);
+                    }
+                });
+            }
+            for (std::thread& producer : producers) {
+                producer.join();
+            }
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                            start)
+                       .count() /
+                   (static_cast<double>(threads) * MESSAGES);
+        }
+
+        void bench_log_flood(context& ctx) {
+            // The floods replace the process's logging with test sinks, so nothing can be
+            // reported until the usual logging is back.
+            const unsigned threads = std::max(4u, std::thread::hardware_concurrency());
+            const std::uint64_t sent = static_cast<std::uint64_t>(threads) * MESSAGES;
+            stop_logging();
+
+            const flood_result dropping =
+                flood(threads, LOG_OVERFLOW_DROP, std::chrono::milliseconds(10000));
+            const flood_result blocking =
+                flood(threads, LOG_OVERFLOW_BLOCK, std::chrono::milliseconds(20));
+
+            // Synchronous logging into a mutex-guarded sink, against the queue with a writer
+            // that keeps up. The queue blocks rather than drops when full, so both write every
+            // message.
+            std::ostringstream sync_out;
+            spdlog::logger sync_logger(
+                "sync", std::make_shared<spdlog::sinks::ostream_sink_mt>(sync_out));
+            const double sync_ns = contended_ns(sync_logger, threads);
+            std::ostringstream async_out;
+            log_settings settings;
+            settings.queue_size = 1 << 17;
+            settings.overflow = LOG_OVERFLOW_BLOCK;
+            settings.sinks.push_back(std::make_shared<spdlog::sinks::ostream_sink_st>(async_out));
+            start_logging(settings);
+            const double async_ns = contended_ns(subsystem_logger(LOG_WORLD), threads);
+            flush_logging();
+            const log_counters async = logging_counters();
+            stop_logging();
+
+            start_logging();
+            ctx.check(dropping.finished_while_stuck,
+                      "logging never waits for a stuck logging thread");
+            ctx.check(dropping.counters.blocked == 0 && dropping.counters.dropped > 0 &&
+                          dropping.counters.queued + dropping.counters.dropped == sent,
+                      "a full queue drops and counts every message it cannot take");
+            ctx.check(dropping.written == dropping.counters.queued &&
+                          dropping.counters.written == dropping.counters.queued,
+                      "every queued message is written");
+            ctx.check(!blocking.finished_while_stuck && blocking.counters.blocked > 0 &&
+                          blocking.counters.dropped == 0 && blocking.written == sent,
+                      "the blocking policy waits for room and loses nothing");
+            ctx.check(async.dropped == 0 && async.written == sent,
+                      "the timed queue writes every message");
+
+            ctx.report("log.threads", threads, "threads");
+            ctx.report("log.flood.dropped", 100.0 * dropping.counters.dropped / sent, "%");
+            ctx.report("log.flood.hot_path", dropping.ns_per_message, "ns/message");
+            ctx.report("log.flood.worst_call", dropping.worst_us, "us");
+            ctx.report("log.block.blocked", 100.0 * blocking.counters.blocked / sent, "%");
+            ctx.report("log.sync", sync_ns, "ns/message");
+            ctx.report("log.async", async_ns, "ns/message");
+            ctx.report("log.async.blocked", 100.0 * async.blocked / sent, "%");
+        }
+    }  // namespace
+
+    void add_log_benchmarks(suite& s) {
+        s.add("core.log", bench_log_flood);
+    }
+}  // namespace qc::bench
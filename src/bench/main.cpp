@@ -0,0 +1,131 @@
+#include <spdlog/spdlog.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/scenario.hpp"
+#include "core/log.hpp"
+#include "core/profile.hpp"
+#include "core/simd.hpp"
+
+// Headless benchmark runner: links only the engine core, so it runs on machines without a
+// display or GPU.
+namespace {
+    void print_usage(const char* program) {
+        spdlog::info("usage: {} [scenario | suite [filter]] [options]", program);
+        spdlog::info("  --radius <chunks>  scenario world radius (default 8)");
+        spdlog::info("  --layers <chunks>  scenario world height (default 4)");
+        spdlog::info("  --seed <n>         scenario world seed (default 42)");
+        spdlog::info("  --threads <n>      scenario worker threads, 0 for all cores (default 1)");
+        spdlog::info("  --edits <n>        scenario block edits (default 1000)");
+        spdlog::info("  --json <path>      write results as JSON");
+        spdlog::info("  --trace <path>     write profiling zones as a Chrome trace");
+    }
+
+    bool parse_int(const char* text, long min, long& out) {
+        char* end = nullptr;
+        out = std::strtol(text, &end, 10);
+        return end != text && *end == '\0' && out >= min;
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const qc::logging_scope logging;
+
+    std::string mode = "scenario";
+    const char* filter = nullptr;
+    const char* json = nullptr;
+    const char* trace = nullptr;
+    qc::bench::scenario_options options;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        long number = 0;
+        if (std::strncmp(arg, "--", 2) != 0) {
+            if (i == 1) {
+                mode = arg;
+            } else if (mode == "suite" && filter == nullptr) {
+                filter = arg;
+            } else {
+                print_usage(argv[0]);
+                return 2;
+            }
+            continue;
+        }
+        if (value == nullptr) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        i++;
+
+        if (std::strcmp(arg, "--json") == 0) {
+            json = value;
+        } else if (std::strcmp(arg, "--trace") == 0) {
+            trace = value;
+        } else if (std::strcmp(arg, "--radius") == 0 && parse_int(value, 0, number)) {
+            options.radius = static_cast<int>(number);
+        } else if (std::strcmp(arg, "--layers") == 0 && parse_int(value, 1, number)) {
+            options.layers = static_cast<int>(number);
+        } else if (std::strcmp(arg, "--seed") == 0 && parse_int(value, 0, number)) {
+            options.seed = static_cast<std::uint32_t>(number);
+        } else if (std::strcmp(arg, "--threads") == 0 && parse_int(value, 0, number)) {
+            options.threads = static_cast<unsigned>(number);
+        } else if (std::strcmp(arg, "--edits") == 0 && parse_int(value, 0, number)) {
+            options.edits = static_cast<int>(number);
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (mode != "scenario" && mode != "suite") {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    qc::bench::context ctx;
+    int status = 0;
+    if (mode == "scenario") {
+        qc::bench::run_scenario(options, ctx);
+        status = ctx.failed() ? 1 : 0;
+    } else {
+        qc::bench::suite suite;
+        qc::bench::add_all_benchmarks(suite);
+        status = suite.run(filter, ctx);
+    }
+
+    if (json != nullptr) {
+        const unsigned threads =
+            options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+        std::vector<std::pair<std::string, std::string>> info = {
+            {"mode", mode},
+            {"simd", qc::simd_level_name(qc::best_simd_level())},
+#if defined(NDEBUG)
+            {"assertions", "off"},
+#else
+            {"assertions", "on"},
+#endif
+        };
+        if (mode == "scenario") {
+            info.insert(info.end(), {{"seed", std::to_string(options.seed)},
+                                     {"radius", std::to_string(options.radius)},
+                                     {"layers", std::to_string(options.layers)},
+                                     {"threads", std::to_string(threads)},
+                                     {"edits", std::to_string(options.edits)}});
+        } else if (filter != nullptr) {
+            info.emplace_back("filter", filter);
+        }
+        if (!qc::bench::write_json(json, info, ctx.results())) {
+            status = 1;
+        }
+    }
+    if (trace != nullptr && !qc::write_chrome_trace(trace)) {
+        status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,539 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench/alloc_counter.hpp"
+#include "bench/benchmarks.hpp"
+#include "bench/scenes.hpp"
+#include "core/arena.hpp"
+#include "core/job_system.hpp"
+#include "mesh/mesher.hpp"
+#include "world/lighting.hpp"
+
+namespace qc::bench {
+    namespace {
+        // One flag per (voxel, face) pair.
+        using face_set = std::vector<std::uint8_t>;
+
+        block_id block_at(const chunk_neighborhood& n, int x, int y, int z) {
+            const int faces[3] = {x < 0 ? FACE_NEG_X : FACE_POS_X, y < 0 ? FACE_NEG_Y : FACE_POS_Y,
+                                  z < 0 ? FACE_NEG_Z : FACE_POS_Z};
+            const int coords[3] = {x, y, z};
+            for (int axis = 0; axis < 3; axis++) {
+                if (coords[axis] < 0 || coords[axis] >= CHUNK_SIZE) {
+                    const chunk* neighbor = n.faces[faces[axis]];
+                    if (neighbor == nullptr) {
+                        return BLOCK_AIR;
+                    }
+                    return neighbor->get(x & (CHUNK_SIZE - 1), y & (CHUNK_SIZE - 1),
+                                         z & (CHUNK_SIZE - 1));
+                }
+            }
+            return n.center->get(x, y, z);
+        }
+
+        // Per-voxel reference culling the binary mesher has to agree with.
+        face_set naive_faces(const chunk_neighborhood& n) {
+            face_set faces(static_cast<std::size_t>(CHUNK_VOLUME) * FACE_COUNT);
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    for (int x = 0; x < CHUNK_SIZE; x++) {
+                        const block_id block = n.center->get(x, y, z);
+                        if (block == BLOCK_AIR) {
+                            continue;
+                        }
+
+                        for (int f = 0; f < FACE_COUNT; f++) {
+                            const block_id next =
+                                block_at(n, x + FACE_OFFSETS[f][0], y + FACE_OFFSETS[f][1],
+                                         z + FACE_OFFSETS[f][2]);
+                            if (!block_properties(next).opaque && next != block) {
+                                faces[chunk_index(x, y, z) * FACE_COUNT + f] = 1;
+                            }
+                        }
+                    }
+                }
+            }
+            return faces;
+        }
+
+        // Rasterizes quads back into faces; returns false if any face is covered twice or a quad
+        // covers a voxel whose texture differs from the quad's.
+        bool quad_faces(const chunk& c, const std::vector<packed_quad>& quads, face_set& faces) {
+            faces.assign(static_cast<std::size_t>(CHUNK_VOLUME) * FACE_COUNT, 0);
+            for (const packed_quad& p : quads) {
+                const quad_desc q = decode_quad(p);
+                for (int v = 0; v < q.height; v++) {
+                    for (int u = 0; u < q.width; u++) {
+                        int x = q.x;
+                        int y = q.y;
+                        int z = q.z;
+                        switch (face_axis(q.dir)) {
+                        case 0:
+                            z += u;
+                            y += v;
+                            break;
+                        case 1:
+                            x += u;
+                            z += v;
+                            break;
+                        default:
+                            x += u;
+                            y += v;
+                            break;
+                        }
+
+                        std::uint8_t& flag = faces[chunk_index(x, y, z) * FACE_COUNT + q.dir];
+                        if (flag != 0 || block_texture(c.get(x, y, z), q.dir) != q.layer) {
+                            return false;
+                        }
+                        flag = 1;
+                    }
+                }
+            }
+            return true;
+        }
+
+        void bench_mesh_greedy(context& ctx) {
+            // A column of terrain with the surface chunk in the middle.
+            chunk below;
+            chunk surface;
+            chunk above;
+            make_terrain(below, 3, 0);
+            make_terrain(surface, 3, 1);
+            make_terrain(above, 3, 2);
+
+            chunk_neighborhood n;
+            n.center = &surface;
+            n.faces[FACE_NEG_Y] = &below;
+            n.faces[FACE_POS_Y] = &above;
+            n.faces[FACE_POS_X] = &below;
+
+            mesher m;
+            std::vector<packed_quad> quads;
+            m.build(n, quads);
+
+            face_set reference = naive_faces(n);
+            face_set covered;
+            ctx.check(quad_faces(surface, quads, covered), "quads do not overlap or mix blocks");
+            ctx.check(covered == reference, "quads cover exactly the naively culled faces");
+
+            // A random mess with translucent blocks, against the same check.
+            std::mt19937 rng(7);
+            chunk noisy;
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                const std::uint32_t r = rng() % 8;
+                noisy.set(i, r < 4 ? BLOCK_AIR : r < 6 ? BLOCK_STONE : BLOCK_WATER);
+            }
+            chunk_neighborhood noisy_n;
+            noisy_n.center = &noisy;
+            noisy_n.faces[FACE_NEG_Z] = &surface;
+            noisy_n.faces[FACE_POS_Z] = &noisy;
+            quads.clear();
+            m.build(noisy_n, quads);
+            reference = naive_faces(noisy_n);
+            ctx.check(quad_faces(noisy, quads, covered) && covered == reference,
+                      "random chunk with water meshes exactly");
+
+            chunk solid(BLOCK_STONE);
+            chunk_neighborhood solid_n;
+            solid_n.center = &solid;
+            quads.clear();
+            m.build(solid_n, quads);
+            ctx.check(quads.size() == 6, "a solid chunk merges into six quads");
+
+            quads.clear();
+            m.build(n, quads);
+            ctx.report("mesh.terrain.quads", static_cast<double>(quads.size()), "quads");
+
+            constexpr int ITERATIONS = 2000;
+            const double terrain_ns = time_ns(ITERATIONS, [&] {
+                quads.clear();
+                m.build(n, quads);
+            });
+            consume(quads.size());
+            ctx.report("mesh.terrain", terrain_ns / 1000.0, "us/chunk");
+            ctx.report("mesh.terrain.rate", 1e9 / terrain_ns, "chunks/s");
+
+            // Worst case for merging: a 3D checkerboard where nothing can merge.
+            chunk checker;
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    for (int x = 0; x < CHUNK_SIZE; x++) {
+                        checker.set(x, y, z, ((x + y + z) & 1) != 0 ? BLOCK_STONE : BLOCK_AIR);
+                    }
+                }
+            }
+            chunk_neighborhood checker_n;
+            checker_n.center = &checker;
+            const double checker_ns = time_ns(100, [&] {
+                quads.clear();
+                m.build(checker_n, quads);
+            });
+            ctx.report("mesh.checkerboard", checker_ns / 1000.0, "us/chunk");
+        }
+
+        // The conventional layout the packed format replaces: four float vertices and six
+        // 32-bit indices per quad.
+        struct float_vertex {
+            glm::vec3 position;
+            glm::vec3 normal;
+            glm::vec2 uv;
+            float layer;
+            float shade;
+        };
+
+        void bench_mesh_quad_format(context& ctx) {
+            std::mt19937 rng(11);
+            bool round_trip = true;
+            bool winding = true;
+            for (int i = 0; i < 10000; i++) {
+                quad_desc q{};
+                q.dir = static_cast<face>(rng() % FACE_COUNT);
+                q.width = static_cast<std::uint8_t>(1 + rng() % CHUNK_SIZE);
+                q.height = static_cast<std::uint8_t>(1 + rng() % CHUNK_SIZE);
+                q.x = static_cast<std::uint8_t>(rng() % CHUNK_SIZE);
+                q.y = static_cast<std::uint8_t>(rng() % CHUNK_SIZE);
+                q.z = static_cast<std::uint8_t>(rng() % CHUNK_SIZE);
+                q.layer = static_cast<std::uint8_t>(rng());
+                for (int corner = 0; corner < 4; corner++) {
+                    q.ao[corner] = static_cast<std::uint8_t>(rng() % 4);
+                    q.light[corner] = static_cast<std::uint8_t>(rng() % 16);
+                }
+
+                const packed_quad p = encode_quad(q);
+                const quad_desc d = decode_quad(p);
+                round_trip &= d.x == q.x && d.y == q.y && d.z == q.z && d.dir == q.dir &&
+                              d.width == q.width && d.height == q.height && d.layer == q.layer;
+                for (int corner = 0; corner < 4; corner++) {
+                    round_trip &= d.ao[corner] == q.ao[corner];
+                    round_trip &= d.light[corner] == q.light[corner];
+                }
+
+                // Both triangles must face out of the block: counter-clockwise seen from outside.
+                for (int tri = 0; tri < 2; tri++) {
+                    const quad_vertex a = expand_quad(p, tri * 3);
+                    const quad_vertex b = expand_quad(p, tri * 3 + 1);
+                    const quad_vertex c = expand_quad(p, tri * 3 + 2);
+                    const glm::ivec3 ab(b.x - a.x, b.y - a.y, b.z - a.z);
+                    const glm::ivec3 ac(c.x - a.x, c.y - a.y, c.z - a.z);
+                    const glm::ivec3 normal(FACE_OFFSETS[q.dir][0], FACE_OFFSETS[q.dir][1],
+                                            FACE_OFFSETS[q.dir][2]);
+                    winding &= glm::dot(glm::cross(ab, ac), normal) > 0;
+                }
+            }
+            ctx.check(round_trip, "encode/decode round-trips every field");
+            ctx.check(winding, "expanded triangles wind counter-clockwise");
+
+            chunk below;
+            chunk surface;
+            chunk above;
+            make_terrain(below, 5, 0);
+            make_terrain(surface, 5, 1);
+            make_terrain(above, 5, 2);
+            chunk_neighborhood n;
+            n.center = &surface;
+            n.faces[FACE_NEG_Y] = &below;
+            n.faces[FACE_POS_Y] = &above;
+
+            mesher m;
+            std::vector<packed_quad> quads;
+            m.build(n, quads);
+
+            std::size_t faces = 0;
+            for (const packed_quad& p : quads) {
+                const quad_desc q = decode_quad(p);
+                faces += static_cast<std::size_t>(q.width) * q.height;
+            }
+
+            // Both formats over the same merged quads, so only the encoding differs.
+            const double float_quad = 4.0 * sizeof(float_vertex) + 6.0 * sizeof(std::uint32_t);
+            const double packed_bytes = static_cast<double>(quads.size() * sizeof(packed_quad));
+            const double float_bytes = static_cast<double>(quads.size()) * float_quad;
+            ctx.report("quad.merged", static_cast<double>(faces) / quads.size(), "faces/quad");
+            ctx.report("quad.packed.bytes_per_quad", sizeof(packed_quad), "B");
+            ctx.report("quad.float_vec3.bytes_per_quad", float_quad, "B");
+            ctx.report("quad.packed.bytes_per_face", packed_bytes / faces, "B");
+            ctx.report("quad.float_vec3.bytes_per_face", float_bytes / faces, "B");
+            ctx.report("quad.savings", float_bytes / packed_bytes, "x");
+
+            std::uint64_t sum = 0;
+            const double decode_ns = time_ns(100, [&] {
+                for (const packed_quad& p : quads) {
+                    for (int vertex = 0; vertex < 6; vertex++) {
+                        const quad_vertex v = expand_quad(p, vertex);
+                        sum += static_cast<std::uint64_t>(v.x + v.y + v.z);
+                    }
+                }
+            });
+            consume(sum);
+            ctx.report("quad.expand", decode_ns / (quads.size() * 6.0), "ns/vertex");
+        }
+
+        void bench_mesh_steady_state(context& ctx) {
+            std::vector<chunk> column(4);
+            for (int y = 0; y < 4; y++) {
+                make_terrain(column[y], 9, y);
+            }
+            std::vector<chunk_neighborhood> neighborhoods(column.size());
+            for (std::size_t y = 0; y < column.size(); y++) {
+                neighborhoods[y].center = &column[y];
+                neighborhoods[y].faces[FACE_NEG_Y] = y > 0 ? &column[y - 1] : nullptr;
+                neighborhoods[y].faces[FACE_POS_Y] =
+                    y + 1 < column.size() ? &column[y + 1] : nullptr;
+            }
+
+            // One frame: mesh every chunk into scratch that the frame's scope then takes back.
+            mesher m;
+            arena& scratch = thread_arena();
+            std::size_t quads = 0;
+            const auto frame = [&] {
+                const arena_scope scope(scratch);
+                for (const chunk_neighborhood& n : neighborhoods) {
+                    std::pmr::vector<packed_quad> out(&scratch);
+                    m.build(n, out);
+                    quads += out.size();
+                }
+            };
+            frame();
+            const std::uint64_t before = thread_heap_allocations();
+            constexpr int FRAMES = 200;
+            const double arena_ns = time_ns(FRAMES, frame);
+            const bool counted = heap_allocations_counted();
+            ctx.check(!counted || thread_heap_allocations() == before,
+                      "meshing into a warmed-up arena makes no heap allocations");
+
+            // The same frames with a fresh std::vector per chunk, as callers did before.
+            const std::uint64_t heap_before = thread_heap_allocations();
+            const double heap_ns = time_ns(FRAMES, [&] {
+                for (const chunk_neighborhood& n : neighborhoods) {
+                    std::vector<packed_quad> out;
+                    m.build(n, out);
+                    quads += out.size();
+                }
+            });
+            const std::uint64_t heap_allocations = thread_heap_allocations() - heap_before;
+            consume(quads);
+
+            // Workers rewind their arenas after every job, so once warm, meshing jobs must not
+            // allocate either. Each job counts its own thread's allocations.
+            job_system jobs(2);
+            const auto mesh_job = [](const chunk_neighborhood& n) {
+                thread_local mesher worker;
+                const std::uint64_t start = thread_heap_allocations();
+                std::pmr::vector<packed_quad> out(&thread_arena());
+                worker.build(n, out);
+                return thread_heap_allocations() - start;
+            };
+
+            // Warm every worker's mesher and arena with every chunk. None of these jobs
+            // finishes before all have started, so each worker runs exactly one.
+            std::atomic<unsigned> started{0};
+            for (unsigned t = 0; t < jobs.thread_count(); t++) {
+                jobs.submit([&] {
+                    started++;
+                    while (started.load() < jobs.thread_count()) {
+                        std::this_thread::yield();
+                    }
+                    for (const chunk_neighborhood& n : neighborhoods) {
+                        mesh_job(n);
+                    }
+                });
+            }
+            jobs.wait_idle();
+
+            std::atomic<std::uint64_t> job_allocations{0};
+            for (int i = 0; i < 64; i++) {
+                const chunk_neighborhood& n = neighborhoods[i % neighborhoods.size()];
+                jobs.submit([&job_allocations, mesh_job, &n] {
+                    job_allocations += mesh_job(n);
+                });
+            }
+            jobs.wait_idle();
+            ctx.check(!counted || job_allocations == 0,
+                      "meshing jobs make no heap allocations once warm");
+
+            const double chunks = static_cast<double>(neighborhoods.size());
+            ctx.report("mesh.steady.arena", arena_ns / chunks / 1000.0, "us/chunk");
+            ctx.report("mesh.steady.heap", heap_ns / chunks / 1000.0, "us/chunk");
+            if (counted) {
+                ctx.report("mesh.steady.heap_allocations", heap_allocations / (FRAMES * chunks),
+                           "allocs/chunk");
+            }
+            ctx.report("mesh.steady.arena_peak", scratch.peak() / 1024.0, "KiB");
+        }
+
+        // Voxel of face (u, v) of a quad.
+        glm::ivec3 quad_voxel(const quad_desc& q, int u, int v) {
+            switch (face_axis(q.dir)) {
+            case 0:
+                return glm::ivec3(q.x, q.y + v, q.z + u);
+            case 1:
+                return glm::ivec3(q.x + u, q.y, q.z + v);
+            default:
+                return glm::ivec3(q.x + u, q.y + v, q.z);
+            }
+        }
+
+        // Shading of one face worked out voxel by voxel from the world, with the mesher's reach:
+        // voxels outside the chunk and its six face neighbours are, like voxels of unlit chunks,
+        // left out of the light.
+        void reference_shading(const world& w, const light_engine& light, const glm::ivec3& chunk,
+                               const glm::ivec3& voxel, face dir, std::uint8_t ao[4],
+                               std::uint8_t smooth[4]) {
+            const int axis = face_axis(dir);
+            const glm::ivec3 normal(FACE_OFFSETS[dir][0], FACE_OFFSETS[dir][1],
+                                    FACE_OFFSETS[dir][2]);
+            glm::ivec3 u_step(0);
+            glm::ivec3 v_step(0);
+            u_step[axis == 0 ? 2 : 0] = 1;
+            v_step[axis == 1 ? 2 : 1] = 1;
+
+            const glm::ivec3 origin = chunk * CHUNK_SIZE;
+            const auto in_reach = [&](const glm::ivec3& v) {
+                int outside = 0;
+                for (int i = 0; i < 3; i++) {
+                    outside += v[i] < origin[i] || v[i] >= origin[i] + CHUNK_SIZE ? 1 : 0;
+                }
+                return outside <= 1;
+            };
+            const auto opaque = [&](const glm::ivec3& v) {
+                return block_properties(w.get_block(v)).opaque;
+            };
+            const auto lit = [&](const glm::ivec3& v) {
+                if (!in_reach(v) || opaque(v) || w.find_light(chunk_of(v)) == nullptr) {
+                    return -1;
+                }
+                return static_cast<int>(std::max(light.light(v, LIGHT_SKY),
+                                                 light.light(v, LIGHT_BLOCK)));
+            };
+
+            const glm::ivec3 front = origin + voxel + normal;
+            for (int corner = 0; corner < 4; corner++) {
+                const glm::ivec3 du = u_step * (corner == 1 || corner == 2 ? 1 : -1);
+                const glm::ivec3 dv = v_step * (corner >= 2 ? 1 : -1);
+                const bool side_u = opaque(front + du);
+                const bool side_v = opaque(front + dv);
+                const bool diagonal = opaque(front + du + dv);
+                ao[corner] = static_cast<std::uint8_t>(side_u && side_v ? 0
+                                                                        : 3 - side_u - side_v -
+                                                                              diagonal);
+
+                const int samples[4] = {lit(front), lit(front + du), lit(front + dv),
+                                        side_u && side_v ? -1 : lit(front + du + dv)};
+                int sum = 0;
+                int count = 0;
+                for (const int sample : samples) {
+                    if (sample >= 0) {
+                        sum += sample;
+                        count++;
+                    }
+                }
+                smooth[corner] = static_cast<std::uint8_t>(count > 0 ? sum / count : MAX_LIGHT);
+            }
+        }
+
+        void bench_mesh_shading(context& ctx) {
+            // A lit 3 x 3 patch of generated terrain, meshing the column in the middle.
+            constexpr int LAYERS = 4;
+            world w;
+            generate_terrain(w, 1, LAYERS);
+            light_engine light(w);
+            light.relight_all();
+
+            std::vector<glm::ivec3> column;
+            std::vector<chunk_neighborhood> neighborhoods;
+            for (int y = 0; y < LAYERS; y++) {
+                column.emplace_back(0, y, 0);
+                neighborhoods.push_back(w.neighborhood(column.back()));
+            }
+
+            mesher_settings flat;
+            flat.ambient_occlusion = false;
+            flat.smooth_light = false;
+            mesher shaded_mesher;
+            mesher flat_mesher(flat);
+
+            // Every face a quad covers must carry the quad's shading, and the quad can only
+            // interpolate back to it if its shading is flat along the directions it merged in.
+            bool exact = true;
+            bool shaded = false;
+            std::vector<packed_quad> quads;
+            for (std::size_t i = 0; i < column.size(); i++) {
+                quads.clear();
+                shaded_mesher.build(neighborhoods[i], quads);
+                for (const packed_quad& p : quads) {
+                    const quad_desc q = decode_quad(p);
+                    for (int v = 0; v < q.height && exact; v++) {
+                        for (int u = 0; u < q.width && exact; u++) {
+                            std::uint8_t ao[4];
+                            std::uint8_t smooth[4];
+                            reference_shading(w, light, column[i], quad_voxel(q, u, v), q.dir, ao,
+                                              smooth);
+                            for (int corner = 0; corner < 4; corner++) {
+                                exact = exact && ao[corner] == q.ao[corner] &&
+                                        smooth[corner] == q.light[corner];
+                                shaded = shaded || ao[corner] < 3 || smooth[corner] < MAX_LIGHT;
+                            }
+                        }
+                    }
+                    if (q.width > 1) {
+                        exact = exact && q.ao[0] == q.ao[1] && q.ao[3] == q.ao[2] &&
+                                q.light[0] == q.light[1] && q.light[3] == q.light[2];
+                    }
+                    if (q.height > 1) {
+                        exact = exact && q.ao[0] == q.ao[3] && q.ao[1] == q.ao[2] &&
+                                q.light[0] == q.light[3] && q.light[1] == q.light[2];
+                    }
+                }
+            }
+            ctx.check(shaded, "the test terrain has occluded and shadowed faces");
+            ctx.check(exact, "merged quads reproduce the shading of every face they cover");
+
+            std::size_t shaded_quads = 0;
+            std::size_t flat_quads = 0;
+            for (const chunk_neighborhood& n : neighborhoods) {
+                quads.clear();
+                shaded_mesher.build(n, quads);
+                shaded_quads += quads.size();
+                quads.clear();
+                flat_mesher.build(n, quads);
+                flat_quads += quads.size();
+            }
+
+            constexpr int ITERATIONS = 200;
+            const auto time_column = [&](mesher& m) {
+                return time_ns(ITERATIONS, [&] {
+                           for (const chunk_neighborhood& n : neighborhoods) {
+                               quads.clear();
+                               m.build(n, quads);
+                           }
+                       }) /
+                       static_cast<double>(neighborhoods.size());
+            };
+            const double flat_ns = time_column(flat_mesher);
+            const double shaded_ns = time_column(shaded_mesher);
+            consume(quads.size());
+
+            ctx.report("mesh.shading.off.quads", static_cast<double>(flat_quads), "quads");
+            ctx.report("mesh.shading.on.quads", static_cast<double>(shaded_quads), "quads");
+            ctx.report("mesh.shading.quad_growth",
+                       100.0 * (static_cast<double>(shaded_quads) / flat_quads - 1.0), "%");
+            ctx.report("mesh.shading.off", flat_ns / 1000.0, "us/chunk");
+            ctx.report("mesh.shading.on", shaded_ns / 1000.0, "us/chunk");
+        }
+    }  // namespace
+
+    void add_mesh_benchmarks(suite& s) {
+        s.add("mesh.greedy", bench_mesh_greedy);
+        s.add("mesh.quad_format", bench_mesh_quad_format);
+        s.add("mesh.steady_state", bench_mesh_steady_state);
+        s.add("mesh.shading", bench_mesh_shading);
+    }
+}  // namespace qc::bench
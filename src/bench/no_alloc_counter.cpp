@@ -0,0 +1,11 @@
+#include "bench/alloc_counter.hpp"
+
+namespace qc::bench {
+    std::uint64_t thread_heap_allocations() {
+        return 0;
+    }
+
+    bool heap_allocations_counted() {
+        return false;
+    }
+}  // namespace qc::bench
@@ -0,0 +1,164 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/noise.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "world/noise.hpp"
+#include "world/terrain.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr std::size_t SAMPLES = 1 << 16;
+
+        // Arbitrary points spanning negative and positive coordinates, plus the odd tail that
+        // does not fill a whole SIMD register.
+        struct sample_points {
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+
+            explicit sample_points(std::size_t count) : x(count), y(count), z(count) {
+                std::mt19937 rng(23);
+                std::uniform_real_distribution<float> coord(-2000.0f, 2000.0f);
+                for (std::size_t i = 0; i < count; i++) {
+                    x[i] = coord(rng);
+                    y[i] = coord(rng);
+                    z[i] = coord(rng);
+                }
+                // Lattice points exercise the floor correction.
+                for (std::size_t i = 0; i < count; i += 97) {
+                    x[i] = std::round(x[i]);
+                    y[i] = std::round(y[i]);
+                }
+            }
+        };
+
+        std::uint64_t bits_of(float value) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        bool same_bits(const std::vector<float>& a, const std::vector<float>& b) {
+            return a.size() == b.size() &&
+                   std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+        }
+
+        void check_paths_agree(context& ctx, const sample_points& points) {
+            const std::size_t count = SAMPLES - 3;
+            fbm_params params;
+            params.seed = 1337;
+            params.frequency = 1.0f / 64.0f;
+            params.octaves = 4;
+
+            std::vector<float> reference2(count);
+            std::vector<float> reference3(count);
+            fbm2(points.x.data(), points.y.data(), reference2.data(), count, params, SIMD_SCALAR);
+            fbm3(points.x.data(), points.y.data(), points.z.data(), reference3.data(), count,
+                 params, SIMD_SCALAR);
+
+            float low = 0.0f;
+            float high = 0.0f;
+            bool finite = true;
+            for (std::size_t i = 0; i < count; i++) {
+                low = std::min({low, reference2[i], reference3[i]});
+                high = std::max({high, reference2[i], reference3[i]});
+                finite &= std::isfinite(reference2[i]) && std::isfinite(reference3[i]);
+            }
+            ctx.check(finite && low > -1.5f && high < 1.5f && high - low > 1.0f,
+                      "fBm is finite and spans roughly [-1, 1]");
+
+            for (int level = SIMD_SSE2; level <= best_simd_level(); level++) {
+                const simd_level l = static_cast<simd_level>(level);
+                std::vector<float> out2(count);
+                std::vector<float> out3(count);
+                fbm2(points.x.data(), points.y.data(), out2.data(), count, params, l);
+                fbm3(points.x.data(), points.y.data(), points.z.data(), out3.data(), count,
+                     params, l);
+                const std::string what = std::string(simd_level_name(l)) + " matches scalar";
+                ctx.check(same_bits(out2, reference2) && same_bits(out3, reference3),
+                          what.c_str());
+            }
+
+            // Whole chunks, caves included, must come out the same on every path.
+            const auto expected = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            const auto actual = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            terrain_generator scalar(42, SIMD_SCALAR);
+            terrain_generator best(42);
+            for (int y = 0; y < 3; y++) {
+                chunk a;
+                chunk b;
+                scalar.generate(a, glm::ivec3(-3, y, 5));
+                best.generate(b, glm::ivec3(-3, y, 5));
+                a.unpack(expected.get());
+                b.unpack(actual.get());
+                ctx.check(std::memcmp(expected.get(), actual.get(),
+                                      CHUNK_VOLUME * sizeof(block_id)) == 0,
+                          "terrain is identical across SIMD paths");
+            }
+        }
+
+        void bench_noise_simplex(context& ctx) {
+            const sample_points points(SAMPLES);
+            check_paths_agree(ctx, points);
+            if (ctx.failed()) {
+                return;
+            }
+
+            std::vector<float> out(SAMPLES);
+            const double glm2 = time_ns(4, [&] {
+                for (std::size_t i = 0; i < SAMPLES; i++) {
+                    out[i] = glm::simplex(glm::vec2(points.x[i], points.y[i]));
+                }
+            });
+            consume(bits_of(out[SAMPLES / 2]));
+            const double glm3 = time_ns(4, [&] {
+                for (std::size_t i = 0; i < SAMPLES; i++) {
+                    out[i] = glm::simplex(glm::vec3(points.x[i], points.y[i], points.z[i]));
+                }
+            });
+            consume(bits_of(out[SAMPLES / 2]));
+            ctx.report("noise.glm.simplex2", glm2 / SAMPLES, "ns/sample");
+            ctx.report("noise.glm.simplex3", glm3 / SAMPLES, "ns/sample");
+
+            for (int level = SIMD_SCALAR; level <= best_simd_level(); level++) {
+                const simd_level l = static_cast<simd_level>(level);
+                const double ns2 = time_ns(4, [&] {
+                    simplex2(points.x.data(), points.y.data(), out.data(), SAMPLES, 0, l);
+                });
+                const double ns3 = time_ns(4, [&] {
+                    simplex3(points.x.data(), points.y.data(), points.z.data(), out.data(),
+                             SAMPLES, 0, l);
+                });
+                consume(bits_of(out[SAMPLES / 2]));
+
+                const std::string name = std::string("noise.") + simd_level_name(l);
+                ctx.report(name + ".simplex2", ns2 / SAMPLES, "ns/sample");
+                ctx.report(name + ".simplex3", ns3 / SAMPLES, "ns/sample");
+                ctx.report(name + ".simplex3.vs_glm", glm3 / ns3, "x");
+            }
+
+            // A surface chunk: five octaves of heightmap plus two of caves for most voxels.
+            terrain_generator generator(42);
+            chunk c;
+            int y = 0;
+            const double generate_ns = time_ns(64, [&] {
+                generator.generate(c, glm::ivec3(y % 8, 1, y / 8));
+                y++;
+            });
+            consume(c.palette_size());
+            ctx.report("terrain.generate", generate_ns / 1000.0, "us/chunk");
+        }
+    }  // namespace
+
+    void add_noise_benchmarks(suite& s) {
+        s.add("noise.simplex", bench_noise_simplex);
+    }
+}  // namespace qc::bench
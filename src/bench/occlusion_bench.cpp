@@ -0,0 +1,293 @@
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/vec2.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/image.hpp"
+#include "bench/scenes.hpp"
+#include "render/occlusion.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int SMALL_RADIUS = 3;
+        constexpr int LARGE_RADIUS = 8;
+        constexpr int LAYERS = 4;
+        // Occluders drawn per frame, nearest first.
+        constexpr std::size_t OCCLUDER_BUDGET = 512;
+        constexpr int FRAMES = 20;
+
+        glm::mat4 camera(const glm::vec3& eye, const glm::vec3& target) {
+            const float aspect = static_cast<float>(occlusion_culler::WIDTH) /
+                                 static_cast<float>(occlusion_culler::HEIGHT);
+            return glm::perspective(glm::radians(70.0f), aspect, 0.1f, 1000.0f) *
+                   glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+
+        // Inverse depth scaled so that one level is 1/1024 of a block's reciprocal distance:
+        // everything within 4 blocks is white, empty pixels black.
+        gray_image depth_image(const occlusion_culler& culler) {
+            gray_image image{occlusion_culler::WIDTH, occlusion_culler::HEIGHT, {}};
+            const float* depth = culler.depth();
+            for (int i = 0; i < image.width * image.height; i++) {
+                const float level = std::round(depth[i] * 1024.0f);
+                image.pixels.push_back(depth[i] <= 0.0f ? 0 : static_cast<std::uint8_t>(
+                                                                  std::clamp(level, 1.0f, 255.0f)));
+            }
+            return image;
+        }
+
+        int surface_height(const world& w, int x, int z) {
+            int y = LAYERS * CHUNK_SIZE - 1;
+            while (y > 0 && !block_properties(w.get_block(glm::ivec3(x, y, z))).opaque) {
+                y--;
+            }
+            return y;
+        }
+
+        // Clears a 5^3 cave 40 blocks under the surface of `column` and returns its centre.
+        glm::vec3 dig_pocket(world& w, const glm::ivec2& column) {
+            const glm::ivec3 pocket(column.x, surface_height(w, column.x, column.y) - 40, column.y);
+            for (int y = -2; y <= 2; y++) {
+                for (int z = -2; z <= 2; z++) {
+                    for (int x = -2; x <= 2; x++) {
+                        w.set_block(pocket + glm::ivec3(x, y, z), BLOCK_AIR);
+                    }
+                }
+            }
+            return glm::vec3(pocket) + glm::vec3(0.5f);
+        }
+
+        // The OCCLUDER_BUDGET boxes nearest to `eye`.
+        std::vector<aabb> nearest_occluders(const world& w, const std::vector<glm::ivec3>& chunks,
+                                            const glm::vec3& eye) {
+            std::vector<aabb> boxes;
+            for (const glm::ivec3& pos : chunks) {
+                find_occluders(*w.find(pos), pos, boxes);
+            }
+            const auto distance = [&](const aabb& box) {
+                const glm::vec3 nearest = glm::clamp(eye, box.min, box.max);
+                return glm::dot(nearest - eye, nearest - eye);
+            };
+            std::sort(boxes.begin(), boxes.end(),
+                      [&](const aabb& a, const aabb& b) { return distance(a) < distance(b); });
+            boxes.resize(std::min(boxes.size(), OCCLUDER_BUDGET));
+            return boxes;
+        }
+
+        void draw(occlusion_culler& culler, const glm::mat4& view_projection,
+                  const std::vector<aabb>& occluders) {
+            culler.begin(view_projection);
+            for (const aabb& box : occluders) {
+                culler.add_occluder(box);
+            }
+            culler.finish();
+        }
+
+        // Hidden boxes must be hidden at full resolution too: every pixel their projection
+        // touches holds a nearer occluder, unless they are behind the camera.
+        bool hidden_per_pixel(const occlusion_culler& culler, const glm::mat4& view_projection,
+                              const aabb& box) {
+            float nearest = 0.0f;
+            int behind = 0;
+            float min_x = 1e30f;
+            float max_x = -1e30f;
+            float min_y = 1e30f;
+            float max_y = -1e30f;
+            for (int i = 0; i < 8; i++) {
+                const glm::vec3 p((i & 1) != 0 ? box.max.x : box.min.x,
+                                  (i & 2) != 0 ? box.max.y : box.min.y,
+                                  (i & 4) != 0 ? box.max.z : box.min.z);
+                const glm::vec4 clip = view_projection * glm::vec4(p, 1.0f);
+                if (clip.z < -clip.w) {
+                    behind++;
+                    continue;
+                }
+                min_x = std::min(min_x, (clip.x / clip.w * 0.5f + 0.5f) * occlusion_culler::WIDTH);
+                max_x = std::max(max_x, (clip.x / clip.w * 0.5f + 0.5f) * occlusion_culler::WIDTH);
+                min_y = std::min(min_y, (0.5f - clip.y / clip.w * 0.5f) * occlusion_culler::HEIGHT);
+                max_y = std::max(max_y, (0.5f - clip.y / clip.w * 0.5f) * occlusion_culler::HEIGHT);
+                nearest = std::max(nearest, 1.0f / clip.w);
+            }
+            if (behind > 0) {
+                return behind == 8;
+            }
+            const int x0 = std::max(0, static_cast<int>(std::floor(min_x)));
+            const int x1 = std::min(occlusion_culler::WIDTH - 1, static_cast<int>(max_x));
+            const int y0 = std::max(0, static_cast<int>(std::floor(min_y)));
+            const int y1 = std::min(occlusion_culler::HEIGHT - 1, static_cast<int>(max_y));
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    if (culler.depth()[y * occlusion_culler::WIDTH + x] <= nearest) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Whether the segment from `eye` to `target` passes through an opaque block, sampled
+        // every quarter block.
+        bool ray_blocked(const world& w, const glm::vec3& eye, const glm::vec3& target) {
+            const glm::vec3 delta = target - eye;
+            const int steps = static_cast<int>(glm::length(delta) * 4.0f);
+            for (int i = 1; i < steps; i++) {
+                const glm::vec3 p = eye + delta * (static_cast<float>(i) / steps);
+                const glm::ivec3 v(static_cast<int>(std::floor(p.x)),
+                                   static_cast<int>(std::floor(p.y)),
+                                   static_cast<int>(std::floor(p.z)));
+                if (block_properties(w.get_block(v)).opaque) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Culled chunks must not be seen along any of a grid of rays through them that ends on
+        // screen.
+        std::size_t false_culls(const world& w, const glm::mat4& view_projection,
+                                const glm::vec3& eye, const std::vector<glm::ivec3>& culled) {
+            std::size_t seen = 0;
+            for (const glm::ivec3& pos : culled) {
+                const aabb bounds = chunk_bounds(pos);
+                bool blocked = true;
+                for (int i = 0; i < 64 && blocked; i++) {
+                    const glm::vec3 t(((i & 3) + 0.5f) / 4.0f, (((i >> 2) & 3) + 0.5f) / 4.0f,
+                                      ((i >> 4) + 0.5f) / 4.0f);
+                    const glm::vec3 target = bounds.min + (bounds.max - bounds.min) * t;
+                    const glm::vec4 clip = view_projection * glm::vec4(target, 1.0f);
+                    if (clip.w > 0.0f && std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w) {
+                        blocked = ray_blocked(w, eye, target);
+                    }
+                }
+                seen += blocked ? 0 : 1;
+            }
+            return seen;
+        }
+
+        void check_synthetic(context& ctx) {
+            const glm::mat4 view_projection =
+                camera(glm::vec3(-20.0f, 20.0f, -10.0f), glm::vec3(0.0f, 8.0f, 24.0f));
+            // A wall, the ground, a crate, and a pillar whose top passes through the near plane.
+            const std::vector<aabb> occluders = {
+                {glm::vec3(-24.0f, 0.0f, 16.0f), glm::vec3(24.0f, 24.0f, 20.0f)},
+                {glm::vec3(-40.0f, -4.0f, -40.0f), glm::vec3(40.0f, 0.0f, 60.0f)},
+                {glm::vec3(8.0f, 0.0f, 0.0f), glm::vec3(12.0f, 6.0f, 6.0f)},
+                {glm::vec3(-22.0f, 0.0f, -12.0f), glm::vec3(-19.0f, 19.95f, -9.0f)},
+            };
+            occlusion_culler culler;
+            draw(culler, view_projection, occluders);
+            check_fixture(ctx, "occlusion_boxes", depth_image(culler), 1);
+
+            occlusion_culler scalar(SIMD_SCALAR);
+            draw(scalar, view_projection, occluders);
+            const int pixels = occlusion_culler::WIDTH * occlusion_culler::HEIGHT;
+            ctx.check(std::equal(culler.depth(), culler.depth() + pixels, scalar.depth()),
+                      "the SIMD and scalar rasterizers agree bit for bit");
+
+            for (const aabb& box : occluders) {
+                ctx.check(culler.visible(box), "occluders never hide themselves");
+            }
+            const aabb behind_wall = {glm::vec3(-4.0f, 4.0f, 30.0f), glm::vec3(4.0f, 12.0f, 38.0f)};
+            const aabb underground = {glm::vec3(0.0f, -20.0f, 0.0f), glm::vec3(8.0f, -12.0f, 8.0f)};
+            const aabb in_front = {glm::vec3(-4.0f, 0.0f, 4.0f), glm::vec3(4.0f, 6.0f, 10.0f)};
+            const aabb above = {glm::vec3(0.0f, 40.0f, 40.0f), glm::vec3(8.0f, 48.0f, 48.0f)};
+            ctx.check(!culler.visible(behind_wall), "a box behind the wall is hidden");
+            ctx.check(!culler.visible(underground), "a box under the ground is hidden");
+            ctx.check(culler.visible(in_front), "a box in front of the wall is visible");
+            ctx.check(culler.visible(above), "a box above the wall is visible");
+        }
+
+        void check_terrain(context& ctx) {
+            world w;
+            const std::vector<glm::ivec3> chunks = generate_terrain(w, SMALL_RADIUS, LAYERS);
+
+            // On a hill looking across the land, then in a pocket dug deep underground.
+            const float hill_y = static_cast<float>(surface_height(w, 0, -40)) + 3.5f;
+            const glm::vec3 hill(0.5f, hill_y, -40.5f);
+            const glm::vec3 cave = dig_pocket(w, glm::ivec2(10, 10));
+            struct view {
+                const char* fixture;
+                glm::vec3 eye;
+                glm::vec3 target;
+            };
+            const view views[] = {
+                {"occlusion_hill", hill, hill + glm::vec3(0.0f, -4.0f, 40.0f)},
+                {"occlusion_cave", cave, cave + glm::vec3(30.0f, -2.0f, 10.0f)},
+            };
+
+            occlusion_culler culler;
+            std::size_t culled_total = 0;
+            std::size_t not_conservative = 0;
+            std::size_t seen = 0;
+            for (const view& v : views) {
+                const glm::mat4 view_projection = camera(v.eye, v.target);
+                draw(culler, view_projection, nearest_occluders(w, chunks, v.eye));
+                check_fixture(ctx, v.fixture, depth_image(culler), 1);
+
+                std::vector<glm::ivec3> culled;
+                for (const glm::ivec3& pos : chunks) {
+                    if (!culler.visible(chunk_bounds(pos))) {
+                        culled.push_back(pos);
+                        not_conservative +=
+                            hidden_per_pixel(culler, view_projection, chunk_bounds(pos)) ? 0 : 1;
+                    }
+                }
+                culled_total += culled.size();
+                seen += false_culls(w, view_projection, v.eye, culled);
+            }
+            ctx.check(not_conservative == 0, "the pyramid only hides what full resolution hides");
+            ctx.check(seen == 0, "no culled chunk can be seen");
+            ctx.report("occlusion.terrain.culled", static_cast<double>(culled_total), "chunks");
+        }
+
+        void bench_occlusion(context& ctx) {
+            check_synthetic(ctx);
+            check_terrain(ctx);
+            if (ctx.failed()) {
+                return;
+            }
+
+            world w;
+            const std::vector<glm::ivec3> chunks = generate_terrain(w, LARGE_RADIUS, LAYERS);
+            const glm::vec3 eye = dig_pocket(w, glm::ivec2(0, 0));
+            const std::vector<aabb> occluders = nearest_occluders(w, chunks, eye);
+
+            occlusion_culler culler;
+            occlusion_culler scalar(SIMD_SCALAR);
+            std::vector<glm::ivec3> visible;
+            std::size_t triangles = 0;
+            double raster_ns = 0.0;
+            double scalar_ns = 0.0;
+            double cull_ns = 0.0;
+            for (int frame = 0; frame < FRAMES; frame++) {
+                const float angle = glm::radians(360.0f * frame / FRAMES);
+                const glm::mat4 view_projection =
+                    camera(eye, eye + glm::vec3(std::sin(angle), -0.2f, std::cos(angle)));
+                raster_ns += time_ns(1, [&] { draw(culler, view_projection, occluders); });
+                scalar_ns += time_ns(1, [&] { draw(scalar, view_projection, occluders); });
+                triangles += culler.triangle_count();
+                visible.clear();
+                cull_ns += time_ns(1, [&] { culler.cull(chunks, visible); });
+            }
+            ctx.report("occlusion.chunks", static_cast<double>(chunks.size()), "chunks");
+            ctx.report("occlusion.visible", 100.0 * visible.size() / chunks.size(), "%");
+            ctx.report("occlusion.occluders", static_cast<double>(occluders.size()), "boxes");
+            ctx.report("occlusion.triangles", static_cast<double>(triangles) / FRAMES,
+                       "triangles/frame");
+            ctx.report("occlusion.raster", raster_ns / FRAMES / 1000.0, "us/frame");
+            ctx.report("occlusion.raster.scalar", scalar_ns / FRAMES / 1000.0, "us/frame");
+            ctx.report("occlusion.test", cull_ns / FRAMES / chunks.size(), "ns/chunk");
+            ctx.report("occlusion.frame", (raster_ns + cull_ns) / FRAMES / 1000.0, "us/frame");
+        }
+    }  // namespace
+
+    void add_occlusion_benchmarks(suite& s) {
+        s.add("render.occlusion", bench_occlusion);
+    }
+}  // namespace qc::bench
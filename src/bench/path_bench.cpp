@@ -0,0 +1,340 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "core/job_system.hpp"
+#include "world/navigation.hpp"
+#include "world/raycast.hpp"
+#include "world/terrain.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int RADIUS = 6;
+        constexpr int LAYERS = 4;
+        constexpr int QUERIES = 300;
+        // Queries checked against a plain block A* over the world.
+        constexpr int REFERENCE_QUERIES = 60;
+        constexpr std::size_t REFERENCE_LIMIT = 400000;
+        // Queries per job on the worker threads.
+        constexpr int BATCH = 4;
+        constexpr int EDITS = 200;
+
+        struct query {
+            glm::ivec3 from;
+            glm::ivec3 to;
+        };
+
+        bool open(const world& w, const glm::ivec3& v) {
+            return !block_solid(w.get_block(v));
+        }
+
+        bool stand(const world& w, const glm::ivec3& v) {
+            return open(w, v) && open(w, v + glm::ivec3(0, 1, 0)) &&
+                   !open(w, v - glm::ivec3(0, 1, 0));
+        }
+
+        // The moves nav_graph documents, one world lookup at a time: where a walker standing at
+        // `p` gets to in one step, and at what cost.
+        void reference_moves(const world& w, const glm::ivec3& p,
+                             std::vector<std::pair<glm::ivec3, float>>& out) {
+            static const glm::ivec3 directions[4] = {{1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}};
+            out.clear();
+            const glm::ivec3 up(0, 1, 0);
+            for (const glm::ivec3& d : directions) {
+                const glm::ivec3 q = p + d;
+                if (stand(w, q)) {
+                    out.push_back({q, 1.0f});
+                } else if (open(w, p + up + up) && stand(w, q + up)) {
+                    out.push_back({q + up, 1.5f});
+                } else if (open(w, q) && open(w, q + up)) {
+                    for (int k = 1; k <= NAV_MAX_DROP && open(w, q - k * up); k++) {
+                        if (stand(w, q - k * up)) {
+                            out.push_back({q - k * up, 1.0f + 0.25f * static_cast<float>(k)});
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Cost of the cheapest path, or -1 if none is found within REFERENCE_LIMIT blocks.
+        float reference_cost(const world& w, const glm::ivec3& from, const glm::ivec3& to) {
+            if (!stand(w, from) || !stand(w, to)) {
+                return -1.0f;
+            }
+            using entry = std::pair<float, glm::ivec3>;
+            const auto later = [](const entry& a, const entry& b) { return a.first > b.first; };
+            std::priority_queue<entry, std::vector<entry>, decltype(later)> open_list(later);
+            std::unordered_map<glm::ivec3, float, chunk_pos_hash> best;
+            const auto estimate = [&](const glm::ivec3& p) {
+                return static_cast<float>(std::abs(p.x - to.x) + std::abs(p.z - to.z));
+            };
+            std::vector<std::pair<glm::ivec3, float>> moves;
+            best[from] = 0.0f;
+            open_list.push({estimate(from), from});
+            std::size_t expanded = 0;
+            while (!open_list.empty() && expanded < REFERENCE_LIMIT) {
+                const entry top = open_list.top();
+                open_list.pop();
+                const float g = best[top.second];
+                if (top.first > g + estimate(top.second)) {
+                    continue;
+                }
+                if (top.second == to) {
+                    return g;
+                }
+                expanded++;
+                reference_moves(w, top.second, moves);
+                for (const auto& [q, cost] : moves) {
+                    const auto it = best.find(q);
+                    if (it == best.end() || g + cost < it->second) {
+                        best[q] = g + cost;
+                        open_list.push({g + cost + estimate(q), q});
+                    }
+                }
+            }
+            return -1.0f;
+        }
+
+        // Cost of `path` if every step is a move the reference allows, else -1.
+        float path_cost(const world& w, const std::vector<glm::ivec3>& path) {
+            std::vector<std::pair<glm::ivec3, float>> moves;
+            float cost = 0.0f;
+            for (std::size_t i = 1; i < path.size(); i++) {
+                reference_moves(w, path[i - 1], moves);
+                const auto it = std::find_if(moves.begin(), moves.end(),
+                                             [&](const auto& m) { return m.first == path[i]; });
+                if (it == moves.end()) {
+                    return -1.0f;
+                }
+                cost += it->second;
+            }
+            return cost;
+        }
+
+        // Where a walker dropped at column (x, z) ends up standing, if anywhere.
+        bool ground(const world& w, int x, int z, glm::ivec3& feet) {
+            const float top = static_cast<float>(LAYERS * CHUNK_SIZE);
+            const glm::vec3 above(static_cast<float>(x) + 0.5f, top, static_cast<float>(z) + 0.5f);
+            ray_hit hit;
+            if (!raycast(w, above, glm::vec3(0.0f, -1.0f, 0.0f), top, RAY_SOLID, hit)) {
+                return false;
+            }
+            feet = hit.voxel + glm::ivec3(0, 1, 0);
+            return stand(w, feet);
+        }
+
+        // Pairs of standing spots `distance` blocks apart in a straight line.
+        std::vector<query> make_queries(const world& w, std::mt19937& rng, float distance) {
+            const float span = static_cast<float>((RADIUS - 1) * CHUNK_SIZE);
+            std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+            std::vector<query> queries;
+            while (queries.size() < QUERIES) {
+                const glm::vec2 from(span * unit(rng), span * unit(rng));
+                const float angle = 3.14159265f * unit(rng);
+                const glm::vec2 to = from + distance * glm::vec2(std::cos(angle), std::sin(angle));
+                query q;
+                if (std::abs(to.x) < span && std::abs(to.y) < span &&
+                    ground(w, static_cast<int>(std::floor(from.x)),
+                           static_cast<int>(std::floor(from.y)), q.from) &&
+                    ground(w, static_cast<int>(std::floor(to.x)),
+                           static_cast<int>(std::floor(to.y)), q.to)) {
+                    queries.push_back(q);
+                }
+            }
+            return queries;
+        }
+
+        struct results {
+            std::vector<std::vector<glm::ivec3>> paths;
+            std::size_t found = 0;
+            std::size_t regions = 0;
+            std::size_t blocks = 0;
+        };
+
+        results run_serial(const nav_graph& graph, const std::vector<query>& queries) {
+            path_finder finder(graph);
+            results r;
+            r.paths.resize(queries.size());
+            for (std::size_t i = 0; i < queries.size(); i++) {
+                r.found += finder.find(queries[i].from, queries[i].to, r.paths[i]) ? 1 : 0;
+                r.regions += finder.regions_expanded();
+                r.blocks += finder.blocks_expanded();
+            }
+            return r;
+        }
+
+        // Paths found over `jobs`, a path_finder per worker as the server would keep them.
+        std::vector<std::vector<glm::ivec3>> run_parallel(job_system& jobs, const nav_graph& graph,
+                                                          const std::vector<query>& queries) {
+            std::vector<std::unique_ptr<path_finder>> finders;
+            for (unsigned i = 0; i < jobs.thread_count(); i++) {
+                finders.push_back(std::make_unique<path_finder>(graph));
+            }
+            std::vector<std::vector<glm::ivec3>> paths(queries.size());
+            for (std::size_t first = 0; first < queries.size(); first += BATCH) {
+                jobs.submit([&, first] {
+                    path_finder& finder = *finders[jobs.current_worker()];
+                    const std::size_t last = std::min(first + BATCH, queries.size());
+                    for (std::size_t i = first; i < last; i++) {
+                        finder.find(queries[i].from, queries[i].to, paths[i]);
+                    }
+                });
+            }
+            jobs.wait_idle();
+            return paths;
+        }
+
+        double elapsed_ms(const std::chrono::steady_clock::time_point& start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             start)
+                .count();
+        }
+
+        bool valid(const world& w, const std::vector<query>& queries, const results& r) {
+            bool ok = true;
+            for (std::size_t i = 0; i < queries.size(); i++) {
+                const std::vector<glm::ivec3>& path = r.paths[i];
+                if (!path.empty()) {
+                    ok = ok && path.front() == queries[i].from && path.back() == queries[i].to &&
+                         path_cost(w, path) >= 0.0f;
+                }
+            }
+            return ok;
+        }
+
+        void bench_distance(context& ctx, job_system& jobs, const world& w, const nav_graph& graph,
+                            const std::vector<query>& queries, const char* name) {
+            const std::string prefix = std::string("path.") + name;
+            auto start = std::chrono::steady_clock::now();
+            const results serial = run_serial(graph, queries);
+            const double serial_ms = elapsed_ms(start);
+            ctx.check(valid(w, queries, serial),
+                      "paths run from start to goal over moves a walker can make");
+
+            start = std::chrono::steady_clock::now();
+            const std::vector<std::vector<glm::ivec3>> parallel =
+                run_parallel(jobs, graph, queries);
+            const double parallel_ms = elapsed_ms(start);
+            ctx.check(parallel == serial.paths, "worker threads find the same paths");
+
+            const double n = static_cast<double>(queries.size());
+            ctx.report(prefix + ".found", 100.0 * static_cast<double>(serial.found) / n, "%");
+            ctx.report(prefix + ".regions", static_cast<double>(serial.regions) / n, "regions");
+            ctx.report(prefix + ".blocks", static_cast<double>(serial.blocks) / n, "blocks");
+            ctx.report(prefix + ".query", serial_ms * 1000.0 / n, "us");
+            ctx.report(prefix + ".paths_per_s", n * 1000.0 / serial_ms, "paths/s");
+            ctx.report(prefix + ".paths_per_s.parallel", n * 1000.0 / parallel_ms, "paths/s");
+        }
+
+        // Walkers crossing generated terrain 64 and 256 blocks, planned over sections first.
+        void bench_path(context& ctx) {
+            world w;
+            terrain_generator generator(11);
+            std::vector<glm::ivec3> loaded;
+            for (int z = -RADIUS; z <= RADIUS; z++) {
+                for (int x = -RADIUS; x <= RADIUS; x++) {
+                    for (int y = 0; y < LAYERS; y++) {
+                        auto c = std::make_unique<chunk>();
+                        generator.generate(*c, glm::ivec3(x, y, z));
+                        w.insert(glm::ivec3(x, y, z), std::move(c));
+                        loaded.push_back(glm::ivec3(x, y, z));
+                    }
+                }
+            }
+
+            nav_graph graph(w);
+            auto start = std::chrono::steady_clock::now();
+            for (const glm::ivec3& pos : loaded) {
+                graph.add_chunk(pos);
+            }
+            graph.update();
+            const double build_ms = elapsed_ms(start);
+
+            std::mt19937 rng(9);
+            const std::vector<query> near = make_queries(w, rng, 64.0f);
+            const std::vector<query> far = make_queries(w, rng, 256.0f);
+            bool agree = true;
+            double ratio = 0.0;
+            std::size_t compared = 0;
+            path_finder finder(graph);
+            std::vector<glm::ivec3> path;
+            start = std::chrono::steady_clock::now();
+            std::vector<float> optimal;
+            for (int i = 0; i < REFERENCE_QUERIES; i++) {
+                optimal.push_back(reference_cost(w, near[i].from, near[i].to));
+            }
+            const double reference_ms = elapsed_ms(start);
+            for (int i = 0; i < REFERENCE_QUERIES; i++) {
+                const bool found = finder.find(near[i].from, near[i].to, path);
+                agree = agree && found == (optimal[i] >= 0.0f);
+                if (found && optimal[i] > 0.0f) {
+                    ratio += path_cost(w, path) / optimal[i];
+                    compared++;
+                }
+            }
+            ctx.check(agree, "paths are found exactly where a plain block search finds one");
+
+            job_system jobs;
+            ctx.report("path.sections", static_cast<double>(graph.section_count()), "sections");
+            ctx.report("path.regions", static_cast<double>(graph.region_count()), "regions");
+            ctx.report("path.edges", static_cast<double>(graph.edge_count()), "edges");
+            ctx.report("path.build", build_ms, "ms");
+            ctx.report("path.threads", jobs.thread_count(), "threads");
+            bench_distance(ctx, jobs, w, graph, near, "64");
+            bench_distance(ctx, jobs, w, graph, far, "256");
+            ctx.report("path.64.reference", reference_ms * 1000.0 / REFERENCE_QUERIES, "us");
+            ctx.report("path.64.length", compared == 0 ? 0.0 : ratio / compared, "x optimal");
+
+            // Pillars and pits across the middle, then the graph patched against one built
+            // from scratch.
+            std::uniform_int_distribution<int> spot(-RADIUS * CHUNK_SIZE / 2,
+                                                    RADIUS * CHUNK_SIZE / 2);
+            std::size_t rebuilt = 0;
+            double edit_ms = 0.0;
+            for (int e = 0; e < EDITS; e++) {
+                glm::ivec3 feet;
+                if (!ground(w, spot(rng), spot(rng), feet)) {
+                    continue;
+                }
+                start = std::chrono::steady_clock::now();
+                for (int k = 0; k < 3; k++) {
+                    const glm::ivec3 v = e % 2 == 0 ? feet + glm::ivec3(0, k, 0)
+                                                    : feet - glm::ivec3(0, k + 1, 0);
+                    w.set_block(v, e % 2 == 0 ? BLOCK_STONE : BLOCK_AIR);
+                    graph.block_changed(v);
+                }
+                rebuilt += graph.update();
+                edit_ms += elapsed_ms(start);
+            }
+            nav_graph fresh(w);
+            for (const glm::ivec3& pos : loaded) {
+                fresh.add_chunk(pos);
+            }
+            fresh.update();
+            ctx.check(graph.region_count() == fresh.region_count() &&
+                          graph.edge_count() == fresh.edge_count(),
+                      "edits patch the graph into the one a full build gives");
+            const results patched = run_serial(graph, near);
+            const results rebuilt_paths = run_serial(fresh, near);
+            ctx.check(patched.paths == rebuilt_paths.paths && valid(w, near, patched),
+                      "the patched graph finds the paths of a fresh one around the edits");
+            ctx.report("path.edit", edit_ms / EDITS, "ms");
+            ctx.report("path.edit.sections", static_cast<double>(rebuilt) / EDITS, "sections");
+        }
+    }  // namespace
+
+    void add_path_benchmarks(suite& s) {
+        s.add("path", bench_path);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,102 @@
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "core/json.hpp"
+#include "core/profile.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int ZONES = 1 << 20;
+        constexpr int THREADS = 4;
+        constexpr int THREAD_ZONES = 1 << 18;
+
+        // Budget for one zone, begin and end included.
+        constexpr double ZONE_BUDGET_NS = 50.0;
+
+        std::size_t count_of(const std::string& text, const std::string& what) {
+            std::size_t count = 0;
+            for (std::size_t at = text.find(what); at != std::string::npos;
+                 at = text.find(what, at + what.size())) {
+                count++;
+            }
+            return count;
+        }
+
+        void bench_profile_zone(context& ctx) {
+            // The zone object is timed directly so the numbers exist in Release builds too,
+            // where the macros compile to nothing.
+            const double clock_ns = time_ns(ZONES, [] { consume(profile_now()); });
+            const double steady_ns = time_ns(ZONES, [] {
+                consume(std::chrono::steady_clock::now().time_since_epoch().count());
+            });
+            const double zone_ns = time_ns(ZONES, [] { profile_zone zone("bench.zone"); });
+            ctx.report("profile.clock", clock_ns, "ns");
+            ctx.report("profile.steady_clock", steady_ns, "ns");
+            ctx.report("profile.zone", zone_ns, "ns/zone");
+#if defined(NDEBUG)
+            ctx.check(zone_ns < ZONE_BUDGET_NS, "a zone costs under 50 ns");
+#endif
+
+            // Threads record into their own rings, so they must not slow each other down, and
+            // dumping while they run must not disturb them.
+            std::atomic<int> finished{0};
+            std::vector<double> thread_ns(THREADS);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < THREADS; t++) {
+                threads.emplace_back([&, t] {
+                    profile_thread_name("bench " + std::to_string(t));
+                    thread_ns[t] =
+                        time_ns(THREAD_ZONES, [] { profile_zone zone("bench.thread_zone"); });
+                    finished++;
+                });
+            }
+            const std::string path =
+                (std::filesystem::temp_directory_path() / "quadcraft_bench_trace.json").string();
+            while (finished < THREADS) {
+                ctx.check(write_chrome_trace(path), "trace writes while threads record");
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            ctx.report("profile.zone.threads_" + std::to_string(THREADS),
+                       *std::max_element(thread_ns.begin(), thread_ns.end()), "ns/zone");
+
+            ctx.check(write_chrome_trace(path), "trace writes");
+            std::ifstream file(path, std::ios::binary);
+            std::stringstream text;
+            text << file.rdbuf();
+            const std::string trace = text.str();
+            ctx.check(trace.rfind("{\"traceEvents\":[", 0) == 0 &&
+                          trace.find("\n]}") != std::string::npos,
+                      "trace is a Chrome trace event list");
+            ctx.check(count_of(trace, "\"name\":\"bench.zone\"") == PROFILE_RING_SIZE - 1 &&
+                          count_of(trace, "\"name\":\"bench.thread_zone\"") ==
+                              THREADS * (PROFILE_RING_SIZE - 1),
+                      "every thread keeps its latest zones");
+            ctx.check(count_of(trace, "\"name\":\"bench 3\"") == 1, "threads are named");
+            ctx.report("profile.trace_bytes", static_cast<double>(trace.size()), "B");
+
+            // Names are free text; control characters have to come out as \u escapes.
+            fmt::memory_buffer escaped;
+            append_json_string(escaped, "a\"b\\c\td\x01");
+            ctx.check(fmt::to_string(escaped) == "\"a\\\"b\\\\c\\u0009d\\u0001\"",
+                      "JSON strings escape quotes, backslashes and control characters");
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+    }  // namespace
+
+    void add_profile_benchmarks(suite& s) {
+        s.add("profile.zone", bench_profile_zone);
+    }
+}  // namespace qc::bench
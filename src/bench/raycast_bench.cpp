@@ -0,0 +1,190 @@
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "world/raycast.hpp"
+#include "world/terrain.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int RADIUS = 8;
+        constexpr int LAYERS = 4;
+        constexpr int SHORT_RAYS = 200000;
+        constexpr int LONG_RAYS = 20000;
+        // A player's reach, and the longest line of sight asked for.
+        constexpr float REACH = 6.0f;
+        constexpr float FAR = 256.0f;
+
+        struct query {
+            glm::vec3 origin;
+            glm::vec3 direction;
+            float max_distance;
+        };
+
+        // The textbook walk: a world lookup for every voxel, no chunk skipping. Crossings are
+        // worked out the same way as in raycast(), so both must agree to the bit.
+        bool reference_raycast(const world& w, const query& q, std::uint8_t mask, ray_hit& hit) {
+            const glm::vec3 dir = q.direction / glm::length(q.direction);
+            glm::ivec3 voxel(glm::floor(q.origin));
+            glm::ivec3 step(0);
+            glm::vec3 inverse(0.0f);
+            glm::vec3 next(0.0f);
+            const auto crossing = [&](int a) {
+                if (step[a] == 0) {
+                    return std::numeric_limits<float>::infinity();
+                }
+                const int plane = step[a] > 0 ? voxel[a] + 1 : voxel[a];
+                return (static_cast<float>(plane) - q.origin[a]) * inverse[a];
+            };
+            for (int a = 0; a < 3; a++) {
+                step[a] = dir[a] > 0.0f ? 1 : dir[a] < 0.0f ? -1 : 0;
+                inverse[a] = step[a] != 0 ? 1.0f / dir[a] : 0.0f;
+                next[a] = crossing(a);
+            }
+
+            float t = 0.0f;
+            face entered = FACE_COUNT;
+            while (true) {
+                const block_id block = w.get_block(voxel);
+                if (((mask & RAY_SOLID) != 0 && block_solid(block)) ||
+                    ((mask & RAY_OPAQUE) != 0 && block_properties(block).opaque)) {
+                    hit = {voxel, block, entered, t};
+                    return true;
+                }
+                const int axis = next.x < next.y ? (next.x < next.z ? 0 : 2)
+                                                 : (next.y < next.z ? 1 : 2);
+                t = next[axis];
+                if (t > q.max_distance) {
+                    return false;
+                }
+                voxel[axis] += step[axis];
+                next[axis] = crossing(axis);
+                entered = static_cast<face>(2 * axis + (step[axis] > 0 ? 1 : 0));
+            }
+        }
+
+        bool same_hit(const ray_hit& a, const ray_hit& b) {
+            return a.voxel == b.voxel && a.block == b.block && a.entered == b.entered &&
+                   a.distance == b.distance;
+        }
+
+        // Casts every query both ways. Returns whether they all agree and counts the hits.
+        bool agrees(const world& w, const std::vector<query>& queries, std::size_t& hits) {
+            bool same = true;
+            hits = 0;
+            for (const query& q : queries) {
+                ray_hit fast;
+                ray_hit slow;
+                const bool hit = raycast(w, q.origin, q.direction, q.max_distance, RAY_SOLID, fast);
+                same = same && hit == reference_raycast(w, q, RAY_SOLID, slow) &&
+                       (!hit || same_hit(fast, slow));
+                // The voxel the ray came from must be one it could pass.
+                if (hit && fast.entered != FACE_COUNT) {
+                    const int* offset = FACE_OFFSETS[fast.entered];
+                    same = same && !block_solid(w.get_block(
+                                       fast.voxel + glm::ivec3(offset[0], offset[1], offset[2])));
+                }
+                hits += hit ? 1 : 0;
+            }
+            return same;
+        }
+
+        // Picking and line-of-sight rays over generated terrain, against the reference walk.
+        void bench_raycast(context& ctx) {
+            world w;
+            terrain_generator generator(42);
+            for (int z = -RADIUS; z <= RADIUS; z++) {
+                for (int x = -RADIUS; x <= RADIUS; x++) {
+                    for (int y = 0; y < LAYERS && x * x + z * z <= RADIUS * RADIUS; y++) {
+                        auto c = std::make_unique<chunk>();
+                        generator.generate(*c, glm::ivec3(x, y, z));
+                        w.insert(glm::ivec3(x, y, z), std::move(c));
+                    }
+                }
+            }
+
+            std::mt19937 rng(21);
+            std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+            const float span = static_cast<float>((RADIUS - 2) * CHUNK_SIZE);
+            const float top = static_cast<float>(LAYERS * CHUNK_SIZE);
+
+            // Players looking around where they stand: at eye height above the ground found by
+            // a ray straight down, mostly looking down at it.
+            std::vector<query> near;
+            while (near.size() < SHORT_RAYS) {
+                const glm::vec3 above(span * unit(rng), top, span * unit(rng));
+                ray_hit ground;
+                if (!raycast(w, above, glm::vec3(0.0f, -1.0f, 0.0f), top, RAY_SOLID, ground)) {
+                    continue;
+                }
+                const glm::vec3 eye(above.x, static_cast<float>(ground.voxel.y) + 2.62f, above.z);
+                const glm::vec3 look(unit(rng), 0.5f * unit(rng) - 0.4f, unit(rng));
+                if (glm::length(look) > 0.0f) {
+                    near.push_back({eye, look, REACH});
+                }
+            }
+
+            // Line of sight in any direction from anywhere in the loaded volume. Every fourth
+            // ray runs along an axis or a diagonal from a voxel corner or center, where crossings
+            // tie and the skip over empty chunks must still pick the same voxels.
+            std::vector<query> far;
+            while (far.size() < LONG_RAYS) {
+                glm::vec3 origin(span * unit(rng), 0.5f * top * (unit(rng) + 1.0f),
+                                 span * unit(rng));
+                glm::vec3 direction(unit(rng), unit(rng), unit(rng));
+                if (far.size() % 4 == 0) {
+                    origin = glm::floor(origin) + glm::vec3(far.size() % 8 == 0 ? 0.0f : 0.5f);
+                    direction = glm::floor(direction * 1.5f + glm::vec3(0.5f));
+                }
+                if (glm::length(direction) > 0.0f) {
+                    far.push_back({origin, direction, FAR});
+                }
+            }
+
+            std::size_t near_hits = 0;
+            std::size_t far_hits = 0;
+            ctx.check(agrees(w, near, near_hits), "short rays hit what a voxel-by-voxel walk hits");
+            ctx.check(agrees(w, far, far_hits), "long rays hit what a voxel-by-voxel walk hits");
+            ctx.check(line_of_sight(w, glm::vec3(-200.0f, 200.0f, 0.0f),
+                                    glm::vec3(200.0f, 200.0f, 0.0f)) &&
+                          !line_of_sight(w, glm::vec3(0.0f, 200.0f, 0.0f),
+                                         glm::vec3(0.5f, 2.0f, 0.5f)),
+                      "line of sight is clear above the terrain and blocked below it");
+
+            const auto cast_all = [&](const std::vector<query>& queries, bool reference) {
+                std::uint64_t sum = 0;
+                for (const query& q : queries) {
+                    ray_hit hit;
+                    const bool found = reference ? reference_raycast(w, q, RAY_SOLID, hit)
+                                                 : raycast(w, q.origin, q.direction,
+                                                           q.max_distance, RAY_SOLID, hit);
+                    sum += found ? static_cast<std::uint64_t>(hit.voxel.y) : 1;
+                }
+                consume(sum);
+            };
+            const double near_ns = time_ns(3, [&] { cast_all(near, false); });
+            const double near_reference_ns = time_ns(3, [&] { cast_all(near, true); });
+            const double far_ns = time_ns(3, [&] { cast_all(far, false); });
+            const double far_reference_ns = time_ns(3, [&] { cast_all(far, true); });
+
+            ctx.report("raycast.chunks", static_cast<double>(w.chunk_count()), "chunks");
+            ctx.report("raycast.short.hits", 100.0 * near_hits / near.size(), "%");
+            ctx.report("raycast.short", near.size() / near_ns * 1e9, "rays/s");
+            ctx.report("raycast.short.reference", near.size() / near_reference_ns * 1e9, "rays/s");
+            ctx.report("raycast.long.hits", 100.0 * far_hits / far.size(), "%");
+            ctx.report("raycast.long", far.size() / far_ns * 1e9, "rays/s");
+            ctx.report("raycast.long.reference", far.size() / far_reference_ns * 1e9, "rays/s");
+            ctx.report("raycast.long.speedup", far_reference_ns / far_ns, "x");
+        }
+    }  // namespace
+
+    void add_raycast_benchmarks(suite& s) {
+        s.add("raycast", bench_raycast);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/fake_gl.hpp"
+#include "bench/scenes.hpp"
+#include "render/chunk_renderer.hpp"
+
+namespace qc::bench {
+    namespace {
+        using mesh_map = std::unordered_map<glm::ivec3, std::vector<packed_quad>, chunk_pos_hash>;
+
+        constexpr int TERRAIN_RADIUS = 4;
+        constexpr int TERRAIN_LAYERS = 4;
+        constexpr int CHURN = 500;
+        // A view distance of 32 chunks in every direction, 8 layers tall.
+        constexpr int FAR_RADIUS = 32;
+        constexpr int FAR_LAYERS = 8;
+
+        void bench_render_allocator(context& ctx) {
+            constexpr std::uint32_t CAPACITY = 1 << 16;
+            range_allocator allocator(CAPACITY);
+            // Which allocation owns each unit, -1 when free.
+            std::vector<int> owner(CAPACITY, -1);
+            struct live_range {
+                std::uint32_t offset;
+                std::uint32_t size;
+            };
+            std::vector<live_range> live;
+            std::mt19937 rng(3);
+            bool disjoint = true;
+            std::uint32_t used = 0;
+            for (int i = 0; i < 200000 && disjoint; i++) {
+                if (!live.empty() && rng() % 2 == 0) {
+                    const std::size_t pick = rng() % live.size();
+                    const live_range range = live[pick];
+                    live[pick] = live.back();
+                    live.pop_back();
+                    allocator.release(range.offset, range.size);
+                    std::fill_n(owner.begin() + range.offset, range.size, -1);
+                    used -= range.size;
+                    continue;
+                }
+                const std::uint32_t size = 1 + rng() % 1024;
+                const std::uint32_t offset = allocator.allocate(size);
+                if (offset == range_allocator::INVALID) {
+                    continue;
+                }
+                disjoint = offset + size <= CAPACITY &&
+                           std::all_of(owner.begin() + offset, owner.begin() + offset + size,
+                                       [](int o) { return o < 0; });
+                std::fill_n(owner.begin() + offset, size, i);
+                live.push_back({offset, size});
+                used += size;
+            }
+            ctx.check(disjoint, "allocated ranges never overlap");
+            ctx.check(allocator.used() == used, "the allocator tracks the units in use");
+            ctx.report("render.arena.fragments", static_cast<double>(allocator.free_ranges()),
+                       "ranges");
+
+            for (const live_range& range : live) {
+                allocator.release(range.offset, range.size);
+            }
+            ctx.check(allocator.free_ranges() == 1 && allocator.largest_free() == CAPACITY,
+                      "released ranges coalesce back into one");
+
+            std::vector<std::uint32_t> offsets;
+            const double allocate_ns = time_ns(4096, [&] {
+                offsets.push_back(allocator.allocate(16));
+            });
+            const double release_ns = time_ns(4096, [&] {
+                allocator.release(offsets.back(), 16);
+                offsets.pop_back();
+            });
+            ctx.report("render.arena.allocate", allocate_ns, "ns/op");
+            ctx.report("render.arena.release", release_ns, "ns/op");
+
+            allocator.grow(CAPACITY * 2);
+            ctx.check(allocator.free_ranges() == 1 && allocator.largest_free() == CAPACITY * 2,
+                      "growing extends the free tail");
+        }
+
+        // Every command of the last draw must read exactly the mesh of the chunk whose origin
+        // its base instance selects.
+        bool draw_matches(const fake_gl& gl, const mesh_map& meshes) {
+            if (gl.draws().size() != 1) {
+                return false;
+            }
+            const fake_gl::draw_call& call = gl.draws().front();
+            const std::vector<std::uint8_t>& quads = *gl.buffer(call.storage_buffer);
+            const std::vector<std::uint8_t>& origins = *gl.buffer(call.origin_buffer);
+            std::size_t drawn = 0;
+            for (const draw_arrays_indirect_command& command : call.commands) {
+                glm::ivec3 origin;
+                std::memcpy(&origin, origins.data() + command.base_instance * sizeof(origin),
+                            sizeof(origin));
+                const auto it = meshes.find(origin / CHUNK_SIZE);
+                if (command.instance_count != 1 || it == meshes.end() ||
+                    command.count != it->second.size() * 6 ||
+                    std::memcmp(quads.data() + command.first / 6 * sizeof(packed_quad),
+                                it->second.data(), it->second.size() * sizeof(packed_quad)) != 0) {
+                    return false;
+                }
+                drawn++;
+            }
+            return call.mode == gl::TRIANGLES && drawn == meshes.size();
+        }
+
+        void bench_render_mdi(context& ctx) {
+            world w;
+            const std::vector<glm::ivec3> positions =
+                generate_terrain(w, TERRAIN_RADIUS, TERRAIN_LAYERS);
+            mesher m;
+            mesh_map meshes;
+            std::vector<std::vector<packed_quad>> library;
+            for (const glm::ivec3& pos : positions) {
+                std::vector<packed_quad> quads;
+                m.build(w.neighborhood(pos), quads);
+                if (!quads.empty()) {
+                    library.push_back(quads);
+                    meshes.emplace(pos, std::move(quads));
+                }
+            }
+
+            fake_gl gl;
+            {
+                // A small arena, so uploading the world has to grow it several times.
+                chunk_renderer renderer(gl.functions(), 4096);
+                for (const auto& entry : meshes) {
+                    renderer.upload(entry.first, entry.second);
+                }
+                ctx.check(renderer.arena().capacity() > 4096, "the arena grows to fit");
+
+                std::size_t calls = gl.calls();
+                ctx.check(renderer.draw(positions) == meshes.size(), "every mesh is drawn");
+                const std::size_t calls_per_frame = gl.calls() - calls;
+                ctx.check(draw_matches(gl, meshes),
+                          "one indirect draw reads every chunk's mesh at its origin");
+
+                // Remeshing, unloading and reloading chunks in random order.
+                std::mt19937 rng(9);
+                bool constant_calls = true;
+                for (int i = 0; i < CHURN; i++) {
+                    const glm::ivec3 pos = positions[rng() % positions.size()];
+                    if (rng() % 4 == 0) {
+                        renderer.remove(pos);
+                        meshes.erase(pos);
+                    } else {
+                        std::vector<packed_quad> quads = library[rng() % library.size()];
+                        quads.resize(std::max<std::size_t>(1, quads.size() * (rng() % 8) / 4));
+                        renderer.upload(pos, quads);
+                        meshes[pos] = std::move(quads);
+                    }
+                    if (i % 50 == 49) {
+                        gl.clear_draws();
+                        calls = gl.calls();
+                        renderer.draw(positions);
+                        constant_calls = constant_calls && gl.calls() - calls == calls_per_frame;
+                    }
+                }
+                ctx.check(draw_matches(gl, meshes), "draws stay correct while chunks churn");
+                bool bounds_match = renderer.bounds().size() == meshes.size();
+                for (std::size_t i = 0; bounds_match && i < renderer.bounds().size(); i++) {
+                    const glm::ivec3& pos = renderer.bounds().key(i);
+                    bounds_match = meshes.count(pos) != 0 &&
+                                   renderer.bounds().box(i).min == chunk_bounds(pos).min &&
+                                   renderer.bounds().box(i).max == chunk_bounds(pos).max;
+                }
+                ctx.check(bounds_match, "the bounds table holds exactly the chunks with a mesh");
+                ctx.check(constant_calls, "a frame makes the same GL calls however many chunks");
+                ctx.report("render.mdi.gl_calls", static_cast<double>(calls_per_frame),
+                           "calls/frame");
+                ctx.report("render.mdi.arena_use",
+                           100.0 * renderer.arena().used() / renderer.arena().capacity(), "%");
+            }
+            ctx.check(gl.errors() == 0, "no invalid GL calls");
+            ctx.check(gl.buffer_count() == 0, "the renderer deletes its buffers");
+        }
+
+        // Command building for a far view distance, where per-chunk draw calls would dominate.
+        void bench_render_commands(context& ctx) {
+            fake_gl gl;
+            chunk_renderer renderer(gl.functions());
+            std::vector<glm::ivec3> visible;
+            const std::vector<packed_quad> quads(64, packed_quad{0, 0});
+            for (int z = -FAR_RADIUS; z < FAR_RADIUS; z++) {
+                for (int x = -FAR_RADIUS; x < FAR_RADIUS; x++) {
+                    for (int y = 0; y < FAR_LAYERS; y++) {
+                        visible.emplace_back(x, y, z);
+                        renderer.upload(visible.back(), quads);
+                    }
+                }
+            }
+            std::shuffle(visible.begin(), visible.end(), std::mt19937(1));
+            std::size_t draws = 0;
+            const double draw_ns = time_ns(20, [&] {
+                gl.clear_draws();
+                draws = renderer.draw(visible);
+            });
+            ctx.check(draws == visible.size() && gl.draws().size() == 1,
+                      "all chunks go out in one indirect draw");
+            ctx.check(gl.errors() == 0, "no invalid GL calls");
+            ctx.report("render.mdi.chunks", static_cast<double>(draws), "chunks");
+            ctx.report("render.mdi.frame", draw_ns / 1000.0, "us");
+            ctx.report("render.mdi.per_chunk", draw_ns / draws, "ns/chunk");
+        }
+    }  // namespace
+
+    void add_render_benchmarks(suite& s) {
+        s.add("render.arena", bench_render_allocator);
+        s.add("render.mdi", bench_render_mdi);
+        s.add("render.commands", bench_render_commands);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,174 @@
+#include "bench/scenario.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include "core/arena.hpp"
+#include "core/job_system.hpp"
+#include "core/profile.hpp"
+#include "mesh/mesher.hpp"
+#include "world/lighting.hpp"
+#include "world/region.hpp"
+#include "world/terrain.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        double elapsed_ms(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             start)
+                .count();
+        }
+
+        // FNV-1a over every block of every chunk, in a fixed chunk order.
+        std::uint32_t block_hash(const world& w, const std::vector<glm::ivec3>& positions) {
+            const auto blocks = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            std::uint32_t hash = 2166136261u;
+            for (const glm::ivec3& pos : positions) {
+                const chunk* c = w.find(pos);
+                if (c == nullptr) {
+                    continue;
+                }
+                c->unpack(blocks.get());
+                for (int i = 0; i < CHUNK_VOLUME; i++) {
+                    hash = (hash ^ blocks[i]) * 16777619u;
+                }
+            }
+            return hash;
+        }
+
+        std::uint32_t light_hash(const world& w, const std::vector<glm::ivec3>& positions) {
+            std::uint32_t hash = 2166136261u;
+            for (const glm::ivec3& pos : positions) {
+                const chunk_light* light = w.find_light(pos);
+                for (int c = 0; c < LIGHT_CHANNEL_COUNT && light != nullptr; c++) {
+                    for (int i = 0; i < CHUNK_VOLUME; i++) {
+                        hash = (hash ^ light->channels[c].get(i)) * 16777619u;
+                    }
+                }
+            }
+            return hash;
+        }
+    }  // namespace
+
+    void run_scenario(const scenario_options& options, context& ctx) {
+        QC_PROFILE_ZONE("scenario");
+        std::vector<glm::ivec3> positions;
+        for (int z = -options.radius; z <= options.radius; z++) {
+            for (int x = -options.radius; x <= options.radius; x++) {
+                if (x * x + z * z > options.radius * options.radius) {
+                    continue;
+                }
+                for (int y = 0; y < options.layers; y++) {
+                    positions.emplace_back(x, y, z);
+                }
+            }
+        }
+        const double chunks = static_cast<double>(positions.size());
+        ctx.report("scenario.chunks", chunks, "chunks");
+
+        world w;
+        for (const glm::ivec3& pos : positions) {
+            w.get_or_create(pos);
+        }
+        job_system jobs(options.threads);
+        std::vector<std::unique_ptr<terrain_generator>> generators;
+        std::vector<std::unique_ptr<mesher>> meshers;
+        for (unsigned i = 0; i < jobs.thread_count(); i++) {
+            generators.push_back(std::make_unique<terrain_generator>(options.seed));
+            meshers.push_back(std::make_unique<mesher>());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (const glm::ivec3& pos : positions) {
+            chunk* c = w.find(pos);
+            jobs.submit([&, c, pos] { generators[jobs.current_worker()]->generate(*c, pos); });
+        }
+        jobs.wait_idle();
+        const double generate_ms = elapsed_ms(start);
+        ctx.report("scenario.generate", generate_ms, "ms");
+        ctx.report("scenario.generate.rate", chunks / generate_ms * 1000.0, "chunks/s");
+        const std::uint32_t world_hash = block_hash(w, positions);
+        ctx.report("scenario.world_hash", world_hash, "fnv");
+
+        std::vector<std::vector<packed_quad>> meshes(positions.size());
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < positions.size(); i++) {
+            const chunk_neighborhood n = w.neighborhood(positions[i]);
+            jobs.submit([&, n, i] {
+                // As the streamer meshes: on the worker's arena, copied out at the final size.
+                std::pmr::vector<packed_quad> quads(&thread_arena());
+                meshers[jobs.current_worker()]->build(n, quads);
+                meshes[i].assign(quads.begin(), quads.end());
+            });
+        }
+        jobs.wait_idle();
+        const double mesh_ms = elapsed_ms(start);
+        std::size_t quads = 0;
+        for (const std::vector<packed_quad>& mesh : meshes) {
+            quads += mesh.size();
+        }
+        ctx.report("scenario.mesh", mesh_ms, "ms");
+        ctx.report("scenario.mesh.rate", chunks / mesh_ms * 1000.0, "chunks/s");
+        ctx.report("scenario.quads", static_cast<double>(quads), "quads");
+
+        light_engine engine(w);
+        start = std::chrono::steady_clock::now();
+        engine.relight_all();
+        ctx.report("scenario.light", elapsed_ms(start), "ms");
+
+        // Scripted edits around the spawn: digging, building, flooding and lamps.
+        std::mt19937 rng(options.seed);
+        const int reach = std::max(1, options.radius / 2) * CHUNK_SIZE;
+        std::uniform_int_distribution<int> horizontal(-reach, reach - 1);
+        std::uniform_int_distribution<int> vertical(0, options.layers * CHUNK_SIZE - 1);
+        const block_id palette[] = {BLOCK_AIR, BLOCK_STONE, BLOCK_WATER, BLOCK_LAMP};
+        std::size_t visits = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.edits; i++) {
+            const glm::ivec3 v(horizontal(rng), vertical(rng), horizontal(rng));
+            engine.set_block(v, palette[rng() % 4]);
+            visits += engine.last_visits();
+        }
+        const double edit_ms = elapsed_ms(start);
+        ctx.report("scenario.edit", edit_ms * 1000.0 / std::max(1, options.edits), "us/edit");
+        ctx.report("scenario.edit.visits",
+                   static_cast<double>(visits) / std::max(1, options.edits), "voxels/edit");
+        const std::uint32_t edited_hash = block_hash(w, positions);
+        ctx.report("scenario.light_hash", light_hash(w, positions), "fnv");
+
+        const std::filesystem::path directory =
+            std::filesystem::temp_directory_path() /
+            ("quadcraft_scenario_" + std::to_string(options.seed));
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+        {
+            region_store store(directory.string());
+            start = std::chrono::steady_clock::now();
+            ctx.check(store.save(w), "world saves");
+            ctx.report("scenario.save", elapsed_ms(start), "ms");
+            ctx.report("scenario.save.bytes", static_cast<double>(store.disk_usage()), "B");
+        }
+
+        world loaded;
+        {
+            region_store store(directory.string());
+            start = std::chrono::steady_clock::now();
+            for (int z = -options.radius; z <= options.radius; z++) {
+                for (int x = -options.radius; x <= options.radius; x++) {
+                    ctx.check(store.load_column(loaded, x, z) >= 0, "columns load");
+                }
+            }
+            ctx.report("scenario.load", elapsed_ms(start), "ms");
+        }
+        ctx.check(loaded.chunk_count() == w.chunk_count() &&
+                      block_hash(loaded, positions) == edited_hash,
+                  "the world loads back unchanged");
+        std::filesystem::remove_all(directory, error);
+    }
+}  // namespace qc::bench
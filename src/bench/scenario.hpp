@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "bench/bench.hpp"
+
+namespace qc::bench {
+    struct scenario_options {
+        // Columns within `radius` chunks of the origin, `layers` chunks tall.
+        int radius = 8;
+        int layers = 4;
+        std::uint32_t seed = 42;
+        unsigned threads = 1;
+        int edits = 1000;
+    };
+
+    // The end-to-end pipeline a session goes through, one timed phase after another: generate
+    // the world, mesh it, light it, apply scripted edits with incremental relighting, then save
+    // it to region files and load it back. Everything derives from the seed, so the checksums
+    // it reports must not change between runs unless the world format or generator does.
+    void run_scenario(const scenario_options& options, context& ctx);
+}  // namespace qc::bench
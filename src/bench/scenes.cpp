@@ -0,0 +1,56 @@
+#include "bench/scenes.hpp"
+
+#include <cmath>
+#include <random>
+
+#include "world/terrain.hpp"
+
+namespace qc::bench {
+    void make_terrain(chunk& c, int seed, int layer) {
+        std::mt19937 rng(static_cast<std::uint32_t>(seed));
+        std::uniform_int_distribution<int> ore(0, 63);
+
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                const float h = 48.0f + 12.0f * std::sin((x + seed) * 0.21f) +
+                                10.0f * std::cos((z - seed) * 0.17f);
+                const int height = static_cast<int>(h);
+                for (int y = layer * CHUNK_SIZE; y < (layer + 1) * CHUNK_SIZE; y++) {
+                    block_id block = BLOCK_AIR;
+                    if (y < height - 4) {
+                        block = ore(rng) == 0 ? static_cast<block_id>(BLOCK_COUNT + ore(rng) % 6)
+                                              : static_cast<block_id>(BLOCK_STONE);
+                    } else if (y < height) {
+                        block = BLOCK_DIRT;
+                    } else if (y == height) {
+                        block = height < 40 ? BLOCK_SAND : BLOCK_GRASS;
+                    } else if (y < 40) {
+                        block = BLOCK_WATER;
+                    }
+                    c.set(x, y - layer * CHUNK_SIZE, z, block);
+                }
+            }
+        }
+    }
+
+    std::vector<glm::ivec3> generate_terrain(world& w, const glm::ivec3& min,
+                                             const glm::ivec3& max, std::uint32_t seed) {
+        terrain_generator generator(seed);
+        std::vector<glm::ivec3> positions;
+        for (int z = min.z; z <= max.z; z++) {
+            for (int x = min.x; x <= max.x; x++) {
+                for (int y = min.y; y <= max.y; y++) {
+                    positions.emplace_back(x, y, z);
+                    generator.generate(w.get_or_create(positions.back()), positions.back());
+                }
+            }
+        }
+        return positions;
+    }
+
+    std::vector<glm::ivec3> generate_terrain(world& w, int radius, int layers,
+                                             std::uint32_t seed) {
+        return generate_terrain(w, glm::ivec3(-radius, 0, -radius),
+                                glm::ivec3(radius, layers - 1, radius), seed);
+    }
+}  // namespace qc::bench
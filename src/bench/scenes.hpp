@@ -0,0 +1,26 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "world/chunk.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    // Rolling hills with a few ore pockets, roughly what the surface of a world looks like.
+    // `layer` stacks chunks vertically so a sample includes solid, surface and empty chunks;
+    // the surface sits in layer 1.
+    void make_terrain(chunk& c, int seed, int layer);
+
+    // Fills `w` with terrain_generator chunks from `min` to `max`, both included, and returns
+    // their positions with z outermost and y innermost.
+    std::vector<glm::ivec3> generate_terrain(world& w, const glm::ivec3& min,
+                                             const glm::ivec3& max, std::uint32_t seed = 42);
+
+    // The columns within `radius` chunks of the origin on x and z, `layers` chunks high from
+    // y = 0.
+    std::vector<glm::ivec3> generate_terrain(world& w, int radius, int layers,
+                                             std::uint32_t seed = 42);
+}  // namespace qc::bench
@@ -0,0 +1,278 @@
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "server/protocol.hpp"
+#include "server/server.hpp"
+#include "world/terrain.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int PLAYERS = 100;
+        // Players come in groups standing close together, each group walking its own way.
+        constexpr int GROUPS = 10;
+        constexpr int RADIUS = 3;
+        constexpr int LAYERS = 3;
+        constexpr std::uint32_t SEED = 42;
+        // Up to thirty seconds for the view to fill after joining and again after moving.
+        constexpr int SETTLE_FRAMES = 600;
+        // Flying three chunks: whichever way a group heads, it crosses at least two chunk
+        // borders along its main axis, past the unload distance of what it left behind.
+        constexpr float WALK_SPEED = 10.9f;
+        constexpr float WALK_DISTANCE = 3.0f * CHUNK_SIZE;
+        constexpr std::chrono::milliseconds FRAME(50);
+        constexpr float FRAME_S = 0.05f;
+        constexpr int WALK_FRAMES = static_cast<int>(WALK_DISTANCE / (WALK_SPEED * FRAME_S)) + 1;
+
+        struct sim_player {
+            connection link;
+            glm::vec3 position{0.0f};
+            glm::vec3 direction{0.0f};
+            std::unordered_set<glm::ivec3, chunk_pos_hash> chunks;
+            std::size_t unloads = 0;
+            bool valid = true;
+        };
+
+        // Sends the player's position and takes in what the server sent. `kept` collects the
+        // chunk payloads when given.
+        void update_player(sim_player& p,
+                           std::unordered_map<glm::ivec3, std::vector<std::uint8_t>,
+                                              chunk_pos_hash>* kept) {
+            std::uint8_t position[POSITION_SIZE];
+            write_position(position, glm::ivec3(glm::floor(p.position)));
+            p.link.send(MSG_POSITION, position, sizeof(position));
+            p.link.flush();
+            p.link.receive([&](std::uint8_t type, const std::uint8_t* data, std::size_t size) {
+                if (size < POSITION_SIZE) {
+                    p.valid = false;
+                    return;
+                }
+                const glm::ivec3 pos = read_position(data);
+                if (type == MSG_CHUNK) {
+                    p.valid = p.valid && p.chunks.insert(pos).second;
+                    if (kept != nullptr) {
+                        (*kept)[pos].assign(data + POSITION_SIZE, data + size);
+                    }
+                } else if (type == MSG_UNLOAD) {
+                    p.valid = p.valid && p.chunks.erase(pos) == 1;
+                    p.unloads++;
+                } else {
+                    p.valid = false;
+                }
+            });
+        }
+
+        // Whether the player holds every chunk in range and nothing past the unload distance.
+        bool has_range(const sim_player& p) {
+            const glm::ivec3 center = chunk_of(glm::ivec3(glm::floor(p.position)));
+            std::size_t wanted = 0;
+            for (int z = -RADIUS; z <= RADIUS; z++) {
+                for (int x = -RADIUS; x <= RADIUS; x++) {
+                    for (int y = 0; y < LAYERS && x * x + z * z <= RADIUS * RADIUS; y++) {
+                        if (p.chunks.count(glm::ivec3(center.x + x, y, center.z + z)) == 0) {
+                            return false;
+                        }
+                        wanted++;
+                    }
+                }
+            }
+            for (const glm::ivec3& pos : p.chunks) {
+                const int dx = pos.x - center.x;
+                const int dz = pos.z - center.z;
+                if (dx * dx + dz * dz > (RADIUS + 1) * (RADIUS + 1)) {
+                    return false;
+                }
+            }
+            return p.chunks.size() >= wanted;
+        }
+
+        // 100 players on one dedicated server over loopback TCP, the server ticking at 20 Hz on
+        // its own thread as it would in production.
+        // A message claiming more than MAX_MESSAGE_SIZE closes the connection as soon as its
+        // header arrives, even behind a good message that came with it.
+        void check_framing(context& ctx) {
+            tcp_socket listener = tcp_socket::listen("127.0.0.1", 0);
+            tcp_socket peer = tcp_socket::connect("127.0.0.1", listener.local_port());
+            tcp_socket accepted;
+            for (int i = 0; i < 1000 && !accepted.valid(); i++) {
+                accepted = listener.accept();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            connection link(std::move(accepted));
+
+            std::vector<std::uint8_t> bytes;
+            const std::uint32_t sizes[2] = {POSITION_SIZE, MAX_MESSAGE_SIZE + 1};
+            for (const std::uint32_t size : sizes) {
+                const std::size_t at = bytes.size();
+                bytes.resize(at + sizeof(size) + 1);
+                std::memcpy(&bytes[at], &size, sizeof(size));
+                bytes.back() = MSG_POSITION;
+                if (size == POSITION_SIZE) {
+                    append_position(bytes, glm::ivec3(0));
+                }
+            }
+            peer.send(bytes.data(), bytes.size());
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            int messages = 0;
+            const bool kept = link.receive([&](std::uint8_t, const std::uint8_t*, std::size_t) {
+                messages++;
+            });
+            ctx.check(!kept && !link.open() && messages == 0,
+                      "an oversized message anywhere in what arrived closes the connection");
+        }
+
+        void bench_server(context& ctx) {
+            check_framing(ctx);
+
+            server_settings settings;
+            settings.port = 0;
+            settings.view_radius = RADIUS;
+            settings.layers = LAYERS;
+            settings.seed = SEED;
+            dedicated_server server(settings);
+            if (!server.start()) {
+                ctx.check(false, "the server listens on loopback");
+                return;
+            }
+
+            std::vector<std::unique_ptr<sim_player>> players;
+            for (int i = 0; i < PLAYERS; i++) {
+                auto p = std::make_unique<sim_player>();
+                p->link = connection(tcp_socket::connect("127.0.0.1", server.port()));
+                const int group = i % GROUPS;
+                const float angle = 6.2831853f * static_cast<float>(group) / GROUPS;
+                const int member = i / GROUPS;
+                p->position = glm::vec3(160.0f * static_cast<float>(group) +
+                                            8.0f * static_cast<float>(member % 4),
+                                        70.0f, 8.0f * static_cast<float>(member / 4));
+                p->direction = glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+                players.push_back(std::move(p));
+            }
+            bool connected = true;
+            for (const std::unique_ptr<sim_player>& p : players) {
+                connected = connected && p->link.open();
+            }
+            ctx.check(connected, "every player connects");
+
+            std::atomic<bool> stop{false};
+            std::thread ticker([&] { server.run(stop); });
+
+            std::unordered_map<glm::ivec3, std::vector<std::uint8_t>, chunk_pos_hash> kept;
+            const auto frame = [&](bool walking) {
+                const auto start = std::chrono::steady_clock::now();
+                for (std::size_t i = 0; i < players.size(); i++) {
+                    sim_player& p = *players[i];
+                    if (walking) {
+                        p.position += p.direction * (WALK_SPEED * FRAME_S);
+                    }
+                    update_player(p, i == 0 ? &kept : nullptr);
+                }
+                std::this_thread::sleep_until(start + FRAME);
+            };
+            const auto all_in_range = [&] {
+                for (const std::unique_ptr<sim_player>& p : players) {
+                    if (!has_range(*p)) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+
+            // Seconds until every player holds its whole view.
+            const auto settle = [&] {
+                const auto start = std::chrono::steady_clock::now();
+                for (int f = 0; f < SETTLE_FRAMES && !all_in_range(); f++) {
+                    frame(false);
+                }
+                return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                    .count();
+            };
+
+            const double join_s = settle();
+            ctx.check(all_in_range(), "every player gets every chunk in range and no other");
+            bool still = true;
+            for (const std::unique_ptr<sim_player>& p : players) {
+                still = still && p->unloads == 0;
+            }
+            ctx.check(still, "players standing still are not told to unload anything");
+
+            for (int f = 0; f < WALK_FRAMES; f++) {
+                frame(true);
+            }
+            const double walk_s = settle();
+            ctx.check(all_in_range(), "moved players get every chunk in range and no other");
+
+            bool valid = true;
+            bool unloaded = true;
+            for (const std::unique_ptr<sim_player>& p : players) {
+                valid = valid && p->valid && p->link.open();
+                unloaded = unloaded && p->unloads > 0;
+            }
+            ctx.check(valid, "the server only sends chunks a player lacks and unloads it has");
+            ctx.check(unloaded, "moving players are told to unload what they left behind");
+
+            // What the first player got against generating the same chunks here.
+            terrain_generator generator(SEED);
+            chunk expected;
+            chunk received;
+            std::vector<block_id> a(CHUNK_VOLUME);
+            std::vector<block_id> b(CHUNK_VOLUME);
+            bool same = !players[0]->chunks.empty();
+            for (const glm::ivec3& pos : players[0]->chunks) {
+                const std::vector<std::uint8_t>& bytes = kept[pos];
+                generator.generate(expected, pos);
+                expected.unpack(a.data());
+                same = same && received.decode(bytes.data(), bytes.size());
+                received.unpack(b.data());
+                same = same && a == b;
+            }
+            ctx.check(same, "players receive the chunks the server generated");
+
+            for (const std::unique_ptr<sim_player>& p : players) {
+                p->link.close();
+            }
+            std::this_thread::sleep_for(10 * FRAME);
+            stop.store(true);
+            ticker.join();
+
+            // Jobs still generating chunks for the players that left finish and are dropped.
+            for (int i = 0; i < 200 && server.chunk_count() > 0; i++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                server.tick();
+            }
+            ctx.check(server.player_count() == 0 && server.chunk_count() == 0,
+                      "chunks are unloaded once no player is in range");
+
+            const tick_histogram& times = server.tick_times();
+            ctx.report("server.players", PLAYERS, "players");
+            ctx.report("server.ticks", static_cast<double>(times.count()), "ticks");
+            ctx.report("server.tick.mean", times.mean_ms(), "ms");
+            ctx.report("server.tick.p50", times.percentile_ms(50.0), "ms");
+            ctx.report("server.tick.p99", times.percentile_ms(99.0), "ms");
+            ctx.report("server.tick.max", times.max_ms(), "ms");
+            ctx.report("server.tick.over_budget",
+                       100.0 * static_cast<double>(times.over_budget()) /
+                           static_cast<double>(times.count()),
+                       "%");
+            ctx.report("server.chunks_sent", static_cast<double>(server.chunks_sent()), "chunks");
+            ctx.report("server.sent", static_cast<double>(server.bytes_sent()) / (1024.0 * 1024.0),
+                       "MiB");
+            ctx.report("server.settle.join", join_s, "s");
+            ctx.report("server.settle.walk", walk_s, "s");
+        }
+    }  // namespace
+
+    void add_server_benchmarks(suite& s) {
+        s.add("server.loopback", bench_server);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/scenes.hpp"
+#include "core/job_system.hpp"
+#include "mesh/mesher.hpp"
+#include "world/lighting.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        // A 5 x 5 patch; snapshots are taken of the 3 x 3 columns in the middle so every one has
+        // all 26 neighbours.
+        constexpr int PATCH = 2;
+        constexpr int LAYERS = 4;
+        constexpr int EDITS = 4000;
+        // A snapshot goes to a mesh job after every few edits, and some are kept to mesh again.
+        constexpr int EDITS_PER_SNAPSHOT = 4;
+        constexpr int KEEP_EVERY = 16;
+
+        // FNV-1a over the blocks and light of a chunk.
+        std::uint32_t chunk_digest(const chunk& blocks, const chunk_light* light,
+                                   block_id* scratch) {
+            blocks.unpack(scratch);
+            std::uint32_t hash = 2166136261u;
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                hash = (hash ^ scratch[i]) * 16777619u;
+            }
+            for (int c = 0; c < LIGHT_CHANNEL_COUNT && light != nullptr; c++) {
+                for (int i = 0; i < CHUNK_VOLUME; i++) {
+                    hash = (hash ^ light->channels[c].get(i)) * 16777619u;
+                }
+            }
+            return hash;
+        }
+
+        std::uint32_t snapshot_digest(const chunk_snapshot& s, block_id* scratch) {
+            const int center = neighbor_index(0, 0, 0);
+            return chunk_digest(*s.blocks[center], s.light[center].get(), scratch);
+        }
+
+        struct mesh_result {
+            std::uint32_t digest = 0;
+            std::vector<packed_quad> quads;
+        };
+
+        // Edits the world through the light engine on this thread while jobs mesh snapshots of
+        // it. Every job must see its snapshot exactly as it was taken, whatever the edits did to
+        // the live chunks meanwhile; built with QUADCRAFT_SANITIZE_THREAD this doubles as the
+        // race test of the copy-on-write world.
+        void bench_snapshot(context& ctx) {
+            world w;
+            generate_terrain(w, PATCH, LAYERS);
+            light_engine light(w);
+            light.relight_all();
+
+            job_system jobs;
+            std::vector<std::unique_ptr<mesher>> meshers;
+            std::vector<std::unique_ptr<block_id[]>> scratch;
+            for (unsigned i = 0; i < jobs.thread_count(); i++) {
+                meshers.push_back(std::make_unique<mesher>());
+                scratch.push_back(std::make_unique<block_id[]>(CHUNK_VOLUME));
+            }
+            const auto main_scratch = std::make_unique<block_id[]>(CHUNK_VOLUME);
+
+            std::mt19937 rng(11);
+            std::uniform_int_distribution<int> horizontal(-CHUNK_SIZE, 2 * CHUNK_SIZE - 1);
+            std::uniform_int_distribution<int> vertical(0, LAYERS * CHUNK_SIZE - 1);
+            std::uniform_int_distribution<int> column(-1, 1);
+            std::uniform_int_distribution<int> layer(1, LAYERS - 2);
+            const block_id choices[] = {BLOCK_AIR, BLOCK_STONE, BLOCK_LAMP, BLOCK_AIR,
+                                        BLOCK_DIRT};
+
+            constexpr int SNAPSHOTS = EDITS / EDITS_PER_SNAPSHOT;
+            std::vector<mesh_result> results(SNAPSHOTS);
+            std::vector<std::uint32_t> taken(SNAPSHOTS);
+            std::vector<chunk_snapshot> kept;
+            std::atomic<int> mismatches{0};
+
+            double edit_total_ns = 0.0;
+            double edit_worst_ns = 0.0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < EDITS; i++) {
+                const glm::ivec3 v(horizontal(rng), vertical(rng), horizontal(rng));
+                const auto edit_start = std::chrono::steady_clock::now();
+                light.set_block(v, choices[i % 5]);
+                const double ns = std::chrono::duration<double, std::nano>(
+                                      std::chrono::steady_clock::now() - edit_start)
+                                      .count();
+                edit_total_ns += ns;
+                edit_worst_ns = std::max(edit_worst_ns, ns);
+
+                if (i % EDITS_PER_SNAPSHOT != 0) {
+                    continue;
+                }
+                const int n = i / EDITS_PER_SNAPSHOT;
+                const glm::ivec3 pos(column(rng), layer(rng), column(rng));
+                chunk_snapshot snapshot = w.snapshot(pos);
+                taken[n] = snapshot_digest(snapshot, main_scratch.get());
+                if (n % KEEP_EVERY == 0) {
+                    kept.push_back(snapshot);
+                }
+                jobs.submit([&, n, snapshot = std::move(snapshot)] {
+                    const unsigned worker = jobs.current_worker();
+                    mesh_result& result = results[n];
+                    result.digest = snapshot_digest(snapshot, scratch[worker].get());
+                    meshers[worker]->build(snapshot.neighborhood(), result.quads);
+                    if (result.digest != snapshot_digest(snapshot, scratch[worker].get())) {
+                        mismatches.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+            jobs.wait_idle();
+            const double total_s = std::chrono::duration<double>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count();
+
+            bool unchanged = mismatches.load() == 0;
+            for (int n = 0; n < SNAPSHOTS; n++) {
+                unchanged = unchanged && results[n].digest == taken[n];
+            }
+            ctx.check(unchanged, "every job reads its snapshot as it was taken");
+            ctx.check(w.cow_copies() > 0, "edits copy chunks that snapshots still share");
+
+            // Meshing the kept snapshots again now, long after the edits, gives the same quads.
+            mesher m;
+            std::vector<packed_quad> quads;
+            bool same = true;
+            for (std::size_t k = 0; k < kept.size(); k++) {
+                quads.clear();
+                m.build(kept[k].neighborhood(), quads);
+                const std::vector<packed_quad>& meshed = results[k * KEEP_EVERY].quads;
+                same = same && quads.size() == meshed.size() &&
+                       std::memcmp(quads.data(), meshed.data(),
+                                   quads.size() * sizeof(packed_quad)) == 0;
+            }
+            ctx.check(same, "snapshots mesh the same whenever they are meshed");
+
+            ctx.report("snapshot.edit", edit_total_ns / EDITS, "ns/edit");
+            ctx.report("snapshot.edit.worst", edit_worst_ns / 1000.0, "us");
+            ctx.report("snapshot.meshes", SNAPSHOTS / total_s, "meshes/s");
+            ctx.report("snapshot.cow_copies", static_cast<double>(w.cow_copies()), "copies");
+        }
+    }  // namespace
+
+    void add_snapshot_benchmarks(suite& s) {
+        s.add("world.snapshot", bench_snapshot);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/scenes.hpp"
+#include "world/region.hpp"
+
+namespace qc::bench {
+    namespace {
+        // Spans four region files around the origin.
+        constexpr int SAVE_RADIUS = 12;
+        constexpr int SAVE_LAYERS = 4;
+
+        double elapsed_ms(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             start)
+                .count();
+        }
+
+        // Loads every column of the saved area through a fresh store; returns chunks loaded.
+        int load_area(const std::string& directory, world& w) {
+            region_store store(directory);
+            int loaded = 0;
+            for (int z = -SAVE_RADIUS; z <= SAVE_RADIUS; z++) {
+                for (int x = -SAVE_RADIUS; x <= SAVE_RADIUS; x++) {
+                    const int n = store.load_column(w, x, z);
+                    loaded += n > 0 ? n : 0;
+                }
+            }
+            return loaded;
+        }
+
+        bool same_chunks(const world& a, const world& b) {
+            const auto left = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            const auto right = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            bool same = a.chunk_count() == b.chunk_count();
+            a.for_each([&](const glm::ivec3& pos, const chunk& c) {
+                const chunk* other = b.find(pos);
+                if (other == nullptr) {
+                    same = false;
+                    return;
+                }
+                c.unpack(left.get());
+                other->unpack(right.get());
+                same &= std::equal(left.get(), left.get() + CHUNK_VOLUME, right.get());
+            });
+            return same;
+        }
+
+        // Two table entries pointing at the same sectors: the later one is dropped, so writing
+        // it again, and then another column, must leave the earlier one intact.
+        void check_overlap(context& ctx, const std::string& directory) {
+            const int x = 7 * region_file::SIZE;
+            const chunk stone(BLOCK_STONE);
+            const chunk dirt(BLOCK_DIRT);
+            const chunk sand(BLOCK_SAND);
+            {
+                region_store store(directory);
+                ctx.check(store.save_column(x, x, {&stone}, {0}) &&
+                              store.save_column(x + 1, x, {&dirt}, {0}),
+                          "columns save");
+            }
+            {
+                std::fstream file(directory + "/r.7.7.qcr",
+                                  std::ios::binary | std::ios::in | std::ios::out);
+                std::uint32_t location = 0;
+                file.seekg(region_file::HEADER_SIZE);
+                file.read(reinterpret_cast<char*>(&location), sizeof(location));
+                file.seekp(region_file::HEADER_SIZE + sizeof(location));
+                file.write(reinterpret_cast<const char*>(&location), sizeof(location));
+            }
+
+            bool intact = false;
+            {
+                region_store store(directory);
+                world w;
+                const bool dropped = store.load_column(w, x + 1, x) == 0;
+                const bool saved = store.save_column(x + 1, x, {&dirt}, {0}) &&
+                                   store.save_column(x + 2, x, {&sand}, {0});
+                intact = dropped && saved && store.load_column(w, x, x) == 1 &&
+                         w.find(glm::ivec3(x, 0, x))->get(0) == BLOCK_STONE;
+            }
+            ctx.check(intact, "a column sharing sectors is dropped, not freed under another");
+        }
+
+        // A region file that is not ours, and a column whose chunk fails to decode, must both
+        // load as errors and keep their bytes rather than come back as empty columns.
+        void check_corruption(context& ctx, const std::string& directory) {
+            const std::string foreign = directory + "/r.9.9.qcr";
+            const std::string junk(3 * region_file::SECTOR_SIZE, 'x');
+            std::ofstream(foreign, std::ios::binary).write(junk.data(), junk.size());
+            {
+                region_store store(directory);
+                world w;
+                const chunk c(BLOCK_STONE);
+                const int far = 9 * region_file::SIZE;
+                const bool refused = store.load_column(w, far, far) == -1 && w.chunk_count() == 0;
+                ctx.check(refused && !store.save_column(far, far, {&c}, {0}),
+                          "a file without the region header is refused");
+            }
+            ctx.check(std::filesystem::file_size(foreign) == junk.size(),
+                      "a refused file is left alone");
+
+            // Column (0, 0) of region (8, 8): the first stored column lands right after the
+            // header. Its chunk's width byte follows the column length, the chunk count, the
+            // chunk's y and its encoded size.
+            const int x = 8 * region_file::SIZE;
+            {
+                region_store store(directory);
+                chunk c(BLOCK_STONE);
+                c.set(1, 2, 3, BLOCK_DIRT);
+                ctx.check(store.save_column(x, x, {&c}, {0}), "column saves");
+            }
+            const std::string path = directory + "/r.8.8.qcr";
+            {
+                std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+                file.seekp(region_file::HEADER_SECTORS * region_file::SECTOR_SIZE + 14);
+                file.put(3);
+            }
+            region_store store(directory);
+            world w;
+            ctx.check(store.load_column(w, x, x) == -1 && w.chunk_count() == 0,
+                      "a corrupt column loads as an error, not as air");
+            ctx.check(store.save(w) && store.load_column(w, x, x) == -1,
+                      "saving afterwards keeps the corrupt column");
+        }
+
+        void bench_storage_region(context& ctx) {
+            const std::string directory =
+                (std::filesystem::temp_directory_path() / "quadcraft_bench_regions").string();
+            std::error_code error;
+            std::filesystem::remove_all(directory, error);
+
+            world saved;
+            generate_terrain(saved, SAVE_RADIUS, SAVE_LAYERS, 7);
+
+            auto start = std::chrono::steady_clock::now();
+            {
+                region_store store(directory);
+                ctx.check(store.save(saved), "world saves");
+                ctx.report("region.save", saved.chunk_count() / elapsed_ms(start) * 1000.0,
+                           "chunks/s");
+                ctx.report("region.bytes_per_chunk",
+                           static_cast<double>(store.disk_usage()) / saved.chunk_count(), "B");
+            }
+
+            world loaded;
+            ctx.check(load_area(directory, loaded) == static_cast<int>(saved.chunk_count()),
+                      "every saved chunk loads");
+            ctx.check(same_chunks(saved, loaded), "loaded chunks match saved ones");
+
+            // Grow one column past its sectors and shrink another, then reload both.
+            {
+                region_store store(directory);
+                chunk& noisy = saved.get_or_create(glm::ivec3(1, 0, 1));
+                for (int i = 0; i < CHUNK_VOLUME; i++) {
+                    noisy.set(i, static_cast<block_id>((i * 2654435761u >> 7) % 300));
+                }
+                saved.get_or_create(glm::ivec3(2, 0, 1)).fill(BLOCK_STONE);
+                for (int x = 1; x <= 2; x++) {
+                    std::vector<const chunk*> chunks;
+                    std::vector<int> ys;
+                    for (int y = 0; y < SAVE_LAYERS; y++) {
+                        chunks.push_back(saved.find(glm::ivec3(x, y, 1)));
+                        ys.push_back(y);
+                    }
+                    ctx.check(store.save_column(x, 1, chunks, ys), "columns resave");
+                }
+            }
+            world reloaded;
+            load_area(directory, reloaded);
+            ctx.check(same_chunks(saved, reloaded), "resized columns reload intact");
+
+            // Warm: files are in the page cache, so a load is a table lookup plus decode.
+            constexpr int ROUNDS = 5;
+            double warm_ms = 0.0;
+            for (int i = 0; i < ROUNDS; i++) {
+                world w;
+                start = std::chrono::steady_clock::now();
+                load_area(directory, w);
+                warm_ms += elapsed_ms(start);
+            }
+            ctx.report("region.load.warm", saved.chunk_count() * ROUNDS / warm_ms * 1000.0,
+                       "chunks/s");
+            ctx.report("region.startup.warm", warm_ms / ROUNDS, "ms");
+
+            // Cold: drop the files from the page cache first.
+            bool evicted = true;
+            for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+                evicted &= mapped_file::evict_from_page_cache(entry.path().string());
+            }
+            if (evicted) {
+                world w;
+                start = std::chrono::steady_clock::now();
+                load_area(directory, w);
+                const double cold_ms = elapsed_ms(start);
+                ctx.report("region.load.cold", saved.chunk_count() / cold_ms * 1000.0,
+                           "chunks/s");
+                ctx.report("region.startup.cold", cold_ms, "ms");
+            }
+
+            check_corruption(ctx, directory);
+            check_overlap(ctx, directory);
+            std::filesystem::remove_all(directory, error);
+        }
+    }  // namespace
+
+    void add_storage_benchmarks(suite& s) {
+        s.add("storage.region", bench_storage_region);
+    }
+}  // namespace qc::bench
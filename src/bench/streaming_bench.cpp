@@ -0,0 +1,231 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/fake_gl.hpp"
+#include "render/occlusion.hpp"
+#include "world/streamer.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr std::uint32_t WORLD_SEED = 42;
+        // Frames are paced at 60 Hz so the workers get the time a real frame would leave them.
+        constexpr std::chrono::microseconds FRAME(16667);
+        constexpr int MAX_FRAMES = 3000;
+
+        struct frame_stats {
+            int frames = 0;
+            double worst_ms = 0.0;
+            double total_ms = 0.0;
+            bool within_budget = true;
+        };
+
+        // Runs one paced frame, timing only the streamer's own work.
+        void frame(chunk_streamer& streamer, const fake_gl& gl, std::size_t budget,
+                   const glm::vec3& eye, const glm::vec3& forward, frame_stats& stats) {
+            const auto start = std::chrono::steady_clock::now();
+            const std::size_t uploaded = gl.bytes_uploaded();
+            streamer.update(eye, forward);
+            const auto end = std::chrono::steady_clock::now();
+
+            const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            const std::size_t bytes = gl.bytes_uploaded() - uploaded;
+            stats.frames++;
+            stats.total_ms += ms;
+            stats.worst_ms = std::max(stats.worst_ms, ms);
+            // Terrain meshes are far smaller than the budget, so none goes through on its own.
+            stats.within_budget =
+                stats.within_budget && bytes == streamer.last_upload_bytes() && bytes <= budget;
+            std::this_thread::sleep_until(start + FRAME);
+        }
+
+        void bench_streaming(context& ctx) {
+            streaming_settings settings;
+            settings.radius = 8;
+            settings.layers = 3;
+            settings.upload_budget = 64 * 1024;
+
+            fake_gl gl;
+            chunk_renderer renderer(gl.functions());
+            world w;
+            job_system jobs;
+            chunk_streamer streamer(w, renderer, jobs, WORLD_SEED, settings);
+
+            std::vector<glm::ivec3> wanted;
+            for (int z = -settings.radius; z <= settings.radius; z++) {
+                for (int x = -settings.radius; x <= settings.radius; x++) {
+                    for (int y = 0; y < settings.layers; y++) {
+                        if (x * x + z * z <= settings.radius * settings.radius) {
+                            wanted.emplace_back(x, y, z);
+                        }
+                    }
+                }
+            }
+
+            // Cold start at the origin looking down +z, recording when each chunk arrives.
+            const glm::vec3 eye(16.0f, 80.0f, 16.0f);
+            const glm::vec3 ahead(0.0f, 0.0f, 1.0f);
+            std::vector<int> arrival(wanted.size(), -1);
+            frame_stats cold;
+            const auto cold_start = std::chrono::steady_clock::now();
+            while (!streamer.complete() && cold.frames < MAX_FRAMES) {
+                frame(streamer, gl, settings.upload_budget, eye, ahead, cold);
+                for (std::size_t i = 0; i < wanted.size(); i++) {
+                    if (arrival[i] < 0 && streamer.state(wanted[i]) == CHUNK_RESIDENT) {
+                        arrival[i] = cold.frames;
+                    }
+                }
+            }
+            const double cold_ms = std::chrono::duration<double, std::milli>(
+                                       std::chrono::steady_clock::now() - cold_start)
+                                       .count();
+            ctx.check(streamer.complete(), "every chunk in range becomes resident");
+            ctx.check(streamer.count(CHUNK_RESIDENT) == wanted.size() &&
+                          w.chunk_count() == wanted.size(),
+                      "exactly the chunks in range are loaded");
+
+            // With the camera still, every mesh must match meshing the finished world the way the
+            // streamer does, without light. Ambient occlusion reads the edge and corner
+            // neighbours, so a chunk not meshed again after one of those arrived differs here.
+            mesher m;
+            std::unordered_map<glm::ivec3, std::vector<packed_quad>, chunk_pos_hash> meshes;
+            for (const glm::ivec3& p : wanted) {
+                std::vector<packed_quad> quads;
+                m.build(w.snapshot(p, false).neighborhood(), quads);
+                if (!quads.empty()) {
+                    meshes.emplace(p, std::move(quads));
+                }
+            }
+            ctx.check(renderer.mesh_count() == meshes.size(), "every non-empty chunk has its mesh");
+            gl.clear_draws();
+            renderer.draw(wanted);
+            bool same = gl.draws().size() == 1;
+            for (std::size_t i = 0; same && i < renderer.commands().size(); i++) {
+                const draw_arrays_indirect_command& command = renderer.commands()[i];
+                const auto it = meshes.find(renderer.origins()[i] / CHUNK_SIZE);
+                const std::vector<std::uint8_t>& arena = *gl.buffer(gl.draws()[0].storage_buffer);
+                same = it != meshes.end() && command.count == it->second.size() * 6 &&
+                       std::memcmp(arena.data() + command.first / 6 * sizeof(packed_quad),
+                                   it->second.data(),
+                                   it->second.size() * sizeof(packed_quad)) == 0;
+            }
+            ctx.check(same, "every mesh matches meshing the finished world");
+
+            // Occluders are found from the chunk alone, so they match the finished world too.
+            std::size_t solid = 0;
+            bool same_occluders = true;
+            for (const glm::ivec3& p : wanted) {
+                std::vector<aabb> boxes;
+                find_occluders(*w.find(p), p, boxes);
+                const std::vector<aabb>& found = streamer.occluders(p);
+                solid += boxes.empty() ? 0 : 1;
+                same_occluders = same_occluders && found.size() == boxes.size();
+                for (std::size_t i = 0; same_occluders && i < boxes.size(); i++) {
+                    same_occluders = found[i].min == boxes[i].min && found[i].max == boxes[i].max;
+                }
+            }
+            ctx.check(same_occluders && streamer.occluder_bounds().size() == solid,
+                      "every resident chunk has the occluders of the finished world");
+            ctx.check(cold.within_budget, "no frame uploads more than the budget");
+
+            // Near before far, and ahead before behind at the same distance.
+            std::vector<std::size_t> order(wanted.size());
+            for (std::size_t i = 0; i < order.size(); i++) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [&](std::size_t a, std::size_t b) { return arrival[a] < arrival[b]; });
+            const auto distance = [&](std::size_t i) {
+                return std::sqrt(static_cast<float>(wanted[i].x * wanted[i].x +
+                                                    wanted[i].z * wanted[i].z));
+            };
+            const std::size_t quarter = order.size() / 4;
+            double early = 0.0;
+            double late = 0.0;
+            for (std::size_t i = 0; i < quarter; i++) {
+                early += distance(order[i]);
+                late += distance(order[order.size() - 1 - i]);
+            }
+            ctx.check(early < late, "nearby chunks arrive before distant ones");
+            double front = 0.0;
+            double back = 0.0;
+            int front_count = 0;
+            int back_count = 0;
+            for (std::size_t i = 0; i < wanted.size(); i++) {
+                const float d = distance(i);
+                if (d < 3.0f || d > 6.0f) {
+                    continue;
+                }
+                if (wanted[i].z > 0) {
+                    front += arrival[i];
+                    front_count++;
+                } else if (wanted[i].z < 0) {
+                    back += arrival[i];
+                    back_count++;
+                }
+            }
+            ctx.check(front / front_count < back / back_count,
+                      "chunks ahead arrive before chunks behind");
+
+            // Fly away while turning, then stop and wait for the view to fill again.
+            frame_stats moving;
+            glm::vec3 position = eye;
+            glm::vec3 forward = ahead;
+            std::size_t most_loaded = 0;
+            for (int i = 0; i < 300; i++) {
+                const float angle = 0.004f * i;
+                forward = glm::vec3(std::sin(angle), 0.0f, std::cos(angle));
+                position += forward * 1.5f;
+                frame(streamer, gl, settings.upload_budget, position, forward, moving);
+                most_loaded = std::max(most_loaded, w.chunk_count());
+            }
+            frame_stats settle;
+            while (!streamer.complete() && settle.frames < MAX_FRAMES) {
+                frame(streamer, gl, settings.upload_budget, position, forward, settle);
+            }
+            ctx.check(streamer.complete(), "the view fills in behind a moving camera");
+
+            // Teleport far away: everything is unloaded and streamed in again.
+            position += glm::vec3(4096.0f, 0.0f, 0.0f);
+            frame_stats teleport;
+            const auto teleport_start = std::chrono::steady_clock::now();
+            do {
+                frame(streamer, gl, settings.upload_budget, position, forward, teleport);
+            } while (!streamer.complete() && teleport.frames < MAX_FRAMES);
+            const double teleport_ms = std::chrono::duration<double, std::milli>(
+                                           std::chrono::steady_clock::now() - teleport_start)
+                                           .count();
+            ctx.check(streamer.complete() && w.chunk_count() == wanted.size(),
+                      "a teleport replaces every loaded chunk");
+            ctx.check(moving.within_budget && settle.within_budget && teleport.within_budget,
+                      "no frame uploads more than the budget while moving");
+            // Unloading keeps the world within one chunk of the loaded radius.
+            const int outer = settings.radius + 2;
+            ctx.check(most_loaded <= static_cast<std::size_t>(outer * outer * 4 * settings.layers),
+                      "chunks out of range are unloaded");
+            ctx.check(gl.errors() == 0, "no GL errors");
+
+            ctx.report("stream.chunks", static_cast<double>(wanted.size()), "chunks");
+            ctx.report("stream.full_view", cold_ms, "ms");
+            ctx.report("stream.full_view.frames", cold.frames, "frames");
+            ctx.report("stream.worst_frame", cold.worst_ms, "ms");
+            ctx.report("stream.mean_frame", cold.total_ms / cold.frames, "ms");
+            ctx.report("stream.moving.worst_frame", moving.worst_ms, "ms");
+            ctx.report("stream.moving.mean_frame", moving.total_ms / moving.frames, "ms");
+            ctx.report("stream.teleport.full_view", teleport_ms, "ms");
+            ctx.report("stream.teleport.worst_frame", teleport.worst_ms, "ms");
+            ctx.report("stream.evicted", static_cast<double>(streamer.evicted()), "chunks");
+        }
+    }  // namespace
+
+    void add_streaming_benchmarks(suite& s) {
+        s.add("world.streaming", bench_streaming);
+    }
+}  // namespace qc::bench
@@ -0,0 +1,246 @@
+#include <glm/common.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "bench/benchmarks.hpp"
+#include "bench/scenes.hpp"
+#include "render/frustum.hpp"
+#include "render/visibility.hpp"
+#include "world/world.hpp"
+
+namespace qc::bench {
+    namespace {
+        constexpr int RADIUS = 8;
+        constexpr int LAYERS = 4;
+        constexpr int FRAMES = 20;
+
+        glm::mat4 camera(const glm::vec3& eye, const glm::vec3& target) {
+            return glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 1000.0f) *
+                   glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+
+        bool links_all(const section_links& links) {
+            for (int a = 0; a < FACE_COUNT; a++) {
+                for (int b = 0; b < FACE_COUNT; b++) {
+                    if (!links.connects(static_cast<face>(a), static_cast<face>(b))) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Sections of the loaded chunks within `radius` chunks of the camera that touch the
+        // frustum, which is all frustum culling alone would keep.
+        std::size_t frustum_sections(const world& w, const glm::vec3& eye,
+                                     const glm::mat4& view_projection, int radius) {
+            const frustum view(view_projection);
+            const glm::ivec3 center = chunk_of(glm::ivec3(glm::floor(eye)));
+            std::size_t count = 0;
+            w.for_each([&](const glm::ivec3& pos, const chunk&) {
+                const glm::ivec3 d = glm::abs(pos - center);
+                if (std::max(d.x, std::max(d.y, d.z)) > radius) {
+                    return;
+                }
+                for (int i = 0; i < CHUNK_SECTION_COUNT; i++) {
+                    const glm::ivec3 local(i % CHUNK_SECTIONS,
+                                           i / (CHUNK_SECTIONS * CHUNK_SECTIONS),
+                                           i / CHUNK_SECTIONS % CHUNK_SECTIONS);
+                    const float size = static_cast<float>(SECTION_SIZE);
+                    const glm::vec3 min(glm::vec3(pos * CHUNK_SECTIONS + local) * size);
+                    count += view.intersects({min, min + glm::vec3(size)}) ? 1 : 0;
+                }
+            });
+            return count;
+        }
+
+        bool contains(const std::vector<glm::ivec3>& chunks, const glm::ivec3& pos) {
+            return std::find(chunks.begin(), chunks.end(), pos) != chunks.end();
+        }
+
+        void check_sections(context& ctx) {
+            chunk_visibility visibility;
+            build_visibility(chunk(BLOCK_AIR), visibility);
+            ctx.check(std::all_of(std::begin(visibility.sections), std::end(visibility.sections),
+                                  links_all),
+                      "open air links every face");
+            build_visibility(chunk(BLOCK_STONE), visibility);
+            ctx.check(std::all_of(std::begin(visibility.sections), std::end(visibility.sections),
+                                  [](const section_links& links) { return links.bits == 0; }),
+                      "solid rock links nothing");
+
+            // A tunnel along x through the bottom sections, with a shaft rising from it in the
+            // first, a tunnel along z through the first at another height, and a sealed pocket
+            // in the top.
+            chunk c(BLOCK_STONE);
+            c.fill(0, 4, 4, 31, 5, 5, BLOCK_AIR);
+            c.fill(8, 4, 4, 9, 15, 5, BLOCK_AIR);
+            c.fill(12, 10, 0, 12, 10, 15, BLOCK_WATER);
+            c.fill(6, 22, 6, 9, 25, 9, BLOCK_AIR);
+            build_visibility(c, visibility);
+            const section_links& first = visibility.sections[section_index(0, 0, 0)];
+            const section_links& second = visibility.sections[section_index(1, 0, 0)];
+            ctx.check(first.connects(FACE_NEG_X, FACE_POS_X) &&
+                          first.connects(FACE_POS_X, FACE_POS_Y) &&
+                          second.connects(FACE_NEG_X, FACE_POS_X),
+                      "tunnels and shafts link the faces they open on");
+            ctx.check(first.connects(FACE_NEG_Z, FACE_POS_Z) &&
+                          !first.connects(FACE_NEG_Z, FACE_POS_X),
+                      "separate tunnels in one section stay apart");
+            ctx.check(!second.connects(FACE_NEG_X, FACE_POS_Y) &&
+                          !second.connects(FACE_NEG_Y, FACE_NEG_Y),
+                      "closed faces link nothing");
+            ctx.check(visibility.sections[section_index(0, 1, 0)].bits == 0,
+                      "a sealed pocket links nothing");
+        }
+
+        // Solid rock with a straight tunnel along +z and a sealed cavern off to its side, seen
+        // from inside the tunnel.
+        void check_caves(context& ctx) {
+            world w;
+            visibility_graph graph;
+            for (int y = 0; y < 3; y++) {
+                for (int z = -2; z <= 2; z++) {
+                    for (int x = -2; x <= 2; x++) {
+                        w.get_or_create(glm::ivec3(x, y, z)).fill(BLOCK_STONE);
+                    }
+                }
+            }
+            for (int z = -60; z < 90; z++) {
+                for (int y = 38; y <= 41; y++) {
+                    for (int x = 6; x <= 9; x++) {
+                        w.set_block(glm::ivec3(x, y, z), BLOCK_AIR);
+                    }
+                }
+            }
+            for (int z = 40; z <= 60; z++) {
+                for (int y = 36; y <= 44; y++) {
+                    for (int x = 40; x <= 60; x++) {
+                        w.set_block(glm::ivec3(x, y, z), BLOCK_AIR);
+                    }
+                }
+            }
+            w.for_each([&](const glm::ivec3& pos, const chunk& c) {
+                chunk_visibility visibility;
+                build_visibility(c, visibility);
+                graph.set(pos, visibility);
+            });
+
+            const glm::vec3 eye(7.5f, 39.5f, -56.0f);
+            const glm::mat4 view_projection = camera(eye, eye + glm::vec3(0.0f, 0.0f, 1.0f));
+            const int radius = 4;
+            std::vector<glm::ivec3> visible;
+            graph.cull(eye, view_projection, radius, visible);
+            ctx.check(contains(visible, glm::ivec3(0, 1, -2)) &&
+                          contains(visible, glm::ivec3(0, 1, 2)),
+                      "the tunnel is visible end to end");
+            ctx.check(!contains(visible, glm::ivec3(1, 1, 1)), "the sealed cavern is culled");
+            ctx.check(!contains(visible, glm::ivec3(0, 2, 0)),
+                      "the rock above the tunnel is culled");
+            ctx.check(graph.visited_sections() <
+                          frustum_sections(w, eye, view_projection, radius) / 4,
+                      "a tunnel reaches a fraction of the frustum");
+
+            // In open air the walk covers the whole frustum.
+            world open;
+            visibility_graph open_graph;
+            chunk_visibility air;
+            build_visibility(chunk(BLOCK_AIR), air);
+            const glm::ivec3 center = chunk_of(glm::ivec3(glm::floor(eye)));
+            for (int z = -radius; z <= radius; z++) {
+                for (int y = -radius; y <= radius; y++) {
+                    for (int x = -radius; x <= radius; x++) {
+                        open.get_or_create(center + glm::ivec3(x, y, z));
+                        open_graph.set(center + glm::ivec3(x, y, z), air);
+                    }
+                }
+            }
+            open_graph.cull(eye, view_projection, radius, visible);
+            ctx.check(open_graph.visited_sections() ==
+                          frustum_sections(open, eye, view_projection, radius),
+                      "open air reaches every section in the frustum");
+        }
+
+        struct view {
+            const char* name;
+            glm::vec3 eye;
+        };
+
+        void bench_visibility(context& ctx) {
+            check_sections(ctx);
+            check_caves(ctx);
+            if (ctx.failed()) {
+                return;
+            }
+
+            world w;
+            const std::vector<glm::ivec3> chunks = generate_terrain(w, RADIUS, LAYERS);
+
+            visibility_graph graph;
+            std::vector<chunk_visibility> visibility(chunks.size());
+            const double build_ns = time_ns(1, [&] {
+                for (std::size_t i = 0; i < chunks.size(); i++) {
+                    build_visibility(*w.find(chunks[i]), visibility[i]);
+                }
+            });
+            for (std::size_t i = 0; i < chunks.size(); i++) {
+                graph.set(chunks[i], visibility[i]);
+            }
+            ctx.report("visibility.build", build_ns / chunks.size() / 1000.0, "us/chunk");
+
+            // Underground, 40 blocks below the surface in a small dug pocket, and on the surface.
+            int surface = LAYERS * CHUNK_SIZE - 1;
+            while (surface > 0 &&
+                   !block_properties(w.get_block(glm::ivec3(0, surface, 0))).opaque) {
+                surface--;
+            }
+            const glm::ivec3 pocket(0, surface - 40, 0);
+            for (int y = -2; y <= 2; y++) {
+                for (int z = -2; z <= 2; z++) {
+                    for (int x = -2; x <= 2; x++) {
+                        w.set_block(pocket + glm::ivec3(x, y, z), BLOCK_AIR);
+                    }
+                }
+            }
+            for (const glm::ivec3& pos : {chunk_of(pocket), chunk_of(pocket + glm::ivec3(2)),
+                                          chunk_of(pocket - glm::ivec3(2))}) {
+                chunk_visibility updated;
+                build_visibility(*w.find(pos), updated);
+                graph.set(pos, updated);
+            }
+            const view views[] = {
+                {"cave", glm::vec3(pocket) + glm::vec3(0.5f)},
+                {"surface", glm::vec3(0.5f, static_cast<float>(surface) + 2.5f, 0.5f)},
+            };
+            std::vector<glm::ivec3> visible;
+            for (const view& v : views) {
+                std::size_t reached = 0;
+                std::size_t frustum_only = 0;
+                double cull_ns = 0.0;
+                for (int frame = 0; frame < FRAMES; frame++) {
+                    const float angle = glm::radians(360.0f * frame / FRAMES);
+                    const glm::mat4 view_projection =
+                        camera(v.eye, v.eye + glm::vec3(std::sin(angle), -0.2f, std::cos(angle)));
+                    cull_ns +=
+                        time_ns(1, [&] { graph.cull(v.eye, view_projection, RADIUS, visible); });
+                    reached += graph.visited_sections();
+                    frustum_only += frustum_sections(w, v.eye, view_projection, RADIUS);
+                }
+                const std::string name = std::string("visibility.") + v.name;
+                ctx.report(name + ".sections", static_cast<double>(reached) / FRAMES, "sections");
+                ctx.report(name + ".frustum", static_cast<double>(frustum_only) / FRAMES,
+                           "sections");
+                ctx.report(name + ".culled", 100.0 - 100.0 * reached / frustum_only, "%");
+                ctx.report(name + ".cull", cull_ns / FRAMES / 1000.0, "us/frame");
+            }
+        }
+    }  // namespace
+
+    void add_visibility_benchmarks(suite& s) {
+        s.add("render.visibility", bench_visibility);
+    }
+}  // namespace qc::bench
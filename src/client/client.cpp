@@ -0,0 +1,301 @@
+#include "client/client.hpp"
+
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "core/log.hpp"
+#include "core/profile.hpp"
+#include "render/frustum.hpp"
+#include "render/gl_api.hpp"
+#include "render/shaders.hpp"
+
+namespace qc {
+    namespace {
+        constexpr int TEXTURE_SIZE = 16;
+        constexpr int TEXTURE_LAYERS = TEXTURE_LAMP + 1;
+        // Blocks per second, and radians per pixel of mouse movement.
+        constexpr float FLY_SPEED = 24.0f;
+        constexpr float LOOK_SPEED = 0.0025f;
+        // Occluder boxes rasterized per frame, nearest first.
+        constexpr std::size_t OCCLUDER_BUDGET = 512;
+
+        spdlog::logger& render_log() {
+            return subsystem_logger(LOG_RENDER);
+        }
+
+        void glfw_error(int code, const char* description) {
+            render_log().error("GLFW error {}: {}", code, description);
+        }
+
+        std::uint32_t compile_shader(GLenum type, const char* source) {
+            const GLuint shader = glCreateShader(type);
+            glShaderSource(shader, 1, &source, nullptr);
+            glCompileShader(shader);
+            GLint status = GL_FALSE;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+            if (status != GL_TRUE) {
+                GLint length = 0;
+                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+                std::string info(static_cast<std::size_t>(std::max(length, 1)), '\0');
+                glGetShaderInfoLog(shader, length, nullptr, info.data());
+                render_log().error("cannot compile shader: {}", info.c_str());
+                glDeleteShader(shader);
+                return 0;
+            }
+            return shader;
+        }
+
+        std::uint32_t link_quad_program() {
+            const GLuint vertex = compile_shader(GL_VERTEX_SHADER, QUAD_VERTEX_SHADER);
+            const GLuint fragment = compile_shader(GL_FRAGMENT_SHADER, QUAD_FRAGMENT_SHADER);
+            if (vertex == 0 || fragment == 0) {
+                glDeleteShader(vertex);
+                glDeleteShader(fragment);
+                return 0;
+            }
+            const GLuint program = glCreateProgram();
+            glAttachShader(program, vertex);
+            glAttachShader(program, fragment);
+            glLinkProgram(program);
+            glDeleteShader(vertex);
+            glDeleteShader(fragment);
+            GLint status = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &status);
+            if (status != GL_TRUE) {
+                GLint length = 0;
+                glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+                std::string info(static_cast<std::size_t>(std::max(length, 1)), '\0');
+                glGetProgramInfoLog(program, length, nullptr, info.data());
+                render_log().error("cannot link shaders: {}", info.c_str());
+                glDeleteProgram(program);
+                return 0;
+            }
+            return program;
+        }
+
+        // Flat colours with a little per-texel noise, one layer per TEXTURE_* entry. Grass
+        // sides are dirt under a fringe of grass.
+        std::uint32_t create_block_textures() {
+            constexpr std::uint32_t COLORS[TEXTURE_LAYERS] = {
+                0x808080,  // TEXTURE_STONE
+                0x7A5535,  // TEXTURE_DIRT
+                0x5C9E3A,  // TEXTURE_GRASS_TOP
+                0x7A5535,  // TEXTURE_GRASS_SIDE
+                0xDCCF8E,  // TEXTURE_SAND
+                0x2F5FBF,  // TEXTURE_WATER
+                0xF4D46A,  // TEXTURE_LAMP
+            };
+            std::vector<std::uint8_t> texels(TEXTURE_LAYERS * TEXTURE_SIZE * TEXTURE_SIZE * 4);
+            for (int layer = 0; layer < TEXTURE_LAYERS; layer++) {
+                for (int y = 0; y < TEXTURE_SIZE; y++) {
+                    for (int x = 0; x < TEXTURE_SIZE; x++) {
+                        std::uint32_t color = COLORS[layer];
+                        if (layer == TEXTURE_GRASS_SIDE && y >= TEXTURE_SIZE - 3) {
+                            color = COLORS[TEXTURE_GRASS_TOP];
+                        }
+                        std::uint32_t h = static_cast<std::uint32_t>((layer * 16 + y) * 16 + x);
+                        h = (h ^ 61u) ^ (h >> 16);
+                        h *= 0x27D4EB2Du;
+                        h ^= h >> 15;
+                        const int shade = static_cast<int>(h % 25u) - 12;
+                        std::uint8_t* texel =
+                            &texels[((layer * TEXTURE_SIZE + y) * TEXTURE_SIZE + x) * 4];
+                        for (int c = 0; c < 3; c++) {
+                            const int v = static_cast<int>(color >> (16 - c * 8) & 255u) + shade;
+                            texel[c] = static_cast<std::uint8_t>(std::clamp(v, 0, 255));
+                        }
+                        texel[3] = 255;
+                    }
+                }
+            }
+
+            GLuint texture = 0;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE,
+                         TEXTURE_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            return texture;
+        }
+
+        glm::vec3 look_direction(float yaw, float pitch) {
+            return glm::vec3(std::sin(yaw) * std::cos(pitch), std::sin(pitch),
+                             std::cos(yaw) * std::cos(pitch));
+        }
+    }  // namespace
+
+    game_client::game_client(const client_settings& settings) : m_settings(settings) {}
+
+    game_client::~game_client() {
+        // The streamer holds the renderer, whose buffers need the context, so both go first.
+        m_streamer.reset();
+        m_renderer.reset();
+        if (m_program != 0) {
+            glDeleteProgram(m_program);
+        }
+        if (m_textures != 0) {
+            glDeleteTextures(1, &m_textures);
+        }
+        if (m_window != nullptr) {
+            glfwDestroyWindow(m_window);
+        }
+        glfwTerminate();
+    }
+
+    bool game_client::start() {
+        glfwSetErrorCallback(glfw_error);
+        if (glfwInit() != GLFW_TRUE) {
+            return false;
+        }
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+        m_window = glfwCreateWindow(m_settings.width, m_settings.height, "quadcraft", nullptr,
+                                    nullptr);
+        if (m_window == nullptr) {
+            return false;
+        }
+        glfwMakeContextCurrent(m_window);
+        glfwSwapInterval(1);
+        if (gladLoadGL(glfwGetProcAddress) == 0 || GLAD_GL_VERSION_4_3 == 0) {
+            render_log().error("OpenGL 4.3 is not available");
+            return false;
+        }
+
+        m_program = link_quad_program();
+        if (m_program == 0) {
+            return false;
+        }
+        m_view_projection = glGetUniformLocation(m_program, "u_view_projection");
+        m_textures = create_block_textures();
+
+        streaming_settings streaming;
+        streaming.radius = m_settings.view_radius;
+        streaming.layers = m_settings.layers;
+        m_jobs = std::make_unique<job_system>(m_settings.threads);
+        m_renderer = std::make_unique<chunk_renderer>(load_gl_functions());
+        m_streamer = std::make_unique<chunk_streamer>(m_world, *m_renderer, *m_jobs,
+                                                      m_settings.seed, streaming);
+
+        glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwGetCursorPos(m_window, &m_cursor_x, &m_cursor_y);
+        return true;
+    }
+
+    void game_client::run() {
+        auto last = std::chrono::steady_clock::now();
+        while (glfwWindowShouldClose(m_window) == 0) {
+            const auto now = std::chrono::steady_clock::now();
+            // A long stall, such as dragging the window, must not fling the camera away.
+            const float dt = std::min(std::chrono::duration<float>(now - last).count(), 0.1f);
+            last = now;
+
+            glfwPollEvents();
+            move(dt);
+            frame();
+            glfwSwapBuffers(m_window);
+        }
+    }
+
+    void game_client::move(float dt) {
+        if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+            glfwSetWindowShouldClose(m_window, GLFW_TRUE);
+        }
+
+        double x = 0.0;
+        double y = 0.0;
+        glfwGetCursorPos(m_window, &x, &y);
+        m_yaw -= static_cast<float>(x - m_cursor_x) * LOOK_SPEED;
+        m_pitch = std::clamp(m_pitch - static_cast<float>(y - m_cursor_y) * LOOK_SPEED, -1.55f,
+                             1.55f);
+        m_cursor_x = x;
+        m_cursor_y = y;
+
+        // Flying follows the heading only, so looking down does not slow the camera.
+        const glm::vec3 ahead(std::sin(m_yaw), 0.0f, std::cos(m_yaw));
+        const glm::vec3 right(-ahead.z, 0.0f, ahead.x);
+        glm::vec3 velocity(0.0f);
+        const auto held = [&](int key) { return glfwGetKey(m_window, key) == GLFW_PRESS; };
+        velocity += ahead * static_cast<float>(held(GLFW_KEY_W) - held(GLFW_KEY_S));
+        velocity += right * static_cast<float>(held(GLFW_KEY_D) - held(GLFW_KEY_A));
+        velocity.y += static_cast<float>(held(GLFW_KEY_SPACE) - held(GLFW_KEY_LEFT_SHIFT));
+        if (glm::dot(velocity, velocity) > 0.0f) {
+            m_eye += glm::normalize(velocity) * FLY_SPEED * dt;
+        }
+    }
+
+    void game_client::frame() {
+        QC_PROFILE_ZONE("client.frame");
+        const glm::vec3 forward = look_direction(m_yaw, m_pitch);
+        m_streamer->update(m_eye, forward);
+
+        int width = 0;
+        int height = 0;
+        glfwGetFramebufferSize(m_window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClearColor(0.55f, 0.72f, 0.95f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (width == 0 || height == 0) {
+            return;
+        }
+
+        const float aspect = static_cast<float>(width) / static_cast<float>(height);
+        const glm::mat4 view_projection =
+            glm::perspective(glm::radians(70.0f), aspect, 0.1f, 1000.0f) *
+            glm::lookAt(m_eye, m_eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        // Only chunks with a mesh are tested, several at a time, from the renderer's table.
+        const frustum view(view_projection);
+        const bounds_table& resident = m_renderer->bounds();
+        view.cull(resident, m_culled);
+        m_candidates.clear();
+        for (const std::uint32_t i : m_culled) {
+            m_candidates.push_back(resident.key(i));
+        }
+
+        // The survivors are then tested against the nearest occluders in view, which may come
+        // from solid chunks with nothing to draw.
+        const bounds_table& solid = m_streamer->occluder_bounds();
+        view.cull(solid, m_culled);
+        m_occluders.clear();
+        for (const std::uint32_t i : m_culled) {
+            const std::vector<aabb>& boxes = m_streamer->occluders(solid.key(i));
+            m_occluders.insert(m_occluders.end(), boxes.begin(), boxes.end());
+        }
+        const glm::vec3 eye = m_eye;
+        const auto distance = [eye](const aabb& box) {
+            const glm::vec3 nearest = glm::clamp(eye, box.min, box.max);
+            return glm::dot(nearest - eye, nearest - eye);
+        };
+        const std::size_t drawn = std::min(m_occluders.size(), OCCLUDER_BUDGET);
+        std::partial_sort(m_occluders.begin(), m_occluders.begin() + drawn, m_occluders.end(),
+                          [&](const aabb& a, const aabb& b) { return distance(a) < distance(b); });
+        m_occlusion.begin(view_projection);
+        for (std::size_t i = 0; i < drawn; i++) {
+            m_occlusion.add_occluder(m_occluders[i]);
+        }
+        m_occlusion.finish();
+        m_visible.clear();
+        m_occlusion.cull(m_candidates, m_visible);
+
+        glEnable(GL_DEPTH_TEST);
+        glUseProgram(m_program);
+        glUniformMatrix4fv(m_view_projection, 1, GL_FALSE, &view_projection[0][0]);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_textures);
+        m_renderer->draw(m_visible);
+    }
+}  // namespace qc
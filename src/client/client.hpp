@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/job_system.hpp"
+#include "render/chunk_renderer.hpp"
+#include "render/occlusion.hpp"
+#include "world/streamer.hpp"
+#include "world/world.hpp"
+
+struct GLFWwindow;
+
+namespace qc {
+    struct client_settings {
+        int width = 1280;
+        int height = 720;
+        // Chunks streamed around the camera: columns within `view_radius`, `layers` high.
+        int view_radius = 8;
+        int layers = 4;
+        std::uint32_t seed = 42;
+        // Generation and meshing workers; 0 means one per hardware thread.
+        unsigned threads = 0;
+    };
+
+    // The game: a window with a GL 4.3 core context, flying a camera over terrain that a
+    // chunk_streamer loads around it and a chunk_renderer draws with QUAD_VERTEX_SHADER.
+    // WASD moves, space and shift rise and sink, the mouse looks around and escape quits.
+    class game_client {
+    public:
+        explicit game_client(const client_settings& settings = {});
+        // Waits for the streamer's jobs, then releases the GL objects and the window.
+        ~game_client();
+
+        game_client(const game_client&) = delete;
+        game_client& operator=(const game_client&) = delete;
+
+        // Opens the window, loads GL and compiles the shaders. Returns false, after logging
+        // why, if any of them fails.
+        bool start();
+
+        // Runs frames until the window is closed.
+        void run();
+
+    private:
+        void frame();
+        void move(float dt);
+
+        client_settings m_settings;
+        GLFWwindow* m_window = nullptr;
+        std::uint32_t m_program = 0;
+        std::uint32_t m_textures = 0;
+        int m_view_projection = -1;
+
+        world m_world;
+        std::unique_ptr<job_system> m_jobs;
+        std::unique_ptr<chunk_renderer> m_renderer;
+        std::unique_ptr<chunk_streamer> m_streamer;
+
+        glm::vec3 m_eye{16.0f, 96.0f, 16.0f};
+        // Radians; yaw 0 looks down +z.
+        float m_yaw = 0.0f;
+        float m_pitch = -0.3f;
+        double m_cursor_x = 0.0;
+        double m_cursor_y = 0.0;
+
+        occlusion_culler m_occlusion;
+
+        // Culling's working lists: rows of a bounds table kept by the frustum, chunks in view,
+        // occluders in view and the chunks left to draw. Cleared rather than reallocated, so
+        // culling stays off the heap once they have grown to the view.
+        std::vector<std::uint32_t> m_culled;
+        std::vector<glm::ivec3> m_candidates;
+        std::vector<aabb> m_occluders;
+        std::vector<glm::ivec3> m_visible;
+    };
+}  // namespace qc
@@ -0,0 +1,82 @@
+#include "core/arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace qc {
+    arena::arena(std::size_t block_size, std::pmr::memory_resource* upstream)
+        : m_upstream(upstream), m_block_size(block_size) {
+    }
+
+    arena::~arena() {
+        for (const block& b : m_blocks) {
+            m_upstream->deallocate(b.data, b.size, alignof(std::max_align_t));
+        }
+    }
+
+    void arena::rewind(const marker& m) {
+        while (m_block > m.block) {
+            m_block--;
+            m_before -= m_blocks[m_block].size;
+        }
+        m_offset = m.offset;
+    }
+
+    std::size_t arena::capacity() const {
+        std::size_t total = 0;
+        for (const block& b : m_blocks) {
+            total += b.size;
+        }
+        return total;
+    }
+
+    void* arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+        for (;;) {
+            if (m_block < m_blocks.size()) {
+                const block& b = m_blocks[m_block];
+                const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(b.data);
+                const std::size_t start =
+                    ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+                if (start <= b.size && bytes <= b.size - start) {
+                    m_offset = start + bytes;
+                    m_peak = std::max(m_peak, used());
+                    return b.data + start;
+                }
+                // Skip the rest of this block if the next one is big enough.
+                if (m_block + 1 < m_blocks.size() &&
+                    m_blocks[m_block + 1].size >= bytes + alignment) {
+                    m_before += b.size;
+                    m_block++;
+                    m_offset = 0;
+                    continue;
+                }
+            }
+
+            // A new block goes right after the current one, keeping later blocks for reuse, and
+            // is big enough for the request at any alignment.
+            const std::size_t size = std::max(m_block_size, bytes + alignment);
+            const block added{
+                static_cast<std::byte*>(m_upstream->allocate(size, alignof(std::max_align_t))),
+                size};
+            const std::size_t at = m_blocks.empty() ? 0 : m_block + 1;
+            m_blocks.insert(m_blocks.begin() + static_cast<std::ptrdiff_t>(at), added);
+            if (at != m_block) {
+                m_before += m_blocks[m_block].size;
+                m_block = at;
+            }
+            m_offset = 0;
+        }
+    }
+
+    void arena::do_deallocate(void*, std::size_t, std::size_t) {
+    }
+
+    bool arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    arena& thread_arena() {
+        thread_local arena scratch;
+        return scratch;
+    }
+}  // namespace qc
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace qc {
+    // Linear allocator for scratch memory. Allocations bump an offset through blocks taken from
+    // `upstream`, and deallocate() does nothing; memory comes back all at once through rewind()
+    // or reset(), which keep the blocks for reuse. Once an arena has grown to its working size,
+    // allocating from it never reaches the heap again. Exposed as a std::pmr::memory_resource,
+    // so pmr containers can be pointed at it. Not synchronized: give each thread its own.
+    class arena : public std::pmr::memory_resource {
+    public:
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+        // A position to rewind() back to.
+        struct marker {
+            std::size_t block;
+            std::size_t offset;
+        };
+
+        explicit arena(std::size_t block_size = DEFAULT_BLOCK_SIZE,
+                       std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~arena() override;
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        marker mark() const {
+            return {m_block, m_offset};
+        }
+
+        // Frees everything allocated since `m` was taken.
+        void rewind(const marker& m);
+
+        void reset() {
+            rewind({0, 0});
+        }
+
+        // Bytes handed out since the last reset, alignment padding and skipped block tails
+        // included, and the most that has ever been.
+        std::size_t used() const {
+            return m_before + m_offset;
+        }
+
+        std::size_t peak() const {
+            return m_peak;
+        }
+
+        // Bytes held from upstream.
+        std::size_t capacity() const;
+
+    private:
+        struct block {
+            std::byte* data;
+            std::size_t size;
+        };
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        std::pmr::memory_resource* m_upstream;
+        std::size_t m_block_size;
+        std::vector<block> m_blocks;
+        // The block being filled, the offset into it, and the sizes of the blocks before it.
+        std::size_t m_block = 0;
+        std::size_t m_offset = 0;
+        std::size_t m_before = 0;
+        std::size_t m_peak = 0;
+    };
+
+    // Rewinds an arena to where it was when the scope began. Scopes nest like the stack.
+    class arena_scope {
+    public:
+        explicit arena_scope(arena& a) : m_arena(a), m_mark(a.mark()) {
+        }
+
+        ~arena_scope() {
+            m_arena.rewind(m_mark);
+        }
+
+        arena_scope(const arena_scope&) = delete;
+        arena_scope& operator=(const arena_scope&) = delete;
+
+    private:
+        arena& m_arena;
+        arena::marker m_mark;
+    };
+
+    // The calling thread's scratch arena, created on first use. job_system workers rewind it
+    // after every job, so memory a job takes from it lasts until the job returns; other threads
+    // scope it themselves, typically once per frame.
+    arena& thread_arena();
+}  // namespace qc
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace qc {
+    // Index of the lowest set bit. `value` must not be zero.
+    inline int ctz32(std::uint32_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(value);
+#endif
+    }
+
+    // Index of the lowest set bit. `value` must not be zero.
+    inline int ctz64(std::uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    inline int popcount32(std::uint32_t value) {
+#if defined(_MSC_VER)
+        return static_cast<int>(__popcnt(value));
+#else
+        return __builtin_popcount(value);
+#endif
+    }
+
+    // Without the POPCNT instruction GCC calls out to libgcc, so the fallback stays inline.
+    inline int popcount64(std::uint64_t value) {
+#if defined(_MSC_VER)
+        return static_cast<int>(__popcnt64(value));
+#elif defined(__POPCNT__)
+        return __builtin_popcountll(value);
+#else
+        value -= value >> 1 & 0x5555555555555555ull;
+        value = (value & 0x3333333333333333ull) + (value >> 2 & 0x3333333333333333ull);
+        value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        return static_cast<int>(value * 0x0101010101010101ull >> 56);
+#endif
+    }
+
+    // Transposes a 32x32 bit matrix in place: bit c of rows[r] moves to bit r of rows[c].
+    inline void transpose32(std::uint32_t rows[32]) {
+        std::uint32_t mask = 0x0000FFFFu;
+        for (int j = 16; j != 0; j >>= 1, mask ^= mask << j) {
+            for (int k = 0; k < 32; k = ((k | j) + 1) & ~j) {
+                const std::uint32_t t = ((rows[k] >> j) ^ rows[k | j]) & mask;
+                rows[k] ^= t << j;
+                rows[k | j] ^= t;
+            }
+        }
+    }
+
+    // Transposes two 32x32 bit matrices at once, one in the low and one in the high half of each
+    // row: bit c of rows[r] moves to bit r of rows[c], and likewise for bits 32 + c.
+    inline void transpose32x2(std::uint64_t rows[32]) {
+        std::uint64_t mask = 0x0000FFFF0000FFFFull;
+        for (int j = 16; j != 0; j >>= 1, mask ^= mask << j) {
+            for (int k = 0; k < 32; k = ((k | j) + 1) & ~j) {
+                const std::uint64_t t = ((rows[k] >> j) ^ rows[k | j]) & mask;
+                rows[k] ^= t << j;
+                rows[k | j] ^= t;
+            }
+        }
+    }
+}  // namespace qc
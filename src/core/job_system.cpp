@@ -0,0 +1,306 @@
+#include "core/job_system.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "core/arena.hpp"
+#include "core/profile.hpp"
+
+namespace qc {
+    namespace detail {
+        struct job {
+            std::function<void()> fn;
+            job_priority priority = PRIORITY_NORMAL;
+            std::atomic<int> refs{1};
+
+            // Unfinished dependencies, plus one held by submit() until every dependency has
+            // been registered.
+            std::atomic<int> pending{1};
+
+            // Guards `dependents` and the transition of `done`.
+            std::mutex mutex;
+            std::vector<job*> dependents;
+            std::atomic<bool> done{false};
+        };
+
+        namespace {
+            void add_ref(job* j) {
+                j->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void release(job* j) {
+                if (j != nullptr && j->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    delete j;
+                }
+            }
+        }  // namespace
+    }  // namespace detail
+
+    namespace {
+        // Set on worker threads so submit() from inside a job goes to the worker's own deque.
+        thread_local const job_system* t_owner = nullptr;
+        thread_local int t_worker = -1;
+
+        // Spins before an idle worker goes to sleep; a new job usually shows up within a few
+        // microseconds while a frame's work is being fanned out.
+        constexpr int IDLE_SPINS = 64;
+    }  // namespace
+
+    job_handle::job_handle(detail::job* j) : m_job(j) {
+        detail::add_ref(j);
+    }
+
+    job_handle::job_handle(const job_handle& other) : m_job(other.m_job) {
+        if (m_job != nullptr) {
+            detail::add_ref(m_job);
+        }
+    }
+
+    job_handle::job_handle(job_handle&& other) noexcept : m_job(other.m_job) {
+        other.m_job = nullptr;
+    }
+
+    job_handle& job_handle::operator=(job_handle other) noexcept {
+        std::swap(m_job, other.m_job);
+        return *this;
+    }
+
+    job_handle::~job_handle() {
+        detail::release(m_job);
+    }
+
+    bool job_handle::done() const {
+        return m_job == nullptr || m_job->done.load(std::memory_order_acquire);
+    }
+
+    job_system::job_system(unsigned threads) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        m_workers.reserve(threads);
+        for (unsigned i = 0; i < threads; i++) {
+            m_workers.push_back(std::make_unique<worker>());
+        }
+        // Start threads only once every deque exists, since workers steal from each other.
+        for (unsigned i = 0; i < threads; i++) {
+            m_workers[i]->thread = std::thread([this, i] { worker_main(static_cast<int>(i)); });
+        }
+    }
+
+    job_system::~job_system() {
+        wait_idle();
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::unique_ptr<worker>& w : m_workers) {
+            w->thread.join();
+        }
+    }
+
+    job_handle job_system::submit(std::function<void()> fn, job_priority priority) {
+        return submit(std::move(fn), priority, nullptr, 0);
+    }
+
+    job_handle job_system::submit(std::function<void()> fn, job_priority priority,
+                                  std::initializer_list<job_handle> dependencies) {
+        return submit(std::move(fn), priority, dependencies.begin(), dependencies.size());
+    }
+
+    job_handle job_system::submit(std::function<void()> fn, job_priority priority,
+                                  const std::vector<job_handle>& dependencies) {
+        return submit(std::move(fn), priority, dependencies.data(), dependencies.size());
+    }
+
+    job_handle job_system::submit(std::function<void()> fn, job_priority priority,
+                                  const job_handle* dependencies, std::size_t count) {
+        // The new job starts with one reference, owned by the system until it has run.
+        detail::job* j = new detail::job;
+        j->fn = std::move(fn);
+        j->priority = std::min(priority, PRIORITY_LOW);
+        job_handle handle(j);
+
+        m_unfinished.fetch_add(1, std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < count; i++) {
+            detail::job* dependency = dependencies[i].m_job;
+            if (dependency == nullptr) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(dependency->mutex);
+            if (!dependency->done.load(std::memory_order_relaxed)) {
+                j->pending.fetch_add(1, std::memory_order_relaxed);
+                dependency->dependents.push_back(j);
+            }
+        }
+
+        if (j->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule(j);
+        }
+        return handle;
+    }
+
+    void job_system::wait(const job_handle& handle) {
+        if (handle.done()) {
+            return;
+        }
+
+        QC_PROFILE_ZONE("jobs.wait");
+        const int self = current_worker();
+        if (self >= 0) {
+            // Blocking a worker could starve the job being waited on; help out instead.
+            while (!handle.done()) {
+                if (detail::job* j = find_job(self)) {
+                    run(j);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        const detail::job* j = handle.m_job;
+        m_finished.wait(lock, [&] { return j->done.load(std::memory_order_seq_cst); });
+        m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void job_system::wait_idle() {
+        QC_PROFILE_ZONE("jobs.wait_idle");
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        m_finished.wait(lock, [&] { return m_unfinished.load(std::memory_order_seq_cst) == 0; });
+        m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    int job_system::current_worker() const {
+        return t_owner == this ? t_worker : -1;
+    }
+
+    void job_system::schedule(detail::job* j) {
+        const int self = current_worker();
+        if (self >= 0) {
+            m_workers[self]->queues[j->priority].push(j);
+        } else {
+            std::lock_guard<std::mutex> lock(m_injected_mutex);
+            m_injected[j->priority].push_back(j);
+            m_injected_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        m_queued.fetch_add(1, std::memory_order_seq_cst);
+        wake_worker();
+    }
+
+    void job_system::wake_worker() {
+        // Pairs with the seq_cst increment of m_sleepers in worker_main(): either the sleeper
+        // sees the new job or this sees the sleeper.
+        if (m_sleepers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_wake.notify_one();
+        }
+    }
+
+    detail::job* job_system::find_job(int self) {
+        const int count = static_cast<int>(m_workers.size());
+        detail::job* j = nullptr;
+        for (int priority = 0; priority < PRIORITY_COUNT; priority++) {
+            if (self >= 0 && m_workers[self]->queues[priority].pop(j)) {
+                break;
+            }
+
+            if (m_injected_count.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard<std::mutex> lock(m_injected_mutex);
+                std::deque<detail::job*>& injected = m_injected[priority];
+                if (!injected.empty()) {
+                    j = injected.front();
+                    injected.pop_front();
+                    m_injected_count.fetch_sub(1, std::memory_order_relaxed);
+                    break;
+                }
+            }
+
+            // Start after ourselves so thieves spread out over the victims.
+            bool stolen = false;
+            for (int i = 1; i <= count && !stolen; i++) {
+                const int victim = (self + i) % count;
+                if (victim != self) {
+                    stolen = m_workers[victim]->queues[priority].steal(j);
+                }
+            }
+            if (stolen) {
+                break;
+            }
+            j = nullptr;
+        }
+
+        if (j != nullptr) {
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return j;
+    }
+
+    void job_system::run(detail::job* j) {
+        {
+            // Whatever the job took from its thread's arena is scratch and goes back now.
+            const arena_scope scratch(thread_arena());
+            j->fn();
+        }
+        j->fn = nullptr;
+
+        std::vector<detail::job*> dependents;
+        {
+            std::lock_guard<std::mutex> lock(j->mutex);
+            j->done.store(true, std::memory_order_seq_cst);
+            dependents.swap(j->dependents);
+        }
+        for (detail::job* dependent : dependents) {
+            if (dependent->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                schedule(dependent);
+            }
+        }
+        detail::release(j);
+
+        // Pairs with the seq_cst increment of m_waiters in wait() and wait_idle().
+        m_unfinished.fetch_sub(1, std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_finished.notify_all();
+        }
+    }
+
+    void job_system::worker_main(int index) {
+        t_owner = this;
+        t_worker = index;
+        QC_PROFILE_THREAD("worker " + std::to_string(index));
+
+        int idle = 0;
+        for (;;) {
+            if (detail::job* j = find_job(index)) {
+                run(j);
+                idle = 0;
+                continue;
+            }
+
+            if (++idle < IDLE_SPINS) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+            m_wake.wait(lock, [&] {
+                return m_stopping || m_queued.load(std::memory_order_seq_cst) > 0;
+            });
+            m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+            if (m_stopping && m_queued.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+            idle = 0;
+        }
+    }
+}  // namespace qc
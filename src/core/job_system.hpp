@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/work_deque.hpp"
+
+namespace qc {
+    // Lower values run first. Chunk work maps distance from the camera onto these levels, so
+    // nearby chunks generate and mesh before distant ones.
+    enum job_priority : std::uint8_t {
+        PRIORITY_CRITICAL = 0,
+        PRIORITY_HIGH,
+        PRIORITY_NORMAL,
+        PRIORITY_LOW,
+        PRIORITY_COUNT,
+    };
+
+    class job_system;
+
+    namespace detail {
+        struct job;
+    }
+
+    // Reference to a submitted job, used to wait on it or to make other jobs depend on it.
+    class job_handle {
+    public:
+        job_handle() = default;
+        job_handle(const job_handle& other);
+        job_handle(job_handle&& other) noexcept;
+        job_handle& operator=(job_handle other) noexcept;
+        ~job_handle();
+
+        bool valid() const {
+            return m_job != nullptr;
+        }
+
+        bool done() const;
+
+    private:
+        friend class job_system;
+
+        explicit job_handle(detail::job* j);
+
+        detail::job* m_job = nullptr;
+    };
+
+    // Work-stealing thread pool. Every worker owns one Chase-Lev deque per priority level and
+    // looks for work from the most urgent level down: its own deque, then jobs submitted from
+    // outside the pool, then the other workers' deques. A job whose dependencies are not yet
+    // finished is parked on them and scheduled by whichever dependency finishes last.
+    class job_system {
+    public:
+        // Zero threads means one per hardware thread.
+        explicit job_system(unsigned threads = 0);
+        ~job_system();
+
+        job_system(const job_system&) = delete;
+        job_system& operator=(const job_system&) = delete;
+
+        job_handle submit(std::function<void()> fn, job_priority priority = PRIORITY_NORMAL);
+        job_handle submit(std::function<void()> fn, job_priority priority,
+                          std::initializer_list<job_handle> dependencies);
+        job_handle submit(std::function<void()> fn, job_priority priority,
+                          const std::vector<job_handle>& dependencies);
+
+        // Blocks until `handle` has run. Called from a worker, runs other jobs meanwhile.
+        void wait(const job_handle& handle);
+
+        // Blocks until every submitted job has run.
+        void wait_idle();
+
+        // Calls fn(i) for every i in [0, count) and returns once all calls are done. The range
+        // is split into jobs of `grain` calls; the calling thread runs the first one itself
+        // rather than sitting idle.
+        template <typename F>
+        void parallel_for(std::size_t count, std::size_t grain, const F& fn,
+                          job_priority priority = PRIORITY_HIGH) {
+            grain = std::max<std::size_t>(grain, 1);
+            std::vector<job_handle> jobs;
+            for (std::size_t begin = grain; begin < count; begin += grain) {
+                const std::size_t end = std::min(begin + grain, count);
+                jobs.push_back(submit(
+                    [&fn, begin, end] {
+                        for (std::size_t i = begin; i < end; i++) {
+                            fn(i);
+                        }
+                    },
+                    priority));
+            }
+            for (std::size_t i = 0; i < std::min(grain, count); i++) {
+                fn(i);
+            }
+            for (const job_handle& j : jobs) {
+                wait(j);
+            }
+        }
+
+        unsigned thread_count() const {
+            return static_cast<unsigned>(m_workers.size());
+        }
+
+        // Index of the calling worker thread, or -1 outside this pool.
+        int current_worker() const;
+
+    private:
+        struct worker {
+            work_deque<detail::job*> queues[PRIORITY_COUNT];
+            std::thread thread;
+        };
+
+        job_handle submit(std::function<void()> fn, job_priority priority,
+                          const job_handle* dependencies, std::size_t count);
+
+        void schedule(detail::job* j);
+        detail::job* find_job(int self);
+        void run(detail::job* j);
+        void wake_worker();
+        void worker_main(int index);
+
+        std::vector<std::unique_ptr<worker>> m_workers;
+
+        // Jobs submitted by threads outside the pool.
+        std::mutex m_injected_mutex;
+        std::deque<detail::job*> m_injected[PRIORITY_COUNT];
+        std::atomic<int> m_injected_count{0};
+
+        // Jobs sitting in any queue, and jobs submitted but not yet finished.
+        std::atomic<int> m_queued{0};
+        std::atomic<int> m_unfinished{0};
+
+        // Idle workers sleep on m_wake; threads outside the pool blocked in wait() or
+        // wait_idle() sleep on m_finished. Both counters are only changed under m_sleep_mutex.
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_finished;
+        std::atomic<int> m_sleepers{0};
+        std::atomic<int> m_waiters{0};
+        bool m_stopping = false;
+    };
+}  // namespace qc
@@ -0,0 +1,21 @@
+#include "core/json.hpp"
+
+#include <iterator>
+
+namespace qc {
+    void append_json_string(fmt::memory_buffer& out, std::string_view text) {
+        out.push_back('"');
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                fmt::format_to(std::back_inserter(out), "\\u{:04x}",
+                               static_cast<unsigned char>(c));
+            } else {
+                out.push_back(c);
+            }
+        }
+        out.push_back('"');
+    }
+}  // namespace qc
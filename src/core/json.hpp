@@ -0,0 +1,11 @@
+#pragma once
+
+#include <spdlog/fmt/fmt.h>
+
+#include <string_view>
+
+namespace qc {
+    // Appends `text` as a quoted JSON string, escaping quotes, backslashes and control
+    // characters.
+    void append_json_string(fmt::memory_buffer& out, std::string_view text);
+}  // namespace qc
@@ -0,0 +1,265 @@
+#include "core/log.hpp"
+
+#include <spdlog/sinks/sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace qc {
+    namespace {
+        const char* const SUBSYSTEM_NAMES[LOG_SUBSYSTEM_COUNT] = {
+            "", "world", "render", "net",
+        };
+
+        struct log_record {
+            std::atomic<std::size_t> sequence;
+            spdlog::log_clock::time_point time;
+            std::size_t thread_id;
+            spdlog::level::level_enum level;
+            log_subsystem subsystem;
+            std::uint16_t size;
+            char text[LOG_MESSAGE_SIZE];
+        };
+
+        // Vyukov's bounded queue: every slot carries a sequence number telling producers and
+        // the consumer whose turn it is, so a push is one compare-and-swap on the tail and a
+        // full queue is seen without waiting on anyone. Only the logging thread pops.
+        class log_queue {
+        public:
+            explicit log_queue(std::size_t size) : m_mask(size - 1), m_records(size) {
+                for (std::size_t i = 0; i < size; i++) {
+                    m_records[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            bool try_push(const spdlog::details::log_msg& msg, log_subsystem subsystem) {
+                std::size_t pos = m_tail.load(std::memory_order_relaxed);
+                log_record* r;
+                for (;;) {
+                    r = &m_records[pos & m_mask];
+                    const std::size_t sequence = r->sequence.load(std::memory_order_acquire);
+                    const std::ptrdiff_t lag =
+                        static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                    if (lag == 0) {
+                        if (m_tail.compare_exchange_weak(pos, pos + 1,
+                                                         std::memory_order_relaxed)) {
+                            break;
+                        }
+                    } else if (lag < 0) {
+                        // The consumer has not freed this slot yet: the queue is full.
+                        return false;
+                    } else {
+                        pos = m_tail.load(std::memory_order_relaxed);
+                    }
+                }
+
+                r->time = msg.time;
+                r->thread_id = msg.thread_id;
+                r->level = msg.level;
+                r->subsystem = subsystem;
+                const std::size_t size = std::min(msg.payload.size(), LOG_MESSAGE_SIZE);
+                std::memcpy(r->text, msg.payload.data(), size);
+                r->size = static_cast<std::uint16_t>(size);
+                r->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Calls fn(record) on the oldest record, if there is one.
+            template <typename F>
+            bool try_pop(F&& fn) {
+                log_record& r = m_records[m_head & m_mask];
+                if (r.sequence.load(std::memory_order_acquire) != m_head + 1) {
+                    return false;
+                }
+                fn(r);
+                r.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+                m_head++;
+                return true;
+            }
+
+        private:
+            const std::size_t m_mask;
+            std::vector<log_record> m_records;
+            alignas(64) std::atomic<std::size_t> m_tail{0};
+            alignas(64) std::size_t m_head = 0;
+        };
+
+        struct log_totals {
+            std::atomic<std::uint64_t> queued{0};
+            std::atomic<std::uint64_t> written{0};
+            std::atomic<std::uint64_t> dropped{0};
+            std::atomic<std::uint64_t> blocked{0};
+        };
+
+        log_totals g_totals;
+
+        // The one sink of every subsystem logger.
+        class queue_sink final : public spdlog::sinks::sink {
+        public:
+            queue_sink(log_queue& queue, log_subsystem subsystem, log_overflow overflow)
+                : m_queue(queue), m_subsystem(subsystem), m_overflow(overflow) {
+            }
+
+            void log(const spdlog::details::log_msg& msg) override {
+                if (m_queue.try_push(msg, m_subsystem)) {
+                    g_totals.queued.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                if (m_overflow == LOG_OVERFLOW_DROP) {
+                    g_totals.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                g_totals.blocked.fetch_add(1, std::memory_order_relaxed);
+                while (!m_queue.try_push(msg, m_subsystem)) {
+                    std::this_thread::yield();
+                }
+                g_totals.queued.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Formatting and flushing happen on the logging thread.
+            void flush() override {
+            }
+
+            void set_pattern(const std::string&) override {
+            }
+
+            void set_formatter(std::unique_ptr<spdlog::formatter>) override {
+            }
+
+        private:
+            log_queue& m_queue;
+            log_subsystem m_subsystem;
+            log_overflow m_overflow;
+        };
+
+        struct logging_state {
+            explicit logging_state(const log_settings& settings)
+                : queue(round_up_pow2(settings.queue_size)), sinks(settings.sinks) {
+            }
+
+            static std::size_t round_up_pow2(std::size_t v) {
+                std::size_t size = 2;
+                while (size < v) {
+                    size <<= 1;
+                }
+                return size;
+            }
+
+            log_queue queue;
+            std::vector<spdlog::sink_ptr> sinks;
+            std::shared_ptr<spdlog::logger> loggers[LOG_SUBSYSTEM_COUNT];
+            std::shared_ptr<spdlog::logger> previous_default;
+            std::atomic<bool> stopping{false};
+            std::thread writer;
+        };
+
+        std::unique_ptr<logging_state> g_state;
+        std::atomic<spdlog::logger*> g_loggers[LOG_SUBSYSTEM_COUNT];
+
+        // Returns true if anything was written.
+        bool write_queued(logging_state& state) {
+            std::uint64_t written = 0;
+            while (state.queue.try_pop([&](const log_record& r) {
+                spdlog::details::log_msg msg(r.time, spdlog::source_loc{},
+                                             SUBSYSTEM_NAMES[r.subsystem], r.level,
+                                             spdlog::string_view_t(r.text, r.size));
+                msg.thread_id = r.thread_id;
+                for (const spdlog::sink_ptr& sink : state.sinks) {
+                    if (sink->should_log(msg.level)) {
+                        sink->log(msg);
+                    }
+                }
+            })) {
+                written++;
+            }
+            if (written == 0) {
+                return false;
+            }
+            for (const spdlog::sink_ptr& sink : state.sinks) {
+                sink->flush();
+            }
+            g_totals.written.fetch_add(written, std::memory_order_release);
+            return true;
+        }
+
+        void writer_main(logging_state& state) {
+            // Polling keeps producers free of any wake-up call; an idle millisecond between
+            // checks costs nothing measurable.
+            while (!state.stopping.load(std::memory_order_acquire)) {
+                if (!write_queued(state)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            write_queued(state);
+        }
+    }  // namespace
+
+    void start_logging(const log_settings& settings) {
+        if (g_state != nullptr) {
+            stop_logging();
+        }
+        g_totals.queued = 0;
+        g_totals.written = 0;
+        g_totals.dropped = 0;
+        g_totals.blocked = 0;
+
+        g_state = std::make_unique<logging_state>(settings);
+        logging_state& state = *g_state;
+        if (state.sinks.empty()) {
+            state.sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_st>());
+        }
+        state.previous_default = spdlog::default_logger();
+        const spdlog::level::level_enum level = state.previous_default->level();
+        for (int s = 0; s < LOG_SUBSYSTEM_COUNT; s++) {
+            auto logger = std::make_shared<spdlog::logger>(
+                SUBSYSTEM_NAMES[s], std::make_shared<queue_sink>(state.queue,
+                                                                 static_cast<log_subsystem>(s),
+                                                                 settings.overflow));
+            logger->set_level(level);
+            state.loggers[s] = logger;
+            g_loggers[s].store(logger.get(), std::memory_order_release);
+        }
+        spdlog::set_default_logger(state.loggers[LOG_CORE]);
+        state.writer = std::thread(writer_main, std::ref(state));
+    }
+
+    void stop_logging() {
+        if (g_state == nullptr) {
+            return;
+        }
+        logging_state& state = *g_state;
+        state.stopping.store(true, std::memory_order_release);
+        state.writer.join();
+        spdlog::set_default_logger(state.previous_default);
+        for (std::atomic<spdlog::logger*>& logger : g_loggers) {
+            logger.store(nullptr, std::memory_order_release);
+        }
+        g_state.reset();
+    }
+
+    void flush_logging() {
+        while (g_state != nullptr && g_totals.written.load(std::memory_order_acquire) <
+                                         g_totals.queued.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    spdlog::logger& subsystem_logger(log_subsystem s) {
+        spdlog::logger* logger = g_loggers[s].load(std::memory_order_acquire);
+        return logger != nullptr ? *logger : *spdlog::default_logger_raw();
+    }
+
+    log_counters logging_counters() {
+        log_counters counters;
+        counters.queued = g_totals.queued.load(std::memory_order_relaxed);
+        counters.written = g_totals.written.load(std::memory_order_relaxed);
+        counters.dropped = g_totals.dropped.load(std::memory_order_relaxed);
+        counters.blocked = g_totals.blocked.load(std::memory_order_relaxed);
+        return counters;
+    }
+}  // namespace qc
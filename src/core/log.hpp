@@ -0,0 +1,84 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qc {
+    enum log_subsystem : std::uint8_t {
+        // spdlog's default logger: spdlog::info() and friends, printed without a name.
+        LOG_CORE = 0,
+        LOG_WORLD,
+        LOG_RENDER,
+        LOG_NET,
+        LOG_SUBSYSTEM_COUNT,
+    };
+
+    enum log_overflow : std::uint8_t {
+        // A full queue drops the new message, so logging never waits.
+        LOG_OVERFLOW_DROP = 0,
+        // A full queue makes the caller wait for room, so nothing is lost.
+        LOG_OVERFLOW_BLOCK,
+    };
+
+    // Longer messages are cut short.
+    constexpr std::size_t LOG_MESSAGE_SIZE = 224;
+
+    struct log_settings {
+        // Messages the queue holds, rounded up to a power of two.
+        std::size_t queue_size = 4096;
+        log_overflow overflow = LOG_OVERFLOW_DROP;
+        // Where messages end up, written by the logging thread only. A colored stdout sink
+        // when empty.
+        std::vector<spdlog::sink_ptr> sinks;
+    };
+
+    // Totals since start_logging().
+    struct log_counters {
+        // Messages that made it into the queue, and those of them already written.
+        std::uint64_t queued = 0;
+        std::uint64_t written = 0;
+        // Messages lost to a full queue (LOG_OVERFLOW_DROP).
+        std::uint64_t dropped = 0;
+        // Messages that had to wait for room (LOG_OVERFLOW_BLOCK).
+        std::uint64_t blocked = 0;
+    };
+
+    // Moves logging off the calling threads: every subsystem logger, spdlog's default logger
+    // included, formats its message and pushes it onto a fixed-size lock-free queue, and one
+    // thread writes the queue out to the sinks. A burst of logging from the job system's workers
+    // thus costs each of them a formatted copy rather than a turn on the console's mutex.
+    //
+    // Call from the main thread while no other thread logs, as with stop_logging().
+    void start_logging(const log_settings& settings = {});
+
+    // Writes out whatever is queued, stops the logging thread and puts back the synchronous
+    // default logger start_logging() replaced.
+    void stop_logging();
+
+    // Waits until every message queued so far has been written.
+    void flush_logging();
+
+    // The logger of `s`. Before start_logging() every subsystem logs synchronously through
+    // spdlog's default logger.
+    spdlog::logger& subsystem_logger(log_subsystem s);
+
+    log_counters logging_counters();
+
+    // Logs asynchronously for the lifetime of a scope, normally main().
+    class logging_scope {
+    public:
+        explicit logging_scope(const log_settings& settings = {}) {
+            start_logging(settings);
+        }
+
+        ~logging_scope() {
+            stop_logging();
+        }
+
+        logging_scope(const logging_scope&) = delete;
+        logging_scope& operator=(const logging_scope&) = delete;
+    };
+}  // namespace qc
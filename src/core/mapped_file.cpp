@@ -0,0 +1,170 @@
+#include "core/mapped_file.hpp"
+
+#include <spdlog/spdlog.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace qc {
+#if defined(_WIN32)
+    std::unique_ptr<mapped_file> mapped_file::open(const std::string& path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                                  nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            spdlog::error("cannot open {}: error {}", path, GetLastError());
+            return nullptr;
+        }
+
+        std::unique_ptr<mapped_file> f(new mapped_file);
+        f->m_file = file;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || !f->remap(static_cast<std::size_t>(size.QuadPart))) {
+            spdlog::error("cannot map {}", path);
+            return nullptr;
+        }
+        return f;
+    }
+
+    mapped_file::~mapped_file() {
+        unmap();
+        if (m_file != nullptr) {
+            CloseHandle(m_file);
+        }
+    }
+
+    bool mapped_file::write(std::uint64_t offset, const void* data, std::size_t size) {
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(offset);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD written = 0;
+        if (!WriteFile(m_file, data, static_cast<DWORD>(size), &written, &at) ||
+            written != size) {
+            return false;
+        }
+        return offset + size <= m_size || remap(static_cast<std::size_t>(offset + size));
+    }
+
+    bool mapped_file::remap(std::size_t size) {
+        unmap();
+        if (size == 0) {
+            return true;
+        }
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping == nullptr) {
+            return false;
+        }
+        const void* view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        m_data = static_cast<const std::uint8_t*>(view);
+        m_size = m_data != nullptr ? size : 0;
+        return m_data != nullptr;
+    }
+
+    void mapped_file::unmap() {
+        if (m_data != nullptr) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr) {
+            CloseHandle(m_mapping);
+        }
+        m_mapping = nullptr;
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    bool mapped_file::evict_from_page_cache(const std::string&) {
+        return false;
+    }
+#else
+    std::unique_ptr<mapped_file> mapped_file::open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            spdlog::error("cannot open {}: {}", path, std::strerror(errno));
+            return nullptr;
+        }
+
+        std::unique_ptr<mapped_file> f(new mapped_file);
+        f->m_fd = fd;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !f->remap(static_cast<std::size_t>(st.st_size))) {
+            spdlog::error("cannot map {}: {}", path, std::strerror(errno));
+            return nullptr;
+        }
+        return f;
+    }
+
+    mapped_file::~mapped_file() {
+        unmap();
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+
+    bool mapped_file::write(std::uint64_t offset, const void* data, std::size_t size) {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        std::size_t done = 0;
+        while (done < size) {
+            const ssize_t n = pwrite(m_fd, bytes + done, size - done,
+                                     static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        return offset + size <= m_size || remap(static_cast<std::size_t>(offset + size));
+    }
+
+    bool mapped_file::remap(std::size_t size) {
+        unmap();
+        if (size == 0) {
+            return true;
+        }
+
+        void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, m_fd, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        m_data = static_cast<const std::uint8_t*>(p);
+        m_size = size;
+        return true;
+    }
+
+    void mapped_file::unmap() {
+        if (m_data != nullptr) {
+            munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        }
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    bool mapped_file::evict_from_page_cache(const std::string& path) {
+#if defined(POSIX_FADV_DONTNEED)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        // Dirty pages cannot be dropped, so flush them first.
+        const bool ok = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        close(fd);
+        return ok;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+#endif
+}  // namespace qc
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace qc {
+    // A file opened for reading and writing whose current contents are mapped read-only.
+    // Writes go through the file and show up in the mapping, which is re-established whenever
+    // the file grows, so pointers from data() are invalidated by write().
+    class mapped_file {
+    public:
+        // Opens `path`, creating an empty file if it does not exist. Returns null on failure.
+        static std::unique_ptr<mapped_file> open(const std::string& path);
+
+        ~mapped_file();
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        // Null while the file is empty.
+        const std::uint8_t* data() const {
+            return m_data;
+        }
+
+        std::size_t size() const {
+            return m_size;
+        }
+
+        bool write(std::uint64_t offset, const void* data, std::size_t size);
+
+        // Asks the OS to drop the file's pages from the page cache so the next read comes from
+        // disk. Only used by benchmarks; returns false where unsupported.
+        static bool evict_from_page_cache(const std::string& path);
+
+    private:
+        mapped_file() = default;
+
+        bool remap(std::size_t size);
+        void unmap();
+
+#if defined(_WIN32)
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#else
+        int m_fd = -1;
+#endif
+        const std::uint8_t* m_data = nullptr;
+        std::size_t m_size = 0;
+    };
+}  // namespace qc
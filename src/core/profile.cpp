@@ -0,0 +1,211 @@
+#include "core/profile.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/json.hpp"
+
+namespace qc {
+    namespace {
+        struct profile_event {
+            std::atomic<const char*> name{nullptr};
+            std::atomic<std::uint64_t> begin{0};
+            std::atomic<std::uint64_t> end{0};
+        };
+
+        // A single-writer ring. `head` counts every zone ever recorded; zone i lives in slot
+        // i % PROFILE_RING_SIZE until zone i + PROFILE_RING_SIZE overwrites it.
+        struct profile_ring {
+            std::atomic<std::uint64_t> head{0};
+            std::atomic<bool> in_use{true};
+            int tid = 0;
+            std::string name;  // guarded by the registry mutex
+            profile_event events[PROFILE_RING_SIZE];
+        };
+
+        struct profile_registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<profile_ring>> rings;
+
+            // Taken with the first ring, to calibrate ticks against the steady clock.
+            std::uint64_t origin_ticks = profile_now();
+            std::chrono::steady_clock::time_point origin_time = std::chrono::steady_clock::now();
+        };
+
+        // Never destroyed, so threads still recording during static destruction are safe.
+        profile_registry& registry() {
+            static profile_registry* r = new profile_registry;
+            return *r;
+        }
+
+        // Hands the ring back for reuse when its thread exits. Its zones stay in the trace
+        // until the next thread to take it overwrites them.
+        struct ring_owner {
+            profile_ring* ring = nullptr;
+
+            ~ring_owner() {
+                if (ring != nullptr) {
+                    ring->in_use.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local ring_owner t_ring;
+
+        profile_ring* acquire_ring() {
+            profile_registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (const std::unique_ptr<profile_ring>& ring : r.rings) {
+                if (!ring->in_use.load(std::memory_order_acquire)) {
+                    ring->in_use.store(true, std::memory_order_relaxed);
+                    // Not the last thread's name: the new one has yet to name itself.
+                    ring->name = "thread " + std::to_string(ring->tid);
+                    return ring.get();
+                }
+            }
+            r.rings.push_back(std::make_unique<profile_ring>());
+            profile_ring* ring = r.rings.back().get();
+            ring->tid = static_cast<int>(r.rings.size());
+            ring->name = "thread " + std::to_string(ring->tid);
+            return ring;
+        }
+
+        profile_ring& thread_ring() {
+            if (t_ring.ring == nullptr) {
+                t_ring.ring = acquire_ring();
+            }
+            return *t_ring.ring;
+        }
+
+        struct zone {
+            const char* name;
+            std::uint64_t begin;
+            std::uint64_t end;
+        };
+
+        // Copies the zones of one ring without stopping its writer, seqlock style: anything
+        // the writer may have started overwriting by the end of the copy is dropped.
+        void snapshot(const profile_ring& ring, std::vector<zone>& out) {
+            const std::uint64_t head = ring.head.load(std::memory_order_acquire);
+            const std::uint64_t first = head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0;
+            const std::size_t start = out.size();
+            for (std::uint64_t i = first; i < head; i++) {
+                const profile_event& e = ring.events[i % PROFILE_RING_SIZE];
+                out.push_back({e.name.load(std::memory_order_acquire),
+                               e.begin.load(std::memory_order_acquire),
+                               e.end.load(std::memory_order_acquire)});
+            }
+
+            const std::uint64_t now = ring.head.load(std::memory_order_relaxed);
+            const std::uint64_t stale = now >= PROFILE_RING_SIZE ? now - PROFILE_RING_SIZE + 1 : 0;
+            if (stale > first) {
+                const std::size_t drop = static_cast<std::size_t>(std::min(stale, head) - first);
+                out.erase(out.begin() + start, out.begin() + start + drop);
+            }
+        }
+
+        // Nanoseconds per profile_now() tick, measured over at least CALIBRATION_TIME since the
+        // profiler started.
+        constexpr std::chrono::milliseconds CALIBRATION_TIME(10);
+
+        double ns_per_tick(const profile_registry& r) {
+#if defined(QC_X86)
+            std::this_thread::sleep_until(r.origin_time + CALIBRATION_TIME);
+            const std::uint64_t ticks = profile_now() - r.origin_ticks;
+            const double ns = std::chrono::duration<double, std::nano>(
+                                  std::chrono::steady_clock::now() - r.origin_time)
+                                  .count();
+            return ticks > 0 ? ns / static_cast<double>(ticks) : 1.0;
+#else
+            static_cast<void>(r);
+            return 1.0;
+#endif
+        }
+    }  // namespace
+
+    void profile_record(const char* name, std::uint64_t begin, std::uint64_t end) {
+        profile_ring& ring = thread_ring();
+        const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+        // Released, so a reader that acquires any of them also sees the head update before,
+        // which tells it the slot is being reused. Free on x86.
+        profile_event& e = ring.events[head % PROFILE_RING_SIZE];
+        e.name.store(name, std::memory_order_release);
+        e.begin.store(begin, std::memory_order_release);
+        e.end.store(end, std::memory_order_release);
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    void profile_thread_name(const std::string& name) {
+        profile_ring& ring = thread_ring();
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        ring.name = name;
+    }
+
+    bool write_chrome_trace(const std::string& path) {
+        struct thread_zones {
+            int tid;
+            std::string name;
+            std::vector<zone> zones;
+        };
+        profile_registry& r = registry();
+        const double scale = ns_per_tick(r);
+        std::vector<thread_zones> threads;
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (const std::unique_ptr<profile_ring>& ring : r.rings) {
+                threads.push_back({ring->tid, ring->name, {}});
+                snapshot(*ring, threads.back().zones);
+            }
+        }
+
+        std::uint64_t origin = UINT64_MAX;
+        std::size_t count = 0;
+        for (const thread_zones& t : threads) {
+            for (const zone& z : t.zones) {
+                origin = std::min(origin, z.begin);
+            }
+            count += t.zones.size();
+        }
+
+        // Timestamps are microseconds from the earliest zone.
+        fmt::memory_buffer out;
+        fmt::format_to(std::back_inserter(out), "{{\"traceEvents\":[\n");
+        bool first = true;
+        for (const thread_zones& t : threads) {
+            fmt::format_to(std::back_inserter(out),
+                           "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+                           "\"args\":{{\"name\":",
+                           first ? "" : ",\n", t.tid);
+            append_json_string(out, t.name);
+            fmt::format_to(std::back_inserter(out), "}}}}");
+            first = false;
+            for (const zone& z : t.zones) {
+                fmt::format_to(std::back_inserter(out), ",\n{{\"name\":");
+                append_json_string(out, z.name);
+                fmt::format_to(std::back_inserter(out),
+                               ",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                               t.tid, (z.begin - origin) * scale / 1000.0,
+                               (z.end - z.begin) * scale / 1000.0);
+            }
+        }
+        fmt::format_to(std::back_inserter(out), "\n]}}\n");
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) {
+            spdlog::error("cannot write trace {}", path);
+            return false;
+        }
+        spdlog::info("wrote {} zones from {} threads to {}", count, threads.size(), path);
+        return true;
+    }
+}  // namespace qc
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "core/simd.hpp"
+
+#if defined(QC_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(QC_X86)
+#include <x86intrin.h>
+#endif
+
+// Scoped profiling zones, dumped as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+//
+//     void mesher::build(...) {
+//         QC_PROFILE_ZONE("mesh");
+//         ...
+//     }
+//
+// The macros expand to nothing unless QC_PROFILE is defined, which the build does for every
+// configuration but Release.
+#define QC_PROFILE_CONCAT_INNER(a, b) a##b
+#define QC_PROFILE_CONCAT(a, b) QC_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(QC_PROFILE)
+#define QC_PROFILE_ZONE(name) const ::qc::profile_zone QC_PROFILE_CONCAT(qc_zone_, __LINE__)(name)
+#define QC_PROFILE_THREAD(name) ::qc::profile_thread_name(name)
+#else
+#define QC_PROFILE_ZONE(name) static_cast<void>(0)
+#define QC_PROFILE_THREAD(name) static_cast<void>(0)
+#endif
+
+namespace qc {
+    // Slots in each thread's ring of zones. The latest PROFILE_RING_SIZE - 1 zones of a thread
+    // can always be read back; older ones are overwritten.
+    constexpr std::size_t PROFILE_RING_SIZE = 1 << 14;
+
+    // Profiler clock: the time stamp counter on x86, which is cheaper to read than
+    // steady_clock, and nanoseconds elsewhere. Ticks become time when the trace is written.
+    inline std::uint64_t profile_now() {
+#if defined(QC_X86)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+#endif
+    }
+
+    // Appends a finished zone, in profile_now() ticks, to the calling thread's ring. `name`
+    // must outlive the profiler, normally a string literal. Wait-free: the ring is only ever
+    // written by its own thread.
+    void profile_record(const char* name, std::uint64_t begin, std::uint64_t end);
+
+    // Labels the calling thread in the trace.
+    void profile_thread_name(const std::string& name);
+
+    // Writes every zone still held in the rings as Chrome trace JSON. Safe to call while other
+    // threads keep recording; zones overwritten during the copy are dropped.
+    bool write_chrome_trace(const std::string& path);
+
+    class profile_zone {
+    public:
+        explicit profile_zone(const char* name) : m_name(name), m_begin(profile_now()) {
+        }
+
+        ~profile_zone() {
+            profile_record(m_name, m_begin, profile_now());
+        }
+
+        profile_zone(const profile_zone&) = delete;
+        profile_zone& operator=(const profile_zone&) = delete;
+
+    private:
+        const char* m_name;
+        std::uint64_t m_begin;
+    };
+}  // namespace qc
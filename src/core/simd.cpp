@@ -0,0 +1,45 @@
+#include "core/simd.hpp"
+
+#if defined(QC_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace qc {
+    namespace {
+        simd_level detect() {
+#if !defined(QC_X86)
+            return SIMD_SCALAR;
+#elif defined(_MSC_VER)
+            int regs[4];
+            __cpuid(regs, 1);
+            // AVX state must also be enabled by the OS (OSXSAVE plus XCR0 bits 1 and 2).
+            const bool os_avx = (regs[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+            __cpuidex(regs, 7, 0);
+            const bool avx2 = (regs[1] & (1 << 5)) != 0;
+            return os_avx && avx2 ? SIMD_AVX2 : SIMD_SSE2;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? SIMD_AVX2 : SIMD_SSE2;
+#endif
+        }
+    }  // namespace
+
+    simd_level best_simd_level() {
+        static const simd_level level = detect();
+        return level;
+    }
+
+    const char* simd_level_name(simd_level level) {
+        switch (level) {
+        case SIMD_SCALAR:
+            return "scalar";
+        case SIMD_SSE2:
+            return "sse2";
+        case SIMD_AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+        }
+    }
+}  // namespace qc
@@ -0,0 +1,20 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QC_X86 1
+#endif
+
+namespace qc {
+    // Instruction sets the SIMD kernels are built for, weakest first.
+    enum simd_level {
+        SIMD_SCALAR = 0,
+        SIMD_SSE2,
+        SIMD_AVX2,
+        SIMD_LEVEL_COUNT,
+    };
+
+    // Best level both this CPU and this build support. Detected once.
+    simd_level best_simd_level();
+
+    const char* simd_level_name(simd_level level);
+}  // namespace qc
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace qc {
+    // Chase-Lev work-stealing deque (Lê et al., "Correct and Efficient Work-Stealing for Weak
+    // Memory Models"). The owning thread pushes and pops at the bottom; any other thread may
+    // steal from the top. T must be trivially copyable; the job system stores pointers.
+    //
+    // The ring grows when full. Retired rings stay alive until the deque is destroyed because a
+    // thief may still be reading from one.
+    template <typename T>
+    class work_deque {
+    public:
+        explicit work_deque(std::size_t capacity = 256) {
+            std::size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            m_rings.push_back(std::make_unique<ring>(size));
+            m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+        }
+
+        work_deque(const work_deque&) = delete;
+        work_deque& operator=(const work_deque&) = delete;
+
+        // Owner only.
+        void push(T item) {
+            const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+            const std::int64_t t = m_top.load(std::memory_order_acquire);
+            ring* r = m_ring.load(std::memory_order_relaxed);
+            if (b - t > static_cast<std::int64_t>(r->mask)) {
+                r = grow(r, t, b);
+            }
+
+            r->put(b, item);
+            m_bottom.store(b + 1, std::memory_order_release);
+        }
+
+        // Owner only. Takes the most recently pushed item.
+        bool pop(T& out) {
+            const std::int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+            ring* r = m_ring.load(std::memory_order_relaxed);
+            // Both seq_cst, so a thief cannot miss the claim on the bottom while this misses
+            // its claim on the top.
+            m_bottom.store(b, std::memory_order_seq_cst);
+            std::int64_t t = m_top.load(std::memory_order_seq_cst);
+
+            if (t > b) {
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            out = r->get(b);
+            if (t == b) {
+                // Last item: race the thieves for it.
+                const bool won = m_top.compare_exchange_strong(
+                    t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        // Any thread. Takes the oldest item; fails when empty or when losing a race.
+        bool steal(T& out) {
+            std::int64_t t = m_top.load(std::memory_order_seq_cst);
+            const std::int64_t b = m_bottom.load(std::memory_order_seq_cst);
+            if (t >= b) {
+                return false;
+            }
+
+            ring* r = m_ring.load(std::memory_order_acquire);
+            const T item = r->get(t);
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                               std::memory_order_relaxed)) {
+                return false;
+            }
+
+            out = item;
+            return true;
+        }
+
+        // Approximate; only for heuristics.
+        bool empty() const {
+            return m_bottom.load(std::memory_order_relaxed) <=
+                   m_top.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct ring {
+            explicit ring(std::size_t size) : mask(size - 1), items(size) {
+            }
+
+            std::size_t slot(std::int64_t index) const {
+                return static_cast<std::size_t>(index) & mask;
+            }
+
+            void put(std::int64_t index, T item) {
+                items[slot(index)].store(item, std::memory_order_relaxed);
+            }
+
+            T get(std::int64_t index) const {
+                return items[slot(index)].load(std::memory_order_relaxed);
+            }
+
+            std::size_t mask;
+            std::vector<std::atomic<T>> items;
+        };
+
+        ring* grow(ring* old, std::int64_t top, std::int64_t bottom) {
+            m_rings.push_back(std::make_unique<ring>((old->mask + 1) * 2));
+            ring* r = m_rings.back().get();
+            for (std::int64_t i = top; i < bottom; i++) {
+                r->put(i, old->get(i));
+            }
+            m_ring.store(r, std::memory_order_release);
+            return r;
+        }
+
+        alignas(64) std::atomic<std::int64_t> m_top{0};
+        alignas(64) std::atomic<std::int64_t> m_bottom{0};
+        std::atomic<ring*> m_ring{nullptr};
+
+        // Owner only: every ring ever allocated, the live one last.
+        std::vector<std::unique_ptr<ring>> m_rings;
+    };
+}  // namespace qc
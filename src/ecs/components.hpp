@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+namespace qc {
+    // World-space position of an entity's feet, in blocks.
+    struct position {
+        glm::vec3 value;
+    };
+
+    // Blocks per second.
+    struct velocity {
+        glm::vec3 value;
+    };
+}  // namespace qc
@@ -0,0 +1,148 @@
+#include "ecs/registry.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+
+#include "core/log.hpp"
+
+namespace qc {
+    namespace detail {
+        namespace {
+            std::mutex g_components_mutex;
+            component_info g_components[MAX_COMPONENTS];
+            int g_component_count = 0;
+        }  // namespace
+
+        int register_component(std::size_t size, std::size_t align) {
+            std::lock_guard<std::mutex> lock(g_components_mutex);
+            if (g_component_count == MAX_COMPONENTS) {
+                subsystem_logger(LOG_CORE).critical("more than {} component types",
+                                                    MAX_COMPONENTS);
+                std::abort();
+            }
+            g_components[g_component_count] = {size, align};
+            return g_component_count++;
+        }
+
+        const component_info& component(int id) {
+            return g_components[id];
+        }
+    }  // namespace detail
+
+    registry::registry() = default;
+
+    registry::~registry() = default;
+
+    void registry::destroy(entity e) {
+        if (!alive(e)) {
+            return;
+        }
+        record& r = m_records[e.index];
+        pop(*r.type, r.row);
+        r.type = nullptr;
+        r.generation++;
+        m_free.push_back(e.index);
+        m_alive--;
+    }
+
+    registry::archetype& registry::archetype_for(std::uint64_t mask) {
+        if (const auto it = m_by_mask.find(mask); it != m_by_mask.end()) {
+            return *it->second;
+        }
+
+        auto a = std::make_unique<archetype>();
+        a->mask = mask;
+        std::fill(std::begin(a->offsets), std::end(a->offsets), -1);
+
+        // As many entities as fit when every array starts suitably aligned.
+        std::size_t per_entity = sizeof(entity);
+        std::size_t padding = 0;
+        for (int id = 0; id < MAX_COMPONENTS; id++) {
+            if ((mask >> id & 1) != 0) {
+                per_entity += detail::component(id).size;
+                padding += detail::component(id).align - 1;
+            }
+        }
+        a->capacity = padding < BLOCK_SIZE
+                          ? std::max<std::size_t>((BLOCK_SIZE - padding) / per_entity, 1)
+                          : 1;
+
+        std::size_t offset = a->capacity * sizeof(entity);
+        for (int id = 0; id < MAX_COMPONENTS; id++) {
+            if ((mask >> id & 1) != 0) {
+                const detail::component_info& info = detail::component(id);
+                offset = (offset + info.align - 1) / info.align * info.align;
+                a->offsets[id] = static_cast<std::ptrdiff_t>(offset);
+                offset += a->capacity * info.size;
+            }
+        }
+        a->block_size = std::max(BLOCK_SIZE, offset);
+
+        archetype& result = *a;
+        m_by_mask.emplace(mask, a.get());
+        m_archetypes.push_back(std::move(a));
+        return result;
+    }
+
+    entity registry::allocate(std::uint64_t mask) {
+        entity e;
+        if (!m_free.empty()) {
+            e.index = m_free.back();
+            m_free.pop_back();
+        } else {
+            e.index = static_cast<std::uint32_t>(m_records.size());
+            m_records.emplace_back();
+        }
+        e.generation = m_records[e.index].generation;
+
+        archetype& a = archetype_for(mask);
+        record& r = m_records[e.index];
+        r.type = &a;
+        r.row = push(a, e);
+        m_alive++;
+        return e;
+    }
+
+    std::size_t registry::push(archetype& a, entity e) {
+        const std::size_t row = a.size++;
+        if (row / a.capacity == a.blocks.size()) {
+            // Blocks come from operator new, aligned for any component type.
+            a.blocks.emplace_back(new unsigned char[a.block_size]);
+        }
+        a.entities(row / a.capacity)[row % a.capacity] = e;
+        return row;
+    }
+
+    void registry::pop(archetype& a, std::size_t row) {
+        const std::size_t last = --a.size;
+        if (row != last) {
+            const entity moved = a.entities(last / a.capacity)[last % a.capacity];
+            a.entities(row / a.capacity)[row % a.capacity] = moved;
+            for (int id = 0; id < MAX_COMPONENTS; id++) {
+                if (a.offsets[id] >= 0) {
+                    std::memcpy(a.at(id, row), a.at(id, last), detail::component(id).size);
+                }
+            }
+            m_records[moved.index].row = row;
+        }
+        if (a.size % a.capacity == 0) {
+            a.blocks.pop_back();
+        }
+    }
+
+    void registry::change(entity e, std::uint64_t mask) {
+        record& r = m_records[e.index];
+        archetype& from = *r.type;
+        archetype& to = archetype_for(mask);
+        const std::size_t row = push(to, e);
+        for (int id = 0; id < MAX_COMPONENTS; id++) {
+            if (from.offsets[id] >= 0 && to.offsets[id] >= 0) {
+                std::memcpy(to.at(id, row), from.at(id, r.row), detail::component(id).size);
+            }
+        }
+        pop(from, r.row);
+        r.type = &to;
+        r.row = row;
+    }
+}  // namespace qc
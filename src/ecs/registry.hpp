@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "core/job_system.hpp"
+
+namespace qc {
+    constexpr int MAX_COMPONENTS = 64;
+
+    // Refers to an entity of a registry. Goes stale when the entity is destroyed: the slot is
+    // reused under the next generation, so an old handle never reaches the new entity.
+    struct entity {
+        std::uint32_t index = 0;
+        std::uint32_t generation = 0;
+
+        bool operator==(const entity& other) const {
+            return index == other.index && generation == other.generation;
+        }
+
+        bool operator!=(const entity& other) const {
+            return !(*this == other);
+        }
+    };
+
+    namespace detail {
+        struct component_info {
+            std::size_t size;
+            std::size_t align;
+        };
+
+        // Assigns the next component id. Past MAX_COMPONENTS types this logs and aborts.
+        int register_component(std::size_t size, std::size_t align);
+        const component_info& component(int id);
+    }  // namespace detail
+
+    // Dense id of component type `T`, given out on first use. Components are plain data that
+    // the registry moves around with memcpy.
+    template <typename T>
+    int component_id() {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                      "components must be plain data");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "blocks are not aligned further");
+        static const int id = detail::register_component(sizeof(T), alignof(T));
+        return id;
+    }
+
+    // Entities and their components, stored by archetype: every entity with the same set of
+    // component types lives in the same archetype, in fixed-size blocks that hold one tightly
+    // packed array per component. A query walks the matching archetypes a block at a time and
+    // hands out those arrays, so systems run over contiguous memory instead of chasing an
+    // object per entity. Adding or removing a component moves the entity to another archetype.
+    //
+    // Not synchronized. parallel_each() may run its function on several threads at once, each
+    // on its own block; the registry must not be changed meanwhile.
+    class registry {
+    public:
+        // Bytes per block, shared by all the arrays of the block. Archetypes whose entities are
+        // too big to fit one to a block get blocks of one entity, as big as it needs.
+        static constexpr std::size_t BLOCK_SIZE = 16 * 1024;
+
+        registry();
+        ~registry();
+
+        registry(const registry&) = delete;
+        registry& operator=(const registry&) = delete;
+
+        template <typename... Ts>
+        entity create(const Ts&... components) {
+            const std::uint64_t mask = (std::uint64_t{0} | ... | component_bit<Ts>());
+            const entity e = allocate(mask);
+            (std::memcpy(column(e, component_id<Ts>()), &components, sizeof(Ts)), ...);
+            return e;
+        }
+
+        void destroy(entity e);
+
+        bool alive(entity e) const {
+            return e.index < m_records.size() && m_records[e.index].generation == e.generation &&
+                   m_records[e.index].type != nullptr;
+        }
+
+        // Null if the entity is stale or lacks the component. Valid until the registry changes.
+        template <typename T>
+        T* get(entity e) {
+            return alive(e) ? static_cast<T*>(column(e, component_id<T>())) : nullptr;
+        }
+
+        template <typename T>
+        bool has(entity e) const {
+            return alive(e) && (mask_of(e) & component_bit<T>()) != 0;
+        }
+
+        // Adds the component, or overwrites it if the entity has it.
+        template <typename T>
+        void add(entity e, const T& value) {
+            if (!alive(e)) {
+                return;
+            }
+            if ((mask_of(e) & component_bit<T>()) == 0) {
+                change(e, mask_of(e) | component_bit<T>());
+            }
+            std::memcpy(column(e, component_id<T>()), &value, sizeof(T));
+        }
+
+        template <typename T>
+        void remove(entity e) {
+            if (has<T>(e)) {
+                change(e, mask_of(e) & ~component_bit<T>());
+            }
+        }
+
+        // Living entities.
+        std::size_t size() const {
+            return m_alive;
+        }
+
+        std::size_t archetype_count() const {
+            return m_archetypes.size();
+        }
+
+        // Calls fn(count, entities, Ts*... arrays) for every block of entities having all of
+        // `Ts`, the arrays holding `count` components each.
+        template <typename... Ts, typename F>
+        void each(F&& fn) {
+            const std::uint64_t mask = (std::uint64_t{0} | ... | component_bit<Ts>());
+            for (const std::unique_ptr<archetype>& a : m_archetypes) {
+                if ((a->mask & mask) != mask) {
+                    continue;
+                }
+                for (std::size_t b = 0; b < a->blocks.size(); b++) {
+                    call<Ts...>(*a, b, fn);
+                }
+            }
+        }
+
+        // Like each(), with the blocks spread over `jobs`.
+        template <typename... Ts, typename F>
+        void parallel_each(job_system& jobs, F&& fn) {
+            const std::uint64_t mask = (std::uint64_t{0} | ... | component_bit<Ts>());
+            m_matches.clear();
+            for (const std::unique_ptr<archetype>& a : m_archetypes) {
+                if ((a->mask & mask) != mask) {
+                    continue;
+                }
+                for (std::size_t b = 0; b < a->blocks.size(); b++) {
+                    m_matches.push_back({a.get(), b});
+                }
+            }
+            // A few blocks per job keeps the job overhead small next to the work.
+            jobs.parallel_for(m_matches.size(), 4, [&](std::size_t i) {
+                call<Ts...>(*m_matches[i].type, m_matches[i].block, fn);
+            });
+        }
+
+    private:
+        struct archetype {
+            std::uint64_t mask = 0;
+            // Offset of each component's array inside a block, or -1 if the archetype lacks it.
+            // The entity handles come first, at offset 0.
+            std::ptrdiff_t offsets[MAX_COMPONENTS];
+            std::size_t capacity = 0;
+            // Bytes per block: BLOCK_SIZE, or more for a single entity that needs it.
+            std::size_t block_size = 0;
+            std::size_t size = 0;
+            std::vector<std::unique_ptr<unsigned char[]>> blocks;
+
+            void* at(int component, std::size_t row) const {
+                return blocks[row / capacity].get() + offsets[component] +
+                       (row % capacity) * detail::component(component).size;
+            }
+
+            entity* entities(std::size_t block) const {
+                return reinterpret_cast<entity*>(blocks[block].get());
+            }
+        };
+
+        struct record {
+            archetype* type = nullptr;
+            std::size_t row = 0;
+            std::uint32_t generation = 0;
+        };
+
+        struct match {
+            archetype* type;
+            std::size_t block;
+        };
+
+        template <typename T>
+        static std::uint64_t component_bit() {
+            return std::uint64_t{1} << component_id<T>();
+        }
+
+        template <typename... Ts, typename F>
+        static void call(const archetype& a, std::size_t block, F& fn) {
+            const std::size_t first = block * a.capacity;
+            const std::size_t count = std::min(a.capacity, a.size - first);
+            unsigned char* data = a.blocks[block].get();
+            fn(count, a.entities(block),
+               reinterpret_cast<Ts*>(data + a.offsets[component_id<Ts>()])...);
+        }
+
+        std::uint64_t mask_of(entity e) const {
+            return m_records[e.index].type->mask;
+        }
+
+        // Where component `id` of a living entity is kept, or null if it has none.
+        void* column(entity e, int id) const {
+            const record& r = m_records[e.index];
+            return r.type->offsets[id] < 0 ? nullptr : r.type->at(id, r.row);
+        }
+
+        archetype& archetype_for(std::uint64_t mask);
+        // A new entity in the archetype of `mask`, its components left uninitialized.
+        entity allocate(std::uint64_t mask);
+        // Takes a row at the end of `a`.
+        std::size_t push(archetype& a, entity e);
+        // Fills the hole at `row` of `a` with its last entity.
+        void pop(archetype& a, std::size_t row);
+        // Moves the entity to the archetype of `mask`, keeping the components both share.
+        void change(entity e, std::uint64_t mask);
+
+        std::vector<std::unique_ptr<archetype>> m_archetypes;
+        std::unordered_map<std::uint64_t, archetype*> m_by_mask;
+        std::vector<record> m_records;
+        std::vector<std::uint32_t> m_free;
+        std::size_t m_alive = 0;
+        std::vector<match> m_matches;
+    };
+}  // namespace qc
@@ -1,5 +1,168 @@
-#include <iostream>
+#include <spdlog/spdlog.h>
 
-int main() {
-	std::cout << "Hello, World\n";
-}
\ No newline at end of file
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench/benchmarks.hpp"
+#if defined(QC_CLIENT)
+#include "client/client.hpp"
+#endif
+#include "core/log.hpp"
+#include "core/profile.hpp"
+#include "server/server.hpp"
+
+namespace {
+    std::atomic<bool> g_stop{false};
+
+    void request_stop(int) {
+        g_stop.store(true);
+    }
+
+    void print_usage(const char* program) {
+        spdlog::info("usage: {} [options] [--trace <path>]", program);
+        spdlog::info("       {} --bench [filter] [--trace <path>]", program);
+        spdlog::info("       {} --server [options] [--port <n>] [--ticks <n>] [--trace <path>]",
+                     program);
+        spdlog::info("  --port <n>       port to listen on, 0 for any (default 27015)");
+        spdlog::info("  --radius <n>     view radius in chunks (default 8, server 6)");
+        spdlog::info("  --layers <n>     world height in chunks (default 4)");
+        spdlog::info("  --seed <n>       world seed (default 42)");
+        spdlog::info("  --threads <n>    generation threads, 0 for all cores (default 0)");
+        spdlog::info("  --ticks <n>      stop after n ticks, 0 to run until interrupted");
+    }
+
+    bool parse_int(const char* text, long min, long max, long& out) {
+        char* end = nullptr;
+        out = std::strtol(text, &end, 10);
+        return end != text && *end == '\0' && out >= min && out <= max;
+    }
+
+    int run_benchmarks(const char* filter) {
+        qc::bench::suite suite;
+        qc::bench::add_all_benchmarks(suite);
+        return suite.run(filter);
+    }
+
+    // The game, or the benchmarks with `--bench`. A headless build has only the benchmarks.
+    int run_client(int argc, char** argv) {
+        if (argc >= 2 && std::strcmp(argv[1], "--bench") == 0) {
+            if (argc > 3) {
+                print_usage(argv[0]);
+                return 2;
+            }
+            return run_benchmarks(argc == 3 ? argv[2] : nullptr);
+        }
+#if defined(QC_CLIENT)
+        qc::client_settings settings;
+        for (int i = 1; i < argc; i += 2) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : "";
+            long number = 0;
+            if (std::strcmp(arg, "--radius") == 0 && parse_int(value, 1, 64, number)) {
+                settings.view_radius = static_cast<int>(number);
+            } else if (std::strcmp(arg, "--layers") == 0 && parse_int(value, 1, 64, number)) {
+                settings.layers = static_cast<int>(number);
+            } else if (std::strcmp(arg, "--seed") == 0 &&
+                       parse_int(value, 0, 0x7FFFFFFF, number)) {
+                settings.seed = static_cast<std::uint32_t>(number);
+            } else if (std::strcmp(arg, "--threads") == 0 && parse_int(value, 0, 256, number)) {
+                settings.threads = static_cast<unsigned>(number);
+            } else {
+                print_usage(argv[0]);
+                return 2;
+            }
+        }
+
+        qc::game_client client(settings);
+        if (!client.start()) {
+            return 1;
+        }
+        client.run();
+        return 0;
+#else
+        print_usage(argv[0]);
+        return 2;
+#endif
+    }
+
+    // Dedicated server: no window, no GL, ticking until interrupted.
+    int run_server(int argc, char** argv) {
+        qc::server_settings settings;
+        long ticks = 0;
+        for (int i = 2; i < argc; i += 2) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : "";
+            long number = 0;
+            if (std::strcmp(arg, "--port") == 0 && parse_int(value, 0, 65535, number)) {
+                settings.port = static_cast<std::uint16_t>(number);
+            } else if (std::strcmp(arg, "--radius") == 0 && parse_int(value, 1, 64, number)) {
+                settings.view_radius = static_cast<int>(number);
+            } else if (std::strcmp(arg, "--layers") == 0 && parse_int(value, 1, 64, number)) {
+                settings.layers = static_cast<int>(number);
+            } else if (std::strcmp(arg, "--seed") == 0 &&
+                       parse_int(value, 0, 0x7FFFFFFF, number)) {
+                settings.seed = static_cast<std::uint32_t>(number);
+            } else if (std::strcmp(arg, "--threads") == 0 && parse_int(value, 0, 256, number)) {
+                settings.threads = static_cast<unsigned>(number);
+            } else if (std::strcmp(arg, "--ticks") == 0 &&
+                       parse_int(value, 0, 0x7FFFFFFF, number)) {
+                ticks = number;
+            } else {
+                print_usage(argv[0]);
+                return 2;
+            }
+        }
+
+        qc::dedicated_server server(settings);
+        if (!server.start()) {
+            return 1;
+        }
+        std::signal(SIGINT, request_stop);
+        std::signal(SIGTERM, request_stop);
+        server.run(g_stop, static_cast<std::uint64_t>(ticks));
+
+        const qc::tick_histogram& times = server.tick_times();
+        spdlog::info("{} ticks: mean {:.2f} ms, p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms, "
+                     "{} over budget",
+                     times.count(), times.mean_ms(), times.percentile_ms(50.0),
+                     times.percentile_ms(99.0), times.max_ms(), times.over_budget());
+        return 0;
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const qc::logging_scope logging;
+
+    // `--trace <path>` may go anywhere in the arguments and dumps the profiling zones when it
+    // finishes. It is taken out of the arguments the command sees.
+    const char* trace = nullptr;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--trace") == 0) {
+            trace = argv[i + 1];
+            for (int j = i; j + 2 <= argc; j++) {
+                argv[j] = argv[j + 2];
+            }
+            argc -= 2;
+            break;
+        }
+    }
+#if !defined(QC_PROFILE)
+    if (trace != nullptr) {
+        spdlog::warn("profiling zones are compiled out of this build");
+    }
+#endif
+
+    int status = 0;
+    if (argc >= 2 && std::strcmp(argv[1], "--server") == 0) {
+        status = run_server(argc, argv);
+    } else {
+        status = run_client(argc, argv);
+    }
+
+    if (trace != nullptr && !qc::write_chrome_trace(trace)) {
+        status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,576 @@
+#include "mesh/mesher.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/bits.hpp"
+#include "core/profile.hpp"
+
+namespace qc {
+    namespace {
+        // Each axis is meshed as a stack of 32x32 slices: `d` is the depth along the face normal,
+        // `a` the slice row (v axis) and `b` the bit within a row (u axis). These are the voxel
+        // index strides of a, b and d for each axis.
+        struct slice_axes {
+            int a;
+            int b;
+            int d;
+        };
+
+        constexpr slice_axes SLICE_STRIDES[3] = {
+            {CHUNK_AREA, CHUNK_SIZE, 1},  // X faces: a = y, b = z, d = x
+            {CHUNK_SIZE, 1, CHUNK_AREA},  // Y faces: a = z, b = x, d = y
+            {CHUNK_AREA, 1, CHUNK_SIZE},  // Z faces: a = y, b = x, d = z
+        };
+
+        constexpr int slice_index(int axis, int a, int b, int d) {
+            const slice_axes& stride = SLICE_STRIDES[axis];
+            return a * stride.a + b * stride.b + d * stride.d;
+        }
+
+        // (x, y, z) of slice position (a, b, d).
+        struct voxel_coords {
+            int x;
+            int y;
+            int z;
+        };
+
+        constexpr voxel_coords slice_voxel(int axis, int a, int b, int d) {
+            return axis == 0 ? voxel_coords{d, a, b}
+                             : (axis == 1 ? voxel_coords{b, d, a} : voxel_coords{b, a, d});
+        }
+
+        // Side of the padded opacity table: the chunk plus one voxel of neighbours all around.
+        constexpr int PADDED = CHUNK_SIZE + 2;
+
+        // A face's shading as it sits in bits 8..31 of packed_quad::hi: 2 bits of ambient
+        // occlusion per corner, then 4 bits of light per corner. Unoccluded and full bright.
+        constexpr std::uint32_t FLAT_SHADE = 0xFFFFFFu;
+
+        constexpr std::uint32_t shade_corner(std::uint32_t shade, int corner) {
+            return ((shade >> (corner * 2)) & 3u) | ((shade >> (8 + corner * 4)) & 15u) << 2;
+        }
+
+        // Whether faces with this shading can sit side by side along u (v) as one quad: the
+        // corners at either end of that axis must agree, or interpolating across the merged
+        // quad would smear them.
+        constexpr bool flat_along_u(std::uint32_t shade) {
+            return shade_corner(shade, 0) == shade_corner(shade, 1) &&
+                   shade_corner(shade, 3) == shade_corner(shade, 2);
+        }
+
+        constexpr bool flat_along_v(std::uint32_t shade) {
+            return shade_corner(shade, 0) == shade_corner(shade, 3) &&
+                   shade_corner(shade, 1) == shade_corner(shade, 2);
+        }
+
+        // Ambient occlusion bits to clear from a face's shading, by the 3x3 opaque voxels in
+        // front of it (bit (v + 1) * 3 + u + 1). A corner darkens by one step for each opaque
+        // side and diagonal voxel touching it, and fully when both sides are opaque.
+        const std::uint8_t* occlusion_table() {
+            static const std::vector<std::uint8_t> table = [] {
+                std::vector<std::uint8_t> occlusion(512);
+                for (std::uint32_t opaque = 0; opaque < occlusion.size(); opaque++) {
+                    for (int corner = 0; corner < 4; corner++) {
+                        const int u = corner == 1 || corner == 2 ? 2 : 0;
+                        const int v = corner >= 2 ? 2 : 0;
+                        const std::uint32_t side_u = (opaque >> (3 + u)) & 1u;
+                        const std::uint32_t side_v = (opaque >> (v * 3 + 1)) & 1u;
+                        const std::uint32_t diagonal = (opaque >> (v * 3 + u)) & 1u;
+                        const std::uint32_t steps =
+                            side_u != 0 && side_v != 0 ? 3 : side_u + side_v + diagonal;
+                        occlusion[opaque] |= static_cast<std::uint8_t>(steps << (corner * 2));
+                    }
+                }
+                return occlusion;
+            }();
+            return table.data();
+        }
+
+        enum : std::uint8_t {
+            FLAG_SOLID = 1 << 0,
+            FLAG_OPAQUE = 1 << 1,
+        };
+
+        // Solid/opaque flags for every block id, so building masks is one load per voxel.
+        const std::uint8_t* block_flags() {
+            static const std::vector<std::uint8_t> flags = [] {
+                std::vector<std::uint8_t> table(std::size_t{1} << 16);
+                for (std::size_t block = 0; block < table.size(); block++) {
+                    const auto id = static_cast<block_id>(block);
+                    table[block] = static_cast<std::uint8_t>(
+                        (id != BLOCK_AIR ? FLAG_SOLID : 0) |
+                        (block_properties(id).opaque ? FLAG_OPAQUE : 0));
+                }
+                return table;
+            }();
+            return flags.data();
+        }
+
+        // With at most one kind of translucent block, two touching translucent voxels are always
+        // the same block and the faces between them can be culled with masks alone.
+        bool one_translucent_kind() {
+            static const bool one = [] {
+                int kinds = 0;
+                for (block_id block = BLOCK_AIR + 1; block < BLOCK_COUNT; block++) {
+                    kinds += block_properties(block).opaque ? 0 : 1;
+                }
+                return kinds <= 1;
+            }();
+            return one;
+        }
+
+        // Greedy merge of one slice: take the lowest face of a row, extend it along the row
+        // while the faces match its block and shading, then grow the run down the following rows
+        // for as long as they contain the whole run with the same block and shading.
+        template <typename Quads>
+        void merge_slice(std::uint32_t* rows, const block_id* blocks,
+                         const std::uint32_t (*shades)[CHUNK_SIZE], int axis, int d, face dir,
+                         Quads& out) {
+            const slice_axes stride = SLICE_STRIDES[axis];
+            const block_id* layer = blocks + d * stride.d;
+
+            for (int a = 0; a < CHUNK_SIZE; a++) {
+                while (rows[a] != 0) {
+                    const int b = ctz32(rows[a]);
+                    const block_id* row = layer + a * stride.a;
+                    const block_id block = row[b * stride.b];
+                    const std::uint32_t shade = shades[a][b];
+
+                    const int run_length =
+                        flat_along_u(shade) ? ctz64(~(static_cast<std::uint64_t>(rows[a]) >> b))
+                                            : 1;
+                    int width = 1;
+                    while (width < run_length && row[(b + width) * stride.b] == block &&
+                           shades[a][b + width] == shade) {
+                        width++;
+                    }
+
+                    const std::uint32_t run =
+                        static_cast<std::uint32_t>(((std::uint64_t{1} << width) - 1) << b);
+
+                    const int max_height = flat_along_v(shade) ? CHUNK_SIZE - a : 1;
+                    int height = 1;
+                    for (; height < max_height; height++) {
+                        if ((rows[a + height] & run) != run) {
+                            break;
+                        }
+
+                        const block_id* next = layer + (a + height) * stride.a;
+                        bool same = true;
+                        for (int i = 0; i < width && same; i++) {
+                            same = next[(b + i) * stride.b] == block &&
+                                   shades[a + height][b + i] == shade;
+                        }
+
+                        if (!same) {
+                            break;
+                        }
+                        rows[a + height] &= ~run;
+                    }
+                    rows[a] &= ~run;
+
+                    const int index = slice_index(axis, a, b, d);
+                    quad_desc q{};
+                    q.x = static_cast<std::uint8_t>(index & (CHUNK_SIZE - 1));
+                    q.y = static_cast<std::uint8_t>(index >> (2 * CHUNK_SIZE_LOG2));
+                    q.z = static_cast<std::uint8_t>((index >> CHUNK_SIZE_LOG2) & (CHUNK_SIZE - 1));
+                    q.dir = dir;
+                    q.width = static_cast<std::uint8_t>(width);
+                    q.height = static_cast<std::uint8_t>(height);
+                    q.layer = block_texture(block, dir);
+                    for (int corner = 0; corner < 4; corner++) {
+                        q.ao[corner] = static_cast<std::uint8_t>(shade >> (corner * 2) & 3u);
+                        q.light[corner] =
+                            static_cast<std::uint8_t>(shade >> (8 + corner * 4) & 15u);
+                    }
+                    out.push_back(encode_quad(q));
+                }
+            }
+        }
+    }  // namespace
+
+    struct mesher::scratch {
+        block_id blocks[CHUNK_VOLUME];
+
+        // Solid (low half) and opaque (high half) bits of each x row, indexed [y * 32 + z].
+        std::uint64_t rows[CHUNK_AREA];
+
+        // Column bitmasks per axis, indexed [a * 32 + b], bit `d` set for a solid/opaque voxel.
+        std::uint32_t solid[3][CHUNK_AREA];
+        std::uint32_t opaque[3][CHUNK_AREA];
+
+        // Opaque and translucent voxels of the neighbour layer touching each face, indexed like
+        // a slice: rows[a] bit b.
+        std::uint32_t border[FACE_COUNT][CHUNK_SIZE];
+        std::uint32_t border_translucent[FACE_COUNT][CHUNK_SIZE];
+
+        // Visible faces of the current axis, indexed [+axis/-axis][d][a] with bit b per face.
+        std::uint32_t planes[2][CHUNK_SIZE][CHUNK_SIZE];
+
+        // Opaque voxels of the chunk and the layer of neighbours around it: rows along x,
+        // indexed [(y + 1) * PADDED + z + 1], and rows along z, indexed [(y + 1) * PADDED + x + 1],
+        // with bit c + 1 for coordinate c.
+        std::uint64_t occluders_x[PADDED * PADDED];
+        std::uint64_t occluders_z[PADDED * PADDED];
+
+        // Brighter of sky and block light of each voxel, when smooth lighting.
+        std::uint8_t light[CHUNK_VOLUME];
+
+        // Shading of the visible faces of the slice being merged, indexed [a][b].
+        std::uint32_t shades[CHUNK_SIZE][CHUNK_SIZE];
+    };
+
+    mesher::mesher(const mesher_settings& settings)
+        : m_settings(settings), m_scratch(std::make_unique<scratch>()) {
+    }
+
+    mesher::~mesher() = default;
+
+    void mesher::build(const chunk_neighborhood& n, std::vector<packed_quad>& out) {
+        build_quads(n, out);
+    }
+
+    void mesher::build(const chunk_neighborhood& n, std::pmr::vector<packed_quad>& out) {
+        build_quads(n, out);
+    }
+
+    template <typename Quads>
+    void mesher::build_quads(const chunk_neighborhood& n, Quads& out) {
+        QC_PROFILE_ZONE("mesh.build");
+        const chunk& center = *n.center;
+        if (center.is_uniform() && center.uniform_block() == BLOCK_AIR) {
+            return;
+        }
+
+        scratch& s = *m_scratch;
+        center.unpack(s.blocks);
+
+        // X columns come straight out of the voxel order; Y and Z are bit transposes of them.
+        // Solid and opaque masks share one 64-bit row so both are transposed together.
+        const std::uint8_t* flags = block_flags();
+        center.unpack_masks(flags, FLAG_SOLID, FLAG_OPAQUE, s.rows);
+        for (int row = 0; row < CHUNK_AREA; row++) {
+            s.solid[0][row] = static_cast<std::uint32_t>(s.rows[row]);
+            s.opaque[0][row] = static_cast<std::uint32_t>(s.rows[row] >> 32);
+        }
+
+        std::uint64_t pairs[CHUNK_SIZE];
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                pairs[y] = s.rows[y * CHUNK_SIZE + z];
+            }
+            transpose32x2(pairs);
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                s.solid[1][z * CHUNK_SIZE + x] = static_cast<std::uint32_t>(pairs[x]);
+                s.opaque[1][z * CHUNK_SIZE + x] = static_cast<std::uint32_t>(pairs[x] >> 32);
+            }
+        }
+
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            std::memcpy(pairs, &s.rows[y * CHUNK_SIZE], sizeof(pairs));
+            transpose32x2(pairs);
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                s.solid[2][y * CHUNK_SIZE + x] = static_cast<std::uint32_t>(pairs[x]);
+                s.opaque[2][y * CHUNK_SIZE + x] = static_cast<std::uint32_t>(pairs[x] >> 32);
+            }
+        }
+
+        for (int f = 0; f < FACE_COUNT; f++) {
+            const chunk* neighbor = n.faces[f];
+            const int axis = face_axis(static_cast<face>(f));
+            const int layer = (f & 1) == 0 ? 0 : CHUNK_SIZE - 1;
+            std::uint32_t* border = s.border[f];
+            std::uint32_t* border_translucent = s.border_translucent[f];
+
+            if (neighbor == nullptr || neighbor->is_uniform()) {
+                const std::uint8_t bits =
+                    neighbor != nullptr ? flags[neighbor->uniform_block()] : std::uint8_t{0};
+                const bool opaque = (bits & FLAG_OPAQUE) != 0;
+                const bool translucent = bits == FLAG_SOLID;
+                std::memset(border, opaque ? 0xFF : 0x00, sizeof(s.border[f]));
+                std::memset(border_translucent, translucent ? 0xFF : 0x00, sizeof(s.border[f]));
+                continue;
+            }
+
+            for (int a = 0; a < CHUNK_SIZE; a++) {
+                std::uint32_t opaque = 0;
+                std::uint32_t translucent = 0;
+                for (int b = 0; b < CHUNK_SIZE; b++) {
+                    const std::uint8_t bits = flags[neighbor->get(slice_index(axis, a, b, layer))];
+                    opaque |= static_cast<std::uint32_t>((bits & FLAG_OPAQUE) != 0) << b;
+                    translucent |= static_cast<std::uint32_t>(bits == FLAG_SOLID) << b;
+                }
+                border[a] = opaque;
+                border_translucent[a] = translucent;
+            }
+        }
+
+        const bool shaded =
+            m_settings.ambient_occlusion || (m_settings.smooth_light && n.center_light != nullptr);
+        if (shaded) {
+            std::memset(s.occluders_x, 0, sizeof(s.occluders_x));
+            std::memset(s.occluders_z, 0, sizeof(s.occluders_z));
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                std::uint64_t* x_rows = &s.occluders_x[(y + 1) * PADDED];
+                std::uint64_t* z_rows = &s.occluders_z[(y + 1) * PADDED];
+                for (int c = 0; c < CHUNK_SIZE; c++) {
+                    const int column = y * CHUNK_SIZE + c;
+                    x_rows[c + 1] = static_cast<std::uint64_t>(s.opaque[0][column]) << 1 |
+                                    ((s.border[FACE_NEG_X][y] >> c) & 1u) |
+                                    static_cast<std::uint64_t>((s.border[FACE_POS_X][y] >> c) & 1u)
+                                        << (CHUNK_SIZE + 1);
+                    z_rows[c + 1] = static_cast<std::uint64_t>(s.opaque[2][column]) << 1 |
+                                    ((s.border[FACE_NEG_Z][y] >> c) & 1u) |
+                                    static_cast<std::uint64_t>((s.border[FACE_POS_Z][y] >> c) & 1u)
+                                        << (CHUNK_SIZE + 1);
+                }
+                x_rows[0] = static_cast<std::uint64_t>(s.border[FACE_NEG_Z][y]) << 1;
+                x_rows[PADDED - 1] = static_cast<std::uint64_t>(s.border[FACE_POS_Z][y]) << 1;
+                z_rows[0] = static_cast<std::uint64_t>(s.border[FACE_NEG_X][y]) << 1;
+                z_rows[PADDED - 1] = static_cast<std::uint64_t>(s.border[FACE_POS_X][y]) << 1;
+            }
+            // The layers below and above, whose border rows run along x.
+            for (const face f : {FACE_NEG_Y, FACE_POS_Y}) {
+                const int row = f == FACE_NEG_Y ? 0 : (PADDED - 1) * PADDED;
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    s.occluders_x[row + z + 1] = static_cast<std::uint64_t>(s.border[f][z]) << 1;
+                }
+                for (int x = 0; x < CHUNK_SIZE; x++) {
+                    std::uint64_t bits = 0;
+                    for (int z = 0; z < CHUNK_SIZE; z++) {
+                        bits |= static_cast<std::uint64_t>((s.border[f][z] >> x) & 1u) << (z + 1);
+                    }
+                    s.occluders_z[row + x + 1] = bits;
+                }
+            }
+            // The edges and corners of the padding, from the diagonal neighbours: whole rows
+            // along x where y and z are both outside, the two ends of the rest.
+            for (int py = 0; py < PADDED; py++) {
+                const int dy = py == 0 ? -1 : (py == PADDED - 1 ? 1 : 0);
+                for (int pz = 0; pz < PADDED; pz++) {
+                    const int dz = pz == 0 ? -1 : (pz == PADDED - 1 ? 1 : 0);
+                    if (dy == 0 && dz == 0) {
+                        continue;
+                    }
+                    const int step = dy != 0 && dz != 0 ? 1 : PADDED - 1;
+                    for (int px = 0; px < PADDED; px += step) {
+                        const int dx = px == 0 ? -1 : (px == PADDED - 1 ? 1 : 0);
+                        if ((dx != 0) + (dy != 0) + (dz != 0) < 2) {
+                            continue;
+                        }
+                        const chunk* neighbor = n.diagonals[neighbor_index(dx, dy, dz)];
+                        if (neighbor == nullptr ||
+                            (flags[neighbor->get((px - 1) & (CHUNK_SIZE - 1),
+                                                 (py - 1) & (CHUNK_SIZE - 1),
+                                                 (pz - 1) & (CHUNK_SIZE - 1))] &
+                             FLAG_OPAQUE) == 0) {
+                            continue;
+                        }
+                        s.occluders_x[py * PADDED + pz] |= std::uint64_t{1} << px;
+                        s.occluders_z[py * PADDED + px] |= std::uint64_t{1} << pz;
+                    }
+                }
+            }
+            if (m_settings.smooth_light && n.center_light != nullptr) {
+                std::memset(s.light, 0, sizeof(s.light));
+                for (const nibble_array& channel : n.center_light->channels) {
+                    channel.unpack_max(s.light);
+                }
+            }
+        } else {
+            std::fill(&s.shades[0][0], &s.shades[0][0] + CHUNK_AREA, FLAT_SHADE);
+        }
+
+        const bool mask_translucent = one_translucent_kind();
+        for (int axis = 0; axis < 3; axis++) {
+            const face pos = static_cast<face>(axis * 2);
+            const face neg = face_opposite(pos);
+            const slice_axes stride = SLICE_STRIDES[axis];
+
+            // Cull: a face is visible when its voxel is solid and the next voxel along the
+            // normal is not opaque, with the neighbour layer shifted in as a 33rd bit. Both
+            // directions share a 64-bit column (+axis low, -axis high) and each row of columns is
+            // transposed so plane d holds bit b of row a.
+            for (int a = 0; a < CHUNK_SIZE; a++) {
+                std::uint64_t columns[CHUNK_SIZE];
+                for (int b = 0; b < CHUNK_SIZE; b++) {
+                    const int column = a * CHUNK_SIZE + b;
+                    const std::uint64_t solid = s.solid[axis][column];
+                    const std::uint64_t opaque = s.opaque[axis][column];
+                    const std::uint64_t translucent = solid & ~opaque;
+                    const std::uint64_t pos_edge = (s.border[pos][a] >> b) & 1u;
+                    const std::uint64_t neg_edge = (s.border[neg][a] >> b) & 1u;
+                    const std::uint64_t pos_edge_t = (s.border_translucent[pos][a] >> b) & 1u;
+                    const std::uint64_t neg_edge_t = (s.border_translucent[neg][a] >> b) & 1u;
+
+                    std::uint32_t visible[2] = {
+                        static_cast<std::uint32_t>(solid & ~((opaque >> 1) | (pos_edge << 31))),
+                        static_cast<std::uint32_t>(solid & ~((opaque << 1) | neg_edge)),
+                    };
+
+                    // Translucent blocks also hide faces against their own kind (water against
+                    // water). When several translucent kinds exist the pairs need a lookup.
+                    std::uint32_t pairs[2] = {
+                        static_cast<std::uint32_t>(translucent &
+                                                   ((translucent >> 1) | (pos_edge_t << 31))),
+                        static_cast<std::uint32_t>(translucent & ((translucent << 1) | neg_edge_t)),
+                    };
+
+                    for (int side = 0; side < 2; side++) {
+                        if (mask_translucent) {
+                            visible[side] &= ~pairs[side];
+                            continue;
+                        }
+
+                        while (pairs[side] != 0) {
+                            const int d = ctz32(pairs[side]);
+                            pairs[side] &= pairs[side] - 1;
+
+                            const int index = slice_index(axis, a, b, d);
+                            const int nd = side == 0 ? d + 1 : d - 1;
+                            block_id next;
+                            if (nd >= 0 && nd < CHUNK_SIZE) {
+                                next = s.blocks[index + (side == 0 ? stride.d : -stride.d)];
+                            } else {
+                                const chunk* neighbor = n.faces[side == 0 ? pos : neg];
+                                next = neighbor->get(
+                                    slice_index(axis, a, b, nd & (CHUNK_SIZE - 1)));
+                            }
+
+                            if (next == s.blocks[index]) {
+                                visible[side] &= ~(1u << d);
+                            }
+                        }
+                    }
+
+                    columns[b] = visible[0] | static_cast<std::uint64_t>(visible[1]) << 32;
+                }
+
+                transpose32x2(columns);
+                for (int d = 0; d < CHUNK_SIZE; d++) {
+                    s.planes[0][d][a] = static_cast<std::uint32_t>(columns[d]);
+                    s.planes[1][d][a] = static_cast<std::uint32_t>(columns[d] >> 32);
+                }
+            }
+
+            for (int d = 0; d < CHUNK_SIZE; d++) {
+                for (const face dir : {pos, neg}) {
+                    if (shaded) {
+                        shade_slice(n, axis, d, dir);
+                    }
+                    merge_slice(s.planes[dir & 1][d], s.blocks, s.shades, axis, d, dir, out);
+                }
+            }
+        }
+    }
+
+    void mesher::shade_slice(const chunk_neighborhood& n, int axis, int d, face dir) {
+        scratch& s = *m_scratch;
+        const bool ao = m_settings.ambient_occlusion;
+        const bool smooth = m_settings.smooth_light && n.center_light != nullptr;
+        const int front = (dir & 1) == 0 ? d + 1 : d - 1;
+
+        // Rows of the layer in front of the faces along b, one per a: X faces read rows along
+        // z, Y and Z faces rows along x.
+        const std::uint64_t* rows = axis == 0 ? &s.occluders_z[front + 1]
+                                              : (axis == 1 ? &s.occluders_x[(front + 1) * PADDED]
+                                                           : &s.occluders_x[front + 1]);
+        const int row_stride = axis == 1 ? 1 : PADDED;
+        const slice_axes stride = SLICE_STRIDES[axis];
+
+        // Light of a voxel of the padded chunk, or -1 where it is not known.
+        const auto light_at = [&](const voxel_coords& v) {
+            if (static_cast<unsigned>(v.x | v.y | v.z) < CHUNK_SIZE) {
+                return static_cast<int>(s.light[chunk_index(v.x, v.y, v.z)]);
+            }
+            const chunk_light* light = nullptr;
+            int outside = 0;
+            const int coords[3] = {v.x, v.y, v.z};
+            for (int i = 0; i < 3; i++) {
+                if (coords[i] < 0 || coords[i] >= CHUNK_SIZE) {
+                    light = n.face_lights[i * 2 + (coords[i] < 0 ? 1 : 0)];
+                    outside++;
+                }
+            }
+            if (light == nullptr || outside > 1) {
+                return -1;
+            }
+            const int index =
+                chunk_index(v.x & (CHUNK_SIZE - 1), v.y & (CHUNK_SIZE - 1), v.z & (CHUNK_SIZE - 1));
+            return static_cast<int>(std::max(light->channels[LIGHT_SKY].get(index),
+                                             light->channels[LIGHT_BLOCK].get(index)));
+        };
+
+        for (int a = 0; a < CHUNK_SIZE; a++) {
+            for (std::uint32_t bits = s.planes[dir & 1][d][a]; bits != 0; bits &= bits - 1) {
+                const int b = ctz32(bits);
+
+                // The 3x3 voxels in front of the face, bit (v + 1) * 3 + u + 1 set if opaque.
+                const std::uint32_t opaque = static_cast<std::uint32_t>(
+                    ((rows[a * row_stride] >> b) & 7u) |
+                    ((rows[(a + 1) * row_stride] >> b) & 7u) << 3 |
+                    ((rows[(a + 2) * row_stride] >> b) & 7u) << 6);
+                std::uint32_t shade = FLAT_SHADE;
+                if (ao) {
+                    shade &= ~static_cast<std::uint32_t>(occlusion_table()[opaque]);
+                }
+                if (smooth) {
+                    // Away from the chunk's sides all nine voxels are read straight from the
+                    // unpacked light.
+                    const bool inside = front >= 0 && front < CHUNK_SIZE && a > 0 &&
+                                        a < CHUNK_SIZE - 1 && b > 0 && b < CHUNK_SIZE - 1;
+                    const int center = slice_index(axis, a, b, front);
+                    int light[3][3];
+                    int darkest = MAX_LIGHT + 1;
+                    int brightest = -1;
+                    for (int v = 0; v < 3; v++) {
+                        for (int u = 0; u < 3; u++) {
+                            int sample = -1;
+                            if (((opaque >> (v * 3 + u)) & 1u) != 0) {
+                                // Opaque voxels are dark inside and left out.
+                            } else if (inside) {
+                                sample = s.light[center + (v - 1) * stride.a + (u - 1) * stride.b];
+                            } else {
+                                sample = light_at(slice_voxel(axis, a + v - 1, b + u - 1, front));
+                            }
+                            light[v][u] = sample;
+                            if (sample >= 0) {
+                                darkest = std::min(darkest, sample);
+                                brightest = std::max(brightest, sample);
+                            }
+                        }
+                    }
+
+                    // Evenly lit surroundings, open sky or a dark cave, give every corner the
+                    // same light whatever blocks it.
+                    if (darkest == brightest) {
+                        shade &= ~(static_cast<std::uint32_t>(15 - darkest) * 0x1111u << 8);
+                    } else if (brightest >= 0) {
+                        for (int corner = 0; corner < 4; corner++) {
+                            const int u = corner == 1 || corner == 2 ? 2 : 0;
+                            const int v = corner >= 2 ? 2 : 0;
+                            // The diagonal voxel is hidden from the corner behind two opaque
+                            // sides.
+                            const bool hidden =
+                                ((opaque >> (3 + u)) & (opaque >> (v * 3 + 1)) & 1u) != 0;
+                            const int samples[4] = {light[1][1], light[1][u], light[v][1],
+                                                    hidden ? -1 : light[v][u]};
+                            int sum = 0;
+                            int count = 0;
+                            for (const int sample : samples) {
+                                if (sample >= 0) {
+                                    sum += sample;
+                                    count++;
+                                }
+                            }
+                            const std::uint32_t mean = count > 0 ? sum / count : MAX_LIGHT;
+                            shade &= ~(static_cast<std::uint32_t>(15u - mean) << (8 + corner * 4));
+                        }
+                    }
+                }
+                s.shades[a][b] = shade;
+            }
+        }
+    }
+}  // namespace qc
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include "mesh/quad.hpp"
+#include "world/chunk.hpp"
+#include "world/face.hpp"
+#include "world/light.hpp"
+
+namespace qc {
+    // The chunk being meshed and its six face neighbours. Missing neighbours count as air.
+    // Without light for the center every face is baked full bright.
+    struct chunk_neighborhood {
+        const chunk* center = nullptr;
+        const chunk* faces[FACE_COUNT] = {};
+        // The chunks sharing only an edge or a corner with the center, indexed by
+        // neighbor_index(); the other entries are not read. They only feed ambient occlusion.
+        const chunk* diagonals[NEIGHBOR_COUNT] = {};
+        const chunk_light* center_light = nullptr;
+        const chunk_light* face_lights[FACE_COUNT] = {};
+    };
+
+    struct mesher_settings {
+        // Darkens each corner of a face by the opaque blocks around it.
+        bool ambient_occlusion = true;
+        // Gives each corner of a face the mean light of the clear voxels around it.
+        bool smooth_light = true;
+    };
+
+    // Binary greedy mesher. Occupancy is kept as one bitmask per voxel column along each axis
+    // (32 voxels plus one bit of neighbour padding at either end), so face culling is a shift and
+    // an and-not per column and merging walks set bits with count-trailing-zeros.
+    //
+    // Ambient occlusion and smooth light are baked into the corners of each face from the layer
+    // of voxels in front of it. Faces only merge when their corners match and the quad they form
+    // would interpolate to the same values, so flat, evenly lit ground still merges into large
+    // quads. Voxels of the edge and corner neighbours occlude but are left out of the light.
+    //
+    // A mesher owns about 160 KiB of scratch memory and is reused between chunks; give each
+    // thread its own.
+    class mesher {
+    public:
+        explicit mesher(const mesher_settings& settings = {});
+        ~mesher();
+
+        mesher(const mesher&) = delete;
+        mesher& operator=(const mesher&) = delete;
+
+        // Appends the quads of `n.center` to `out`. With a vector on an arena (core/arena.hpp)
+        // that has reached its working size, meshing makes no heap allocations at all.
+        void build(const chunk_neighborhood& n, std::vector<packed_quad>& out);
+        void build(const chunk_neighborhood& n, std::pmr::vector<packed_quad>& out);
+
+    private:
+        struct scratch;
+
+        template <typename Quads>
+        void build_quads(const chunk_neighborhood& n, Quads& out);
+
+        // Fills the shading of every visible face of slice `d` facing `dir`.
+        void shade_slice(const chunk_neighborhood& n, int axis, int d, face dir);
+
+        mesher_settings m_settings;
+        std::unique_ptr<scratch> m_scratch;
+    };
+}  // namespace qc
@@ -0,0 +1,40 @@
+#include "mesh/quad.hpp"
+
+namespace qc {
+    namespace {
+        // Keep these tables in step with render/shaders.cpp.
+        constexpr int U_AXIS[3] = {2, 0, 0};
+        constexpr int V_AXIS[3] = {1, 2, 1};
+
+        // Corner order for the two triangles, split along 0-2 or, when flipped, along 1-3.
+        constexpr int CORNERS[2][6] = {{0, 1, 2, 0, 2, 3}, {1, 2, 3, 1, 3, 0}};
+
+        // Faces whose (u, v) basis points into the block and so wind the other way round.
+        constexpr bool REVERSED[FACE_COUNT] = {true, false, true, false, false, true};
+    }  // namespace
+
+    quad_vertex expand_quad(packed_quad p, int vertex) {
+        const quad_desc q = decode_quad(p);
+        const int axis = face_axis(q.dir);
+
+        // Split along the diagonal with the brighter ends so AO interpolates without creases.
+        const bool flip = q.ao[1] + q.ao[3] > q.ao[0] + q.ao[2];
+
+        if (REVERSED[q.dir] && vertex % 3 != 0) {
+            vertex += vertex % 3 == 1 ? 1 : -1;
+        }
+
+        const int corner = CORNERS[flip ? 1 : 0][vertex];
+        const int u = corner == 1 || corner == 2 ? q.width : 0;
+        const int v = corner >= 2 ? q.height : 0;
+
+        int pos[3] = {q.x, q.y, q.z};
+        pos[U_AXIS[axis]] += u;
+        pos[V_AXIS[axis]] += v;
+        if ((q.dir & 1) == 0) {
+            pos[axis] += 1;
+        }
+
+        return {pos[0], pos[1], pos[2], corner};
+    }
+}  // namespace qc
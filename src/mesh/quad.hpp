@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#include "world/face.hpp"
+
+namespace qc {
+    // A merged face as the GPU sees it: two 32-bit words per quad, read from a shader storage
+    // buffer and expanded into two triangles by quad.vert using gl_VertexID.
+    //
+    //   lo  bits  0..14  x, y, z of the minimum voxel (5 bits each)
+    //       bits 15..17  face direction
+    //       bits 18..22  width - 1 along the face's u axis
+    //       bits 23..27  height - 1 along the face's v axis
+    //       bits 28..31  reserved
+    //   hi  bits  0..7   texture array layer
+    //       bits  8..15  ambient occlusion, 2 bits per corner (3 = unoccluded)
+    //       bits 16..31  light, 4 bits per corner (15 = full bright)
+    //
+    // (x, y, z) is the minimum voxel covered by the quad; width runs along the face's u axis and
+    // height along its v axis:
+    //   X faces: u = z, v = y    Y faces: u = x, v = z    Z faces: u = x, v = y
+    // Corners are numbered in (u, v) order: 0 = (0, 0), 1 = (w, 0), 2 = (w, h), 3 = (0, h).
+    struct packed_quad {
+        std::uint32_t lo;
+        std::uint32_t hi;
+    };
+
+    static_assert(sizeof(packed_quad) == 8, "packed_quad must stay 8 bytes");
+
+    // Unpacked form of a packed_quad.
+    struct quad_desc {
+        std::uint8_t x;
+        std::uint8_t y;
+        std::uint8_t z;
+        face dir;
+        std::uint8_t width;
+        std::uint8_t height;
+        std::uint8_t layer;
+        std::uint8_t ao[4] = {3, 3, 3, 3};
+        std::uint8_t light[4] = {15, 15, 15, 15};
+    };
+
+    constexpr packed_quad encode_quad(const quad_desc& q) {
+        packed_quad p{0, 0};
+        p.lo = static_cast<std::uint32_t>(q.x) | static_cast<std::uint32_t>(q.y) << 5 |
+               static_cast<std::uint32_t>(q.z) << 10 | static_cast<std::uint32_t>(q.dir) << 15 |
+               static_cast<std::uint32_t>(q.width - 1) << 18 |
+               static_cast<std::uint32_t>(q.height - 1) << 23;
+        p.hi = q.layer;
+        for (int corner = 0; corner < 4; corner++) {
+            p.hi |= static_cast<std::uint32_t>(q.ao[corner] & 3u) << (8 + corner * 2);
+            p.hi |= static_cast<std::uint32_t>(q.light[corner] & 15u) << (16 + corner * 4);
+        }
+        return p;
+    }
+
+    constexpr quad_desc decode_quad(packed_quad p) {
+        quad_desc q{};
+        q.x = static_cast<std::uint8_t>(p.lo & 31u);
+        q.y = static_cast<std::uint8_t>((p.lo >> 5) & 31u);
+        q.z = static_cast<std::uint8_t>((p.lo >> 10) & 31u);
+        q.dir = static_cast<face>((p.lo >> 15) & 7u);
+        q.width = static_cast<std::uint8_t>(((p.lo >> 18) & 31u) + 1);
+        q.height = static_cast<std::uint8_t>(((p.lo >> 23) & 31u) + 1);
+        q.layer = static_cast<std::uint8_t>(p.hi & 255u);
+        for (int corner = 0; corner < 4; corner++) {
+            q.ao[corner] = static_cast<std::uint8_t>((p.hi >> (8 + corner * 2)) & 3u);
+            q.light[corner] = static_cast<std::uint8_t>((p.hi >> (16 + corner * 4)) & 15u);
+        }
+        return q;
+    }
+
+    // Chunk-local position of vertex `vertex` (0..5) of a quad, computed exactly as quad.vert
+    // does so the expansion can be checked without a GPU.
+    struct quad_vertex {
+        int x;
+        int y;
+        int z;
+        int corner;
+    };
+
+    quad_vertex expand_quad(packed_quad p, int vertex);
+}  // namespace qc
@@ -0,0 +1,67 @@
+#include "net/connection.hpp"
+
+namespace qc {
+    void connection::send(std::uint8_t type, const std::uint8_t* payload, std::size_t size) {
+        const std::uint32_t length = static_cast<std::uint32_t>(size);
+        std::uint8_t header[HEADER_SIZE];
+        std::memcpy(header, &length, sizeof(length));
+        header[4] = type;
+        m_out.insert(m_out.end(), header, header + HEADER_SIZE);
+        m_out.insert(m_out.end(), payload, payload + size);
+    }
+
+    bool connection::flush() {
+        if (!m_socket.valid()) {
+            return false;
+        }
+        while (m_out_at < m_out.size()) {
+            const long sent = m_socket.send(m_out.data() + m_out_at, m_out.size() - m_out_at);
+            if (sent < 0) {
+                m_socket.close();
+                return false;
+            }
+            if (sent == 0) {
+                break;
+            }
+            m_out_at += static_cast<std::size_t>(sent);
+        }
+        // Drop what went out once it is worth the move.
+        if (m_out_at == m_out.size()) {
+            m_out.clear();
+            m_out_at = 0;
+        } else if (m_out_at >= 64 * 1024 && m_out_at * 2 >= m_out.size()) {
+            m_out.erase(m_out.begin(), m_out.begin() + static_cast<std::ptrdiff_t>(m_out_at));
+            m_out_at = 0;
+        }
+        return true;
+    }
+
+    bool connection::read_available() {
+        if (!m_socket.valid()) {
+            return false;
+        }
+        std::uint8_t buffer[16 * 1024];
+        for (;;) {
+            const long received = m_socket.receive(buffer, sizeof(buffer));
+            if (received < 0) {
+                m_socket.close();
+                return false;
+            }
+            if (received == 0) {
+                break;
+            }
+            m_in.insert(m_in.end(), buffer, buffer + received);
+            // Check each header as soon as it arrives, before buffering the message behind it.
+            while (m_in.size() >= m_next_header + HEADER_SIZE) {
+                std::uint32_t size = 0;
+                std::memcpy(&size, &m_in[m_next_header], sizeof(size));
+                if (size > MAX_MESSAGE_SIZE) {
+                    m_socket.close();
+                    return false;
+                }
+                m_next_header += HEADER_SIZE + size;
+            }
+        }
+        return true;
+    }
+}  // namespace qc
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "net/socket.hpp"
+
+namespace qc {
+    // Longer messages mean a broken or hostile peer, and close the connection.
+    constexpr std::size_t MAX_MESSAGE_SIZE = 1 << 20;
+
+    // Messages over a TCP socket, each a 32-bit payload size, a type byte and the payload. Sizes
+    // are sent in host order, assumed little-endian as in chunk::encode(). Both directions are
+    // buffered, so neither side ever waits on the other.
+    class connection {
+    public:
+        connection() = default;
+        explicit connection(tcp_socket socket) : m_socket(std::move(socket)) {
+        }
+
+        bool open() const {
+            return m_socket.valid();
+        }
+
+        // Queues a message; flush() sends it.
+        void send(std::uint8_t type, const std::uint8_t* payload, std::size_t size);
+
+        // Sends what the socket takes. Returns false, closing the connection, once it is lost.
+        bool flush();
+
+        // Reads what has arrived and calls fn(type, payload, size) for every complete message.
+        // Returns false, closing the connection, once the peer has gone or sent garbage.
+        template <typename F>
+        bool receive(F&& fn) {
+            if (!read_available()) {
+                return false;
+            }
+            std::size_t at = 0;
+            while (m_in.size() - at >= HEADER_SIZE) {
+                std::uint32_t size = 0;
+                std::memcpy(&size, &m_in[at], sizeof(size));
+                if (m_in.size() - at - HEADER_SIZE < size) {
+                    break;
+                }
+                fn(m_in[at + 4], m_in.data() + at + HEADER_SIZE, static_cast<std::size_t>(size));
+                at += HEADER_SIZE + size;
+            }
+            m_in.erase(m_in.begin(), m_in.begin() + static_cast<std::ptrdiff_t>(at));
+            m_next_header -= at;
+            return true;
+        }
+
+        // Bytes queued but not yet taken by the socket.
+        std::size_t queued_bytes() const {
+            return m_out.size() - m_out_at;
+        }
+
+        void close() {
+            m_socket.close();
+        }
+
+    private:
+        static constexpr std::size_t HEADER_SIZE = 5;
+
+        // Appends whatever the socket holds to m_in; false if the connection is gone or any
+        // message in it is too long.
+        bool read_available();
+
+        tcp_socket m_socket;
+        std::vector<std::uint8_t> m_out;
+        std::size_t m_out_at = 0;
+        std::vector<std::uint8_t> m_in;
+        // Offset in m_in of the first header read_available() has not checked yet.
+        std::size_t m_next_header = 0;
+    };
+}  // namespace qc
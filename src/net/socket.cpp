@@ -0,0 +1,229 @@
+#include "net/socket.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <utility>
+
+#include "core/log.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace qc {
+    namespace {
+#if defined(_WIN32)
+        using native_socket = SOCKET;
+
+        int last_error() {
+            return WSAGetLastError();
+        }
+
+        bool would_block() {
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+
+        void close_native(native_socket s) {
+            closesocket(s);
+        }
+
+        bool set_non_blocking(native_socket s) {
+            u_long on = 1;
+            return ioctlsocket(s, FIONBIO, &on) == 0;
+        }
+
+        // Winsock needs starting once per process before the first socket.
+        bool start_sockets() {
+            static const bool started = [] {
+                WSADATA data;
+                return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }();
+            return started;
+        }
+#else
+        using native_socket = int;
+
+        int last_error() {
+            return errno;
+        }
+
+        bool would_block() {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+
+        void close_native(native_socket s) {
+            ::close(s);
+        }
+
+        bool set_non_blocking(native_socket s) {
+            const int flags = fcntl(s, F_GETFL, 0);
+            return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+        }
+
+        bool start_sockets() {
+            return true;
+        }
+#endif
+
+        spdlog::logger& net_log() {
+            return subsystem_logger(LOG_NET);
+        }
+
+        bool make_address(const char* address, std::uint16_t port, sockaddr_in& out) {
+            out = {};
+            out.sin_family = AF_INET;
+            out.sin_port = htons(port);
+            if (inet_pton(AF_INET, address, &out.sin_addr) != 1) {
+                net_log().error("not an IPv4 address: {}", address);
+                return false;
+            }
+            return true;
+        }
+
+        // Game traffic is many small messages that should leave at once. Where send() cannot
+        // be told not to raise SIGPIPE, the socket is.
+        void set_options(native_socket s) {
+            int on = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on),
+                       sizeof(on));
+#if defined(SO_NOSIGPIPE)
+            setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        }
+    }  // namespace
+
+    tcp_socket::~tcp_socket() {
+        close();
+    }
+
+    tcp_socket::tcp_socket(tcp_socket&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, INVALID)) {
+    }
+
+    tcp_socket& tcp_socket::operator=(tcp_socket&& other) noexcept {
+        if (this != &other) {
+            close();
+            m_handle = std::exchange(other.m_handle, INVALID);
+        }
+        return *this;
+    }
+
+    tcp_socket tcp_socket::listen(const char* address, std::uint16_t port) {
+        sockaddr_in addr;
+        if (!start_sockets() || !make_address(address, port, addr)) {
+            return tcp_socket();
+        }
+        const native_socket s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        tcp_socket result(static_cast<handle>(s));
+        if (!result.valid()) {
+            net_log().error("cannot create a socket: error {}", last_error());
+            return result;
+        }
+        int on = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&on), sizeof(on));
+        if (::bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(s, SOMAXCONN) != 0 || !set_non_blocking(s)) {
+            net_log().error("cannot listen on {}:{}: error {}", address, port, last_error());
+            return tcp_socket();
+        }
+        return result;
+    }
+
+    tcp_socket tcp_socket::connect(const char* address, std::uint16_t port) {
+        sockaddr_in addr;
+        if (!start_sockets() || !make_address(address, port, addr)) {
+            return tcp_socket();
+        }
+        const native_socket s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        tcp_socket result(static_cast<handle>(s));
+        if (!result.valid()) {
+            net_log().error("cannot create a socket: error {}", last_error());
+            return result;
+        }
+        if (::connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            !set_non_blocking(s)) {
+            net_log().error("cannot connect to {}:{}: error {}", address, port, last_error());
+            return tcp_socket();
+        }
+        set_options(s);
+        return result;
+    }
+
+    tcp_socket tcp_socket::accept() {
+        const native_socket s = ::accept(static_cast<native_socket>(m_handle), nullptr, nullptr);
+        tcp_socket result(static_cast<handle>(s));
+        if (!result.valid()) {
+            if (!would_block()) {
+                net_log().warn("accept failed: error {}", last_error());
+            }
+            return result;
+        }
+        if (!set_non_blocking(s)) {
+            net_log().warn("cannot make an accepted socket non-blocking: error {}", last_error());
+            return tcp_socket();
+        }
+        set_options(s);
+        return result;
+    }
+
+    std::uint16_t tcp_socket::local_port() const {
+        sockaddr_in addr = {};
+        socklen_t size = sizeof(addr);
+        if (getsockname(static_cast<native_socket>(m_handle), reinterpret_cast<sockaddr*>(&addr),
+                        &size) != 0) {
+            return 0;
+        }
+        return ntohs(addr.sin_port);
+    }
+
+    long tcp_socket::send(const void* data, std::size_t size) {
+#if defined(_WIN32)
+        const int sent = ::send(static_cast<native_socket>(m_handle),
+                                static_cast<const char*>(data), static_cast<int>(size), 0);
+#elif defined(MSG_NOSIGNAL)
+        const ssize_t sent =
+            ::send(static_cast<native_socket>(m_handle), data, size, MSG_NOSIGNAL);
+#else
+        const ssize_t sent = ::send(static_cast<native_socket>(m_handle), data, size, 0);
+#endif
+        if (sent < 0) {
+            return would_block() ? 0 : -1;
+        }
+        return static_cast<long>(sent);
+    }
+
+    long tcp_socket::receive(void* data, std::size_t size) {
+#if defined(_WIN32)
+        const int received = ::recv(static_cast<native_socket>(m_handle), static_cast<char*>(data),
+                                    static_cast<int>(size), 0);
+#else
+        const ssize_t received = ::recv(static_cast<native_socket>(m_handle), data, size, 0);
+#endif
+        if (received == 0) {
+            return -1;
+        }
+        if (received < 0) {
+            return would_block() ? 0 : -1;
+        }
+        return static_cast<long>(received);
+    }
+
+    void tcp_socket::close() {
+        if (valid()) {
+            close_native(static_cast<native_socket>(m_handle));
+            m_handle = INVALID;
+        }
+    }
+}  // namespace qc
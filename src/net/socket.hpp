@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace qc {
+    // A non-blocking TCP socket over IPv4, just what the dedicated server and its simulated
+    // clients need. Invalid sockets stand for failures, which are logged.
+    class tcp_socket {
+    public:
+        tcp_socket() = default;
+        ~tcp_socket();
+
+        tcp_socket(tcp_socket&& other) noexcept;
+        tcp_socket& operator=(tcp_socket&& other) noexcept;
+        tcp_socket(const tcp_socket&) = delete;
+        tcp_socket& operator=(const tcp_socket&) = delete;
+
+        // Listens on `port` of the dotted IPv4 `address`; port 0 picks a free one.
+        static tcp_socket listen(const char* address, std::uint16_t port);
+
+        // Connects to a listening socket, waiting for the connection to be made.
+        static tcp_socket connect(const char* address, std::uint16_t port);
+
+        // The next pending connection of a listening socket, or an invalid socket if none is.
+        tcp_socket accept();
+
+        bool valid() const {
+            return m_handle != INVALID;
+        }
+
+        std::uint16_t local_port() const;
+
+        // Send and receive move what they can without waiting and return the byte count: 0 when
+        // nothing could move right now, -1 once the connection is closed or lost.
+        long send(const void* data, std::size_t size);
+        long receive(void* data, std::size_t size);
+
+        void close();
+
+    private:
+        // Wide enough for a Winsock SOCKET as well as a file descriptor.
+        using handle = std::uintptr_t;
+        static constexpr handle INVALID = ~handle{0};
+
+        explicit tcp_socket(handle h) : m_handle(h) {
+        }
+
+        handle m_handle = INVALID;
+    };
+}  // namespace qc
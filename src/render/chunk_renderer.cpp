@@ -0,0 +1,135 @@
+#include "render/chunk_renderer.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "core/profile.hpp"
+
+namespace qc {
+    namespace {
+        constexpr std::size_t INITIAL_DRAWS = 1024;
+    }  // namespace
+
+    chunk_renderer::chunk_renderer(const gl_functions& gl, std::uint32_t capacity) : m_gl(gl) {
+        m_gl.gen_vertex_arrays(1, &m_vertex_array);
+        m_gl.gen_buffers(1, &m_command_buffer);
+        m_gl.gen_buffers(1, &m_origin_buffer);
+        grow(std::max<std::uint32_t>(capacity, 1));
+
+        m_draw_capacity = INITIAL_DRAWS;
+        m_gl.bind_buffer(gl::DRAW_INDIRECT_BUFFER, m_command_buffer);
+        m_gl.buffer_data(gl::DRAW_INDIRECT_BUFFER,
+                         m_draw_capacity * sizeof(draw_arrays_indirect_command), nullptr,
+                         gl::STREAM_DRAW);
+
+        // The origin attribute advances once per instance; a command's base instance is its
+        // index in the origin buffer.
+        m_gl.bind_vertex_array(m_vertex_array);
+        m_gl.bind_buffer(gl::ARRAY_BUFFER, m_origin_buffer);
+        m_gl.buffer_data(gl::ARRAY_BUFFER, m_draw_capacity * sizeof(glm::ivec3), nullptr,
+                         gl::STREAM_DRAW);
+        m_gl.enable_vertex_attrib_array(0);
+        m_gl.vertex_attrib_i_pointer(0, 3, gl::INT, sizeof(glm::ivec3), nullptr);
+        m_gl.vertex_attrib_divisor(0, 1);
+        m_gl.bind_vertex_array(0);
+    }
+
+    chunk_renderer::~chunk_renderer() {
+        const std::uint32_t buffers[] = {m_quad_buffer, m_command_buffer, m_origin_buffer};
+        m_gl.delete_buffers(3, buffers);
+        m_gl.delete_vertex_arrays(1, &m_vertex_array);
+    }
+
+    void chunk_renderer::upload(const glm::ivec3& pos, const packed_quad* quads,
+                                std::size_t count) {
+        // Freeing first lets a remeshed chunk that did not grow keep its place.
+        remove(pos);
+        if (count == 0) {
+            return;
+        }
+        assert(count <= UINT32_MAX / 6);
+        const std::uint32_t size = static_cast<std::uint32_t>(count);
+        std::uint32_t offset = m_arena.allocate(size);
+        if (offset == range_allocator::INVALID) {
+            grow(std::max(m_arena.capacity() * 2, m_arena.capacity() + size));
+            offset = m_arena.allocate(size);
+            assert(offset != range_allocator::INVALID);
+        }
+        m_meshes.emplace(pos, mesh_range{offset, size});
+        m_bounds.insert(pos, chunk_bounds(pos));
+
+        m_gl.bind_buffer(gl::COPY_WRITE_BUFFER, m_quad_buffer);
+        m_gl.buffer_sub_data(gl::COPY_WRITE_BUFFER,
+                             static_cast<std::ptrdiff_t>(offset) * sizeof(packed_quad),
+                             static_cast<std::ptrdiff_t>(size) * sizeof(packed_quad),
+                             quads);
+    }
+
+    void chunk_renderer::remove(const glm::ivec3& pos) {
+        const auto it = m_meshes.find(pos);
+        if (it == m_meshes.end()) {
+            return;
+        }
+        m_arena.release(it->second.offset, it->second.size);
+        m_meshes.erase(it);
+        m_bounds.erase(pos);
+    }
+
+    std::size_t chunk_renderer::draw(const std::vector<glm::ivec3>& chunks) {
+        QC_PROFILE_ZONE("render.draw");
+        m_commands.clear();
+        m_origins.clear();
+        for (const glm::ivec3& pos : chunks) {
+            const auto it = m_meshes.find(pos);
+            if (it == m_meshes.end()) {
+                continue;
+            }
+            const std::uint32_t index = static_cast<std::uint32_t>(m_commands.size());
+            m_commands.push_back({it->second.size * 6, 1, it->second.offset * 6, index});
+            m_origins.push_back(pos * CHUNK_SIZE);
+        }
+        if (m_commands.empty()) {
+            return 0;
+        }
+
+        // Respecifying the whole store orphans the previous frame's data instead of waiting for
+        // the GPU to finish reading it.
+        const std::size_t count = m_commands.size();
+        while (m_draw_capacity < count) {
+            m_draw_capacity *= 2;
+        }
+        m_gl.bind_vertex_array(m_vertex_array);
+        m_gl.bind_buffer(gl::ARRAY_BUFFER, m_origin_buffer);
+        m_gl.buffer_data(gl::ARRAY_BUFFER, m_draw_capacity * sizeof(glm::ivec3), nullptr,
+                         gl::STREAM_DRAW);
+        m_gl.buffer_sub_data(gl::ARRAY_BUFFER, 0, count * sizeof(glm::ivec3), m_origins.data());
+        m_gl.bind_buffer(gl::DRAW_INDIRECT_BUFFER, m_command_buffer);
+        m_gl.buffer_data(gl::DRAW_INDIRECT_BUFFER,
+                         m_draw_capacity * sizeof(draw_arrays_indirect_command), nullptr,
+                         gl::STREAM_DRAW);
+        m_gl.buffer_sub_data(gl::DRAW_INDIRECT_BUFFER, 0,
+                             count * sizeof(draw_arrays_indirect_command), m_commands.data());
+        m_gl.bind_buffer_base(gl::SHADER_STORAGE_BUFFER, 0, m_quad_buffer);
+        m_gl.multi_draw_arrays_indirect(gl::TRIANGLES, nullptr, static_cast<int>(count), 0);
+        m_gl.bind_vertex_array(0);
+        return count;
+    }
+
+    void chunk_renderer::grow(std::uint32_t capacity) {
+        std::uint32_t buffer = 0;
+        m_gl.gen_buffers(1, &buffer);
+        m_gl.bind_buffer(gl::COPY_WRITE_BUFFER, buffer);
+        m_gl.buffer_data(gl::COPY_WRITE_BUFFER,
+                         static_cast<std::ptrdiff_t>(capacity) * sizeof(packed_quad), nullptr,
+                         gl::DYNAMIC_DRAW);
+        if (m_quad_buffer != 0) {
+            m_gl.bind_buffer(gl::COPY_READ_BUFFER, m_quad_buffer);
+            m_gl.copy_buffer_sub_data(
+                gl::COPY_READ_BUFFER, gl::COPY_WRITE_BUFFER, 0, 0,
+                static_cast<std::ptrdiff_t>(m_arena.capacity()) * sizeof(packed_quad));
+            m_gl.delete_buffers(1, &m_quad_buffer);
+        }
+        m_quad_buffer = buffer;
+        m_arena.grow(capacity);
+    }
+}  // namespace qc
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "mesh/quad.hpp"
+#include "render/frustum.hpp"
+#include "render/gl_api.hpp"
+#include "render/range_allocator.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // Draws every chunk with one glMultiDrawArraysIndirect call.
+    //
+    // All meshes live in one shader storage buffer of packed_quads (the arena), suballocated by
+    // a range_allocator in units of quads; the arena doubles, copying on the GPU, when a mesh no
+    // longer fits. Each draw gets one indirect command whose `first` is its mesh's offset in
+    // vertices, so gl_VertexID / 6 indexes the arena directly, and whose base instance selects
+    // its chunk origin from a per-draw instanced attribute (location 0). Needs QUAD_VERTEX_SHADER
+    // bound, with its u_view_projection set by the caller.
+    class chunk_renderer {
+    public:
+        static constexpr std::uint32_t DEFAULT_CAPACITY = 1 << 20;
+
+        // `capacity` is the arena's initial size in quads.
+        explicit chunk_renderer(const gl_functions& gl,
+                                std::uint32_t capacity = DEFAULT_CAPACITY);
+        ~chunk_renderer();
+
+        chunk_renderer(const chunk_renderer&) = delete;
+        chunk_renderer& operator=(const chunk_renderer&) = delete;
+
+        // Replaces the mesh of chunk `pos`; an empty mesh removes it.
+        void upload(const glm::ivec3& pos, const packed_quad* quads, std::size_t count);
+
+        void upload(const glm::ivec3& pos, const std::vector<packed_quad>& quads) {
+            upload(pos, quads.data(), quads.size());
+        }
+        void remove(const glm::ivec3& pos);
+
+        // Draws the given chunks, in order, skipping those without a mesh. Returns the number of
+        // indirect commands issued.
+        std::size_t draw(const std::vector<glm::ivec3>& chunks);
+
+        // The commands and origins written by the last draw(), one entry per command.
+        const std::vector<draw_arrays_indirect_command>& commands() const {
+            return m_commands;
+        }
+
+        const std::vector<glm::ivec3>& origins() const {
+            return m_origins;
+        }
+
+        std::size_t mesh_count() const {
+            return m_meshes.size();
+        }
+
+        // The chunk_bounds() of every chunk with a mesh, keyed by position, for frustum::cull().
+        const bounds_table& bounds() const {
+            return m_bounds;
+        }
+
+        const range_allocator& arena() const {
+            return m_arena;
+        }
+
+    private:
+        struct mesh_range {
+            std::uint32_t offset;
+            std::uint32_t size;
+        };
+
+        // Reallocates the arena with room for at least `capacity` quads.
+        void grow(std::uint32_t capacity);
+
+        gl_functions m_gl;
+        range_allocator m_arena;
+        std::unordered_map<glm::ivec3, mesh_range, chunk_pos_hash> m_meshes;
+        bounds_table m_bounds;
+
+        std::uint32_t m_vertex_array = 0;
+        std::uint32_t m_quad_buffer = 0;
+        std::uint32_t m_command_buffer = 0;
+        std::uint32_t m_origin_buffer = 0;
+        // Draws the command and origin buffers have room for.
+        std::size_t m_draw_capacity = 0;
+
+        std::vector<draw_arrays_indirect_command> m_commands;
+        std::vector<glm::ivec3> m_origins;
+    };
+}  // namespace qc
@@ -0,0 +1,107 @@
+#include "render/frustum.hpp"
+
+#include <algorithm>
+
+#include "core/profile.hpp"
+#include "render/frustum_kernel.hpp"
+
+namespace qc {
+    void bounds_table::insert(const glm::ivec3& key, const aabb& box) {
+        const float bounds[BOUND_COUNT] = {box.min.x, box.min.y, box.min.z,
+                                           box.max.x, box.max.y, box.max.z};
+        const auto found = m_indices.find(key);
+        std::size_t index;
+        if (found != m_indices.end()) {
+            index = found->second;
+        } else {
+            index = m_keys.size();
+            m_indices.emplace(key, static_cast<std::uint32_t>(index));
+            m_keys.push_back(key);
+            const std::size_t padded = (m_keys.size() + LANES - 1) / LANES * LANES;
+            for (std::vector<float>& values : m_bounds) {
+                values.resize(padded, 0.0f);
+            }
+        }
+        for (int b = 0; b < BOUND_COUNT; b++) {
+            m_bounds[b][index] = bounds[b];
+        }
+    }
+
+    void bounds_table::erase(const glm::ivec3& key) {
+        const auto found = m_indices.find(key);
+        if (found == m_indices.end()) {
+            return;
+        }
+        const std::uint32_t index = found->second;
+        const std::size_t last = m_keys.size() - 1;
+        m_indices.erase(found);
+        if (index != last) {
+            m_keys[index] = m_keys[last];
+            m_indices[m_keys[index]] = index;
+        }
+        m_keys.pop_back();
+        for (std::vector<float>& values : m_bounds) {
+            values[index] = values[last];
+            values[last] = 0.0f;
+            values.resize((m_keys.size() + LANES - 1) / LANES * LANES);
+        }
+    }
+
+    aabb bounds_table::box(std::size_t index) const {
+        return {glm::vec3(m_bounds[MIN_X][index], m_bounds[MIN_Y][index], m_bounds[MIN_Z][index]),
+                glm::vec3(m_bounds[MAX_X][index], m_bounds[MAX_Y][index],
+                          m_bounds[MAX_Z][index])};
+    }
+
+    frustum::frustum(const glm::mat4& view_projection) {
+        // Gribb-Hartmann: each plane is the last row of the matrix plus or minus another row.
+        for (int i = 0; i < 3; i++) {
+            for (int side = 0; side < 2; side++) {
+                const float sign = side == 0 ? 1.0f : -1.0f;
+                glm::vec4& plane = m_planes[i * 2 + side];
+                for (int column = 0; column < 4; column++) {
+                    plane[column] =
+                        view_projection[column][3] + sign * view_projection[column][i];
+                }
+            }
+        }
+    }
+
+    bool frustum::intersects(const aabb& box) const {
+        for (const glm::vec4& plane : m_planes) {
+            // The corner furthest along the plane's normal.
+            const float x = plane.x > 0.0f ? box.max.x : box.min.x;
+            const float y = plane.y > 0.0f ? box.max.y : box.min.y;
+            const float z = plane.z > 0.0f ? box.max.z : box.min.z;
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void frustum::cull(const bounds_table& table, std::vector<std::uint32_t>& visible,
+                       simd_level level) const {
+        QC_PROFILE_ZONE("frustum.cull");
+        detail::frustum_cull_fn fn = &cull_boxes<scalar_frustum_lanes>;
+        level = std::min(level, best_simd_level());
+        if (level >= SIMD_AVX2 && detail::FRUSTUM_CULL_AVX2 != nullptr) {
+            fn = detail::FRUSTUM_CULL_AVX2;
+        } else if (level >= SIMD_SSE2 && detail::FRUSTUM_CULL_SSE2 != nullptr) {
+            fn = detail::FRUSTUM_CULL_SSE2;
+        }
+
+        float planes[detail::FRUSTUM_PLANES][4];
+        for (int p = 0; p < detail::FRUSTUM_PLANES; p++) {
+            for (int k = 0; k < 4; k++) {
+                planes[p][k] = m_planes[p][k];
+            }
+        }
+        const float* bounds[bounds_table::BOUND_COUNT];
+        for (int b = 0; b < bounds_table::BOUND_COUNT; b++) {
+            bounds[b] = table.bounds(static_cast<bounds_table::bound>(b));
+        }
+        visible.resize(table.size());
+        visible.resize(fn(planes, bounds, table.size(), visible.data()));
+    }
+}  // namespace qc
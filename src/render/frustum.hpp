@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "core/simd.hpp"
+#include "world/aabb.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // Boxes keyed by a grid position, such as a chunk or section coordinate, stored as one
+    // array per bound so frustum::cull() can test several boxes per instruction. The arrays are
+    // padded to a whole number of LANES. Erasing moves the last box into the hole, so indices
+    // only stay valid until the next erase(). Not synchronized.
+    class bounds_table {
+    public:
+        static constexpr std::size_t LANES = 8;
+
+        enum bound {
+            MIN_X = 0,
+            MIN_Y,
+            MIN_Z,
+            MAX_X,
+            MAX_Y,
+            MAX_Z,
+            BOUND_COUNT,
+        };
+
+        // Adds a box, or replaces the box already stored under `key`.
+        void insert(const glm::ivec3& key, const aabb& box);
+        void erase(const glm::ivec3& key);
+
+        std::size_t size() const {
+            return m_keys.size();
+        }
+
+        const glm::ivec3& key(std::size_t index) const {
+            return m_keys[index];
+        }
+
+        aabb box(std::size_t index) const;
+
+        // size() values, then zeros up to the next multiple of LANES.
+        const float* bounds(bound b) const {
+            return m_bounds[b].data();
+        }
+
+    private:
+        std::vector<float> m_bounds[BOUND_COUNT];
+        std::vector<glm::ivec3> m_keys;
+        std::unordered_map<glm::ivec3, std::uint32_t, chunk_pos_hash> m_indices;
+    };
+
+    // The six planes of a view-projection's clip volume, in world space, pointing inwards.
+    class frustum {
+    public:
+        // `view_projection` follows GL clip-space conventions.
+        explicit frustum(const glm::mat4& view_projection);
+
+        // False only if `box` lies wholly outside one of the planes. Boxes near the frustum's
+        // edges may pass without touching it.
+        bool intersects(const aabb& box) const;
+
+        // Replaces `visible` with the indices of the boxes in `table` that intersects() keeps,
+        // in table order. Tests 4 or 8 boxes at a time on the SSE2 and AVX2 paths, with the
+        // same float operations as intersects(), so every path keeps exactly the same boxes.
+        void cull(const bounds_table& table, std::vector<std::uint32_t>& visible,
+                  simd_level level = best_simd_level()) const;
+
+    private:
+        // Left, right, bottom, top, near, far; dot(plane, (p, 1)) >= 0 inside.
+        glm::vec4 m_planes[6];
+    };
+}  // namespace qc
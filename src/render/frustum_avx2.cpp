@@ -0,0 +1,51 @@
+#include "render/frustum_kernel.hpp"
+
+#if defined(QC_X86)
+#include <immintrin.h>
+#endif
+
+namespace qc {
+#if defined(QC_X86)
+    namespace {
+        // Built with AVX2 enabled; only called after best_simd_level() has confirmed support.
+        struct avx2_frustum_lanes {
+            static constexpr int WIDTH = 8;
+            using f = __m256;
+            using m = __m256;
+
+            static f load(const float* p) {
+                return _mm256_loadu_ps(p);
+            }
+            static f set(float v) {
+                return _mm256_set1_ps(v);
+            }
+            static f add(f a, f b) {
+                return _mm256_add_ps(a, b);
+            }
+            static f mul(f a, f b) {
+                return _mm256_mul_ps(a, b);
+            }
+            static m lt(f a, f b) {
+                return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+            }
+            static m none() {
+                return _mm256_setzero_ps();
+            }
+            static m or_m(m a, m b) {
+                return _mm256_or_ps(a, b);
+            }
+            static std::uint32_t bits(m v) {
+                return static_cast<std::uint32_t>(_mm256_movemask_ps(v));
+            }
+        };
+    }  // namespace
+
+    namespace detail {
+        const frustum_cull_fn FRUSTUM_CULL_AVX2 = &cull_boxes<avx2_frustum_lanes>;
+    }  // namespace detail
+#else
+    namespace detail {
+        const frustum_cull_fn FRUSTUM_CULL_AVX2 = nullptr;
+    }  // namespace detail
+#endif
+}  // namespace qc
@@ -0,0 +1,110 @@
+#pragma once
+
+// Private to frustum*.cpp. Like the noise kernels, the box test is a template over a lane type
+// describing one instruction set, instantiated in a translation unit built for it, and kept in
+// an anonymous namespace so no AVX2 copy of an inline function can reach the scalar path.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/bits.hpp"
+#include "core/simd.hpp"
+
+namespace qc {
+    namespace detail {
+        constexpr int FRUSTUM_PLANES = 6;
+
+        // Writes the indices of the boxes among the first `count` outside none of `planes`
+        // (a, b, c, d each, inside where a * x + b * y + c * z + d >= 0) to `out` and returns
+        // how many there are. `bounds` are the six bounds_table arrays, readable up to `count`
+        // rounded up to the lane width.
+        using frustum_cull_fn = std::size_t (*)(const float (*planes)[4],
+                                                const float* const* bounds, std::size_t count,
+                                                std::uint32_t* out);
+
+        // Entry points of the SIMD translation units; null where the build lacks them.
+        extern const frustum_cull_fn FRUSTUM_CULL_SSE2;
+        extern const frustum_cull_fn FRUSTUM_CULL_AVX2;
+    }  // namespace detail
+
+    namespace {
+        struct scalar_frustum_lanes {
+            static constexpr int WIDTH = 1;
+            using f = float;
+            using m = bool;
+
+            static f load(const float* p) {
+                return *p;
+            }
+            static f set(float v) {
+                return v;
+            }
+            static f add(f a, f b) {
+                return a + b;
+            }
+            static f mul(f a, f b) {
+                return a * b;
+            }
+            static m lt(f a, f b) {
+                return a < b;
+            }
+            static m none() {
+                return false;
+            }
+            static m or_m(m a, m b) {
+                return a || b;
+            }
+            // One bit per lane.
+            static std::uint32_t bits(m v) {
+                return v ? 1u : 0u;
+            }
+        };
+
+        template <typename V>
+        std::size_t cull_boxes(const float (*planes)[4], const float* const* bounds,
+                               std::size_t count, std::uint32_t* out) {
+            constexpr std::size_t W = V::WIDTH;
+            constexpr std::uint32_t ALL_LANES = (1u << W) - 1;
+
+            // Only the corner furthest along each plane's normal matters, so every plane reads
+            // one fixed array per axis: the max bound where the normal is positive.
+            const float* corner[detail::FRUSTUM_PLANES][3];
+            typename V::f a[detail::FRUSTUM_PLANES];
+            typename V::f b[detail::FRUSTUM_PLANES];
+            typename V::f c[detail::FRUSTUM_PLANES];
+            typename V::f d[detail::FRUSTUM_PLANES];
+            for (int p = 0; p < detail::FRUSTUM_PLANES; p++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    corner[p][axis] = bounds[planes[p][axis] > 0.0f ? 3 + axis : axis];
+                }
+                a[p] = V::set(planes[p][0]);
+                b[p] = V::set(planes[p][1]);
+                c[p] = V::set(planes[p][2]);
+                d[p] = V::set(planes[p][3]);
+            }
+
+            const typename V::f zero = V::set(0.0f);
+            std::size_t visible = 0;
+            for (std::size_t i = 0; i < count; i += W) {
+                typename V::m outside = V::none();
+                for (int p = 0; p < detail::FRUSTUM_PLANES; p++) {
+                    const typename V::f distance =
+                        V::add(V::add(V::add(V::mul(a[p], V::load(corner[p][0] + i)),
+                                             V::mul(b[p], V::load(corner[p][1] + i))),
+                                      V::mul(c[p], V::load(corner[p][2] + i))),
+                               d[p]);
+                    outside = V::or_m(outside, V::lt(distance, zero));
+                }
+                std::uint32_t inside = ~V::bits(outside) & ALL_LANES;
+                if (count - i < W) {
+                    inside &= (1u << (count - i)) - 1;
+                }
+                while (inside != 0) {
+                    out[visible++] = static_cast<std::uint32_t>(i) + ctz32(inside);
+                    inside &= inside - 1;
+                }
+            }
+            return visible;
+        }
+    }  // namespace
+}  // namespace qc
@@ -0,0 +1,50 @@
+#include "render/frustum_kernel.hpp"
+
+#if defined(QC_X86)
+#include <emmintrin.h>
+#endif
+
+namespace qc {
+#if defined(QC_X86)
+    namespace {
+        struct sse2_frustum_lanes {
+            static constexpr int WIDTH = 4;
+            using f = __m128;
+            using m = __m128;
+
+            static f load(const float* p) {
+                return _mm_loadu_ps(p);
+            }
+            static f set(float v) {
+                return _mm_set1_ps(v);
+            }
+            static f add(f a, f b) {
+                return _mm_add_ps(a, b);
+            }
+            static f mul(f a, f b) {
+                return _mm_mul_ps(a, b);
+            }
+            static m lt(f a, f b) {
+                return _mm_cmplt_ps(a, b);
+            }
+            static m none() {
+                return _mm_setzero_ps();
+            }
+            static m or_m(m a, m b) {
+                return _mm_or_ps(a, b);
+            }
+            static std::uint32_t bits(m v) {
+                return static_cast<std::uint32_t>(_mm_movemask_ps(v));
+            }
+        };
+    }  // namespace
+
+    namespace detail {
+        const frustum_cull_fn FRUSTUM_CULL_SSE2 = &cull_boxes<sse2_frustum_lanes>;
+    }  // namespace detail
+#else
+    namespace detail {
+        const frustum_cull_fn FRUSTUM_CULL_SSE2 = nullptr;
+    }  // namespace detail
+#endif
+}  // namespace qc
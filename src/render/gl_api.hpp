@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace qc {
+    // The OpenGL entry points the renderer uses, as a table of plain function pointers. The game
+    // fills it from glad (load_gl_functions() in render/gl_loader.cpp); the benchmarks fill it
+    // with a recording fake, so buffer management and draw commands can be checked on machines
+    // without a GPU. Parameter types follow the GL ones: GLuint and GLenum as uint32_t, GLsizei
+    // as int, GLintptr and GLsizeiptr as ptrdiff_t.
+    struct gl_functions {
+        void (*gen_buffers)(int n, std::uint32_t* buffers);
+        void (*delete_buffers)(int n, const std::uint32_t* buffers);
+        void (*bind_buffer)(std::uint32_t target, std::uint32_t buffer);
+        void (*bind_buffer_base)(std::uint32_t target, std::uint32_t index, std::uint32_t buffer);
+        void (*buffer_data)(std::uint32_t target, std::ptrdiff_t size, const void* data,
+                            std::uint32_t usage);
+        void (*buffer_sub_data)(std::uint32_t target, std::ptrdiff_t offset, std::ptrdiff_t size,
+                                const void* data);
+        void (*copy_buffer_sub_data)(std::uint32_t read_target, std::uint32_t write_target,
+                                     std::ptrdiff_t read_offset, std::ptrdiff_t write_offset,
+                                     std::ptrdiff_t size);
+        void (*gen_vertex_arrays)(int n, std::uint32_t* arrays);
+        void (*delete_vertex_arrays)(int n, const std::uint32_t* arrays);
+        void (*bind_vertex_array)(std::uint32_t array);
+        void (*enable_vertex_attrib_array)(std::uint32_t index);
+        void (*vertex_attrib_i_pointer)(std::uint32_t index, int size, std::uint32_t type,
+                                        int stride, const void* pointer);
+        void (*vertex_attrib_divisor)(std::uint32_t index, std::uint32_t divisor);
+        void (*multi_draw_arrays_indirect)(std::uint32_t mode, const void* indirect,
+                                           int draw_count, int stride);
+    };
+
+    // Enum values from the GL 4.3 core headers, named without the GL_ prefix so they never
+    // collide with glad's macros.
+    namespace gl {
+        constexpr std::uint32_t TRIANGLES = 0x0004;
+        constexpr std::uint32_t INT = 0x1404;
+        constexpr std::uint32_t ARRAY_BUFFER = 0x8892;
+        constexpr std::uint32_t STREAM_DRAW = 0x88E0;
+        constexpr std::uint32_t DYNAMIC_DRAW = 0x88E8;
+        constexpr std::uint32_t COPY_READ_BUFFER = 0x8F36;
+        constexpr std::uint32_t COPY_WRITE_BUFFER = 0x8F37;
+        constexpr std::uint32_t DRAW_INDIRECT_BUFFER = 0x8F3F;
+        constexpr std::uint32_t SHADER_STORAGE_BUFFER = 0x90D2;
+    }  // namespace gl
+
+    // Layout of one glMultiDrawArraysIndirect record.
+    struct draw_arrays_indirect_command {
+        std::uint32_t count;
+        std::uint32_t instance_count;
+        std::uint32_t first;
+        std::uint32_t base_instance;
+    };
+
+    static_assert(sizeof(draw_arrays_indirect_command) == 16,
+                  "indirect commands must match the GL layout");
+
+    // Fills the table from glad. Needs a current GL 4.3 context and a successful gladLoadGL().
+    gl_functions load_gl_functions();
+}  // namespace qc
@@ -0,0 +1,93 @@
+#include <glad/gl.h>
+
+#include "render/gl_api.hpp"
+
+namespace qc {
+    namespace {
+        // Forwarders rather than glad's pointers themselves: they absorb the calling convention
+        // and the platform-specific GL typedefs.
+        void gen_buffers(int n, std::uint32_t* buffers) {
+            glGenBuffers(n, buffers);
+        }
+
+        void delete_buffers(int n, const std::uint32_t* buffers) {
+            glDeleteBuffers(n, buffers);
+        }
+
+        void bind_buffer(std::uint32_t target, std::uint32_t buffer) {
+            glBindBuffer(target, buffer);
+        }
+
+        void bind_buffer_base(std::uint32_t target, std::uint32_t index, std::uint32_t buffer) {
+            glBindBufferBase(target, index, buffer);
+        }
+
+        void buffer_data(std::uint32_t target, std::ptrdiff_t size, const void* data,
+                         std::uint32_t usage) {
+            glBufferData(target, static_cast<GLsizeiptr>(size), data, usage);
+        }
+
+        void buffer_sub_data(std::uint32_t target, std::ptrdiff_t offset, std::ptrdiff_t size,
+                             const void* data) {
+            glBufferSubData(target, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size),
+                            data);
+        }
+
+        void copy_buffer_sub_data(std::uint32_t read_target, std::uint32_t write_target,
+                                  std::ptrdiff_t read_offset, std::ptrdiff_t write_offset,
+                                  std::ptrdiff_t size) {
+            glCopyBufferSubData(read_target, write_target, static_cast<GLintptr>(read_offset),
+                                static_cast<GLintptr>(write_offset),
+                                static_cast<GLsizeiptr>(size));
+        }
+
+        void gen_vertex_arrays(int n, std::uint32_t* arrays) {
+            glGenVertexArrays(n, arrays);
+        }
+
+        void delete_vertex_arrays(int n, const std::uint32_t* arrays) {
+            glDeleteVertexArrays(n, arrays);
+        }
+
+        void bind_vertex_array(std::uint32_t array) {
+            glBindVertexArray(array);
+        }
+
+        void enable_vertex_attrib_array(std::uint32_t index) {
+            glEnableVertexAttribArray(index);
+        }
+
+        void vertex_attrib_i_pointer(std::uint32_t index, int size, std::uint32_t type, int stride,
+                                     const void* pointer) {
+            glVertexAttribIPointer(index, size, type, stride, pointer);
+        }
+
+        void vertex_attrib_divisor(std::uint32_t index, std::uint32_t divisor) {
+            glVertexAttribDivisor(index, divisor);
+        }
+
+        void multi_draw_arrays_indirect(std::uint32_t mode, const void* indirect, int draw_count,
+                                        int stride) {
+            glMultiDrawArraysIndirect(mode, indirect, draw_count, stride);
+        }
+    }  // namespace
+
+    gl_functions load_gl_functions() {
+        gl_functions gl;
+        gl.gen_buffers = gen_buffers;
+        gl.delete_buffers = delete_buffers;
+        gl.bind_buffer = bind_buffer;
+        gl.bind_buffer_base = bind_buffer_base;
+        gl.buffer_data = buffer_data;
+        gl.buffer_sub_data = buffer_sub_data;
+        gl.copy_buffer_sub_data = copy_buffer_sub_data;
+        gl.gen_vertex_arrays = gen_vertex_arrays;
+        gl.delete_vertex_arrays = delete_vertex_arrays;
+        gl.bind_vertex_array = bind_vertex_array;
+        gl.enable_vertex_attrib_array = enable_vertex_attrib_array;
+        gl.vertex_attrib_i_pointer = vertex_attrib_i_pointer;
+        gl.vertex_attrib_divisor = vertex_attrib_divisor;
+        gl.multi_draw_arrays_indirect = multi_draw_arrays_indirect;
+        return gl;
+    }
+}  // namespace qc
@@ -0,0 +1,478 @@
+#include "render/occlusion.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec4.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/profile.hpp"
+
+#if defined(QC_X86)
+#include <emmintrin.h>
+#endif
+
+namespace qc {
+    namespace {
+        constexpr int SUBPIXEL_BITS = 4;
+        constexpr int SUBPIXEL = 1 << SUBPIXEL_BITS;
+        constexpr int SECTIONS = CHUNK_SIZE / OCCLUDER_SECTION;
+
+        // Polygons are clipped to GUARD_BAND times the screen's half-extent around its centre,
+        // which keeps edge functions within 32 bits.
+        constexpr float GUARD_BAND = 3.0f;
+        // Relative depth margin a box must lie behind its occluders by, so a solid box is never
+        // hidden by rounding in its own faces.
+        constexpr float DEPTH_BIAS = 1e-3f;
+
+        // Corner i of a box takes max on x if bit 0 is set, on y for bit 1 and on z for bit 2.
+        // Faces list their corners counter-clockwise seen from outside.
+        constexpr int FACE_CORNERS[6][4] = {
+            {0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6},
+        };
+
+        // The half-spaces dot(p, plane) >= 0 polygons are clipped to: the near plane, which GL
+        // puts at z = -w, and the guard band.
+        constexpr int CLIP_PLANE_COUNT = 5;
+        const glm::vec4 CLIP_PLANES[CLIP_PLANE_COUNT] = {
+            glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),       glm::vec4(-1.0f, 0.0f, 0.0f, GUARD_BAND),
+            glm::vec4(1.0f, 0.0f, 0.0f, GUARD_BAND), glm::vec4(0.0f, -1.0f, 0.0f, GUARD_BAND),
+            glm::vec4(0.0f, 1.0f, 0.0f, GUARD_BAND),
+        };
+        constexpr int MAX_CLIPPED = 4 + CLIP_PLANE_COUNT;
+
+        constexpr std::uint8_t FLAG_OPAQUE = 1;
+
+        constexpr std::uint8_t occluder_flags(block_id block) {
+            return block_properties(block).opaque ? FLAG_OPAQUE : 0;
+        }
+
+        // Sutherland-Hodgman against one plane. Returns the new vertex count.
+        int clip_polygon(const glm::vec4* in, int count, int plane, glm::vec4* out) {
+            int n = 0;
+            for (int i = 0; i < count; i++) {
+                const glm::vec4& a = in[i];
+                const glm::vec4& b = in[(i + 1) % count];
+                const float da = glm::dot(a, CLIP_PLANES[plane]);
+                const float db = glm::dot(b, CLIP_PLANES[plane]);
+                if (da >= 0.0f) {
+                    out[n++] = a;
+                }
+                if ((da >= 0.0f) != (db >= 0.0f)) {
+                    out[n++] = a + (b - a) * (da / (da - db));
+                }
+            }
+            return n;
+        }
+
+        float screen_x(const glm::vec4& clip) {
+            return (clip.x / clip.w * 0.5f + 0.5f) * occlusion_culler::WIDTH;
+        }
+
+        float screen_y(const glm::vec4& clip) {
+            return (0.5f - clip.y / clip.w * 0.5f) * occlusion_culler::HEIGHT;
+        }
+
+        // Scalar twins of MINPS and MAXPS, down to which operand wins a tie.
+        float min_ps(float a, float b) {
+            return a < b ? a : b;
+        }
+
+        float max_ps(float a, float b) {
+            return a > b ? a : b;
+        }
+
+        // One triangle edge as a*x + b*y + c over 28.4 coordinates, non-negative inside.
+        struct edge {
+            std::int32_t a;
+            std::int32_t b;
+            std::int32_t c;
+        };
+
+        // `from` -> `to` with the interior on its left in a y-down frame. Of the two
+        // triangles sharing an edge, exactly one includes pixels lying on it.
+        template <typename V>
+        edge make_edge(const V& from, const V& to) {
+            const std::int64_t a = static_cast<std::int64_t>(from.y) - to.y;
+            const std::int64_t b = static_cast<std::int64_t>(to.x) - from.x;
+            const bool inclusive = a > 0 || (a == 0 && b > 0);
+            const std::int64_t c = -(a * from.x + b * from.y) - (inclusive ? 0 : 1);
+            return {static_cast<std::int32_t>(a), static_cast<std::int32_t>(b),
+                    static_cast<std::int32_t>(c)};
+        }
+
+        // Smallest k in [0, limit + 1] with value + step * k >= 0, for step > 0. The float
+        // estimate is corrected with exact integer tests, which keeps the result deterministic.
+        int first_inside(std::int32_t value, std::int32_t step, float inverse_step, int limit) {
+            const float estimate = std::ceil(static_cast<float>(-value) * inverse_step);
+            int k = static_cast<int>(std::clamp(estimate, 0.0f, static_cast<float>(limit + 1)));
+            while (k > 0 && value + step * (k - 1) >= 0) {
+                k--;
+            }
+            while (k <= limit && value + step * k < 0) {
+                k++;
+            }
+            return k;
+        }
+
+        // Depth along one row: pixel x gets min(z_row + z_step * x, z_max).
+        struct depth_row {
+            float* row;
+            float z_row;
+            float z_step;
+            float z_max;
+        };
+
+        void fill_scalar(const depth_row& d, int x0, int x1) {
+            for (int x = x0; x <= x1; x++) {
+                const float z = min_ps(d.z_row + d.z_step * static_cast<float>(x), d.z_max);
+                d.row[x] = max_ps(d.row[x], z);
+            }
+        }
+
+#if defined(QC_X86)
+        // Aligned groups of four go through SSE2; the ends use the scalar loop, which computes
+        // the same values.
+        void fill_sse2(const depth_row& d, int x0, int x1) {
+            const int head = std::min(x1, (x0 + 3) & ~3);
+            fill_scalar(d, x0, head - 1);
+            const __m128 z_row = _mm_set1_ps(d.z_row);
+            const __m128 z_step = _mm_set1_ps(d.z_step);
+            const __m128 z_max = _mm_set1_ps(d.z_max);
+            const __m128 four = _mm_set1_ps(4.0f);
+            __m128 x = _mm_add_ps(_mm_set1_ps(static_cast<float>(head)),
+                                  _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+            int px = head;
+            for (; px + 3 <= x1; px += 4) {
+                const __m128 z = _mm_min_ps(_mm_add_ps(z_row, _mm_mul_ps(z_step, x)), z_max);
+                _mm_storeu_ps(d.row + px, _mm_max_ps(_mm_loadu_ps(d.row + px), z));
+                x = _mm_add_ps(x, four);
+            }
+            fill_scalar(d, px, x1);
+        }
+#endif
+    }  // namespace
+
+    void find_occluders(const chunk& c, const glm::ivec3& pos, std::vector<aabb>& out) {
+        bool solid[SECTIONS][SECTIONS][SECTIONS] = {};
+        if (c.is_uniform()) {
+            if (!block_properties(c.uniform_block()).opaque) {
+                return;
+            }
+            std::fill(&solid[0][0][0], &solid[0][0][0] + SECTIONS * SECTIONS * SECTIONS, true);
+        } else {
+            std::uint64_t rows[CHUNK_AREA];
+            c.unpack_masks(block_flag_table<occluder_flags>(), FLAG_OPAQUE, 0, rows);
+            constexpr std::uint64_t SECTION_ROW = (1ull << OCCLUDER_SECTION) - 1;
+            for (int sy = 0; sy < SECTIONS; sy++) {
+                for (int sz = 0; sz < SECTIONS; sz++) {
+                    for (int sx = 0; sx < SECTIONS; sx++) {
+                        const std::uint64_t mask = SECTION_ROW << (sx * OCCLUDER_SECTION);
+                        bool full = true;
+                        for (int y = sy * OCCLUDER_SECTION; full && y < (sy + 1) * OCCLUDER_SECTION;
+                             y++) {
+                            for (int z = sz * OCCLUDER_SECTION;
+                                 full && z < (sz + 1) * OCCLUDER_SECTION; z++) {
+                                full = (rows[y * CHUNK_SIZE + z] & mask) == mask;
+                            }
+                        }
+                        solid[sy][sz][sx] = full;
+                    }
+                }
+            }
+        }
+
+        // Greedy merge: grow each box along x, then z, then y over sections not yet taken.
+        bool taken[SECTIONS][SECTIONS][SECTIONS] = {};
+        const auto available = [&](int y, int z, int x0, int x1) {
+            for (int x = x0; x <= x1; x++) {
+                if (!solid[y][z][x] || taken[y][z][x]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        const glm::vec3 origin(glm::vec3(pos) * static_cast<float>(CHUNK_SIZE));
+        for (int sy = 0; sy < SECTIONS; sy++) {
+            for (int sz = 0; sz < SECTIONS; sz++) {
+                for (int sx = 0; sx < SECTIONS; sx++) {
+                    if (!available(sy, sz, sx, sx)) {
+                        continue;
+                    }
+                    int ex = sx;
+                    while (ex + 1 < SECTIONS && available(sy, sz, ex + 1, ex + 1)) {
+                        ex++;
+                    }
+                    int ez = sz;
+                    while (ez + 1 < SECTIONS && available(sy, ez + 1, sx, ex)) {
+                        ez++;
+                    }
+                    int ey = sy;
+                    bool grow = true;
+                    while (grow && ey + 1 < SECTIONS) {
+                        for (int z = sz; grow && z <= ez; z++) {
+                            grow = available(ey + 1, z, sx, ex);
+                        }
+                        ey += grow ? 1 : 0;
+                    }
+                    for (int y = sy; y <= ey; y++) {
+                        for (int z = sz; z <= ez; z++) {
+                            std::fill(&taken[y][z][sx], &taken[y][z][ex] + 1, true);
+                        }
+                    }
+                    const float section = static_cast<float>(OCCLUDER_SECTION);
+                    const glm::vec3 first(glm::ivec3(sx, sy, sz));
+                    const glm::vec3 last(glm::ivec3(ex + 1, ey + 1, ez + 1));
+                    out.push_back({origin + first * section, origin + last * section});
+                }
+            }
+        }
+    }
+
+    occlusion_culler::occlusion_culler(simd_level level) : m_level(level), m_view_projection(1.0f) {
+        for (int w = WIDTH, h = HEIGHT; w >= 1 && h >= 1; w /= 2, h /= 2) {
+            m_levels.emplace_back(static_cast<std::size_t>(w) * h, 0.0f);
+        }
+    }
+
+    void occlusion_culler::begin(const glm::mat4& view_projection) {
+        m_view_projection = view_projection;
+        // The camera is the point clip space sends to infinity, with w kept non-negative.
+        m_eye = glm::inverse(view_projection) * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+        if (m_eye.w < 0.0f) {
+            m_eye = -m_eye;
+        }
+        std::fill(m_levels[0].begin(), m_levels[0].end(), 0.0f);
+        m_triangles = 0;
+    }
+
+    void occlusion_culler::add_occluder(const aabb& box) {
+        glm::vec4 corners[8];
+        for (int i = 0; i < 8; i++) {
+            const glm::vec3 p((i & 1) != 0 ? box.max.x : box.min.x,
+                              (i & 2) != 0 ? box.max.y : box.min.y,
+                              (i & 4) != 0 ? box.max.z : box.min.z);
+            corners[i] = m_view_projection * glm::vec4(p, 1.0f);
+        }
+        // Nothing to draw if every corner is outside the same clip plane.
+        for (const glm::vec4& plane : CLIP_PLANES) {
+            int outside = 0;
+            for (const glm::vec4& corner : corners) {
+                outside += glm::dot(corner, plane) < 0.0f ? 1 : 0;
+            }
+            if (outside == 8) {
+                return;
+            }
+        }
+
+        // Only the faces whose outer side holds the camera can be seen.
+        const bool front[6] = {
+            m_eye.x < box.min.x * m_eye.w, m_eye.x > box.max.x * m_eye.w,
+            m_eye.y < box.min.y * m_eye.w, m_eye.y > box.max.y * m_eye.w,
+            m_eye.z < box.min.z * m_eye.w, m_eye.z > box.max.z * m_eye.w,
+        };
+        for (int f = 0; f < 6; f++) {
+            if (!front[f]) {
+                continue;
+            }
+            const int* face = FACE_CORNERS[f];
+            glm::vec4 polygon[2][MAX_CLIPPED];
+            int count = 4;
+            for (int i = 0; i < 4; i++) {
+                polygon[0][i] = corners[face[i]];
+            }
+            int current = 0;
+            for (int plane = 0; plane < CLIP_PLANE_COUNT && count >= 3; plane++) {
+                count = clip_polygon(polygon[current], count, plane, polygon[current ^ 1]);
+                current ^= 1;
+            }
+            if (count < 3) {
+                continue;
+            }
+
+            screen_vertex vertices[MAX_CLIPPED];
+            for (int i = 0; i < count; i++) {
+                const glm::vec4& v = polygon[current][i];
+                vertices[i] = {
+                    static_cast<std::int32_t>(std::floor(screen_x(v) * SUBPIXEL + 0.5f)),
+                    static_cast<std::int32_t>(std::floor(screen_y(v) * SUBPIXEL + 0.5f)),
+                    1.0f / v.w};
+            }
+            // Counter-clockwise faces turn clockwise once y points down; anything else has
+            // collapsed in snapping.
+            std::int64_t area = 0;
+            for (int i = 1; i + 1 < count; i++) {
+                area += static_cast<std::int64_t>(vertices[i].x - vertices[0].x) *
+                            (vertices[i + 1].y - vertices[0].y) -
+                        static_cast<std::int64_t>(vertices[i + 1].x - vertices[0].x) *
+                            (vertices[i].y - vertices[0].y);
+            }
+            if (area >= 0) {
+                continue;
+            }
+            for (int i = 1; i + 1 < count; i++) {
+                rasterize(vertices[0], vertices[i + 1], vertices[i]);
+            }
+        }
+    }
+
+    void occlusion_culler::rasterize(const screen_vertex& a, const screen_vertex& b,
+                                     const screen_vertex& c) {
+        const std::int64_t area = static_cast<std::int64_t>(b.x - a.x) * (c.y - a.y) -
+                                  static_cast<std::int64_t>(c.x - a.x) * (b.y - a.y);
+        if (area <= 0) {
+            return;
+        }
+        // Pixels whose centres fall inside the bounding box.
+        constexpr int HALF = SUBPIXEL / 2;
+        int x0 = (std::min({a.x, b.x, c.x}) - HALF + SUBPIXEL - 1) >> SUBPIXEL_BITS;
+        int x1 = (std::max({a.x, b.x, c.x}) - HALF) >> SUBPIXEL_BITS;
+        int y0 = (std::min({a.y, b.y, c.y}) - HALF + SUBPIXEL - 1) >> SUBPIXEL_BITS;
+        int y1 = (std::max({a.y, b.y, c.y}) - HALF) >> SUBPIXEL_BITS;
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, WIDTH - 1);
+        y0 = std::max(y0, 0);
+        y1 = std::min(y1, HEIGHT - 1);
+        if (x0 > x1 || y0 > y1) {
+            return;
+        }
+        m_triangles++;
+
+        const edge edges[3] = {make_edge(a, b), make_edge(b, c), make_edge(c, a)};
+        const double zx = ((static_cast<double>(b.z) - a.z) * (c.y - a.y) -
+                           (static_cast<double>(c.z) - a.z) * (b.y - a.y)) /
+                          static_cast<double>(area);
+        const double zy = ((static_cast<double>(c.z) - a.z) * (b.x - a.x) -
+                           (static_cast<double>(b.z) - a.z) * (c.x - a.x)) /
+                          static_cast<double>(area);
+
+        std::int32_t steps[3];
+        float inverse_steps[3];
+        for (int i = 0; i < 3; i++) {
+            steps[i] = edges[i].a * SUBPIXEL;
+            inverse_steps[i] = steps[i] != 0 ? 1.0f / static_cast<float>(steps[i]) : 0.0f;
+        }
+
+        depth_row d;
+        d.z_step = static_cast<float>(zx * SUBPIXEL);
+        d.z_max = std::max({a.z, b.z, c.z});
+        const std::int32_t px = x0 * SUBPIXEL + HALF;
+        for (int y = y0; y <= y1; y++) {
+            // Each edge bounds the covered pixels of the row from one side; solving for where it
+            // changes sign leaves no per-pixel coverage tests.
+            const std::int32_t py = y * SUBPIXEL + HALF;
+            const int width = x1 - x0;
+            int first = 0;
+            int last = width;
+            for (int i = 0; i < 3; i++) {
+                const edge& e = edges[i];
+                const std::int32_t value = e.a * px + e.b * py + e.c;
+                if (e.a > 0) {
+                    first = std::max(first, first_inside(value, steps[i], inverse_steps[i], width));
+                } else if (e.a < 0) {
+                    // Counted from the right end, the edge becomes a left one.
+                    last = std::min(last, width - first_inside(value + steps[i] * width, -steps[i],
+                                                               -inverse_steps[i], width));
+                } else if (value < 0) {
+                    last = -1;
+                }
+            }
+            if (first > last) {
+                continue;
+            }
+            d.row = m_levels[0].data() + static_cast<std::size_t>(y) * WIDTH;
+            d.z_row = static_cast<float>(a.z + zx * (HALF - a.x) + zy * (py - a.y));
+#if defined(QC_X86)
+            if (m_level >= SIMD_SSE2) {
+                fill_sse2(d, x0 + first, x0 + last);
+                continue;
+            }
+#endif
+            fill_scalar(d, x0 + first, x0 + last);
+        }
+    }
+
+    void occlusion_culler::finish() {
+        QC_PROFILE_ZONE("occlusion.finish");
+        for (std::size_t level = 1; level < m_levels.size(); level++) {
+            const int width = WIDTH >> level;
+            const int height = HEIGHT >> level;
+            const float* from = m_levels[level - 1].data();
+            float* to = m_levels[level].data();
+            for (int y = 0; y < height; y++) {
+                const float* top = from + static_cast<std::size_t>(2 * y) * (2 * width);
+                const float* bottom = top + 2 * width;
+                for (int x = 0; x < width; x++) {
+                    to[y * width + x] = std::min(std::min(top[2 * x], top[2 * x + 1]),
+                                                 std::min(bottom[2 * x], bottom[2 * x + 1]));
+                }
+            }
+        }
+    }
+
+    bool occlusion_culler::visible(const aabb& box) const {
+        float min_x = std::numeric_limits<float>::max();
+        float max_x = std::numeric_limits<float>::lowest();
+        float min_y = std::numeric_limits<float>::max();
+        float max_y = std::numeric_limits<float>::lowest();
+        float nearest = 0.0f;
+        int behind = 0;
+        for (int i = 0; i < 8; i++) {
+            const glm::vec3 p((i & 1) != 0 ? box.max.x : box.min.x,
+                              (i & 2) != 0 ? box.max.y : box.min.y,
+                              (i & 4) != 0 ? box.max.z : box.min.z);
+            const glm::vec4 clip = m_view_projection * glm::vec4(p, 1.0f);
+            if (clip.z < -clip.w) {
+                behind++;
+                continue;
+            }
+            const float x = screen_x(clip);
+            const float y = screen_y(clip);
+            min_x = std::min(min_x, x);
+            max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y);
+            max_y = std::max(max_y, y);
+            nearest = std::max(nearest, 1.0f / clip.w);
+        }
+        if (behind > 0) {
+            return behind < 8;
+        }
+        if (max_x < 0.0f || min_x >= WIDTH || max_y < 0.0f || min_y >= HEIGHT) {
+            return false;
+        }
+        const int x0 = std::max(static_cast<int>(min_x), 0);
+        const int x1 = std::min(static_cast<int>(max_x), WIDTH - 1);
+        const int y0 = std::max(static_cast<int>(min_y), 0);
+        const int y1 = std::min(static_cast<int>(max_y), HEIGHT - 1);
+
+        // The finest level where the rectangle spans at most 4x4 texels.
+        std::size_t level = 0;
+        while (level + 1 < m_levels.size() &&
+               ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3)) {
+            level++;
+        }
+        const int width = WIDTH >> level;
+        const float* texels = m_levels[level].data();
+        const float threshold = nearest * (1.0f + DEPTH_BIAS);
+        for (int y = y0 >> level; y <= y1 >> level; y++) {
+            for (int x = x0 >> level; x <= x1 >> level; x++) {
+                if (!(threshold < texels[y * width + x])) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void occlusion_culler::cull(const std::vector<glm::ivec3>& chunks,
+                                std::vector<glm::ivec3>& out) const {
+        QC_PROFILE_ZONE("occlusion.cull");
+        for (const glm::ivec3& pos : chunks) {
+            if (visible(chunk_bounds(pos))) {
+                out.push_back(pos);
+            }
+        }
+    }
+}  // namespace qc
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/simd.hpp"
+#include "world/aabb.hpp"
+#include "world/chunk.hpp"
+
+namespace qc {
+    // Edge of the cubic sections occluders are built from.
+    constexpr int OCCLUDER_SECTION = 16;
+
+    // Appends boxes covering the fully opaque sections of chunk `pos`, adjacent ones merged.
+    // Sections with any see-through voxel contribute nothing.
+    void find_occluders(const chunk& c, const glm::ivec3& pos, std::vector<aabb>& out);
+
+    // Software occlusion culling. Each frame, the front faces of solid occluder boxes are
+    // rasterized into a small depth buffer, which is reduced into a hierarchical-Z pyramid that
+    // bounding boxes are then tested against.
+    //
+    // Depth is stored as 1 / w (inverse view distance, 0 where nothing was drawn), which is
+    // affine in screen space, so nearer is larger. Coverage uses 28.4 fixed-point edge
+    // functions sampled at pixel centres with a top-left fill rule, and depth is interpolated
+    // with the same float operations on every SIMD path, so a frame rasterizes to the same bits
+    // on any machine. Row 0 is the top of the screen.
+    class occlusion_culler {
+    public:
+        static constexpr int WIDTH = 256;
+        static constexpr int HEIGHT = 128;
+
+        explicit occlusion_culler(simd_level level = best_simd_level());
+
+        // Starts a frame seen through `view_projection`, in GL clip-space conventions.
+        void begin(const glm::mat4& view_projection);
+
+        // Draws a box known to be solid. Parts nearer than the near plane are clipped away.
+        void add_occluder(const aabb& box);
+
+        // Builds the hierarchical-Z pyramid; call once all occluders are drawn.
+        void finish();
+
+        // False only if every part of `box` lies behind drawn occluders. Boxes crossing the near
+        // plane always pass; boxes wholly off screen or behind the camera never do.
+        bool visible(const aabb& box) const;
+
+        // Keeps the chunks of `chunks` whose bounds are visible(), in order.
+        void cull(const std::vector<glm::ivec3>& chunks, std::vector<glm::ivec3>& out) const;
+
+        // WIDTH * HEIGHT inverse depths, row by row.
+        const float* depth() const {
+            return m_levels[0].data();
+        }
+
+        std::size_t triangle_count() const {
+            return m_triangles;
+        }
+
+    private:
+        struct screen_vertex {
+            std::int32_t x;
+            std::int32_t y;
+            float z;
+        };
+
+        void rasterize(const screen_vertex& a, const screen_vertex& b, const screen_vertex& c);
+
+        simd_level m_level;
+        glm::mat4 m_view_projection;
+        // Camera position in homogeneous coordinates.
+        glm::vec4 m_eye;
+        // Level 0 is the depth buffer; each next level keeps the minimum of 2x2 texels.
+        std::vector<std::vector<float>> m_levels;
+        std::size_t m_triangles = 0;
+    };
+}  // namespace qc
@@ -0,0 +1,68 @@
+#include "render/range_allocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace qc {
+    range_allocator::range_allocator(std::uint32_t capacity) {
+        grow(capacity);
+    }
+
+    std::uint32_t range_allocator::allocate(std::uint32_t size) {
+        assert(size > 0);
+        for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+            if (it->second < size) {
+                continue;
+            }
+            const std::uint32_t offset = it->first;
+            const std::uint32_t rest = it->second - size;
+            m_free.erase(it);
+            if (rest > 0) {
+                m_free.emplace(offset + size, rest);
+            }
+            m_used += size;
+            return offset;
+        }
+        return INVALID;
+    }
+
+    void range_allocator::release(std::uint32_t offset, std::uint32_t size) {
+        assert(size > 0 && offset + size <= m_capacity && size <= m_used);
+        m_used -= size;
+        auto next = m_free.lower_bound(offset);
+        assert(next == m_free.end() || next->first >= offset + size);
+        if (next != m_free.end() && next->first == offset + size) {
+            size += next->second;
+            next = m_free.erase(next);
+        }
+        if (next != m_free.begin()) {
+            auto previous = std::prev(next);
+            assert(previous->first + previous->second <= offset);
+            if (previous->first + previous->second == offset) {
+                previous->second += size;
+                return;
+            }
+        }
+        m_free.emplace_hint(next, offset, size);
+    }
+
+    void range_allocator::grow(std::uint32_t capacity) {
+        if (capacity <= m_capacity) {
+            return;
+        }
+        const std::uint32_t added = capacity - m_capacity;
+        const std::uint32_t old_capacity = m_capacity;
+        m_capacity = capacity;
+        m_used += added;
+        release(old_capacity, added);
+    }
+
+    std::uint32_t range_allocator::largest_free() const {
+        std::uint32_t largest = 0;
+        for (const auto& range : m_free) {
+            largest = std::max(largest, range.second);
+        }
+        return largest;
+    }
+}  // namespace qc
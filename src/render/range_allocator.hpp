@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace qc {
+    // Hands out ranges of [0, capacity) in arbitrary units. Allocation is first fit by offset;
+    // released ranges merge with free neighbours, so the free map only ever holds gaps between
+    // live ranges plus the tail. Not synchronized.
+    class range_allocator {
+    public:
+        static constexpr std::uint32_t INVALID = UINT32_MAX;
+
+        explicit range_allocator(std::uint32_t capacity = 0);
+
+        // Offset of a new range of `size` (> 0) units, or INVALID if no free range fits.
+        std::uint32_t allocate(std::uint32_t size);
+
+        // Returns a range obtained from allocate().
+        void release(std::uint32_t offset, std::uint32_t size);
+
+        // Extends the space to `capacity` units; existing ranges keep their offsets.
+        void grow(std::uint32_t capacity);
+
+        std::uint32_t capacity() const {
+            return m_capacity;
+        }
+
+        std::uint32_t used() const {
+            return m_used;
+        }
+
+        std::size_t free_ranges() const {
+            return m_free.size();
+        }
+
+        std::uint32_t largest_free() const;
+
+    private:
+        std::uint32_t m_capacity = 0;
+        std::uint32_t m_used = 0;
+        // Free ranges, offset -> size.
+        std::map<std::uint32_t, std::uint32_t> m_free;
+    };
+}  // namespace qc
@@ -0,0 +1,81 @@
+#include "render/shaders.hpp"
+
+namespace qc {
+    // expand_quad() in mesh/quad.cpp mirrors the vertex expansion below.
+    const char* const QUAD_VERTEX_SHADER = R"glsl(
+#version 430 core
+
+layout(std430, binding = 0) readonly buffer quad_buffer {
+    uvec2 quads[];
+};
+
+// World-space origin of the chunk being drawn, fetched per draw through its base instance.
+layout(location = 0) in ivec3 a_chunk_origin;
+
+uniform mat4 u_view_projection;
+
+out vec2 v_uv;
+flat out uint v_layer;
+out float v_shade;
+
+const int U_AXIS[3] = int[3](2, 0, 0);
+const int V_AXIS[3] = int[3](1, 2, 1);
+const int CORNERS[12] = int[12](0, 1, 2, 0, 2, 3, 1, 2, 3, 1, 3, 0);
+const bool REVERSED[6] = bool[6](true, false, true, false, false, true);
+const float FACE_SHADE[6] = float[6](0.8, 0.8, 1.0, 0.5, 0.9, 0.9);
+const float AO_SHADE[4] = float[4](0.45, 0.65, 0.85, 1.0);
+
+void main() {
+    uvec2 q = quads[gl_VertexID / 6];
+    int vertex = gl_VertexID % 6;
+
+    ivec3 pos = ivec3(q.x & 31u, (q.x >> 5) & 31u, (q.x >> 10) & 31u);
+    uint dir = (q.x >> 15) & 7u;
+    int width = int((q.x >> 18) & 31u) + 1;
+    int height = int((q.x >> 23) & 31u) + 1;
+    uint axis = dir >> 1;
+
+    uvec4 ao = (uvec4(q.y) >> uvec4(8u, 10u, 12u, 14u)) & 3u;
+    uvec4 light = (uvec4(q.y) >> uvec4(16u, 20u, 24u, 28u)) & 15u;
+
+    // Split along the diagonal with the brighter ends so AO interpolates without creases.
+    bool flip = ao.y + ao.w > ao.x + ao.z;
+
+    if (REVERSED[dir] && vertex % 3 != 0) {
+        vertex += vertex % 3 == 1 ? 1 : -1;
+    }
+
+    int corner = CORNERS[(flip ? 6 : 0) + vertex];
+    int u = corner == 1 || corner == 2 ? width : 0;
+    int v = corner >= 2 ? height : 0;
+
+    pos[U_AXIS[axis]] += u;
+    pos[V_AXIS[axis]] += v;
+    if ((dir & 1u) == 0u) {
+        pos[axis] += 1;
+    }
+
+    gl_Position = u_view_projection * vec4(vec3(a_chunk_origin + pos), 1.0);
+    v_uv = vec2(u, v);
+    v_layer = q.y & 255u;
+    v_shade = FACE_SHADE[dir] * AO_SHADE[ao[corner]] * pow(0.8, float(15u - light[corner]));
+}
+)glsl";
+
+    const char* const QUAD_FRAGMENT_SHADER = R"glsl(
+#version 430 core
+
+layout(binding = 0) uniform sampler2DArray u_textures;
+
+in vec2 v_uv;
+flat in uint v_layer;
+in float v_shade;
+
+out vec4 o_color;
+
+void main() {
+    vec4 color = texture(u_textures, vec3(v_uv, float(v_layer)));
+    o_color = vec4(color.rgb * v_shade, color.a);
+}
+)glsl";
+}  // namespace qc
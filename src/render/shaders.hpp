@@ -0,0 +1,10 @@
+#pragma once
+
+namespace qc {
+    // GLSL 4.30 sources for chunk rendering. The vertex shader reads packed_quad records (see
+    // mesh/quad.hpp) from the shader storage buffer at binding 0 and expands each into six
+    // vertices using gl_VertexID, so no vertex attributes carry geometry. The only attribute is
+    // the per-draw chunk origin supplied by chunk_renderer.
+    extern const char* const QUAD_VERTEX_SHADER;
+    extern const char* const QUAD_FRAGMENT_SHADER;
+}  // namespace qc
@@ -0,0 +1,236 @@
+#include "render/visibility.hpp"
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+
+#include "core/profile.hpp"
+#include "render/frustum.hpp"
+
+namespace qc {
+    namespace {
+        constexpr std::uint8_t FLAG_SEE_THROUGH = 1;
+        constexpr int SECTION_AREA = SECTION_SIZE * SECTION_SIZE;
+        constexpr std::uint16_t FULL_ROW = 0xFFFF;
+        constexpr int SECTION_TO_CHUNK_SHIFT = CHUNK_SIZE_LOG2 - SECTION_SIZE_LOG2;
+        static_assert(SECTION_SIZE == 16, "section rows are 16-bit masks");
+
+        constexpr std::uint8_t visibility_flags(block_id block) {
+            return block_properties(block).opaque ? 0 : FLAG_SEE_THROUGH;
+        }
+
+        // Every face linked to every other: what open air gives.
+        std::uint64_t link_all(std::uint8_t faces) {
+            std::uint64_t bits = 0;
+            for (int f = 0; f < FACE_COUNT; f++) {
+                if (faces >> f & 1) {
+                    bits |= static_cast<std::uint64_t>(faces) << (f * FACE_COUNT);
+                }
+            }
+            return bits;
+        }
+
+        // Extends `bits` over the runs of `open` they touch.
+        std::uint16_t grow_runs(std::uint16_t bits, std::uint16_t open) {
+            for (;;) {
+                const std::uint16_t next =
+                    static_cast<std::uint16_t>((bits | bits << 1 | bits >> 1) & open);
+                if (next == bits) {
+                    return bits;
+                }
+                bits = next;
+            }
+        }
+
+        // Bit x of open[y * SECTION_SIZE + z] is set for see-through voxels. Returns the links
+        // between faces touching the same connected region, marking the voxels of each in
+        // `seen`.
+        std::uint64_t section_flood(const std::uint16_t* open, std::uint16_t* seen) {
+            struct span {
+                int row;
+                std::uint16_t bits;
+            };
+            span stack[SECTION_AREA * SECTION_SIZE];
+            std::uint64_t links = 0;
+
+            for (int start = 0; start < SECTION_AREA; start++) {
+                while ((open[start] & ~seen[start]) != 0) {
+                    const int free = open[start] & ~seen[start];
+                    int top = 0;
+                    std::uint8_t faces = 0;
+                    // Each voxel is pushed once: bits are marked seen as they are pushed.
+                    const auto visit = [&](int row, std::uint16_t bits) {
+                        bits = static_cast<std::uint16_t>(grow_runs(bits, open[row]) & ~seen[row]);
+                        if (bits != 0) {
+                            seen[row] |= bits;
+                            stack[top++] = {row, bits};
+                        }
+                    };
+                    visit(start, static_cast<std::uint16_t>(free & -free));
+                    while (top > 0) {
+                        const span s = stack[--top];
+                        const int y = s.row / SECTION_SIZE;
+                        const int z = s.row % SECTION_SIZE;
+                        faces |= (s.bits & 1) != 0 ? 1 << FACE_NEG_X : 0;
+                        faces |= (s.bits >> (SECTION_SIZE - 1)) != 0 ? 1 << FACE_POS_X : 0;
+                        faces |= y == 0 ? 1 << FACE_NEG_Y : y == SECTION_SIZE - 1 ? 1 << FACE_POS_Y
+                                                                                   : 0;
+                        faces |= z == 0 ? 1 << FACE_NEG_Z : z == SECTION_SIZE - 1 ? 1 << FACE_POS_Z
+                                                                                   : 0;
+                        if (y > 0) {
+                            visit(s.row - SECTION_SIZE, s.bits & open[s.row - SECTION_SIZE]);
+                        }
+                        if (y < SECTION_SIZE - 1) {
+                            visit(s.row + SECTION_SIZE, s.bits & open[s.row + SECTION_SIZE]);
+                        }
+                        if (z > 0) {
+                            visit(s.row - 1, s.bits & open[s.row - 1]);
+                        }
+                        if (z < SECTION_SIZE - 1) {
+                            visit(s.row + 1, s.bits & open[s.row + 1]);
+                        }
+                    }
+                    links |= link_all(faces);
+                }
+            }
+            return links;
+        }
+    }  // namespace
+
+    void build_visibility(const chunk& c, chunk_visibility& out) {
+        QC_PROFILE_ZONE("visibility.build");
+        constexpr std::uint8_t ALL_FACES = (1 << FACE_COUNT) - 1;
+        if (c.is_uniform()) {
+            const bool open = (visibility_flags(c.uniform_block()) & FLAG_SEE_THROUGH) != 0;
+            for (section_links& links : out.sections) {
+                links.bits = open ? link_all(ALL_FACES) : 0;
+            }
+            return;
+        }
+
+        std::uint64_t rows[CHUNK_AREA];
+        c.unpack_masks(block_flag_table<visibility_flags>(), FLAG_SEE_THROUGH, 0, rows);
+        for (int sy = 0; sy < CHUNK_SECTIONS; sy++) {
+            for (int sz = 0; sz < CHUNK_SECTIONS; sz++) {
+                for (int sx = 0; sx < CHUNK_SECTIONS; sx++) {
+                    std::uint16_t open[SECTION_AREA];
+                    std::uint16_t all = FULL_ROW;
+                    std::uint16_t any = 0;
+                    for (int y = 0; y < SECTION_SIZE; y++) {
+                        for (int z = 0; z < SECTION_SIZE; z++) {
+                            const std::uint64_t row = rows[(sy * SECTION_SIZE + y) * CHUNK_SIZE +
+                                                           sz * SECTION_SIZE + z];
+                            const std::uint16_t bits =
+                                static_cast<std::uint16_t>(row >> (sx * SECTION_SIZE));
+                            open[y * SECTION_SIZE + z] = bits;
+                            all &= bits;
+                            any |= bits;
+                        }
+                    }
+                    section_links& links = out.sections[section_index(sx, sy, sz)];
+                    if (all == FULL_ROW || any == 0) {
+                        links.bits = any != 0 ? link_all(ALL_FACES) : 0;
+                        continue;
+                    }
+                    std::uint16_t seen[SECTION_AREA] = {};
+                    links.bits = section_flood(open, seen);
+                }
+            }
+        }
+    }
+
+    void visibility_graph::set(const glm::ivec3& pos, const chunk_visibility& visibility) {
+        m_chunks[pos] = visibility;
+    }
+
+    void visibility_graph::remove(const glm::ivec3& pos) {
+        m_chunks.erase(pos);
+    }
+
+    void visibility_graph::cull(const glm::vec3& eye, const glm::mat4& view_projection,
+                                int radius, std::vector<glm::ivec3>& out) {
+        QC_PROFILE_ZONE("visibility.cull");
+        out.clear();
+        m_visited = 0;
+        const frustum view(view_projection);
+        const glm::ivec3 start(glm::floor(eye / static_cast<float>(SECTION_SIZE)));
+        const glm::ivec3 center_chunk(start.x >> SECTION_TO_CHUNK_SHIFT,
+                                      start.y >> SECTION_TO_CHUNK_SHIFT,
+                                      start.z >> SECTION_TO_CHUNK_SHIFT);
+        const int chunk_side = 2 * radius + 1;
+        const int side = chunk_side * CHUNK_SECTIONS;
+        const glm::ivec3 low_chunk = center_chunk - glm::ivec3(radius);
+        const glm::ivec3 low = low_chunk * CHUNK_SECTIONS;
+        m_seen_sections.assign(static_cast<std::size_t>(side) * side * side, 0);
+        m_seen_chunks.assign(static_cast<std::size_t>(chunk_side) * chunk_side * chunk_side, 0);
+        m_queue.clear();
+
+        const chunk_visibility* cached = nullptr;
+        glm::ivec3 cached_pos(0);
+        const auto links_of = [&](const glm::ivec3& section, const glm::ivec3& chunk_pos) {
+            if (cached == nullptr || cached_pos != chunk_pos) {
+                const auto it = m_chunks.find(chunk_pos);
+                if (it == m_chunks.end()) {
+                    return static_cast<const section_links*>(nullptr);
+                }
+                cached = &it->second;
+                cached_pos = chunk_pos;
+            }
+            const glm::ivec3 local = section - chunk_pos * CHUNK_SECTIONS;
+            return &cached->sections[section_index(local.x, local.y, local.z)];
+        };
+
+        const glm::ivec3 offset = start - low;
+        m_seen_sections[(static_cast<std::size_t>(offset.y) * side + offset.z) * side + offset.x] =
+            1;
+        m_queue.push_back({start, FACE_COUNT, 0});
+        for (std::size_t head = 0; head < m_queue.size(); head++) {
+            const step current = m_queue[head];
+            const glm::ivec3 chunk_pos(current.section.x >> SECTION_TO_CHUNK_SHIFT,
+                                       current.section.y >> SECTION_TO_CHUNK_SHIFT,
+                                       current.section.z >> SECTION_TO_CHUNK_SHIFT);
+            const section_links* links = links_of(current.section, chunk_pos);
+            if (links != nullptr) {
+                m_visited++;
+                const glm::ivec3 c = chunk_pos - low_chunk;
+                std::uint8_t& seen =
+                    m_seen_chunks[(static_cast<std::size_t>(c.y) * chunk_side + c.z) * chunk_side +
+                                  c.x];
+                if (seen == 0) {
+                    seen = 1;
+                    out.push_back(chunk_pos);
+                }
+            }
+
+            for (int f = 0; f < FACE_COUNT; f++) {
+                const face exit = static_cast<face>(f);
+                if ((current.directions >> face_opposite(exit) & 1) != 0) {
+                    continue;
+                }
+                if (current.entry != FACE_COUNT && links != nullptr &&
+                    !links->connects(static_cast<face>(current.entry), exit)) {
+                    continue;
+                }
+                const glm::ivec3 next = current.section + glm::ivec3(FACE_OFFSETS[f][0],
+                                                                     FACE_OFFSETS[f][1],
+                                                                     FACE_OFFSETS[f][2]);
+                const glm::ivec3 n = next - low;
+                if (n.x < 0 || n.y < 0 || n.z < 0 || n.x >= side || n.y >= side || n.z >= side) {
+                    continue;
+                }
+                std::uint8_t& seen =
+                    m_seen_sections[(static_cast<std::size_t>(n.y) * side + n.z) * side + n.x];
+                if (seen != 0) {
+                    continue;
+                }
+                const glm::vec3 min(glm::vec3(next) * static_cast<float>(SECTION_SIZE));
+                if (!view.intersects({min, min + glm::vec3(static_cast<float>(SECTION_SIZE))})) {
+                    continue;
+                }
+                seen = 1;
+                m_queue.push_back({next, face_opposite(exit),
+                                   static_cast<std::uint8_t>(current.directions | 1 << f)});
+            }
+        }
+    }
+}  // namespace qc
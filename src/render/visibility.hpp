@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "world/chunk.hpp"
+#include "world/face.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // Edge of the cubic sections the visibility graph is built over.
+    constexpr int SECTION_SIZE_LOG2 = 4;
+    constexpr int SECTION_SIZE = 1 << SECTION_SIZE_LOG2;
+    constexpr int CHUNK_SECTIONS = CHUNK_SIZE / SECTION_SIZE;
+    constexpr int CHUNK_SECTION_COUNT = CHUNK_SECTIONS * CHUNK_SECTIONS * CHUNK_SECTIONS;
+
+    // Sections of a chunk are numbered like its voxels: x fastest, then z, then y.
+    constexpr int section_index(int x, int y, int z) {
+        return (y * CHUNK_SECTIONS + z) * CHUNK_SECTIONS + x;
+    }
+
+    // Which faces of a section see each other through it: bit a * FACE_COUNT + b is set when
+    // faces a and b touch the same connected region of see-through voxels. Symmetric, and a face
+    // links to itself when any see-through voxel touches it.
+    struct section_links {
+        std::uint64_t bits = 0;
+
+        bool connects(face a, face b) const {
+            return (bits >> (a * FACE_COUNT + b) & 1) != 0;
+        }
+    };
+
+    struct chunk_visibility {
+        section_links sections[CHUNK_SECTION_COUNT];
+    };
+
+    // Flood fills the see-through voxels of every section of `c` to find which faces connect.
+    // Meant to run beside meshing, whenever a chunk's blocks change.
+    void build_visibility(const chunk& c, chunk_visibility& out);
+
+    // Cave culling. Holds the face connectivity of every loaded chunk's sections and, each frame,
+    // walks outwards from the camera's section through the frustum, only leaving a section
+    // through a face that connects to the one it was entered by. A walk never turns back along
+    // an axis it has already travelled the other way, so light cannot bend around corners
+    // indefinitely. Sections sealed off from the camera by solid rock are never reached, which
+    // skips most of the surface for a player underground and most caves for one above it.
+    //
+    // Chunks without visibility data count as open air. Not synchronized.
+    class visibility_graph {
+    public:
+        void set(const glm::ivec3& pos, const chunk_visibility& visibility);
+        void remove(const glm::ivec3& pos);
+
+        std::size_t chunk_count() const {
+            return m_chunks.size();
+        }
+
+        // Replaces `out` with the loaded chunks within `radius` chunks of the camera (on every
+        // axis) that have a reachable section, in the order the walk reached them.
+        void cull(const glm::vec3& eye, const glm::mat4& view_projection, int radius,
+                  std::vector<glm::ivec3>& out);
+
+        // Sections of loaded chunks the last cull() reached.
+        std::size_t visited_sections() const {
+            return m_visited;
+        }
+
+    private:
+        struct step {
+            glm::ivec3 section;
+            // Face the section was entered by, FACE_COUNT for the camera's own.
+            std::uint8_t entry;
+            // Bit f is set once the walk has crossed a face f of some section.
+            std::uint8_t directions;
+        };
+
+        std::unordered_map<glm::ivec3, chunk_visibility, chunk_pos_hash> m_chunks;
+        // Scratch for cull(): seen flags over the cube of sections and of chunks in range.
+        std::vector<std::uint8_t> m_seen_sections;
+        std::vector<std::uint8_t> m_seen_chunks;
+        std::vector<step> m_queue;
+        std::size_t m_visited = 0;
+    };
+}  // namespace qc
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace qc {
+    // What the server and its players say to each other. Coordinates are three 32-bit integers.
+    enum message_type : std::uint8_t {
+        // Player to server: the block the player stands in. The first one spawns the player.
+        MSG_POSITION = 1,
+        // Server to player: a chunk's position followed by its chunk::encode() output.
+        MSG_CHUNK,
+        // Server to player: the position of a chunk that went out of the player's range.
+        MSG_UNLOAD,
+    };
+
+    constexpr std::size_t POSITION_SIZE = 3 * sizeof(std::int32_t);
+
+    inline void write_position(std::uint8_t* out, const glm::ivec3& pos) {
+        const std::int32_t values[3] = {pos.x, pos.y, pos.z};
+        std::memcpy(out, values, sizeof(values));
+    }
+
+    inline void append_position(std::vector<std::uint8_t>& out, const glm::ivec3& pos) {
+        out.resize(out.size() + POSITION_SIZE);
+        write_position(out.data() + out.size() - POSITION_SIZE, pos);
+    }
+
+    inline glm::ivec3 read_position(const std::uint8_t* data) {
+        std::int32_t values[3];
+        std::memcpy(values, data, sizeof(values));
+        return glm::ivec3(values[0], values[1], values[2]);
+    }
+}  // namespace qc
@@ -0,0 +1,294 @@
+#include "server/server.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+#include "core/log.hpp"
+#include "core/profile.hpp"
+#include "server/protocol.hpp"
+
+namespace qc {
+    namespace {
+        int distance2(const glm::ivec3& pos, const glm::ivec3& center) {
+            const int dx = pos.x - center.x;
+            const int dz = pos.z - center.z;
+            return dx * dx + dz * dz;
+        }
+    }  // namespace
+
+    tick_histogram::tick_histogram(double tick_ms)
+        : m_buckets(static_cast<std::size_t>(std::ceil(4.0 * tick_ms / BUCKET_MS)) + 1, 0),
+          m_tick_ms(tick_ms) {
+    }
+
+    void tick_histogram::add(double ms) {
+        const std::size_t bucket =
+            std::min(static_cast<std::size_t>(ms / BUCKET_MS), m_buckets.size() - 1);
+        m_buckets[bucket]++;
+        m_count++;
+        m_over_budget += ms > m_tick_ms ? 1 : 0;
+        m_total_ms += ms;
+        m_max_ms = std::max(m_max_ms, ms);
+    }
+
+    double tick_histogram::percentile_ms(double p) const {
+        const double wanted = p / 100.0 * static_cast<double>(m_count);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < m_buckets.size(); i++) {
+            seen += m_buckets[i];
+            if (seen > 0 && static_cast<double>(seen) >= wanted) {
+                return std::min(static_cast<double>(i + 1) * BUCKET_MS, m_max_ms);
+            }
+        }
+        return m_max_ms;
+    }
+
+    dedicated_server::dedicated_server(const server_settings& settings)
+        : m_settings(settings), m_jobs(settings.threads),
+          m_max_jobs(settings.max_jobs > 0 ? settings.max_jobs
+                                           : 16 * static_cast<int>(m_jobs.thread_count())),
+          m_tick_times(1000.0 / settings.tick_rate) {
+        for (unsigned i = 0; i < m_jobs.thread_count(); i++) {
+            m_generators.push_back(std::make_unique<terrain_generator>(settings.seed));
+        }
+    }
+
+    dedicated_server::~dedicated_server() {
+        m_jobs.wait_idle();
+    }
+
+    bool dedicated_server::start() {
+        m_listener = tcp_socket::listen(m_settings.address.c_str(), m_settings.port);
+        if (!m_listener.valid()) {
+            return false;
+        }
+        m_port = m_listener.local_port();
+        subsystem_logger(LOG_NET).info("listening on {}:{}", m_settings.address, m_port);
+        return true;
+    }
+
+    void dedicated_server::tick() {
+        const auto start = std::chrono::steady_clock::now();
+        {
+            QC_PROFILE_ZONE("server.tick");
+            accept_players();
+            for (const std::unique_ptr<player>& p : m_players) {
+                read_player(*p);
+            }
+            drain();
+            submit_generation();
+            for (const std::unique_ptr<player>& p : m_players) {
+                send_chunks(*p);
+                p->link.flush();
+            }
+
+            const auto gone = [](const std::unique_ptr<player>& p) { return !p->link.open(); };
+            for (const std::unique_ptr<player>& p : m_players) {
+                if (gone(p)) {
+                    drop(*p);
+                }
+            }
+            m_players.erase(std::remove_if(m_players.begin(), m_players.end(), gone),
+                            m_players.end());
+        }
+        m_tick_times.add(std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count());
+    }
+
+    void dedicated_server::run(const std::atomic<bool>& stop, std::uint64_t ticks) {
+        const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / m_settings.tick_rate));
+        auto next = std::chrono::steady_clock::now();
+        for (std::uint64_t t = 0; !stop.load() && (ticks == 0 || t < ticks); t++) {
+            tick();
+            next += period;
+            const auto now = std::chrono::steady_clock::now();
+            if (next < now) {
+                next = now;
+            } else {
+                std::this_thread::sleep_until(next);
+            }
+        }
+    }
+
+    void dedicated_server::accept_players() {
+        if (!m_listener.valid()) {
+            return;
+        }
+        for (tcp_socket s = m_listener.accept(); s.valid(); s = m_listener.accept()) {
+            auto p = std::make_unique<player>();
+            p->id = m_next_id++;
+            p->link = connection(std::move(s));
+            subsystem_logger(LOG_NET).debug("player {} connected", p->id);
+            m_players.push_back(std::move(p));
+        }
+    }
+
+    void dedicated_server::read_player(player& p) {
+        bool moved = false;
+        p.link.receive([&](std::uint8_t type, const std::uint8_t* data, std::size_t size) {
+            if (type == MSG_POSITION && size == POSITION_SIZE) {
+                p.position = read_position(data);
+                moved = true;
+            } else {
+                subsystem_logger(LOG_NET).warn("player {} sent a bad message", p.id);
+                p.link.close();
+            }
+        });
+        if (!moved || !p.link.open()) {
+            return;
+        }
+        const glm::ivec3 center = chunk_of(p.position);
+        if (!p.spawned || center.x != p.center.x || center.z != p.center.z) {
+            p.spawned = true;
+            p.center = center;
+            update_range(p);
+        }
+    }
+
+    void dedicated_server::update_range(player& p) {
+        const int r = m_settings.view_radius;
+        std::vector<glm::ivec3> requested;
+        for (int z = p.center.z - r; z <= p.center.z + r; z++) {
+            for (int x = p.center.x - r; x <= p.center.x + r; x++) {
+                for (int y = 0; y < m_settings.layers; y++) {
+                    const glm::ivec3 pos(x, y, z);
+                    if (distance2(pos, p.center) > r * r ||
+                        !p.watching.emplace(pos, false).second) {
+                        continue;
+                    }
+                    if (watch(pos)) {
+                        requested.push_back(pos);
+                    }
+                }
+            }
+        }
+
+        std::vector<std::uint8_t> payload;
+        p.unsent.clear();
+        for (auto it = p.watching.begin(); it != p.watching.end();) {
+            if (distance2(it->first, p.center) <= (r + 1) * (r + 1)) {
+                if (!it->second) {
+                    p.unsent.push_back(it->first);
+                }
+                ++it;
+                continue;
+            }
+            if (it->second) {
+                payload.clear();
+                append_position(payload, it->first);
+                p.link.send(MSG_UNLOAD, payload.data(), payload.size());
+            }
+            unwatch(it->first);
+            it = p.watching.erase(it);
+        }
+        const auto nearer = [&](const glm::ivec3& a, const glm::ivec3& b) {
+            return distance2(a, p.center) < distance2(b, p.center);
+        };
+        std::sort(p.unsent.begin(), p.unsent.end(), nearer);
+        std::sort(requested.begin(), requested.end(), nearer);
+        m_requested.insert(m_requested.end(), requested.begin(), requested.end());
+    }
+
+    bool dedicated_server::watch(const glm::ivec3& pos) {
+        std::unique_ptr<entry>& e = m_entries[pos];
+        const bool created = e == nullptr;
+        if (created) {
+            e = std::make_unique<entry>();
+            e->pos = pos;
+            e->queued = true;
+        }
+        e->watchers++;
+        return created;
+    }
+
+    void dedicated_server::unwatch(const glm::ivec3& pos) {
+        const auto it = m_entries.find(pos);
+        entry& e = *it->second;
+        if (--e.watchers > 0 || e.busy) {
+            // A job still holds it; drain() unloads it once the job is done.
+            return;
+        }
+        if (e.ready) {
+            m_world.erase(pos);
+        }
+        m_entries.erase(it);
+    }
+
+    void dedicated_server::drop(player& p) {
+        subsystem_logger(LOG_NET).debug("player {} disconnected", p.id);
+        for (const auto& it : p.watching) {
+            unwatch(it.first);
+        }
+        p.watching.clear();
+        p.unsent.clear();
+    }
+
+    void dedicated_server::drain() {
+        {
+            std::lock_guard<std::mutex> lock(m_finished_mutex);
+            m_drained.swap(m_finished);
+        }
+        for (entry* e : m_drained) {
+            e->busy = false;
+            m_in_flight--;
+            if (e->watchers == 0) {
+                m_entries.erase(e->pos);
+                continue;
+            }
+            m_world.insert(e->pos, std::move(e->blocks));
+            e->ready = true;
+        }
+        m_drained.clear();
+    }
+
+    void dedicated_server::submit_generation() {
+        while (m_in_flight < m_max_jobs && !m_requested.empty()) {
+            const auto it = m_entries.find(m_requested.front());
+            m_requested.pop_front();
+            // Unloaded, or requested again by another player and already on its way.
+            if (it == m_entries.end() || !it->second->queued) {
+                continue;
+            }
+            entry* e = it->second.get();
+            e->queued = false;
+            e->busy = true;
+            e->blocks = std::make_unique<chunk>();
+            m_in_flight++;
+            m_jobs.submit([this, e] {
+                m_generators[m_jobs.current_worker()]->generate(*e->blocks, e->pos);
+                e->payload.clear();
+                append_position(e->payload, e->pos);
+                e->blocks->encode(e->payload);
+                std::lock_guard<std::mutex> lock(m_finished_mutex);
+                m_finished.push_back(e);
+            });
+        }
+    }
+
+    void dedicated_server::send_chunks(player& p) {
+        if (p.unsent.empty() || p.link.queued_bytes() > m_settings.send_window) {
+            return;
+        }
+        int sent = 0;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < p.unsent.size(); i++) {
+            const glm::ivec3 pos = p.unsent[i];
+            const entry& e = *m_entries.find(pos)->second;
+            if (!e.ready || sent >= m_settings.chunks_per_tick) {
+                p.unsent[kept++] = pos;
+                continue;
+            }
+            p.link.send(MSG_CHUNK, e.payload.data(), e.payload.size());
+            p.watching[pos] = true;
+            m_chunks_sent++;
+            m_bytes_sent += e.payload.size();
+            sent++;
+        }
+        p.unsent.resize(kept);
+    }
+}  // namespace qc
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/job_system.hpp"
+#include "net/connection.hpp"
+#include "world/terrain.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    struct server_settings {
+        // Port 0 picks a free one; port() tells which.
+        std::string address = "127.0.0.1";
+        std::uint16_t port = 27015;
+        int tick_rate = 20;
+        // Players get the columns within `view_radius` chunks of them, `layers` chunks high
+        // from y = 0. Chunks go out of a player's range one chunk further out.
+        int view_radius = 6;
+        int layers = 4;
+        std::uint32_t seed = 42;
+        // Generation workers; 0 means one per hardware thread.
+        unsigned threads = 0;
+        // Generation jobs in flight; 0 means 16 per worker.
+        int max_jobs = 0;
+        // Chunks sent to each player per tick, nearest first. None go to a player with more
+        // than `send_window` bytes still waiting for the socket.
+        int chunks_per_tick = 16;
+        std::size_t send_window = 256 * 1024;
+    };
+
+    // Tick times in 0.25 ms buckets up to four ticks, longer ones counted in the last.
+    class tick_histogram {
+    public:
+        explicit tick_histogram(double tick_ms);
+
+        void add(double ms);
+
+        std::uint64_t count() const {
+            return m_count;
+        }
+
+        double mean_ms() const {
+            return m_count > 0 ? m_total_ms / static_cast<double>(m_count) : 0.0;
+        }
+
+        double max_ms() const {
+            return m_max_ms;
+        }
+
+        // Ticks that took longer than a tick.
+        std::uint64_t over_budget() const {
+            return m_over_budget;
+        }
+
+        // Upper edge of the bucket holding the `p`th percentile, `p` from 0 to 100.
+        double percentile_ms(double p) const;
+
+    private:
+        static constexpr double BUCKET_MS = 0.25;
+
+        std::vector<std::uint64_t> m_buckets;
+        double m_tick_ms;
+        std::uint64_t m_count = 0;
+        std::uint64_t m_over_budget = 0;
+        double m_total_ms = 0.0;
+        double m_max_ms = 0.0;
+    };
+
+    // A world without a window: ticks at a fixed rate, takes players over TCP and streams them
+    // the chunks around them. Needs no GL context, so many servers can share a machine.
+    //
+    // A chunk is loaded while any player is in range of it. Terrain is generated and encoded by
+    // jobs. Light is not sent, so the server leaves it to the players, who light what they
+    // receive as the game lights streamed chunks. Every tick sends each player the nearest
+    // chunks it has not got yet, holding back while its connection is backed up.
+    // Everything but the jobs runs on the thread calling tick().
+    class dedicated_server {
+    public:
+        explicit dedicated_server(const server_settings& settings = {});
+        // Waits for the generation jobs.
+        ~dedicated_server();
+
+        dedicated_server(const dedicated_server&) = delete;
+        dedicated_server& operator=(const dedicated_server&) = delete;
+
+        // Starts listening. Returns false if the socket cannot be opened.
+        bool start();
+
+        std::uint16_t port() const {
+            return m_port;
+        }
+
+        void tick();
+
+        // Ticks at the tick rate until `stop` is set or `ticks` have run, 0 for no limit. A
+        // tick that overruns delays the next one rather than making later ticks hurry.
+        void run(const std::atomic<bool>& stop, std::uint64_t ticks = 0);
+
+        const tick_histogram& tick_times() const {
+            return m_tick_times;
+        }
+
+        std::size_t player_count() const {
+            return m_players.size();
+        }
+
+        // Chunks being generated or loaded.
+        std::size_t chunk_count() const {
+            return m_entries.size();
+        }
+
+        std::uint64_t chunks_sent() const {
+            return m_chunks_sent;
+        }
+
+        std::uint64_t bytes_sent() const {
+            return m_bytes_sent;
+        }
+
+    private:
+        struct entry {
+            glm::ivec3 pos;
+            // Players in range.
+            int watchers = 0;
+            // Waiting for a generation job, or held by one.
+            bool queued = false;
+            bool busy = false;
+            // In the world with its MSG_CHUNK payload.
+            bool ready = false;
+            // Filled by the job, then moved into the world.
+            std::unique_ptr<chunk> blocks;
+            std::vector<std::uint8_t> payload;
+        };
+
+        struct player {
+            std::uint32_t id = 0;
+            connection link;
+            bool spawned = false;
+            glm::ivec3 position{0};
+            glm::ivec3 center{0};
+            // Chunks in range, and whether the player has been sent each.
+            std::unordered_map<glm::ivec3, bool, chunk_pos_hash> watching;
+            // Watched chunks not yet sent, nearest first.
+            std::vector<glm::ivec3> unsent;
+        };
+
+        void accept_players();
+        void read_player(player& p);
+        void update_range(player& p);
+        // Returns true if the chunk was not loaded and has been queued for generation.
+        bool watch(const glm::ivec3& pos);
+        void unwatch(const glm::ivec3& pos);
+        void drop(player& p);
+
+        void drain();
+        void submit_generation();
+        void send_chunks(player& p);
+
+        server_settings m_settings;
+        tcp_socket m_listener;
+        std::uint16_t m_port = 0;
+
+        world m_world;
+        job_system m_jobs;
+        // One per worker.
+        std::vector<std::unique_ptr<terrain_generator>> m_generators;
+
+        std::vector<std::unique_ptr<player>> m_players;
+        std::uint32_t m_next_id = 1;
+
+        std::unordered_map<glm::ivec3, std::unique_ptr<entry>, chunk_pos_hash> m_entries;
+        // Positions waiting for a job, nearest to the player who wanted them first. Entries
+        // unloaded meanwhile are skipped.
+        std::deque<glm::ivec3> m_requested;
+
+        // Entries whose job has finished, handed back to tick().
+        std::mutex m_finished_mutex;
+        std::vector<entry*> m_finished;
+        std::vector<entry*> m_drained;
+
+        int m_max_jobs;
+        int m_in_flight = 0;
+        tick_histogram m_tick_times;
+        std::uint64_t m_chunks_sent = 0;
+        std::uint64_t m_bytes_sent = 0;
+    };
+}  // namespace qc
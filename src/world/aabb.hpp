@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include "world/chunk.hpp"
+
+namespace qc {
+    // An axis-aligned box in world space, covering [min, max] on each axis.
+    struct aabb {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // The space taken by chunk `pos`.
+    inline aabb chunk_bounds(const glm::ivec3& pos) {
+        const glm::vec3 min(glm::vec3(pos) * static_cast<float>(CHUNK_SIZE));
+        return {min, min + glm::vec3(static_cast<float>(CHUNK_SIZE))};
+    }
+}  // namespace qc
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "world/face.hpp"
+
+namespace qc {
+    using block_id = std::uint16_t;
+
+    enum : block_id {
+        BLOCK_AIR = 0,
+        BLOCK_STONE,
+        BLOCK_DIRT,
+        BLOCK_GRASS,
+        BLOCK_SAND,
+        BLOCK_WATER,
+        BLOCK_LAMP,
+        BLOCK_COUNT,
+    };
+
+    // Layers of the block texture array.
+    enum : std::uint8_t {
+        TEXTURE_STONE = 0,
+        TEXTURE_DIRT,
+        TEXTURE_GRASS_TOP,
+        TEXTURE_GRASS_SIDE,
+        TEXTURE_SAND,
+        TEXTURE_WATER,
+        TEXTURE_LAMP,
+    };
+
+    struct block_info {
+        // Hides the faces of neighbouring blocks.
+        bool opaque;
+
+        // Texture layers of the +y face, the four side faces and the -y face.
+        std::uint8_t texture_top;
+        std::uint8_t texture_side;
+        std::uint8_t texture_bottom;
+
+        // Block light level emitted, 0..15.
+        std::uint8_t emission;
+
+        // Extra light lost passing through, on top of one level per step. Opaque blocks stop
+        // light entirely.
+        std::uint8_t absorption;
+    };
+
+    constexpr block_info BLOCK_INFO[BLOCK_COUNT] = {
+        {false, 0, 0, 0, 0, 0},                                             // BLOCK_AIR
+        {true, TEXTURE_STONE, TEXTURE_STONE, TEXTURE_STONE, 0, 0},          // BLOCK_STONE
+        {true, TEXTURE_DIRT, TEXTURE_DIRT, TEXTURE_DIRT, 0, 0},             // BLOCK_DIRT
+        {true, TEXTURE_GRASS_TOP, TEXTURE_GRASS_SIDE, TEXTURE_DIRT, 0, 0},  // BLOCK_GRASS
+        {true, TEXTURE_SAND, TEXTURE_SAND, TEXTURE_SAND, 0, 0},             // BLOCK_SAND
+        {false, TEXTURE_WATER, TEXTURE_WATER, TEXTURE_WATER, 0, 2},         // BLOCK_WATER
+        {true, TEXTURE_LAMP, TEXTURE_LAMP, TEXTURE_LAMP, 15, 0},            // BLOCK_LAMP
+    };
+
+    // Ids past the built-in table behave like stone.
+    constexpr const block_info& block_properties(block_id block) {
+        return block < BLOCK_COUNT ? BLOCK_INFO[block] : BLOCK_INFO[BLOCK_STONE];
+    }
+
+    // Whether entities bump into the block and the player can point at it: everything but air
+    // and water.
+    constexpr bool block_solid(block_id block) {
+        return block != BLOCK_AIR && block != BLOCK_WATER;
+    }
+
+    // `Flags` of every block id, indexed by id, for chunk::unpack_masks() and
+    // chunk::unpack_box_masks(). Each `Flags` gets one table, built on first use.
+    template <std::uint8_t (*Flags)(block_id)>
+    const std::uint8_t* block_flag_table() {
+        static const std::unique_ptr<std::uint8_t[]> table = [] {
+            std::unique_ptr<std::uint8_t[]> flags(new std::uint8_t[1 << 16]);
+            for (int block = 0; block < (1 << 16); block++) {
+                flags[block] = Flags(static_cast<block_id>(block));
+            }
+            return flags;
+        }();
+        return table.get();
+    }
+
+    constexpr std::uint8_t block_texture(block_id block, face dir) {
+        const block_info& info = block_properties(block);
+        return dir == FACE_POS_Y ? info.texture_top
+                                 : dir == FACE_NEG_Y ? info.texture_bottom : info.texture_side;
+    }
+}  // namespace qc
@@ -0,0 +1,192 @@
+#include "world/block_ticks.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace qc {
+    namespace {
+        constexpr std::uint64_t WHEEL_MASK = block_scheduler::WHEEL_SLOTS - 1;
+
+        glm::ivec3 voxel_of(const glm::ivec3& chunk_pos, int index) {
+            const int mask = CHUNK_SIZE - 1;
+            return chunk_pos * CHUNK_SIZE +
+                   glm::ivec3(index & mask, index >> (2 * CHUNK_SIZE_LOG2),
+                              (index >> CHUNK_SIZE_LOG2) & mask);
+        }
+    }  // namespace
+
+    block_scheduler::block_scheduler(world& w, std::uint64_t seed)
+        : m_world(w), m_random(seed | 1) {
+    }
+
+    block_scheduler::~block_scheduler() = default;
+
+    void block_scheduler::on(block_id block, tick_kind kind, handler fn) {
+        std::vector<handler>& handlers = m_handlers[kind];
+        if (handlers.size() <= block) {
+            handlers.resize(static_cast<std::size_t>(block) + 1);
+        }
+        handlers[block] = std::move(fn);
+    }
+
+    void block_scheduler::schedule(const glm::ivec3& v, std::uint32_t delay) {
+        const glm::ivec3 pos = chunk_of(v);
+        if (!m_world.contains(pos)) {
+            return;
+        }
+        std::unique_ptr<chunk_wheels>& wheels = m_wheels[pos];
+        if (!wheels) {
+            wheels = std::make_unique<chunk_wheels>();
+        }
+        const glm::ivec3 local = local_of(v);
+        const int index = chunk_index(local.x, local.y, local.z);
+        std::uint64_t& word = wheels->pending[index >> 6];
+        const std::uint64_t bit = std::uint64_t{1} << (index & 63);
+        if ((word & bit) != 0) {
+            return;
+        }
+        word |= bit;
+        wheels->count++;
+        m_pending++;
+        insert(*wheels, {m_now + std::max<std::uint32_t>(delay, 1),
+                         static_cast<std::uint16_t>(index)});
+    }
+
+    bool block_scheduler::scheduled(const glm::ivec3& v) const {
+        const auto it = m_wheels.find(chunk_of(v));
+        if (it == m_wheels.end()) {
+            return false;
+        }
+        const glm::ivec3 local = local_of(v);
+        const int index = chunk_index(local.x, local.y, local.z);
+        return (it->second->pending[index >> 6] >> (index & 63) & 1) != 0;
+    }
+
+    void block_scheduler::insert(chunk_wheels& wheels, const entry& e) {
+        const std::uint64_t delay = e.due - m_now;
+        for (int level = 0; level < WHEEL_LEVELS; level++) {
+            if (delay < std::uint64_t{1} << (WHEEL_BITS * (level + 1))) {
+                wheels.slots[level][e.due >> (WHEEL_BITS * level) & WHEEL_MASK].push_back(e);
+                return;
+            }
+        }
+        wheels.overflow.push_back(e);
+    }
+
+    void block_scheduler::cascade(chunk_wheels& wheels, std::vector<entry>& slot) {
+        // Entries still a lap or more away land back in the slot they came from.
+        m_scratch.clear();
+        m_scratch.swap(slot);
+        for (const entry& e : m_scratch) {
+            insert(wheels, e);
+        }
+    }
+
+    void block_scheduler::set_block(const glm::ivec3& v, block_id block) {
+        if (m_world.get_block(v) == block) {
+            return;
+        }
+        m_world.set_block(v, block);
+        m_changes.push_back(v);
+        notify_neighbors(v);
+    }
+
+    void block_scheduler::notify_neighbors(const glm::ivec3& v) {
+        for (const auto& offset : FACE_OFFSETS) {
+            m_neighbors.push_back(v + glm::ivec3(offset[0], offset[1], offset[2]));
+        }
+    }
+
+    void block_scheduler::remove_chunk(const glm::ivec3& pos) {
+        const auto it = m_wheels.find(pos);
+        if (it != m_wheels.end()) {
+            m_pending -= it->second->count;
+            m_wheels.erase(it);
+        }
+    }
+
+    void block_scheduler::take_changes(std::vector<glm::ivec3>& out) {
+        out.insert(out.end(), m_changes.begin(), m_changes.end());
+        m_changes.clear();
+    }
+
+    std::uint64_t block_scheduler::next_random() {
+        // xorshift64, plenty for picking blocks.
+        m_random ^= m_random << 13;
+        m_random ^= m_random >> 7;
+        m_random ^= m_random << 17;
+        return m_random;
+    }
+
+    void block_scheduler::fire(tick_kind kind, const glm::ivec3& v) {
+        const block_id block = m_world.get_block(v);
+        if (handles(kind, block)) {
+            m_fired[kind]++;
+            m_handlers[kind][block](v);
+        }
+    }
+
+    void block_scheduler::tick() {
+        m_now++;
+        std::fill(std::begin(m_fired), std::end(m_fired), 0);
+
+        // Collected first: handlers may schedule into other chunks, or load them.
+        m_due.clear();
+        for (auto& [pos, wheels] : m_wheels) {
+            if (wheels->count == 0) {
+                continue;
+            }
+            for (int level = WHEEL_LEVELS; level > 0; level--) {
+                if ((m_now & ((std::uint64_t{1} << (WHEEL_BITS * level)) - 1)) == 0) {
+                    cascade(*wheels, level == WHEEL_LEVELS
+                                         ? wheels->overflow
+                                         : wheels->slots[level][m_now >> (WHEEL_BITS * level) &
+                                                                WHEEL_MASK]);
+                }
+            }
+            std::vector<entry>& slot = wheels->slots[0][m_now & WHEEL_MASK];
+            for (const entry& e : slot) {
+                wheels->pending[e.index >> 6] &= ~(std::uint64_t{1} << (e.index & 63));
+                m_due.push_back(voxel_of(pos, e.index));
+            }
+            wheels->count -= slot.size();
+            m_pending -= slot.size();
+            slot.clear();
+        }
+        for (const glm::ivec3& v : m_due) {
+            fire(TICK_SCHEDULED, v);
+        }
+
+        if (!m_handlers[TICK_RANDOM].empty()) {
+            m_due.clear();
+            constexpr int PER_CHUNK = RANDOM_TICKS * (CHUNK_VOLUME / (16 * 16 * 16));
+            m_world.for_each([&](const glm::ivec3& pos, const chunk& c) {
+                if (c.is_uniform() && !handles(TICK_RANDOM, c.uniform_block())) {
+                    return;
+                }
+                for (int i = 0; i < PER_CHUNK; i++) {
+                    const int index = static_cast<int>(next_random() >> 40) & (CHUNK_VOLUME - 1);
+                    if (handles(TICK_RANDOM, c.get(index))) {
+                        m_due.push_back(voxel_of(pos, index));
+                    }
+                }
+            });
+            for (const glm::ivec3& v : m_due) {
+                fire(TICK_RANDOM, v);
+            }
+        }
+
+        // Updates raised meanwhile join the back of the queue.
+        std::size_t budget = max_neighbor_updates;
+        while (m_next_neighbor < m_neighbors.size() && budget > 0) {
+            const glm::ivec3 v = m_neighbors[m_next_neighbor++];
+            fire(TICK_NEIGHBOR, v);
+            budget--;
+        }
+        m_neighbors.erase(m_neighbors.begin(),
+                          m_neighbors.begin() + static_cast<std::ptrdiff_t>(m_next_neighbor));
+        m_next_neighbor = 0;
+    }
+}  // namespace qc
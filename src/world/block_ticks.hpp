@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "world/world.hpp"
+
+namespace qc {
+    enum tick_kind : std::uint8_t {
+        // Asked for with block_scheduler::schedule().
+        TICK_SCHEDULED = 0,
+        // A few random blocks of every loaded chunk each tick.
+        TICK_RANDOM,
+        // A face neighbour was set through block_scheduler::set_block().
+        TICK_NEIGHBOR,
+        TICK_KIND_COUNT,
+    };
+
+    // Gives blocks their ticks: delayed ticks asked for ahead of time, random ticks and
+    // neighbour updates. Behaviour is registered per block type and kind of tick with on().
+    //
+    // Delayed ticks wait in hierarchical timing wheels kept per chunk: WHEEL_LEVELS wheels of
+    // WHEEL_SLOTS slots, the slots of each wheel WHEEL_SLOTS times wider than the last. A tick
+    // goes into the slot of its due time in the finest wheel that reaches that far, and every
+    // WHEEL_SLOTS ticks the next slot of the coarser wheel is spread over the finer one. So
+    // scheduling and firing a tick take constant time however many are pending, where a
+    // sorted queue of all of them pays a logarithm on both. A block has at most one tick
+    // pending, and unloading a chunk drops its ticks with it.
+    //
+    // Neighbour updates run later in the same tick, in the order they were raised; past
+    // `max_neighbor_updates` the rest wait for the next tick, so a chain reaction cannot stall
+    // one.
+    //
+    // Everything runs on the thread calling tick(), handlers included.
+    class block_scheduler {
+    public:
+        using handler = std::function<void(const glm::ivec3& v)>;
+
+        static constexpr int WHEEL_BITS = 6;
+        static constexpr int WHEEL_SLOTS = 1 << WHEEL_BITS;
+        static constexpr int WHEEL_LEVELS = 3;
+        // Random ticks per 16^3 of a chunk each tick.
+        static constexpr int RANDOM_TICKS = 3;
+
+        explicit block_scheduler(world& w, std::uint64_t seed = 1);
+        ~block_scheduler();
+
+        block_scheduler(const block_scheduler&) = delete;
+        block_scheduler& operator=(const block_scheduler&) = delete;
+
+        // Calls `fn` for ticks of `kind` given to blocks of type `block`. Blocks without a
+        // handler for a kind ignore it.
+        void on(block_id block, tick_kind kind, handler fn);
+
+        // Ticks the block at `v` `delay` ticks from now, at least one. Does nothing if the block
+        // already has a tick pending or its chunk is not loaded.
+        void schedule(const glm::ivec3& v, std::uint32_t delay);
+        bool scheduled(const glm::ivec3& v) const;
+
+        // Sets the block and raises neighbour updates around it.
+        void set_block(const glm::ivec3& v, block_id block);
+        void notify_neighbors(const glm::ivec3& v);
+
+        // Forgets the chunk's pending ticks.
+        void remove_chunk(const glm::ivec3& pos);
+
+        // Advances time by one tick: fires the delayed ticks now due, the random ticks and the
+        // neighbour updates.
+        void tick();
+
+        // Moves the blocks set through set_block() since the last call to `out`, for whatever
+        // else keeps state about them, such as light or meshes.
+        void take_changes(std::vector<glm::ivec3>& out);
+
+        std::uint64_t now() const {
+            return m_now;
+        }
+
+        // Delayed ticks pending over all chunks.
+        std::size_t pending() const {
+            return m_pending;
+        }
+
+        // Ticks fired by the last tick(), per kind.
+        std::size_t fired(tick_kind kind) const {
+            return m_fired[kind];
+        }
+
+        std::size_t max_neighbor_updates = 1 << 16;
+
+    private:
+        struct entry {
+            std::uint64_t due;
+            std::uint16_t index;
+        };
+
+        struct chunk_wheels {
+            std::vector<entry> slots[WHEEL_LEVELS][WHEEL_SLOTS];
+            // Past the reach of the coarsest wheel.
+            std::vector<entry> overflow;
+            // One bit per voxel with a tick pending.
+            std::uint64_t pending[CHUNK_VOLUME / 64] = {};
+            std::size_t count = 0;
+        };
+
+        void insert(chunk_wheels& wheels, const entry& e);
+        // Spreads the ticks of a slot of a coarser wheel over the finer ones.
+        void cascade(chunk_wheels& wheels, std::vector<entry>& slot);
+        bool handles(tick_kind kind, block_id block) const {
+            return block < m_handlers[kind].size() && m_handlers[kind][block];
+        }
+        void fire(tick_kind kind, const glm::ivec3& v);
+        std::uint64_t next_random();
+
+        world& m_world;
+        std::vector<handler> m_handlers[TICK_KIND_COUNT];
+        std::unordered_map<glm::ivec3, std::unique_ptr<chunk_wheels>, chunk_pos_hash> m_wheels;
+        std::uint64_t m_now = 0;
+        std::size_t m_pending = 0;
+        std::uint64_t m_random;
+
+        std::vector<glm::ivec3> m_due;
+        std::vector<entry> m_scratch;
+        std::vector<glm::ivec3> m_neighbors;
+        std::size_t m_next_neighbor = 0;
+        std::vector<glm::ivec3> m_changes;
+        std::size_t m_fired[TICK_KIND_COUNT] = {};
+    };
+}  // namespace qc
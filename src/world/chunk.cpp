@@ -0,0 +1,732 @@
+#include "world/chunk.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <memory>
+
+#include "core/bits.hpp"
+
+namespace qc {
+    namespace {
+        int log2_of(int bits) {
+            int log2 = 0;
+            while ((1 << log2) < bits) {
+                log2++;
+            }
+            return log2;
+        }
+
+        // Smallest power-of-two index width able to address `entries` palette slots.
+        int bits_for(std::size_t entries) {
+            int bits = 0;
+            while ((std::size_t{1} << bits) < entries) {
+                bits = bits == 0 ? 1 : bits * 2;
+            }
+            return bits;
+        }
+
+        // For a byte of 2-bit indices, how many of its four fields hold each value, in one 16-bit
+        // lane per value. A chunk has too few voxels to carry out of a lane.
+        constexpr std::array<std::uint64_t, 256> make_pair_counts() {
+            std::array<std::uint64_t, 256> table{};
+            for (int byte = 0; byte < 256; byte++) {
+                for (int shift = 0; shift < 8; shift += 2) {
+                    table[byte] += std::uint64_t{1} << (16 * (byte >> shift & 3));
+                }
+            }
+            return table;
+        }
+
+        constexpr std::array<std::uint64_t, 256> PAIR_COUNTS = make_pair_counts();
+
+        // For a byte of 4-bit indices, how many of its two fields hold each value, in one 8-bit
+        // lane per value: values 0-7 in the first word, 8-15 in the second.
+        constexpr std::array<std::uint64_t, 512> make_nibble_counts() {
+            std::array<std::uint64_t, 512> table{};
+            for (int byte = 0; byte < 256; byte++) {
+                for (int shift = 0; shift < 8; shift += 4) {
+                    const int value = byte >> shift & 15;
+                    table[byte * 2 + value / 8] += std::uint64_t{1} << (8 * (value % 8));
+                }
+            }
+            return table;
+        }
+
+        constexpr std::array<std::uint64_t, 512> NIBBLE_COUNTS = make_nibble_counts();
+
+        // Adds to used[v] how often index v appears in `count` words of packed indices, each
+        // standing for `times` identical words. The common widths count a whole byte per table
+        // lookup into registers, rather than bumping a counter in memory per field, which would
+        // serialize on it wherever neighbouring voxels share a block.
+        void count_indices(const std::uint64_t* words, std::size_t count, int bits,
+                           std::size_t times, std::uint32_t* used) {
+            const auto n = static_cast<std::uint32_t>(times);
+            if (bits == 1) {
+                std::uint32_t ones = 0;
+                for (std::size_t i = 0; i < count; i++) {
+                    ones += static_cast<std::uint32_t>(popcount64(words[i]));
+                }
+                used[0] += (static_cast<std::uint32_t>(count) * 64 - ones) * n;
+                used[1] += ones * n;
+            } else if (bits == 2) {
+                std::uint64_t lanes = 0;
+                for (std::size_t i = 0; i < count; i++) {
+                    for (int shift = 0; shift < 64; shift += 8) {
+                        lanes += PAIR_COUNTS[words[i] >> shift & 0xFF];
+                    }
+                }
+                for (int v = 0; v < 4; v++) {
+                    used[v] += static_cast<std::uint32_t>(lanes >> (16 * v) & 0xFFFF) * n;
+                }
+            } else if (bits == 4) {
+                // A lane gains at most 16 a word, so it is emptied every 15 words.
+                for (std::size_t i = 0; i < count; i += 15) {
+                    std::uint64_t low = 0;
+                    std::uint64_t high = 0;
+                    for (std::size_t j = i; j < std::min(count, i + 15); j++) {
+                        for (int shift = 0; shift < 64; shift += 8) {
+                            const std::size_t byte = words[j] >> shift & 0xFF;
+                            low += NIBBLE_COUNTS[byte * 2];
+                            high += NIBBLE_COUNTS[byte * 2 + 1];
+                        }
+                    }
+                    for (int v = 0; v < 8; v++) {
+                        used[v] += static_cast<std::uint32_t>(low >> (8 * v) & 0xFF) * n;
+                        used[v + 8] += static_cast<std::uint32_t>(high >> (8 * v) & 0xFF) * n;
+                    }
+                }
+            } else {
+                for (std::size_t i = 0; i < count; i++) {
+                    for (int shift = 0; shift < 64; shift += 8) {
+                        used[words[i] >> shift & 0xFF] += n;
+                    }
+                }
+            }
+        }
+
+        // Decodes a byte of packed indices at a time through a table of every possible byte, so
+        // narrow widths emit several voxels per lookup.
+        template <int BITS>
+        void unpack_bytes(const std::vector<std::uint64_t>& data,
+                          const std::vector<block_id>& palette, block_id* out) {
+            constexpr int PER_BYTE = 8 / BITS;
+            constexpr std::uint32_t MASK = (1u << BITS) - 1;
+
+            block_id table[256][PER_BYTE];
+            for (std::uint32_t byte = 0; byte < 256; byte++) {
+                for (int i = 0; i < PER_BYTE; i++) {
+                    const std::uint32_t index = (byte >> (i * BITS)) & MASK;
+                    table[byte][i] = index < palette.size() ? palette[index] : block_id{BLOCK_AIR};
+                }
+            }
+
+            for (const std::uint64_t word : data) {
+                for (int shift = 0; shift < 64; shift += 8) {
+                    const block_id* entry = table[(word >> shift) & 0xFF];
+                    for (int i = 0; i < PER_BYTE; i++) {
+                        *out++ = entry[i];
+                    }
+                }
+            }
+        }
+
+        template <int BITS>
+        void mask_bytes(const std::vector<std::uint64_t>& data,
+                        const std::vector<block_id>& palette, const std::uint8_t* flags,
+                        std::uint8_t low, std::uint8_t high, std::uint64_t* rows) {
+            constexpr int PER_BYTE = 8 / BITS;
+            constexpr std::uint32_t INDEX_MASK = (1u << BITS) - 1;
+
+            // Per palette entry: bit 0 for the low mask, bit 8 for the high mask.
+            std::uint32_t matches[256] = {};
+            for (std::size_t i = 0; i < palette.size(); i++) {
+                const std::uint8_t f = flags[palette[i]];
+                matches[i] = ((f & low) != 0 ? 1u : 0u) | ((f & high) != 0 ? 0x100u : 0u);
+            }
+
+            // Every possible byte of packed indices mapped to its low bits and high bits.
+            std::uint16_t table[256];
+            for (std::uint32_t byte = 0; byte < 256; byte++) {
+                std::uint32_t bits = 0;
+                for (int i = 0; i < PER_BYTE; i++) {
+                    bits |= matches[(byte >> (i * BITS)) & INDEX_MASK] << i;
+                }
+                table[byte] = static_cast<std::uint16_t>(bits);
+            }
+
+            // A row of 32 voxels spans 4 * BITS bytes. Reading the packed words a byte at a time
+            // assumes a little-endian host.
+            const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+            constexpr int BYTES_PER_ROW = 4 * BITS;
+            for (int r = 0; r < CHUNK_AREA; r++) {
+                std::uint32_t lo = 0;
+                std::uint32_t hi = 0;
+                for (int i = 0; i < BYTES_PER_ROW; i++) {
+                    const std::uint32_t bits = table[bytes[i]];
+                    lo |= (bits & 0xFF) << (i * PER_BYTE);
+                    hi |= (bits >> 8) << (i * PER_BYTE);
+                }
+                rows[r] = lo | static_cast<std::uint64_t>(hi) << 32;
+                bytes += BYTES_PER_ROW;
+            }
+        }
+
+        void unpack_direct(const std::vector<std::uint64_t>& data, block_id* out) {
+            for (const std::uint64_t word : data) {
+                for (int shift = 0; shift < 64; shift += 16) {
+                    *out++ = static_cast<block_id>(word >> shift);
+                }
+            }
+        }
+
+        // Little-endian helpers for encode() and decode().
+        template <typename T>
+        void put(std::vector<std::uint8_t>& out, T value) {
+            const std::size_t at = out.size();
+            out.resize(at + sizeof(T));
+            std::memcpy(out.data() + at, &value, sizeof(T));
+        }
+
+        void put_varint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        struct reader {
+            const std::uint8_t* data;
+            std::size_t size;
+            std::size_t at = 0;
+
+            template <typename T>
+            bool get(T& value) {
+                if (size - at < sizeof(T)) {
+                    return false;
+                }
+                std::memcpy(&value, data + at, sizeof(T));
+                at += sizeof(T);
+                return true;
+            }
+
+            bool get_varint(std::uint32_t& value) {
+                value = 0;
+                for (int shift = 0; shift < 35; shift += 7) {
+                    if (at == size) {
+                        return false;
+                    }
+                    const std::uint8_t byte = data[at++];
+                    value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
+    }  // namespace
+
+    chunk::chunk(block_id fill_block) {
+        fill(fill_block);
+    }
+
+    void chunk::set(int index, block_id block) {
+        assert(index >= 0 && index < CHUNK_VOLUME);
+
+        if (m_bits == DIRECT_BITS) {
+            write(index, block);
+            return;
+        }
+
+        const std::uint32_t old_index = read(index);
+        if (m_palette[old_index] == block) {
+            return;
+        }
+
+        const std::uint32_t new_index = find_or_add(block);
+        if (m_bits == DIRECT_BITS) {
+            write(index, block);
+            return;
+        }
+
+        write(index, new_index);
+        m_counts[new_index]++;
+        m_counts[old_index]--;
+    }
+
+    void chunk::fill(block_id block) {
+        m_palette.assign(1, block);
+        m_counts.assign(1, static_cast<std::uint16_t>(CHUNK_VOLUME));
+        m_data.clear();
+        m_data.shrink_to_fit();
+        m_bits = 0;
+        m_bits_log2 = 0;
+        m_mask = 0;
+    }
+
+    void chunk::fill(int min_x, int min_y, int min_z, int max_x, int max_y, int max_z,
+                     block_id block) {
+        min_x = std::max(min_x, 0);
+        min_y = std::max(min_y, 0);
+        min_z = std::max(min_z, 0);
+        max_x = std::min(max_x, CHUNK_SIZE - 1);
+        max_y = std::min(max_y, CHUNK_SIZE - 1);
+        max_z = std::min(max_z, CHUNK_SIZE - 1);
+
+        if (min_x > max_x || min_y > max_y || min_z > max_z) {
+            return;
+        }
+
+        if (min_x == 0 && min_y == 0 && min_z == 0 && max_x == CHUNK_SIZE - 1 &&
+            max_y == CHUNK_SIZE - 1 && max_z == CHUNK_SIZE - 1) {
+            fill(block);
+            return;
+        }
+
+        if (m_bits == 0 && m_palette[0] == block) {
+            return;
+        }
+
+        // Resolve the palette slot once and then write raw indices row by row.
+        const std::uint32_t new_index = find_or_add(block);
+        for (int y = min_y; y <= max_y; y++) {
+            for (int z = min_z; z <= max_z; z++) {
+                for (int x = min_x; x <= max_x; x++) {
+                    const int index = chunk_index(x, y, z);
+                    if (m_bits == DIRECT_BITS) {
+                        write(index, block);
+                        continue;
+                    }
+
+                    const std::uint32_t old_index = read(index);
+                    if (old_index != new_index) {
+                        write(index, new_index);
+                        m_counts[new_index]++;
+                        m_counts[old_index]--;
+                    }
+                }
+            }
+        }
+    }
+
+    void chunk::assign(const block_id* blocks) {
+        // Generated chunks are long runs of one block, so remember the last palette slot.
+        std::vector<block_id> palette{blocks[0]};
+        std::vector<std::uint16_t> counts{0};
+        std::size_t last = 0;
+        bool direct = false;
+        for (int i = 0; i < CHUNK_VOLUME && !direct; i++) {
+            if (blocks[i] != palette[last]) {
+                last = static_cast<std::size_t>(
+                    std::find(palette.begin(), palette.end(), blocks[i]) - palette.begin());
+                if (last == palette.size()) {
+                    direct = palette.size() == MAX_PALETTE_SIZE;
+                    palette.push_back(blocks[i]);
+                    counts.push_back(0);
+                }
+            }
+            counts[last]++;
+        }
+
+        if (palette.size() == 1) {
+            fill(palette[0]);
+            return;
+        }
+
+        const int bits = direct ? DIRECT_BITS : bits_for(palette.size());
+        m_bits = static_cast<std::uint8_t>(bits);
+        m_bits_log2 = static_cast<std::uint8_t>(log2_of(bits));
+        m_mask = (1u << bits) - 1;
+        m_data.assign(static_cast<std::size_t>(CHUNK_VOLUME) * bits / 64, 0);
+        m_data.shrink_to_fit();
+
+        if (direct) {
+            m_palette.clear();
+            m_palette.shrink_to_fit();
+            m_counts.clear();
+            m_counts.shrink_to_fit();
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                write(i, blocks[i]);
+            }
+            return;
+        }
+
+        m_palette = std::move(palette);
+        m_counts = std::move(counts);
+        last = 0;
+        for (int i = 0; i < CHUNK_VOLUME; i++) {
+            if (blocks[i] != m_palette[last]) {
+                last = static_cast<std::size_t>(
+                    std::find(m_palette.begin(), m_palette.end(), blocks[i]) - m_palette.begin());
+            }
+            write(i, static_cast<std::uint32_t>(last));
+        }
+    }
+
+    void chunk::encode(std::vector<std::uint8_t>& out) const {
+        put<std::uint8_t>(out, m_bits);
+        if (m_bits != DIRECT_BITS) {
+            put(out, static_cast<std::uint16_t>(m_palette.size()));
+            for (std::size_t i = 0; i < m_palette.size(); i++) {
+                put(out, m_palette[i]);
+                put(out, m_counts[i]);
+            }
+        }
+
+        // Words as a series of runs and literal spans, each headed by (length << 1) | is_run.
+        const std::size_t words = m_data.size();
+        std::size_t i = 0;
+        while (i < words) {
+            std::size_t run = 1;
+            while (i + run < words && m_data[i + run] == m_data[i]) {
+                run++;
+            }
+            if (run >= 2) {
+                put_varint(out, static_cast<std::uint32_t>(run << 1 | 1));
+                put(out, m_data[i]);
+                i += run;
+                continue;
+            }
+
+            std::size_t literal = 1;
+            while (i + literal < words &&
+                   (i + literal + 1 >= words || m_data[i + literal] != m_data[i + literal + 1])) {
+                literal++;
+            }
+            put_varint(out, static_cast<std::uint32_t>(literal << 1));
+            const std::size_t at = out.size();
+            out.resize(at + literal * sizeof(std::uint64_t));
+            std::memcpy(out.data() + at, &m_data[i], literal * sizeof(std::uint64_t));
+            i += literal;
+        }
+    }
+
+    bool chunk::decode(const std::uint8_t* data, std::size_t size) {
+        reader in{data, size};
+        std::uint8_t bits;
+        if (!in.get(bits) || (bits != 0 && bits != 1 && bits != 2 && bits != 4 && bits != 8 &&
+                              bits != DIRECT_BITS)) {
+            return false;
+        }
+
+        std::vector<block_id> palette;
+        std::vector<std::uint16_t> counts;
+        if (bits != DIRECT_BITS) {
+            // The count has to fit both the index width and the bytes left, checked before
+            // anything is sized from it.
+            std::uint16_t entries;
+            const std::size_t entry_bytes = sizeof(block_id) + sizeof(std::uint16_t);
+            if (!in.get(entries) || entries == 0 || entries > (1u << bits) ||
+                entries > MAX_PALETTE_SIZE || entries > (in.size - in.at) / entry_bytes) {
+                return false;
+            }
+            palette.resize(entries);
+            counts.resize(entries);
+            for (std::size_t i = 0; i < entries; i++) {
+                if (!in.get(palette[i]) || !in.get(counts[i])) {
+                    return false;
+                }
+            }
+            if (bits == 0 && counts[0] != CHUNK_VOLUME) {
+                return false;
+            }
+            // Indices past a short palette would read out of bounds; pad it with free slots.
+            if (bits != 0) {
+                palette.resize(std::size_t{1} << bits, BLOCK_AIR);
+                counts.resize(std::size_t{1} << bits, 0);
+            }
+        }
+
+        // Palette indices are recounted as the words arrive, a run counted once, so the stored
+        // reference counts can be checked against them.
+        std::uint32_t used[MAX_PALETTE_SIZE] = {};
+        const bool paletted = bits != 0 && bits != DIRECT_BITS;
+        std::vector<std::uint64_t> words(static_cast<std::size_t>(CHUNK_VOLUME) * bits / 64);
+        std::size_t filled = 0;
+        while (filled < words.size()) {
+            std::uint32_t header;
+            if (!in.get_varint(header)) {
+                return false;
+            }
+            const std::size_t length = header >> 1;
+            if (length == 0 || length > words.size() - filled) {
+                return false;
+            }
+
+            if ((header & 1) != 0) {
+                std::uint64_t word;
+                if (!in.get(word)) {
+                    return false;
+                }
+                std::fill(words.begin() + filled, words.begin() + filled + length, word);
+                if (paletted) {
+                    count_indices(&word, 1, bits, length, used);
+                }
+            } else {
+                const std::size_t bytes = length * sizeof(std::uint64_t);
+                if (in.size - in.at < bytes) {
+                    return false;
+                }
+                std::memcpy(&words[filled], in.data + in.at, bytes);
+                in.at += bytes;
+                if (paletted) {
+                    count_indices(&words[filled], length, bits, 1, used);
+                }
+            }
+            filled += length;
+        }
+
+        // set() and find_or_add() trust the counts: one too low wraps on removal, and a slot
+        // counted free while voxels still point at it gets handed to another block. Padded
+        // slots count zero, so an index into one fails too.
+        for (std::size_t i = 0; paletted && i < counts.size(); i++) {
+            if (used[i] != counts[i]) {
+                return false;
+            }
+        }
+
+        m_palette = std::move(palette);
+        m_counts = std::move(counts);
+        m_data = std::move(words);
+        m_bits = bits;
+        m_bits_log2 = static_cast<std::uint8_t>(log2_of(bits));
+        m_mask = bits == 0 ? 0 : (1u << bits) - 1;
+        return true;
+    }
+
+    void chunk::compact() {
+        if (m_bits == 0) {
+            return;
+        }
+
+        const auto blocks = std::make_unique<block_id[]>(CHUNK_VOLUME);
+        unpack(blocks.get());
+
+        std::vector<block_id> palette;
+        std::vector<std::uint16_t> counts;
+        if (m_bits == DIRECT_BITS) {
+            std::vector<std::uint16_t> histogram(65536);
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                histogram[blocks[i]]++;
+            }
+
+            for (std::size_t id = 0; id < histogram.size(); id++) {
+                if (histogram[id] != 0) {
+                    palette.push_back(static_cast<block_id>(id));
+                    counts.push_back(histogram[id]);
+                }
+            }
+
+            if (palette.size() > MAX_PALETTE_SIZE) {
+                return;
+            }
+        } else {
+            for (std::size_t i = 0; i < m_palette.size(); i++) {
+                if (m_counts[i] != 0) {
+                    palette.push_back(m_palette[i]);
+                    counts.push_back(m_counts[i]);
+                }
+            }
+        }
+
+        if (palette.size() == 1) {
+            fill(palette[0]);
+            return;
+        }
+
+        m_palette = std::move(palette);
+        m_counts = std::move(counts);
+        m_bits = static_cast<std::uint8_t>(bits_for(m_palette.size()));
+        m_bits_log2 = static_cast<std::uint8_t>(log2_of(m_bits));
+        m_mask = (1u << m_bits) - 1;
+        m_data.assign(static_cast<std::size_t>(CHUNK_VOLUME) * m_bits / 64, 0);
+        m_data.shrink_to_fit();
+
+        for (int i = 0; i < CHUNK_VOLUME; i++) {
+            const auto it = std::find(m_palette.begin(), m_palette.end(), blocks[i]);
+            write(i, static_cast<std::uint32_t>(it - m_palette.begin()));
+        }
+    }
+
+    void chunk::unpack(block_id* out) const {
+        if (m_bits == 0) {
+            std::fill(out, out + CHUNK_VOLUME, m_palette[0]);
+            return;
+        }
+
+        switch (m_bits) {
+        case 1:
+            unpack_bytes<1>(m_data, m_palette, out);
+            break;
+        case 2:
+            unpack_bytes<2>(m_data, m_palette, out);
+            break;
+        case 4:
+            unpack_bytes<4>(m_data, m_palette, out);
+            break;
+        case 8:
+            unpack_bytes<8>(m_data, m_palette, out);
+            break;
+        default:
+            unpack_direct(m_data, out);
+            break;
+        }
+    }
+
+    void chunk::unpack_masks(const std::uint8_t* flags, std::uint8_t low, std::uint8_t high,
+                             std::uint64_t* rows) const {
+        switch (m_bits) {
+        case 0: {
+            const std::uint8_t f = flags[m_palette[0]];
+            const std::uint64_t row = ((f & low) != 0 ? 0xFFFFFFFFull : 0) |
+                                      ((f & high) != 0 ? 0xFFFFFFFF00000000ull : 0);
+            std::fill(rows, rows + CHUNK_AREA, row);
+            break;
+        }
+        case 1:
+            mask_bytes<1>(m_data, m_palette, flags, low, high, rows);
+            break;
+        case 2:
+            mask_bytes<2>(m_data, m_palette, flags, low, high, rows);
+            break;
+        case 4:
+            mask_bytes<4>(m_data, m_palette, flags, low, high, rows);
+            break;
+        case 8:
+            mask_bytes<8>(m_data, m_palette, flags, low, high, rows);
+            break;
+        default:
+            for (int r = 0; r < CHUNK_AREA; r++) {
+                std::uint64_t row = 0;
+                for (int x = 0; x < CHUNK_SIZE; x++) {
+                    const std::uint8_t f = flags[get(r * CHUNK_SIZE + x)];
+                    row |= static_cast<std::uint64_t>((f & low) != 0) << x;
+                    row |= static_cast<std::uint64_t>((f & high) != 0) << (x + 32);
+                }
+                rows[r] = row;
+            }
+            break;
+        }
+    }
+
+    void chunk::unpack_box_masks(const std::uint8_t* flags, std::uint8_t bit, int min_x,
+                                 int min_y, int min_z, int max_x, int max_y, int max_z,
+                                 std::uint32_t* rows) const {
+        const int depth = max_z - min_z + 1;
+        if (m_bits == 0) {
+            const std::uint32_t span =
+                (0xFFFFFFFFu >> (CHUNK_SIZE - 1 - max_x)) & (0xFFFFFFFFu << min_x);
+            const std::uint32_t row = (flags[m_palette[0]] & bit) != 0 ? span : 0u;
+            std::fill(rows, rows + (max_y - min_y + 1) * depth, row);
+            return;
+        }
+
+        // Per palette entry, so the flags are looked up once per entry rather than per voxel.
+        std::uint32_t matches[MAX_PALETTE_SIZE];
+        if (m_bits != DIRECT_BITS) {
+            for (std::size_t i = 0; i < m_palette.size(); i++) {
+                matches[i] = (flags[m_palette[i]] & bit) != 0 ? 1u : 0u;
+            }
+        }
+        for (int y = min_y; y <= max_y; y++) {
+            for (int z = min_z; z <= max_z; z++) {
+                const int base = chunk_index(0, y, z);
+                std::uint32_t row = 0;
+                for (int x = min_x; x <= max_x; x++) {
+                    const std::uint32_t value = read(base + x);
+                    const std::uint32_t match =
+                        m_bits == DIRECT_BITS
+                            ? static_cast<std::uint32_t>((flags[value] & bit) != 0)
+                            : matches[value];
+                    row |= match << x;
+                }
+                rows[(y - min_y) * depth + z - min_z] = row;
+            }
+        }
+    }
+
+    std::size_t chunk::palette_size() const {
+        if (m_bits == DIRECT_BITS) {
+            const auto blocks = std::make_unique<block_id[]>(CHUNK_VOLUME);
+            unpack(blocks.get());
+            std::sort(blocks.get(), blocks.get() + CHUNK_VOLUME);
+            return static_cast<std::size_t>(
+                std::unique(blocks.get(), blocks.get() + CHUNK_VOLUME) - blocks.get());
+        }
+
+        return static_cast<std::size_t>(std::count_if(m_counts.begin(), m_counts.end(),
+                                                      [](std::uint16_t c) { return c != 0; }));
+    }
+
+    std::size_t chunk::memory_usage() const {
+        return sizeof(chunk) + m_palette.capacity() * sizeof(block_id) +
+               m_counts.capacity() * sizeof(std::uint16_t) +
+               m_data.capacity() * sizeof(std::uint64_t);
+    }
+
+    std::uint32_t chunk::find_or_add(block_id block) {
+        if (m_bits == DIRECT_BITS) {
+            return block;
+        }
+
+        std::size_t free_slot = m_palette.size();
+        for (std::size_t i = 0; i < m_palette.size(); i++) {
+            if (m_palette[i] == block) {
+                return static_cast<std::uint32_t>(i);
+            }
+
+            if (m_counts[i] == 0 && free_slot == m_palette.size()) {
+                free_slot = i;
+            }
+        }
+
+        if (free_slot != m_palette.size()) {
+            m_palette[free_slot] = block;
+            return static_cast<std::uint32_t>(free_slot);
+        }
+
+        if (m_palette.size() == MAX_PALETTE_SIZE) {
+            resize(DIRECT_BITS);
+            return block;
+        }
+
+        m_palette.push_back(block);
+        m_counts.push_back(0);
+        const int bits = bits_for(m_palette.size());
+        if (bits != m_bits) {
+            resize(bits);
+        }
+
+        return static_cast<std::uint32_t>(m_palette.size() - 1);
+    }
+
+    void chunk::resize(int bits) {
+        std::vector<std::uint64_t> data(static_cast<std::size_t>(CHUNK_VOLUME) * bits / 64, 0);
+        const int bits_log2 = log2_of(bits);
+
+        for (int i = 0; i < CHUNK_VOLUME; i++) {
+            std::uint32_t value = read(i);
+            if (bits == DIRECT_BITS) {
+                value = m_palette[value];
+            }
+
+            const std::uint32_t bit = static_cast<std::uint32_t>(i) << bits_log2;
+            data[bit >> 6] |= static_cast<std::uint64_t>(value) << (bit & 63);
+        }
+
+        if (bits == DIRECT_BITS) {
+            m_palette.clear();
+            m_palette.shrink_to_fit();
+            m_counts.clear();
+            m_counts.shrink_to_fit();
+        }
+
+        m_data = std::move(data);
+        m_bits = static_cast<std::uint8_t>(bits);
+        m_bits_log2 = static_cast<std::uint8_t>(bits_log2);
+        m_mask = (1u << bits) - 1;
+    }
+}  // namespace qc
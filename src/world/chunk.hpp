@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "world/block.hpp"
+
+namespace qc {
+    constexpr int CHUNK_SIZE_LOG2 = 5;
+    constexpr int CHUNK_SIZE = 1 << CHUNK_SIZE_LOG2;
+    constexpr int CHUNK_AREA = CHUNK_SIZE * CHUNK_SIZE;
+    constexpr int CHUNK_VOLUME = CHUNK_AREA * CHUNK_SIZE;
+
+    // Voxels are laid out x-fastest, then z, then y.
+    constexpr int chunk_index(int x, int y, int z) {
+        return (y << (2 * CHUNK_SIZE_LOG2)) | (z << CHUNK_SIZE_LOG2) | x;
+    }
+
+    // A 32^3 block of voxels stored as a per-chunk palette plus bit-packed palette indices.
+    //
+    // Index width is always a power of two so an index never straddles a 64-bit word: a chunk
+    // holding a single block type stores no indices at all, and the width doubles (1, 2, 4, 8)
+    // as the palette grows. Past 256 entries the palette is dropped and the 16-bit words hold
+    // block ids directly. Palette slots whose reference count reaches zero are reused before the
+    // palette grows; compact() shrinks the width back down after heavy edits.
+    class chunk {
+    public:
+        static constexpr int DIRECT_BITS = 16;
+        static constexpr std::size_t MAX_PALETTE_SIZE = 256;
+
+        explicit chunk(block_id fill_block = BLOCK_AIR);
+
+        block_id get(int x, int y, int z) const {
+            return get(chunk_index(x, y, z));
+        }
+
+        block_id get(int index) const {
+            const std::uint32_t value = read(index);
+            return m_bits == DIRECT_BITS ? static_cast<block_id>(value) : m_palette[value];
+        }
+
+        void set(int x, int y, int z, block_id block) {
+            set(chunk_index(x, y, z), block);
+        }
+
+        void set(int index, block_id block);
+
+        // Replaces every voxel, collapsing the chunk back to a single-entry palette.
+        void fill(block_id block);
+
+        // Fills the inclusive box [min, max] in chunk-local coordinates.
+        void fill(int min_x, int min_y, int min_z, int max_x, int max_y, int max_z, block_id block);
+
+        // Replaces every voxel from `blocks`, laid out like unpack() output. Builds the palette in
+        // one pass, so it is far cheaper than setting CHUNK_VOLUME voxels one by one.
+        void assign(const block_id* blocks);
+
+        // Appends a compact serialized form to `out`: the palette followed by the packed
+        // indices, with runs of identical 64-bit words collapsed. Assumes a little-endian host.
+        void encode(std::vector<std::uint8_t>& out) const;
+
+        // Replaces the contents from encode() output. Returns false, leaving the chunk
+        // unchanged, if `data` is truncated or malformed.
+        bool decode(const std::uint8_t* data, std::size_t size);
+
+        // Drops unused palette entries and narrows the index width if possible.
+        void compact();
+
+        // Decodes every voxel into `out`, which must hold CHUNK_VOLUME entries.
+        void unpack(block_id* out) const;
+
+        // Builds two bits per voxel from a per-block flag table indexed by block id: bit x of
+        // rows[y * 32 + z] is set when `flags[block] & low` is non-zero and bit 32 + x when
+        // `flags[block] & high` is. `rows` must hold CHUNK_AREA entries. The flags are looked up
+        // once per palette entry rather than once per voxel.
+        void unpack_masks(const std::uint8_t* flags, std::uint8_t low, std::uint8_t high,
+                          std::uint64_t* rows) const;
+
+        // Like unpack_masks() for the inclusive box [min, max] only, such as the few voxels
+        // around an entity: bit x of rows[(y - min_y) * (max_z - min_z + 1) + z - min_z] is set
+        // when `flags[block] & bit` is non-zero, and bits outside [min_x, max_x] are clear.
+        void unpack_box_masks(const std::uint8_t* flags, std::uint8_t bit, int min_x, int min_y,
+                              int min_z, int max_x, int max_y, int max_z,
+                              std::uint32_t* rows) const;
+
+        bool is_uniform() const {
+            return m_bits == 0;
+        }
+
+        // Only meaningful for a uniform chunk.
+        block_id uniform_block() const {
+            return m_palette[0];
+        }
+
+        int bits_per_index() const {
+            return m_bits;
+        }
+
+        // Number of distinct block types present, counting only live palette entries.
+        std::size_t palette_size() const;
+
+        // Bytes owned by this chunk, including heap storage.
+        std::size_t memory_usage() const;
+
+    private:
+        std::uint32_t read(int index) const {
+            if (m_bits == 0) {
+                return 0;
+            }
+
+            const std::uint32_t bit = static_cast<std::uint32_t>(index) << m_bits_log2;
+            return static_cast<std::uint32_t>(m_data[bit >> 6] >> (bit & 63)) & m_mask;
+        }
+
+        void write(int index, std::uint32_t value) {
+            const std::uint32_t bit = static_cast<std::uint32_t>(index) << m_bits_log2;
+            std::uint64_t& word = m_data[bit >> 6];
+            word &= ~(static_cast<std::uint64_t>(m_mask) << (bit & 63));
+            word |= static_cast<std::uint64_t>(value) << (bit & 63);
+        }
+
+        // Returns the palette index for `block`, adding it (and widening storage) if needed.
+        // Returns the block id itself once the chunk has switched to direct storage.
+        std::uint32_t find_or_add(block_id block);
+
+        void resize(int bits);
+
+        std::vector<block_id> m_palette;
+        std::vector<std::uint16_t> m_counts;
+        std::vector<std::uint64_t> m_data;
+        std::uint32_t m_mask = 0;
+        std::uint8_t m_bits = 0;
+        std::uint8_t m_bits_log2 = 0;
+    };
+}  // namespace qc
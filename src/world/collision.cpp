@@ -0,0 +1,130 @@
+#include "world/collision.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/bits.hpp"
+
+namespace qc {
+    namespace {
+        constexpr std::uint8_t FLAG_SOLID = 1;
+
+        // Per-block flags for chunk::unpack_box_masks().
+        constexpr std::uint8_t solid_flags(block_id block) {
+            return block_solid(block) ? FLAG_SOLID : 0;
+        }
+    }  // namespace
+
+    collider::collider(const world& w) : m_world(w) {
+    }
+
+    glm::vec3 collider::move(aabb& box, const glm::vec3& motion, float step_height) {
+        aabb region = box;
+        for (int a = 0; a < 3; a++) {
+            (motion[a] < 0.0f ? region.min[a] : region.max[a]) += motion[a];
+        }
+        region.max.y += std::max(step_height, 0.0f);
+        gather(region);
+
+        // Vertical first, so a box standing on the ground slides over it.
+        const aabb start = box;
+        glm::vec3 moved(0.0f);
+        moved.y = sweep(box, 1, motion.y);
+        moved.x = sweep(box, 0, motion.x);
+        moved.z = sweep(box, 2, motion.z);
+
+        const bool landed = motion.y < 0.0f && moved.y != motion.y;
+        if (step_height <= 0.0f || !landed || (moved.x == motion.x && moved.z == motion.z)) {
+            return moved;
+        }
+
+        aabb stepped = start;
+        glm::vec3 climbed(0.0f);
+        const float up = sweep(stepped, 1, step_height);
+        climbed.x = sweep(stepped, 0, motion.x);
+        climbed.z = sweep(stepped, 2, motion.z);
+        climbed.y = up + sweep(stepped, 1, motion.y - up);
+        if (climbed.x * climbed.x + climbed.z * climbed.z <=
+            moved.x * moved.x + moved.z * moved.z) {
+            return moved;
+        }
+        box = stepped;
+        return climbed;
+    }
+
+    const std::vector<aabb>& collider::gather(const aabb& region) {
+        m_blocks.clear();
+        glm::ivec3 lo(0);
+        glm::ivec3 hi(0);
+        for (int a = 0; a < 3; a++) {
+            lo[a] = static_cast<int>(std::floor(region.min[a]));
+            hi[a] = static_cast<int>(std::ceil(region.max[a])) - 1;
+            if (hi[a] < lo[a]) {
+                return m_blocks;
+            }
+        }
+
+        const glm::ivec3 first = chunk_of(lo);
+        const glm::ivec3 last = chunk_of(hi);
+        for (int cy = first.y; cy <= last.y; cy++) {
+            for (int cz = first.z; cz <= last.z; cz++) {
+                for (int cx = first.x; cx <= last.x; cx++) {
+                    const glm::ivec3 pos(cx, cy, cz);
+                    const chunk* c = m_world.find(pos);
+                    if (c == nullptr || (c->is_uniform() && !block_solid(c->uniform_block()))) {
+                        continue;
+                    }
+
+                    // The part of the region inside this chunk, in chunk-local coordinates.
+                    glm::ivec3 origin(0);
+                    glm::ivec3 min(0);
+                    glm::ivec3 max(0);
+                    for (int a = 0; a < 3; a++) {
+                        origin[a] = pos[a] << CHUNK_SIZE_LOG2;
+                        min[a] = std::max(lo[a] - origin[a], 0);
+                        max[a] = std::min(hi[a] - origin[a], CHUNK_SIZE - 1);
+                    }
+                    const int depth = max.z - min.z + 1;
+                    m_rows.resize(static_cast<std::size_t>((max.y - min.y + 1) * depth));
+                    c->unpack_box_masks(block_flag_table<solid_flags>(), FLAG_SOLID, min.x,
+                                        min.y, min.z, max.x, max.y, max.z, m_rows.data());
+
+                    for (std::size_t r = 0; r < m_rows.size(); r++) {
+                        const int y = origin.y + min.y + static_cast<int>(r) / depth;
+                        const int z = origin.z + min.z + static_cast<int>(r) % depth;
+                        for (std::uint32_t bits = m_rows[r]; bits != 0; bits &= bits - 1) {
+                            const glm::vec3 corner(static_cast<float>(origin.x + ctz32(bits)),
+                                                   static_cast<float>(y), static_cast<float>(z));
+                            m_blocks.push_back({corner, corner + glm::vec3(1.0f)});
+                        }
+                    }
+                }
+            }
+        }
+        return m_blocks;
+    }
+
+    float collider::sweep(aabb& box, int axis, float delta) const {
+        if (delta == 0.0f) {
+            return 0.0f;
+        }
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+        for (const aabb& block : m_blocks) {
+            if (block.max[u] <= box.min[u] + EPSILON || block.min[u] >= box.max[u] - EPSILON ||
+                block.max[v] <= box.min[v] + EPSILON || block.min[v] >= box.max[v] - EPSILON) {
+                continue;
+            }
+            if (delta > 0.0f && block.min[axis] >= box.max[axis] - EPSILON) {
+                delta = std::min(delta, block.min[axis] - box.max[axis]);
+            } else if (delta < 0.0f && block.max[axis] <= box.min[axis] + EPSILON) {
+                delta = std::max(delta, block.max[axis] - box.min[axis]);
+            }
+        }
+        box.min[axis] += delta;
+        box.max[axis] += delta;
+        return delta;
+    }
+}  // namespace qc
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "world/aabb.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // Moves boxes through the solid blocks of a world (see block_solid()), sweeping one axis at
+    // a time so a box stopped on one axis slides along the others. Unloaded chunks read as air.
+    //
+    // The blocks a move could touch are gathered up front a chunk at a time: the rows under the
+    // swept box are decoded straight from the packed palette indices, and chunks of a single
+    // block are taken or skipped whole. Holds scratch buffers, so use one collider per thread.
+    class collider {
+    public:
+        // Boxes closer to a block than this count as touching it. Keeps float rounding from
+        // letting a box that was stopped against a block creep into it later.
+        static constexpr float EPSILON = 1.0f / 1024.0f;
+
+        explicit collider(const world& w);
+
+        // Moves `box` by up to `motion` and returns how far it went. A box that lands on the
+        // ground (moving down and stopped on y) but is stopped sideways tries the move again
+        // raised by up to `step_height`, then lowered back down, and keeps whichever went
+        // further sideways: that is how walkers climb single blocks.
+        glm::vec3 move(aabb& box, const glm::vec3& motion, float step_height = 0.0f);
+
+        // The unit boxes of the solid blocks overlapping `region`, as move() sees them.
+        const std::vector<aabb>& gather(const aabb& region);
+
+    private:
+        // Moves `box` along `axis` by up to `delta` against the gathered blocks.
+        float sweep(aabb& box, int axis, float delta) const;
+
+        const world& m_world;
+        std::vector<std::uint32_t> m_rows;
+        std::vector<aabb> m_blocks;
+    };
+}  // namespace qc
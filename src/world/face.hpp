@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+namespace qc {
+    // The six axis-aligned faces of a voxel. Even values point along +axis, odd along -axis.
+    enum face : std::uint8_t {
+        FACE_POS_X = 0,
+        FACE_NEG_X,
+        FACE_POS_Y,
+        FACE_NEG_Y,
+        FACE_POS_Z,
+        FACE_NEG_Z,
+        FACE_COUNT,
+    };
+
+    constexpr int face_axis(face f) {
+        return f >> 1;
+    }
+
+    constexpr face face_opposite(face f) {
+        return static_cast<face>(f ^ 1);
+    }
+
+    constexpr int FACE_OFFSETS[FACE_COUNT][3] = {
+        {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1},
+    };
+
+    // A chunk and the 26 chunks touching it by a face, edge or corner.
+    constexpr int NEIGHBOR_COUNT = 27;
+
+    // Index of the chunk at offset (dx, dy, dz), each -1 to 1, among NEIGHBOR_COUNT.
+    constexpr int neighbor_index(int dx, int dy, int dz) {
+        return (dy + 1) * 9 + (dz + 1) * 3 + dx + 1;
+    }
+}  // namespace qc
@@ -0,0 +1,161 @@
+#include "world/fluid.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+namespace qc {
+    namespace {
+        const glm::ivec3 SIDES[4] = {{1, 0, 0}, {0, 0, 1}, {-1, 0, 0}, {0, 0, -1}};
+        const glm::ivec3 UP(0, 1, 0);
+
+        int voxel_index(const glm::ivec3& v) {
+            const glm::ivec3 local = local_of(v);
+            return chunk_index(local.x, local.y, local.z);
+        }
+    }  // namespace
+
+    fluid_sim::fluid_sim(block_scheduler& scheduler, world& w)
+        : m_scheduler(scheduler), m_world(w) {
+        m_scheduler.on(BLOCK_WATER, TICK_SCHEDULED, [this](const glm::ivec3& v) { flow(v); });
+        m_scheduler.on(BLOCK_WATER, TICK_NEIGHBOR,
+                       [this](const glm::ivec3& v) { m_scheduler.schedule(v, FLOW_DELAY); });
+    }
+
+    fluid_sim::~fluid_sim() {
+        m_scheduler.on(BLOCK_WATER, TICK_SCHEDULED, nullptr);
+        m_scheduler.on(BLOCK_WATER, TICK_NEIGHBOR, nullptr);
+    }
+
+    int fluid_sim::level(const glm::ivec3& v) const {
+        if (m_world.get_block(v) != BLOCK_WATER) {
+            return 0;
+        }
+        const auto it = m_levels.find(chunk_of(v));
+        const int stored = it == m_levels.end() ? 0 : it->second[voxel_index(v)];
+        return stored == 0 ? MAX_LEVEL : stored;
+    }
+
+    void fluid_sim::set_level(const glm::ivec3& v, int level) {
+        if (level <= 0) {
+            const auto it = m_levels.find(chunk_of(v));
+            if (it != m_levels.end()) {
+                it->second[voxel_index(v)] = 0;
+            }
+            m_scheduler.set_block(v, BLOCK_AIR);
+            return;
+        }
+        std::unique_ptr<std::uint8_t[]>& levels = m_levels[chunk_of(v)];
+        if (!levels) {
+            levels.reset(new std::uint8_t[CHUNK_VOLUME]());
+        }
+        levels[voxel_index(v)] = static_cast<std::uint8_t>(level);
+        m_scheduler.set_block(v, BLOCK_WATER);
+    }
+
+    int fluid_sim::pour(const glm::ivec3& v, int amount) {
+        const block_id block = m_world.get_block(v);
+        if (!m_world.contains(chunk_of(v)) || (block != BLOCK_AIR && block != BLOCK_WATER)) {
+            return 0;
+        }
+        const int current = level(v);
+        const int added = std::clamp(amount, 0, MAX_LEVEL - current);
+        if (added > 0) {
+            set_level(v, current + added);
+            m_scheduler.schedule(v, FLOW_DELAY);
+        }
+        return added;
+    }
+
+    void fluid_sim::add_spring(const glm::ivec3& v) {
+        m_springs.insert(v);
+        m_sprung += static_cast<std::uint64_t>(pour(v, MAX_LEVEL));
+        m_scheduler.schedule(v, FLOW_DELAY);
+    }
+
+    void fluid_sim::remove_spring(const glm::ivec3& v) {
+        m_springs.erase(v);
+    }
+
+    void fluid_sim::remove_chunk(const glm::ivec3& pos) {
+        m_levels.erase(pos);
+    }
+
+    void fluid_sim::flow(const glm::ivec3& v) {
+        // Room for more water; unloaded chunks count as solid so water never loads them.
+        const auto room = [&](const glm::ivec3& n) {
+            if (!m_world.contains(chunk_of(n))) {
+                return -1;
+            }
+            const block_id block = m_world.get_block(n);
+            return block == BLOCK_AIR     ? MAX_LEVEL
+                   : block == BLOCK_WATER ? MAX_LEVEL - level(n)
+                                          : -1;
+        };
+
+        int units = level(v);
+        bool changed = false;
+
+        const glm::ivec3 below = v - UP;
+        const int space = room(below);
+        const int down = std::min(units, space);
+        if (down > 0) {
+            set_level(below, MAX_LEVEL - space + down);
+            m_scheduler.schedule(below, FLOW_DELAY);
+            units -= down;
+            changed = true;
+        }
+
+        // Single units at a time, starting from a different side each tick so water spreads
+        // evenly, while some side holds at least two less.
+        glm::ivec3 sides[4];
+        int levels[4];
+        int start_levels[4];
+        const std::uint32_t turn = m_turn++;
+        for (int i = 0; i < 4; i++) {
+            sides[i] = v + SIDES[(i + turn) & 3];
+            const int side_space = room(sides[i]);
+            levels[i] = side_space < 0 ? MAX_LEVEL + 1 : MAX_LEVEL - side_space;
+            start_levels[i] = levels[i];
+        }
+        for (bool moved = true; moved;) {
+            moved = false;
+            for (int i = 0; i < 4; i++) {
+                if (units - levels[i] >= 2) {
+                    levels[i]++;
+                    units--;
+                    moved = true;
+                }
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            if (levels[i] != start_levels[i]) {
+                set_level(sides[i], levels[i]);
+                m_scheduler.schedule(sides[i], FLOW_DELAY);
+                changed = true;
+            }
+        }
+
+        if (!changed) {
+            return;
+        }
+        // Springs fill back up after giving water away, so they keep ticking.
+        if (m_springs.count(v) != 0) {
+            m_sprung += static_cast<std::uint64_t>(MAX_LEVEL - units);
+            units = MAX_LEVEL;
+        }
+        set_level(v, units);
+        if (units > 0) {
+            m_scheduler.schedule(v, FLOW_DELAY);
+        }
+        // Water around may now move into what this block gave up.
+        if (m_world.get_block(v + UP) == BLOCK_WATER) {
+            m_scheduler.schedule(v + UP, FLOW_DELAY);
+        }
+        for (const glm::ivec3& side : SIDES) {
+            if (m_world.get_block(v + side) == BLOCK_WATER) {
+                m_scheduler.schedule(v + side, FLOW_DELAY);
+            }
+        }
+    }
+}  // namespace qc
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "world/block_ticks.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // Water as a cellular automaton, moved by block_scheduler ticks.
+    //
+    // Every water block holds 1 to MAX_LEVEL units of water, kept beside the blocks. Water the
+    // simulation did not place, such as the sea, counts as full. When a water block ticks it
+    // first pours as much as fits into the block below, then hands single units to side
+    // neighbours holding at least two less, until none does. Units only ever move, so water
+    // is conserved apart from springs, which fill back up whenever they give water away.
+    //
+    // A block that changed ticks again FLOW_DELAY ticks later, together with the water around
+    // it; a block that could not move anything stops ticking until a neighbour update wakes
+    // it. Still water costs nothing.
+    class fluid_sim {
+    public:
+        static constexpr int MAX_LEVEL = 8;
+        static constexpr std::uint32_t FLOW_DELAY = 2;
+
+        // Registers the water handlers with `scheduler`, which must outlive the simulation and
+        // set blocks in the same world.
+        fluid_sim(block_scheduler& scheduler, world& w);
+        ~fluid_sim();
+
+        fluid_sim(const fluid_sim&) = delete;
+        fluid_sim& operator=(const fluid_sim&) = delete;
+
+        // Adds up to `amount` units at `v`, where there is air or water. Returns the units
+        // added.
+        int pour(const glm::ivec3& v, int amount);
+
+        // Keeps the block at `v` full of water for as long as it is a spring.
+        void add_spring(const glm::ivec3& v);
+        void remove_spring(const glm::ivec3& v);
+
+        // Units of water at `v`: 0 without water.
+        int level(const glm::ivec3& v) const;
+
+        // Forgets the levels kept for the chunk.
+        void remove_chunk(const glm::ivec3& pos);
+
+        // Units springs have added so far.
+        std::uint64_t sprung() const {
+            return m_sprung;
+        }
+
+    private:
+        void flow(const glm::ivec3& v);
+        // Sets the units at `v`, turning it into air at 0 and into water above.
+        void set_level(const glm::ivec3& v, int level);
+
+        block_scheduler& m_scheduler;
+        world& m_world;
+        // Per chunk with water the simulation placed, a level per voxel; 0 where it placed none.
+        std::unordered_map<glm::ivec3, std::unique_ptr<std::uint8_t[]>, chunk_pos_hash> m_levels;
+        std::unordered_set<glm::ivec3, chunk_pos_hash> m_springs;
+        std::uint64_t m_sprung = 0;
+        std::uint32_t m_turn = 0;
+    };
+}  // namespace qc
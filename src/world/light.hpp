@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "world/chunk.hpp"
+
+namespace qc {
+    constexpr std::uint8_t MAX_LIGHT = 15;
+
+    // One 4-bit value per voxel of a chunk, two voxels to a byte (even index in the low
+    // nibble). Stays a single fill value until a voxel differs, so fully dark or fully sky-lit
+    // chunks cost nothing.
+    class nibble_array {
+    public:
+        explicit nibble_array(std::uint8_t fill_value = 0) : m_fill(fill_value) {
+        }
+
+        std::uint8_t get(int index) const {
+            if (m_data.empty()) {
+                return m_fill;
+            }
+            return (m_data[index >> 1] >> ((index & 1) << 2)) & 15;
+        }
+
+        void set(int index, std::uint8_t value) {
+            if (m_data.empty()) {
+                if (value == m_fill) {
+                    return;
+                }
+                m_data.assign(CHUNK_VOLUME / 2, static_cast<std::uint8_t>(m_fill * 0x11));
+            }
+            std::uint8_t& byte = m_data[index >> 1];
+            const int shift = (index & 1) << 2;
+            byte = static_cast<std::uint8_t>((byte & ~(15 << shift)) | (value << shift));
+        }
+
+        void fill(std::uint8_t value) {
+            m_data.clear();
+            m_data.shrink_to_fit();
+            m_fill = value;
+        }
+
+        // Raises out[i] to the value of voxel i, for every voxel of the chunk.
+        void unpack_max(std::uint8_t* out) const {
+            if (m_data.empty()) {
+                for (int i = 0; i < CHUNK_VOLUME; i++) {
+                    out[i] = std::max(out[i], m_fill);
+                }
+                return;
+            }
+            for (int i = 0; i < CHUNK_VOLUME / 2; i++) {
+                out[i * 2] = std::max(out[i * 2], static_cast<std::uint8_t>(m_data[i] & 15));
+                out[i * 2 + 1] =
+                    std::max(out[i * 2 + 1], static_cast<std::uint8_t>(m_data[i] >> 4));
+            }
+        }
+
+        bool is_uniform() const {
+            return m_data.empty();
+        }
+
+        std::size_t memory_usage() const {
+            return sizeof(nibble_array) + m_data.capacity();
+        }
+
+    private:
+        std::vector<std::uint8_t> m_data;
+        std::uint8_t m_fill;
+    };
+
+    enum light_channel {
+        LIGHT_SKY = 0,
+        LIGHT_BLOCK,
+        LIGHT_CHANNEL_COUNT,
+    };
+
+    // Sky light and block light of one chunk.
+    struct chunk_light {
+        nibble_array channels[LIGHT_CHANNEL_COUNT];
+    };
+}  // namespace qc
@@ -0,0 +1,410 @@
+#include "world/lighting.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/bits.hpp"
+#include "core/profile.hpp"
+
+namespace qc {
+    namespace {
+        // Per-block flags for chunk::unpack_masks().
+        constexpr std::uint8_t FLAG_CLEAR = 1;  // sky light falls through without fading
+        constexpr std::uint8_t FLAG_EMITS = 2;
+
+        constexpr std::uint8_t light_flags(block_id block) {
+            const block_info& info = block_properties(block);
+            return static_cast<std::uint8_t>(
+                (!info.opaque && info.absorption == 0 ? FLAG_CLEAR : 0) |
+                (info.emission > 0 ? FLAG_EMITS : 0));
+        }
+
+        // Index step and coordinate shift of each face, following chunk_index().
+        constexpr int FACE_STRIDE[FACE_COUNT] = {1, -1, CHUNK_AREA, -CHUNK_AREA, CHUNK_SIZE,
+                                                 -CHUNK_SIZE};
+        constexpr int AXIS_SHIFT[3] = {0, 2 * CHUNK_SIZE_LOG2, CHUNK_SIZE_LOG2};
+
+        // Light reaching a `block` from a neighbour at `level` travelling towards face `f`.
+        int passed_level(light_channel channel, int f, int level, block_id block) {
+            const block_info& info = block_properties(block);
+            if (info.opaque) {
+                return 0;
+            }
+            if (channel == LIGHT_SKY && f == FACE_NEG_Y && level == MAX_LIGHT &&
+                info.absorption == 0) {
+                return MAX_LIGHT;
+            }
+            return level - 1 - info.absorption;
+        }
+
+        // Whether light at `level` leaving through face `f` is what lit a neighbour at
+        // `neighbor_level`, for the removal pass.
+        bool depends_on(light_channel channel, int f, int level, int neighbor_level) {
+            return neighbor_level < level || (channel == LIGHT_SKY && f == FACE_NEG_Y &&
+                                              level == MAX_LIGHT && neighbor_level == MAX_LIGHT);
+        }
+    }  // namespace
+
+    light_engine::light_engine(world& w) : m_world(w) {
+    }
+
+    void light_engine::light_chunk(const glm::ivec3& pos) {
+        QC_PROFILE_ZONE("light.chunk");
+        begin_update();
+        const int s = slot_of(pos);
+        if (s == MISSING) {
+            return;
+        }
+
+        seed_sources(s);
+        seed_from_neighbors(s);
+        propagate(LIGHT_SKY);
+        propagate(LIGHT_BLOCK);
+
+        darken_below(s);
+        unpropagate(LIGHT_SKY);
+        propagate(LIGHT_SKY);
+    }
+
+    void light_engine::relight_all() {
+        std::vector<glm::ivec3> positions;
+        m_world.for_each([&](const glm::ivec3& pos, const chunk&) { positions.push_back(pos); });
+        std::sort(positions.begin(), positions.end(),
+                  [](const glm::ivec3& a, const glm::ivec3& b) { return a.y > b.y; });
+
+        for (const glm::ivec3& pos : positions) {
+            for (nibble_array& channel : m_world.get_or_create_light(pos).channels) {
+                channel.fill(0);
+            }
+        }
+        for (const glm::ivec3& pos : positions) {
+            light_chunk(pos);
+        }
+    }
+
+    void light_engine::set_block(const glm::ivec3& voxel, block_id block) {
+        QC_PROFILE_ZONE("light.set_block");
+        begin_update();
+        const int s = slot_of(chunk_of(voxel));
+        if (s == MISSING) {
+            return;
+        }
+
+        const glm::ivec3 local = local_of(voxel);
+        const int index = chunk_index(local.x, local.y, local.z);
+        if (m_slots[s].blocks->get(index) == block) {
+            return;
+        }
+        // Writing copies the chunk if a snapshot shares it, so the slot moves to the copy.
+        chunk* blocks = m_world.find(m_slots[s].pos);
+        blocks->set(index, block);
+        m_slots[s].blocks = blocks;
+
+        const block_info& info = block_properties(block);
+        for (int c = 0; c < LIGHT_CHANNEL_COUNT; c++) {
+            const light_channel channel = static_cast<light_channel>(c);
+            nibble_array& light = m_slots[s].light->channels[channel];
+            const std::uint8_t old_level = light.get(index);
+            if (old_level > 0) {
+                light.set(index, 0);
+                m_remove.push_back({s, static_cast<std::uint16_t>(index), old_level});
+            }
+            unpropagate(channel);
+
+            // The voxel may be a source itself: an emitter, or clear and open to the sky.
+            std::uint8_t source = 0;
+            if (channel == LIGHT_BLOCK) {
+                source = info.emission;
+            } else if (!info.opaque && info.absorption == 0 && local.y == CHUNK_SIZE - 1 &&
+                       neighbor(s, FACE_POS_Y) == MISSING) {
+                source = MAX_LIGHT;
+            }
+            if (source > 0) {
+                light.set(index, source);
+                m_add[channel].push_back({s, static_cast<std::uint16_t>(index), source});
+            }
+            if (!info.opaque) {
+                for (int f = 0; f < FACE_COUNT; f++) {
+                    int ns = s;
+                    int ni = index;
+                    if (!step(ns, ni, f)) {
+                        continue;
+                    }
+                    const std::uint8_t level = m_slots[ns].light->channels[channel].get(ni);
+                    if (level > 0) {
+                        m_add[channel].push_back({ns, static_cast<std::uint16_t>(ni), level});
+                    }
+                }
+            }
+            propagate(channel);
+        }
+    }
+
+    std::uint8_t light_engine::light(const glm::ivec3& voxel, light_channel channel) const {
+        const chunk_light* light = std::as_const(m_world).find_light(chunk_of(voxel));
+        if (light == nullptr) {
+            return 0;
+        }
+        const glm::ivec3 local = local_of(voxel);
+        return light->channels[channel].get(chunk_index(local.x, local.y, local.z));
+    }
+
+    void light_engine::begin_update() {
+        m_slots.clear();
+        m_slot_of.clear();
+        m_visits = 0;
+    }
+
+    int light_engine::slot_of(const glm::ivec3& pos) {
+        const auto it = m_slot_of.find(pos);
+        if (it != m_slot_of.end()) {
+            return it->second;
+        }
+
+        // Blocks are only read while lighting, so they are not copied away from snapshots.
+        const chunk* blocks = std::as_const(m_world).find(pos);
+        if (blocks == nullptr) {
+            m_slot_of.emplace(pos, MISSING);
+            return MISSING;
+        }
+        const int s = static_cast<int>(m_slots.size());
+        m_slots.push_back({pos, blocks, &m_world.get_or_create_light(pos), {}});
+        std::fill(std::begin(m_slots[s].neighbors), std::end(m_slots[s].neighbors), UNKNOWN);
+        m_slot_of.emplace(pos, s);
+        return s;
+    }
+
+    int light_engine::neighbor(int s, int f) {
+        if (m_slots[s].neighbors[f] == UNKNOWN) {
+            const glm::ivec3 pos =
+                m_slots[s].pos + glm::ivec3(FACE_OFFSETS[f][0], FACE_OFFSETS[f][1],
+                                            FACE_OFFSETS[f][2]);
+            const int n = slot_of(pos);
+            m_slots[s].neighbors[f] = n;
+        }
+        return m_slots[s].neighbors[f];
+    }
+
+    bool light_engine::step(int& s, int& index, int f) {
+        const int coordinate = (index >> AXIS_SHIFT[f >> 1]) & (CHUNK_SIZE - 1);
+        if (coordinate != ((f & 1) ? 0 : CHUNK_SIZE - 1)) {
+            index += FACE_STRIDE[f];
+            return true;
+        }
+        const int n = neighbor(s, f);
+        if (n == MISSING) {
+            return false;
+        }
+        s = n;
+        index -= FACE_STRIDE[f] * (CHUNK_SIZE - 1);
+        return true;
+    }
+
+    void light_engine::seed_sources(int s) {
+        nibble_array& sky = m_slots[s].light->channels[LIGHT_SKY];
+        nibble_array& emitted = m_slots[s].light->channels[LIGHT_BLOCK];
+        const int above = neighbor(s, FACE_POS_Y);
+        const nibble_array* above_sky =
+            above == MISSING ? nullptr : &m_slots[above].light->channels[LIGHT_SKY];
+
+        // Bit x of rows[y * 32 + z] is a clear voxel, bit 32 + x an emitter.
+        std::uint64_t rows[CHUNK_AREA];
+        m_slots[s].blocks->unpack_masks(block_flag_table<light_flags>(), FLAG_CLEAR, FLAG_EMITS,
+                                        rows);
+
+        // Scan each column down from the top until sky light hits something. `bottom` is the
+        // lowest fully sky-lit y, or CHUNK_SIZE if the column gets no direct sky at all.
+        int bottom[CHUNK_AREA];
+        sky.fill(0);
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                int y = CHUNK_SIZE;
+                if (above_sky == nullptr ||
+                    above_sky->get(chunk_index(x, 0, z)) == MAX_LIGHT) {
+                    while (y > 0 && (rows[(y - 1) * CHUNK_SIZE + z] >> x & 1)) {
+                        y--;
+                        sky.set(chunk_index(x, y, z), MAX_LIGHT);
+                    }
+                }
+                bottom[z * CHUNK_SIZE + x] = y;
+            }
+        }
+
+        // Only the edges of the lit shafts can spread further: the foot of each shaft, voxels
+        // beside a shorter shaft, and voxels facing a darker one in a loaded neighbour.
+        const nibble_array* beside[FACE_COUNT] = {};
+        for (int f : {FACE_POS_X, FACE_NEG_X, FACE_POS_Z, FACE_NEG_Z}) {
+            const int n = neighbor(s, f);
+            beside[f] = n == MISSING ? nullptr : &m_slots[n].light->channels[LIGHT_SKY];
+        }
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                const int foot = bottom[z * CHUNK_SIZE + x];
+                if (foot == CHUNK_SIZE) {
+                    continue;
+                }
+                const auto bottom_at = [&](int nx, int nz) {
+                    const bool inside = nx >= 0 && nx < CHUNK_SIZE && nz >= 0 && nz < CHUNK_SIZE;
+                    return inside ? bottom[nz * CHUNK_SIZE + nx] : 0;
+                };
+                const int top = std::max({bottom_at(x + 1, z), bottom_at(x - 1, z),
+                                          bottom_at(x, z + 1), bottom_at(x, z - 1), foot + 1});
+                for (int y = foot; y < CHUNK_SIZE; y++) {
+                    const int index = chunk_index(x, y, z);
+                    bool edge = y < top;
+                    for (int f : {FACE_POS_X, FACE_NEG_X, FACE_POS_Z, FACE_NEG_Z}) {
+                        int ns = s;
+                        int ni = index;
+                        if (edge || beside[f] == nullptr || !step(ns, ni, f) || ns == s) {
+                            continue;
+                        }
+                        edge = beside[f]->get(ni) < MAX_LIGHT - 1;
+                    }
+                    if (edge) {
+                        m_add[LIGHT_SKY].push_back(
+                            {s, static_cast<std::uint16_t>(index), MAX_LIGHT});
+                    }
+                }
+            }
+        }
+
+        emitted.fill(0);
+        for (int row = 0; row < CHUNK_AREA; row++) {
+            for (std::uint64_t bits = rows[row] >> 32; bits != 0; bits &= bits - 1) {
+                const int index = row * CHUNK_SIZE + ctz64(bits);
+                const std::uint8_t level =
+                    block_properties(m_slots[s].blocks->get(index)).emission;
+                emitted.set(index, level);
+                m_add[LIGHT_BLOCK].push_back({s, static_cast<std::uint16_t>(index), level});
+            }
+        }
+    }
+
+    void light_engine::seed_from_neighbors(int s) {
+        for (int f = 0; f < FACE_COUNT; f++) {
+            const int n = neighbor(s, f);
+            if (n == MISSING) {
+                continue;
+            }
+
+            // The neighbour's layer touching this chunk, walked over the two other axes.
+            const int axis = f >> 1;
+            const int layer = (f & 1) ? CHUNK_SIZE - 1 : 0;
+            const int u_shift = AXIS_SHIFT[(axis + 1) % 3];
+            const int v_shift = AXIS_SHIFT[(axis + 2) % 3];
+            const int into_layer = CHUNK_SIZE - 1 - layer;
+            for (int c = 0; c < LIGHT_CHANNEL_COUNT; c++) {
+                const light_channel channel = static_cast<light_channel>(c);
+                const nibble_array& light = m_slots[n].light->channels[channel];
+                if (light.is_uniform() && light.get(0) <= 1) {
+                    continue;
+                }
+                nibble_array& own = m_slots[s].light->channels[channel];
+                for (int v = 0; v < CHUNK_SIZE; v++) {
+                    for (int u = 0; u < CHUNK_SIZE; u++) {
+                        const int across = u << u_shift | v << v_shift;
+                        const int level = light.get(layer << AXIS_SHIFT[axis] | across);
+                        if (level <= 1) {
+                            continue;
+                        }
+                        const int index = into_layer << AXIS_SHIFT[axis] | across;
+                        const int target =
+                            passed_level(channel, face_opposite(static_cast<face>(f)), level,
+                                         m_slots[s].blocks->get(index));
+                        if (target > own.get(index)) {
+                            own.set(index, static_cast<std::uint8_t>(target));
+                            m_add[c].push_back({s, static_cast<std::uint16_t>(index),
+                                                static_cast<std::uint8_t>(target)});
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void light_engine::darken_below(int s) {
+        // The chunk below may have been lit as open to the sky before this one arrived.
+        const int below = neighbor(s, FACE_NEG_Y);
+        if (below == MISSING) {
+            return;
+        }
+        const nibble_array& sky = m_slots[s].light->channels[LIGHT_SKY];
+        nibble_array& below_sky = m_slots[below].light->channels[LIGHT_SKY];
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                const int top = chunk_index(x, CHUNK_SIZE - 1, z);
+                if (below_sky.get(top) == MAX_LIGHT && sky.get(chunk_index(x, 0, z)) != MAX_LIGHT) {
+                    below_sky.set(top, 0);
+                    m_remove.push_back({below, static_cast<std::uint16_t>(top), MAX_LIGHT});
+                }
+            }
+        }
+    }
+
+    void light_engine::unpropagate(light_channel channel) {
+        // m_remove grows while it is walked; voxels at the edge of the darkened region that are
+        // lit from elsewhere go to the add queue to refill it.
+        for (std::size_t head = 0; head < m_remove.size(); head++) {
+            const node n = m_remove[head];
+            m_visits++;
+            for (int f = 0; f < FACE_COUNT; f++) {
+                int s = n.slot;
+                int index = n.index;
+                if (!step(s, index, f)) {
+                    continue;
+                }
+                nibble_array& light = m_slots[s].light->channels[channel];
+                const std::uint8_t level = light.get(index);
+                if (level == 0) {
+                    continue;
+                }
+                const node next{s, static_cast<std::uint16_t>(index), level};
+                if (!depends_on(channel, f, n.level, level)) {
+                    m_add[channel].push_back(next);
+                    continue;
+                }
+
+                light.set(index, 0);
+                m_remove.push_back(next);
+                if (channel == LIGHT_BLOCK) {
+                    const std::uint8_t emission =
+                        block_properties(m_slots[s].blocks->get(index)).emission;
+                    if (emission > 0) {
+                        light.set(index, emission);
+                        m_add[channel].push_back({next.slot, next.index, emission});
+                    }
+                }
+            }
+        }
+        m_remove.clear();
+    }
+
+    void light_engine::propagate(light_channel channel) {
+        std::vector<node>& queue = m_add[channel];
+        for (std::size_t head = 0; head < queue.size(); head++) {
+            const node n = queue[head];
+            m_visits++;
+            // The level may have changed since the node was queued; spread what is there now.
+            const int level = m_slots[n.slot].light->channels[channel].get(n.index);
+            if (level <= 1) {
+                continue;
+            }
+            for (int f = 0; f < FACE_COUNT; f++) {
+                int s = n.slot;
+                int index = n.index;
+                if (!step(s, index, f)) {
+                    continue;
+                }
+                const int target =
+                    passed_level(channel, f, level, m_slots[s].blocks->get(index));
+                nibble_array& light = m_slots[s].light->channels[channel];
+                if (target > light.get(index)) {
+                    light.set(index, static_cast<std::uint8_t>(target));
+                    queue.push_back({s, static_cast<std::uint16_t>(index),
+                                     static_cast<std::uint8_t>(target)});
+                }
+            }
+        }
+        queue.clear();
+    }
+}  // namespace qc
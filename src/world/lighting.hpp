@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "world/light.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // Breadth-first flood fill of sky light and block light over a world's chunks.
+    //
+    // Light falls one level per step (plus the absorption of the block entered) and does not
+    // enter opaque blocks, except that full sky light travels straight down through clear blocks
+    // without fading. Removal runs the classic two-queue pass: light that depended on the removed
+    // level is cleared breadth-first, and the brighter voxels found at the edge of the cleared
+    // region seed a normal fill back into it. Both passes cross chunk borders freely, so an edit
+    // touches only the voxels whose light actually changes.
+    class light_engine {
+    public:
+        explicit light_engine(world& w);
+
+        // Lights a chunk just added to the world and exchanges light with its loaded
+        // neighbours. A chunk with nothing loaded above it is treated as open to the sky and
+        // darkened once the chunk above is lit, so loading columns top-down does the least work.
+        void light_chunk(const glm::ivec3& pos);
+
+        // Lights every loaded chunk from scratch, top layer first.
+        void relight_all();
+
+        // Changes one block and updates only the light it affects. Voxels outside loaded chunks
+        // are left alone.
+        void set_block(const glm::ivec3& voxel, block_id block);
+
+        // Light at a world voxel, 0 outside lit chunks.
+        std::uint8_t light(const glm::ivec3& voxel, light_channel channel) const;
+
+        // Voxels dequeued by the last light_chunk() or set_block(), over both channels.
+        std::size_t last_visits() const {
+            return m_visits;
+        }
+
+    private:
+        static constexpr int UNKNOWN = -2;
+        static constexpr int MISSING = -1;
+
+        // A chunk taking part in the current update, with its neighbours looked up lazily.
+        struct slot {
+            glm::ivec3 pos;
+            const chunk* blocks;
+            chunk_light* light;
+            int neighbors[FACE_COUNT];
+        };
+
+        struct node {
+            std::int32_t slot;
+            std::uint16_t index;
+            std::uint8_t level;
+        };
+
+        void begin_update();
+        int slot_of(const glm::ivec3& pos);
+        int neighbor(int s, int f);
+
+        // Moves `index` in slot `s` one voxel towards face `f`. Returns false at the edge of the
+        // loaded world.
+        bool step(int& s, int& index, int f);
+
+        // Resets a chunk to its direct sky shafts and emitters and queues their edges.
+        void seed_sources(int s);
+        // Queues the lit border voxels of the loaded neighbours.
+        void seed_from_neighbors(int s);
+        void darken_below(int s);
+
+        void unpropagate(light_channel channel);
+        void propagate(light_channel channel);
+
+        world& m_world;
+        std::vector<slot> m_slots;
+        std::unordered_map<glm::ivec3, int, chunk_pos_hash> m_slot_of;
+        std::vector<node> m_add[LIGHT_CHANNEL_COUNT];
+        std::vector<node> m_remove;
+        std::size_t m_visits = 0;
+    };
+}  // namespace qc
@@ -0,0 +1,413 @@
+#include "world/lod.hpp"
+
+#include <algorithm>
+#include <memory_resource>
+
+#include "core/arena.hpp"
+#include "core/profile.hpp"
+
+namespace qc {
+    namespace {
+        // Children are numbered x + 2y + 4z.
+        glm::ivec3 octant_offset(int c) {
+            return glm::ivec3(c & 1, (c >> 1) & 1, (c >> 2) & 1);
+        }
+
+        int octant_of(const glm::ivec3& cell, int shift) {
+            return ((cell.x >> shift) & 1) | ((cell.y >> shift) & 1) << 1 |
+                   ((cell.z >> shift) & 1) << 2;
+        }
+
+        glm::ivec3 shift_down(const glm::ivec3& v, int bits) {
+            return glm::ivec3(v.x >> bits, v.y >> bits, v.z >> bits);
+        }
+
+        glm::ivec3 low_bits(const glm::ivec3& v, int bits) {
+            const int mask = (1 << bits) - 1;
+            return glm::ivec3(v.x & mask, v.y & mask, v.z & mask);
+        }
+
+        constexpr int CHUNK_CELLS = CHUNK_SIZE / 2;
+        // Depth of the node covering one chunk.
+        constexpr int CHUNK_DEPTH = LOD_REGION_CHUNKS_LOG2;
+    }  // namespace
+
+    block_id lod_downsample(const block_id children[8]) {
+        // Upper children first, so they win ties.
+        constexpr int ORDER[8] = {2, 3, 6, 7, 0, 1, 4, 5};
+        int filled = 0;
+        for (int c = 0; c < 8; c++) {
+            filled += children[c] != BLOCK_AIR ? 1 : 0;
+        }
+        if (filled < 4) {
+            return BLOCK_AIR;
+        }
+
+        block_id best = BLOCK_AIR;
+        int best_count = 0;
+        for (int i = 0; i < 8; i++) {
+            const block_id block = children[ORDER[i]];
+            if (block == BLOCK_AIR || block == best) {
+                continue;
+            }
+            int count = 0;
+            for (int c = 0; c < 8; c++) {
+                count += children[c] == block ? 1 : 0;
+            }
+            if (count > best_count) {
+                best = block;
+                best_count = count;
+            }
+        }
+        return best;
+    }
+
+    lod_region::lod_region() {
+        m_nodes.push_back({0, BLOCK_AIR});
+        // Group 0 stands for "no children", as node 0, the root, does.
+        m_cells.push_back({});
+    }
+
+    std::uint32_t lod_region::allocate_group(block_id fill) {
+        std::uint32_t first;
+        if (!m_free.empty()) {
+            first = m_free.back();
+            m_free.pop_back();
+        } else {
+            first = static_cast<std::uint32_t>(m_nodes.size());
+            m_nodes.resize(m_nodes.size() + 8);
+        }
+        for (int c = 0; c < 8; c++) {
+            m_nodes[first + c] = {0, fill};
+        }
+        return first;
+    }
+
+    std::uint32_t lod_region::allocate_cells(block_id fill) {
+        std::uint32_t group;
+        if (!m_free_cells.empty()) {
+            group = m_free_cells.back();
+            m_free_cells.pop_back();
+        } else {
+            group = static_cast<std::uint32_t>(m_cells.size());
+            m_cells.emplace_back();
+        }
+        std::fill(m_cells[group].blocks, m_cells[group].blocks + 8, fill);
+        return group;
+    }
+
+    void lod_region::free_subtree(std::uint32_t n, int depth) {
+        const std::uint32_t children = m_nodes[n].children;
+        if (children == 0) {
+            return;
+        }
+        if (depth == BOTTOM) {
+            m_free_cells.push_back(children);
+        } else {
+            for (int c = 0; c < 8; c++) {
+                free_subtree(children + c, depth + 1);
+            }
+            m_free.push_back(children);
+        }
+        m_nodes[n].children = 0;
+    }
+
+    void lod_region::refresh(std::uint32_t n, int depth) {
+        const std::uint32_t children = m_nodes[n].children;
+        if (children == 0) {
+            return;
+        }
+        block_id blocks[8];
+        bool uniform = true;
+        for (int c = 0; c < 8; c++) {
+            if (depth == BOTTOM) {
+                blocks[c] = m_cells[children].blocks[c];
+            } else {
+                blocks[c] = m_nodes[children + c].block;
+                uniform = uniform && m_nodes[children + c].children == 0;
+            }
+            uniform = uniform && blocks[c] == blocks[0];
+        }
+        m_nodes[n].block = lod_downsample(blocks);
+        if (uniform) {
+            if (depth == BOTTOM) {
+                m_free_cells.push_back(children);
+            } else {
+                m_free.push_back(children);
+            }
+            m_nodes[n].children = 0;
+        }
+    }
+
+    void lod_region::build(std::uint32_t n, int depth, const block_id* cells, const glm::ivec3& at,
+                           int stride) {
+        if (depth == BOTTOM) {
+            const std::uint32_t group = allocate_cells(BLOCK_AIR);
+            m_nodes[n].children = group;
+            for (int c = 0; c < 8; c++) {
+                const glm::ivec3 cell = at + octant_offset(c);
+                m_cells[group].blocks[c] = cells[(cell.z * stride + cell.y) * stride + cell.x];
+            }
+        } else {
+            const std::uint32_t children = allocate_group(BLOCK_AIR);
+            m_nodes[n].children = children;
+            const int half = 1 << (DEPTH - 1 - depth);
+            for (int c = 0; c < 8; c++) {
+                build(children + c, depth + 1, cells, at + octant_offset(c) * half, stride);
+            }
+        }
+        refresh(n, depth);
+    }
+
+    void lod_region::insert_chunk(const glm::ivec3& local, const chunk& blocks) {
+        QC_PROFILE_ZONE("lod.insert_chunk");
+
+        // Walk down to the chunk's node, splitting uniform nodes on the way.
+        std::uint32_t path[CHUNK_DEPTH];
+        std::uint32_t n = 0;
+        for (int d = 0; d < CHUNK_DEPTH; d++) {
+            path[d] = n;
+            if (m_nodes[n].children == 0) {
+                const std::uint32_t children = allocate_group(m_nodes[n].block);
+                m_nodes[n].children = children;
+            }
+            n = m_nodes[n].children + octant_of(local, CHUNK_DEPTH - 1 - d);
+        }
+        free_subtree(n, CHUNK_DEPTH);
+        if (blocks.is_uniform()) {
+            // Eight equal blocks downsample to themselves, all the way up.
+            m_nodes[n].block = blocks.uniform_block();
+        } else {
+            arena& scratch = thread_arena();
+            const arena_scope scope(scratch);
+            std::pmr::vector<block_id> voxels(CHUNK_VOLUME, &scratch);
+            blocks.unpack(voxels.data());
+
+            // Level 1 cells of the chunk, x fastest, then y, then z.
+            std::pmr::vector<block_id> cells(CHUNK_CELLS * CHUNK_CELLS * CHUNK_CELLS, &scratch);
+            for (int z = 0; z < CHUNK_CELLS; z++) {
+                for (int y = 0; y < CHUNK_CELLS; y++) {
+                    for (int x = 0; x < CHUNK_CELLS; x++) {
+                        block_id children[8];
+                        for (int c = 0; c < 8; c++) {
+                            const glm::ivec3 v = glm::ivec3(x, y, z) * 2 + octant_offset(c);
+                            children[c] = voxels[chunk_index(v.x, v.y, v.z)];
+                        }
+                        cells[(z * CHUNK_CELLS + y) * CHUNK_CELLS + x] = lod_downsample(children);
+                    }
+                }
+            }
+            build(n, CHUNK_DEPTH, cells.data(), glm::ivec3(0), CHUNK_CELLS);
+        }
+        for (int d = CHUNK_DEPTH - 1; d >= 0; d--) {
+            refresh(path[d], d);
+        }
+    }
+
+    int lod_region::set_cell(const glm::ivec3& cell, block_id block) {
+        std::uint32_t path[DEPTH];
+        std::uint32_t n = 0;
+        for (int d = 0; d < DEPTH; d++) {
+            path[d] = n;
+            if (m_nodes[n].children == 0) {
+                if (m_nodes[n].block == block) {
+                    return 0;
+                }
+                const std::uint32_t children = d == BOTTOM ? allocate_cells(m_nodes[n].block)
+                                                           : allocate_group(m_nodes[n].block);
+                m_nodes[n].children = children;
+            }
+            if (d < BOTTOM) {
+                n = m_nodes[n].children + octant_of(cell, DEPTH - 1 - d);
+            }
+        }
+        block_id& target = m_cells[m_nodes[n].children].blocks[octant_of(cell, 0)];
+        if (target == block) {
+            return 0;
+        }
+        target = block;
+
+        // A cell can only change if one of its children did, so the levels that changed run
+        // from the bottom up to the first one that did not.
+        int changed = 1;
+        for (int d = DEPTH - 1; d >= 0; d--) {
+            const block_id before = m_nodes[path[d]].block;
+            refresh(path[d], d);
+            if (changed == DEPTH - d && m_nodes[path[d]].block != before) {
+                changed = DEPTH + 1 - d;
+            }
+        }
+        return changed;
+    }
+
+    block_id lod_region::get(int level, const glm::ivec3& cell) const {
+        const int depth = DEPTH + 1 - level;
+        std::uint32_t n = 0;
+        for (int d = 0; d < std::min(depth, BOTTOM) && m_nodes[n].children != 0; d++) {
+            n = m_nodes[n].children + octant_of(cell, depth - 1 - d);
+        }
+        if (depth == DEPTH && m_nodes[n].children != 0) {
+            return m_cells[m_nodes[n].children].blocks[octant_of(cell, 0)];
+        }
+        return m_nodes[n].block;
+    }
+
+    void lod_region::fill(std::uint32_t n, int depth, const glm::ivec3& pos, int level,
+                          const glm::ivec3& origin, block_id* out) const {
+        const int span = 1 << (DEPTH + 1 - level - depth);
+        const glm::ivec3 lo = glm::max(pos, origin);
+        const glm::ivec3 hi = glm::min(pos + glm::ivec3(span), origin + glm::ivec3(CHUNK_SIZE));
+        if (lo.x >= hi.x || lo.y >= hi.y || lo.z >= hi.z) {
+            return;
+        }
+
+        const node& here = m_nodes[n];
+        if (here.children != 0 && span > 1) {
+            if (depth < BOTTOM) {
+                for (int c = 0; c < 8; c++) {
+                    fill(here.children + c, depth + 1, pos + octant_offset(c) * (span / 2), level,
+                         origin, out);
+                }
+                return;
+            }
+            // Level 1 cells, one each.
+            for (int c = 0; c < 8; c++) {
+                const glm::ivec3 cell = pos + octant_offset(c) - origin;
+                if (cell.x >= 0 && cell.y >= 0 && cell.z >= 0 && cell.x < CHUNK_SIZE &&
+                    cell.y < CHUNK_SIZE && cell.z < CHUNK_SIZE) {
+                    out[chunk_index(cell.x, cell.y, cell.z)] = m_cells[here.children].blocks[c];
+                }
+            }
+            return;
+        }
+        if (here.block == BLOCK_AIR) {
+            return;
+        }
+        for (int y = lo.y; y < hi.y; y++) {
+            for (int z = lo.z; z < hi.z; z++) {
+                block_id* row = out + chunk_index(0, y - origin.y, z - origin.z) - origin.x;
+                std::fill(row + lo.x, row + hi.x, here.block);
+            }
+        }
+    }
+
+    void lod_region::extract(int level, const glm::ivec3& origin, block_id* out) const {
+        std::fill(out, out + CHUNK_VOLUME, BLOCK_AIR);
+        fill(0, 0, glm::ivec3(0), level, origin, out);
+    }
+
+    void lod_world::insert_chunk(const glm::ivec3& pos, const chunk& blocks) {
+        std::unique_ptr<lod_region>& region = m_regions[shift_down(pos, LOD_REGION_CHUNKS_LOG2)];
+        if (!region) {
+            region = std::make_unique<lod_region>();
+        }
+        region->insert_chunk(low_bits(pos, LOD_REGION_CHUNKS_LOG2), blocks);
+
+        // A chunk lies within one mesh of every level; its corners find the neighbours it
+        // borders.
+        for (int level = 1; level <= LOD_MESH_LEVELS; level++) {
+            const glm::ivec3 last = (pos + glm::ivec3(1)) * CHUNK_SIZE - glm::ivec3(1);
+            mark(level, shift_down(pos * CHUNK_SIZE, level));
+            mark(level, shift_down(last, level));
+        }
+    }
+
+    void lod_world::set_block(const world& w, const glm::ivec3& voxel) {
+        const auto it = m_regions.find(shift_down(voxel, LOD_REGION_SIZE_LOG2));
+        if (it == m_regions.end()) {
+            return;
+        }
+        const glm::ivec3 cell = shift_down(voxel, 1);
+        block_id children[8];
+        for (int c = 0; c < 8; c++) {
+            children[c] = w.get_block(cell * 2 + octant_offset(c));
+        }
+        const int changed = it->second->set_cell(low_bits(cell, LOD_REGION_SIZE_LOG2 - 1),
+                                                 lod_downsample(children));
+        for (int level = 1; level <= std::min(changed, LOD_MESH_LEVELS); level++) {
+            mark(level, shift_down(voxel, level));
+        }
+    }
+
+    block_id lod_world::get(int level, const glm::ivec3& cell) const {
+        const int cells_log2 = LOD_REGION_SIZE_LOG2 - level;
+        const lod_region* region = find(shift_down(cell, cells_log2));
+        if (region == nullptr) {
+            return BLOCK_AIR;
+        }
+        return region->get(level, low_bits(cell, cells_log2));
+    }
+
+    void lod_world::build_mesh(const lod_key& key, mesher& m, std::vector<packed_quad>& out) {
+        QC_PROFILE_ZONE("lod.build_mesh");
+        if (!extract(key, m_scratch[0])) {
+            return;
+        }
+        chunk_neighborhood n;
+        n.center = &m_scratch[0];
+        for (int f = 0; f < FACE_COUNT; f++) {
+            const lod_key next{key.pos + glm::ivec3(FACE_OFFSETS[f][0], FACE_OFFSETS[f][1],
+                                                    FACE_OFFSETS[f][2]),
+                               key.level};
+            if (extract(next, m_scratch[1 + f])) {
+                n.faces[f] = &m_scratch[1 + f];
+            }
+        }
+        m.build(n, out);
+    }
+
+    void lod_world::take_dirty(std::vector<lod_key>& out) {
+        out.insert(out.end(), m_dirty.begin(), m_dirty.end());
+        m_dirty.clear();
+    }
+
+    std::size_t lod_world::node_count() const {
+        std::size_t total = 0;
+        for (const auto& it : m_regions) {
+            total += it.second->node_count();
+        }
+        return total;
+    }
+
+    std::size_t lod_world::memory_usage() const {
+        std::size_t total = sizeof(lod_world);
+        for (const auto& it : m_regions) {
+            total += it.second->memory_usage();
+        }
+        return total;
+    }
+
+    const lod_region* lod_world::find(const glm::ivec3& region) const {
+        const auto it = m_regions.find(region);
+        return it == m_regions.end() ? nullptr : it->second.get();
+    }
+
+    bool lod_world::extract(const lod_key& key, chunk& out) const {
+        // Meshes of a level tile a region 2^(3 - level) to a side.
+        const int meshes_log2 = LOD_REGION_SIZE_LOG2 - key.level - CHUNK_SIZE_LOG2;
+        const lod_region* region = find(shift_down(key.pos, meshes_log2));
+        if (region == nullptr) {
+            return false;
+        }
+        arena& scratch = thread_arena();
+        const arena_scope scope(scratch);
+        std::pmr::vector<block_id> cells(CHUNK_VOLUME, &scratch);
+        region->extract(key.level, low_bits(key.pos, meshes_log2) * CHUNK_SIZE, cells.data());
+        out.assign(cells.data());
+        return true;
+    }
+
+    void lod_world::mark(int level, const glm::ivec3& cell) {
+        const glm::ivec3 key = shift_down(cell, CHUNK_SIZE_LOG2);
+        m_dirty.insert({key, level});
+        // Cells on a mesh's border also shape the faces of the neighbouring mesh.
+        for (int axis = 0; axis < 3; axis++) {
+            const int local = cell[axis] & (CHUNK_SIZE - 1);
+            if (local == 0 || local == CHUNK_SIZE - 1) {
+                glm::ivec3 next = key;
+                next[axis] += local == 0 ? -1 : 1;
+                m_dirty.insert({next, level});
+            }
+        }
+    }
+}  // namespace qc
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "mesh/mesher.hpp"
+#include "world/chunk.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // Cells of level L are 2^L blocks on a side. Level 1 is the finest kept; levels 1 to
+    // LOD_MESH_LEVELS get meshes.
+    constexpr int LOD_MESH_LEVELS = 3;
+
+    // A region spans 8 chunks, 256 blocks, on every axis.
+    constexpr int LOD_REGION_CHUNKS_LOG2 = 3;
+    constexpr int LOD_REGION_SIZE_LOG2 = LOD_REGION_CHUNKS_LOG2 + CHUNK_SIZE_LOG2;
+    constexpr int LOD_REGION_LEVELS = LOD_REGION_SIZE_LOG2;
+
+    // The block standing in for a cell made of eight smaller ones: air unless at least half of
+    // them are filled, otherwise the most common filling, the upper half winning ties so grass
+    // stays on top. Applied level by level, so a cell only ever depends on its eight children.
+    block_id lod_downsample(const block_id children[8]);
+
+    // A sparse octree over one 256-block region holding its terrain from level 1 up. Every node
+    // stores the downsampled block of its cube, so any level can be read by stopping at the
+    // right depth, and a subtree that would be uniform is cut off at its root. Nodes live in an
+    // array in groups of eight siblings, and groups freed by edits are reused.
+    class lod_region {
+    public:
+        lod_region();
+
+        // Rebuilds the cells of the chunk at `local` (0 to 7 on each axis) from its blocks.
+        void insert_chunk(const glm::ivec3& local, const chunk& blocks);
+
+        // Sets the level 1 cell `cell` (0 to 127 on each axis). Returns the highest level whose
+        // cell changed, or 0 if nothing did.
+        int set_cell(const glm::ivec3& cell, block_id block);
+
+        // The block of cell `cell` of `level` (1 to LOD_REGION_LEVELS).
+        block_id get(int level, const glm::ivec3& cell) const;
+
+        // Writes the 32^3 cells of `level` starting at cell `origin` to `out`, laid out like
+        // chunk::unpack() output.
+        void extract(int level, const glm::ivec3& origin, block_id* out) const;
+
+        // Nodes and level 1 cells in use; cell group 0 is only a sentinel.
+        std::size_t node_count() const {
+            return m_nodes.size() - m_free.size() * 8 +
+                   (m_cells.size() - 1 - m_free_cells.size()) * 8;
+        }
+
+        std::size_t memory_usage() const {
+            return sizeof(lod_region) + m_nodes.capacity() * sizeof(node) +
+                   m_cells.capacity() * sizeof(cell_group) +
+                   (m_free.capacity() + m_free_cells.capacity()) * sizeof(std::uint32_t);
+        }
+
+    private:
+        // Depth of level 1 cells; the root is depth 0.
+        static constexpr int DEPTH = LOD_REGION_LEVELS - 1;
+        // Depth of the nodes whose children are level 1 cells. Those are stored as bare blocks
+        // rather than nodes, since they make up most of the tree and never have children.
+        static constexpr int BOTTOM = DEPTH - 1;
+
+        struct node {
+            // First of the eight children, or their cell group at BOTTOM, or 0 if the node's
+            // whole cube is `block`.
+            std::uint32_t children;
+            block_id block;
+        };
+
+        struct cell_group {
+            block_id blocks[8];
+        };
+
+        std::uint32_t allocate_group(block_id fill);
+        std::uint32_t allocate_cells(block_id fill);
+        void free_subtree(std::uint32_t n, int depth);
+        // Recomputes node `n` from its children, dropping them if they are uniform.
+        void refresh(std::uint32_t n, int depth);
+        void build(std::uint32_t n, int depth, const block_id* cells, const glm::ivec3& at,
+                   int stride);
+        void fill(std::uint32_t n, int depth, const glm::ivec3& pos, int level,
+                  const glm::ivec3& origin, block_id* out) const;
+
+        std::vector<node> m_nodes;
+        std::vector<std::uint32_t> m_free;
+        std::vector<cell_group> m_cells;
+        std::vector<std::uint32_t> m_free_cells;
+    };
+
+    // One mesh of the far terrain: 32^3 cells of `level`, at `pos` in units of their size.
+    struct lod_key {
+        glm::ivec3 pos;
+        int level;
+
+        bool operator==(const lod_key& other) const {
+            return pos == other.pos && level == other.level;
+        }
+    };
+
+    struct lod_key_hash {
+        std::size_t operator()(const lod_key& key) const {
+            return chunk_pos_hash()(key.pos) * 31 + static_cast<std::size_t>(key.level);
+        }
+    };
+
+    // Far terrain: chunks go in at full resolution and only their downsampled octrees are kept,
+    // so the full-resolution chunks can be dropped. Edits are applied cell by cell, and every
+    // LOD mesh whose cells changed is reported for remeshing.
+    class lod_world {
+    public:
+        // Replaces the chunk at `pos` and marks its meshes dirty.
+        void insert_chunk(const glm::ivec3& pos, const chunk& blocks);
+
+        // Updates the cell holding `voxel` after the block there changed in `w`, which must
+        // hold the chunk. Marks the meshes of every level whose cell changed.
+        void set_block(const world& w, const glm::ivec3& voxel);
+
+        block_id get(int level, const glm::ivec3& cell) const;
+
+        // Meshes `key` against its six neighbours, with quads in units of the level's cells.
+        void build_mesh(const lod_key& key, mesher& m, std::vector<packed_quad>& out);
+
+        // Moves the keys of meshes changed since the last call into `out`.
+        void take_dirty(std::vector<lod_key>& out);
+
+        std::size_t region_count() const {
+            return m_regions.size();
+        }
+
+        std::size_t node_count() const;
+        std::size_t memory_usage() const;
+
+    private:
+        const lod_region* find(const glm::ivec3& region) const;
+        // Fills `out` with the cells of `key`; returns false, leaving it alone, if the region
+        // is not loaded.
+        bool extract(const lod_key& key, chunk& out) const;
+        void mark(int level, const glm::ivec3& cell);
+
+        std::unordered_map<glm::ivec3, std::unique_ptr<lod_region>, chunk_pos_hash> m_regions;
+        std::unordered_set<lod_key, lod_key_hash> m_dirty;
+        chunk m_scratch[1 + FACE_COUNT];
+    };
+}  // namespace qc
@@ -0,0 +1,638 @@
+#include "world/navigation.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <tuple>
+
+namespace qc {
+    namespace {
+        constexpr std::uint8_t FLAG_OPEN = 1;
+
+        // What a walker does stepping off in one direction. MOVE_DROP + k - 1 drops k blocks.
+        enum nav_move : int { MOVE_NONE = 0, MOVE_FLAT = 1, MOVE_UP = 2, MOVE_DROP = 3 };
+        constexpr int MOVE_BITS = 3;
+        constexpr int DIRECTION_COUNT = 4;
+        const glm::ivec3 DIRECTIONS[DIRECTION_COUNT] = {
+            {1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}};
+
+        // Climbing costs more than walking and long drops a little more than short ones, but
+        // every move costs at least 1 and goes one block sideways, so the horizontal distance
+        // never overestimates what is left.
+        float move_cost(int move) {
+            return move == MOVE_FLAT ? 1.0f
+                   : move == MOVE_UP ? 1.5f
+                                     : 1.0f + 0.25f * static_cast<float>(move - MOVE_DROP + 1);
+        }
+
+        int move_rise(int move) {
+            return move == MOVE_FLAT ? 0 : move == MOVE_UP ? 1 : MOVE_DROP - 1 - move;
+        }
+
+        // Moves a walker can undo, which keep it inside its region.
+        bool reversible(int move) {
+            return move == MOVE_FLAT || move == MOVE_UP || move == MOVE_DROP;
+        }
+
+        int cell_index(int x, int y, int z) {
+            return (y << (2 * NAV_SECTION_LOG2)) | (z << NAV_SECTION_LOG2) | x;
+        }
+
+        int cell_index(const glm::ivec3& local) {
+            return cell_index(local.x, local.y, local.z);
+        }
+
+        glm::ivec3 cell_of(int index) {
+            const int mask = NAV_SECTION_SIZE - 1;
+            return glm::ivec3(index & mask, index >> (2 * NAV_SECTION_LOG2),
+                              (index >> NAV_SECTION_LOG2) & mask);
+        }
+
+        glm::ivec3 section_of(const glm::ivec3& v) {
+            return glm::ivec3(v.x >> NAV_SECTION_LOG2, v.y >> NAV_SECTION_LOG2,
+                              v.z >> NAV_SECTION_LOG2);
+        }
+
+        glm::ivec3 section_local(const glm::ivec3& v) {
+            const int mask = NAV_SECTION_SIZE - 1;
+            return glm::ivec3(v.x & mask, v.y & mask, v.z & mask);
+        }
+
+        bool inside_section(const glm::ivec3& local) {
+            return local.x >= 0 && local.y >= 0 && local.z >= 0 && local.x < NAV_SECTION_SIZE &&
+                   local.y < NAV_SECTION_SIZE && local.z < NAV_SECTION_SIZE;
+        }
+
+        // Per-block flags for chunk::unpack_box_masks().
+        constexpr std::uint8_t open_flags(block_id block) {
+            return block_solid(block) ? 0 : FLAG_OPEN;
+        }
+
+        // A section's open blocks with the margin its moves look into: one block to each side,
+        // two above and a drop plus a floor below.
+        class open_grid {
+        public:
+            static constexpr int BELOW = NAV_MAX_DROP + 1;
+            static constexpr int WIDTH = NAV_SECTION_SIZE + 2;
+            static constexpr int HEIGHT = NAV_SECTION_SIZE + BELOW + 2;
+
+            bool open(int x, int y, int z) const {
+                return m_open[((y + BELOW) * WIDTH + z + 1) * WIDTH + x + 1] != 0;
+            }
+
+            bool stand(int x, int y, int z) const {
+                return open(x, y, z) && open(x, y + 1, z) && !open(x, y - 1, z);
+            }
+
+            void set(int x, int y, int z, bool open) {
+                m_open[((y + BELOW) * WIDTH + z + 1) * WIDTH + x + 1] = open ? 1 : 0;
+            }
+
+            // One of the MOVE_ values, for a walker standing at (x, y, z).
+            int move(int x, int y, int z, const glm::ivec3& d) const {
+                const int qx = x + d.x;
+                const int qz = z + d.z;
+                if (stand(qx, y, qz)) {
+                    return MOVE_FLAT;
+                }
+                if (open(x, y + 2, z) && stand(qx, y + 1, qz)) {
+                    return MOVE_UP;
+                }
+                if (!open(qx, y, qz) || !open(qx, y + 1, qz)) {
+                    return MOVE_NONE;
+                }
+                for (int k = 1; k <= NAV_MAX_DROP; k++) {
+                    if (!open(qx, y - k, qz)) {
+                        break;
+                    }
+                    if (stand(qx, y - k, qz)) {
+                        return MOVE_DROP + k - 1;
+                    }
+                }
+                return MOVE_NONE;
+            }
+
+        private:
+            std::uint8_t m_open[WIDTH * HEIGHT * WIDTH];
+        };
+    }  // namespace
+
+    nav_graph::nav_graph(const world& w) : m_world(w) {
+    }
+
+    nav_graph::~nav_graph() = default;
+
+    const nav_graph::section* nav_graph::find(const glm::ivec3& pos) const {
+        const auto it = m_sections.find(pos);
+        return it == m_sections.end() ? nullptr : it->second.get();
+    }
+
+    void nav_graph::stale_blocks(const glm::ivec3& pos) {
+        const auto it = m_sections.find(pos);
+        if (it != m_sections.end() && !it->second->stale_blocks) {
+            it->second->stale_blocks = true;
+            m_stale_blocks.push_back(pos);
+        }
+    }
+
+    void nav_graph::stale_labels(const glm::ivec3& min_block, const glm::ivec3& max_block) {
+        const glm::ivec3 first = section_of(min_block - glm::ivec3(1, 2, 1));
+        const glm::ivec3 last = section_of(max_block + glm::ivec3(1, NAV_MAX_DROP + 1, 1));
+        for (int y = first.y; y <= last.y; y++) {
+            for (int z = first.z; z <= last.z; z++) {
+                for (int x = first.x; x <= last.x; x++) {
+                    const auto it = m_sections.find(glm::ivec3(x, y, z));
+                    if (it != m_sections.end() && !it->second->stale_labels) {
+                        it->second->stale_labels = true;
+                        m_stale_labels.push_back(it->first);
+                    }
+                }
+            }
+        }
+    }
+
+    void nav_graph::add_chunk(const glm::ivec3& pos) {
+        constexpr int PER_CHUNK = CHUNK_SIZE / NAV_SECTION_SIZE;
+        for (int y = 0; y < PER_CHUNK; y++) {
+            for (int z = 0; z < PER_CHUNK; z++) {
+                for (int x = 0; x < PER_CHUNK; x++) {
+                    const glm::ivec3 p = pos * PER_CHUNK + glm::ivec3(x, y, z);
+                    std::unique_ptr<section>& s = m_sections[p];
+                    if (!s) {
+                        s = std::make_unique<section>();
+                        s->pos = p;
+                    }
+                    stale_blocks(p);
+                }
+            }
+        }
+        const glm::ivec3 first = pos * CHUNK_SIZE;
+        stale_labels(first, first + glm::ivec3(CHUNK_SIZE - 1));
+    }
+
+    void nav_graph::remove_chunk(const glm::ivec3& pos) {
+        constexpr int PER_CHUNK = CHUNK_SIZE / NAV_SECTION_SIZE;
+        for (int y = 0; y < PER_CHUNK; y++) {
+            for (int z = 0; z < PER_CHUNK; z++) {
+                for (int x = 0; x < PER_CHUNK; x++) {
+                    m_sections.erase(pos * PER_CHUNK + glm::ivec3(x, y, z));
+                }
+            }
+        }
+        const glm::ivec3 first = pos * CHUNK_SIZE;
+        stale_labels(first, first + glm::ivec3(CHUNK_SIZE - 1));
+    }
+
+    void nav_graph::block_changed(const glm::ivec3& v) {
+        stale_blocks(section_of(v));
+        stale_labels(v, v);
+    }
+
+    std::size_t nav_graph::update() {
+        // In stages, as labels read the open blocks of the sections around and edges their
+        // labels.
+        for (const glm::ivec3& pos : m_stale_blocks) {
+            const auto it = m_sections.find(pos);
+            if (it != m_sections.end()) {
+                refresh_open(*it->second);
+                it->second->stale_blocks = false;
+            }
+        }
+        m_stale_blocks.clear();
+
+        std::size_t rebuilt = 0;
+        for (const glm::ivec3& pos : m_stale_labels) {
+            const auto it = m_sections.find(pos);
+            if (it == m_sections.end()) {
+                continue;
+            }
+            relabel(*it->second);
+            it->second->stale_labels = false;
+            rebuilt++;
+            // Edges name the regions they lead to, here and around.
+            for (int y = -1; y <= 1; y++) {
+                for (int z = -1; z <= 1; z++) {
+                    for (int x = -1; x <= 1; x++) {
+                        const auto n = m_sections.find(pos + glm::ivec3(x, y, z));
+                        if (n != m_sections.end() && !n->second->stale_edges) {
+                            n->second->stale_edges = true;
+                            m_stale_edges.push_back(n->first);
+                        }
+                    }
+                }
+            }
+        }
+        m_stale_labels.clear();
+
+        for (const glm::ivec3& pos : m_stale_edges) {
+            const auto it = m_sections.find(pos);
+            if (it != m_sections.end()) {
+                rebuild_edges(*it->second);
+                it->second->stale_edges = false;
+            }
+        }
+        m_stale_edges.clear();
+        return rebuilt;
+    }
+
+    void nav_graph::refresh_open(section& s) {
+        constexpr int PER_CHUNK_LOG2 = CHUNK_SIZE_LOG2 - NAV_SECTION_LOG2;
+        const glm::ivec3 chunk_pos(s.pos.x >> PER_CHUNK_LOG2, s.pos.y >> PER_CHUNK_LOG2,
+                                   s.pos.z >> PER_CHUNK_LOG2);
+        const chunk* c = m_world.find(chunk_pos);
+        if (c == nullptr) {
+            std::fill(std::begin(s.open), std::end(s.open), std::uint16_t{0xFFFF});
+            return;
+        }
+
+        const glm::ivec3 origin = (s.pos - chunk_pos * (1 << PER_CHUNK_LOG2)) * NAV_SECTION_SIZE;
+        const int last = NAV_SECTION_SIZE - 1;
+        std::uint32_t rows[NAV_SECTION_SIZE * NAV_SECTION_SIZE];
+        c->unpack_box_masks(block_flag_table<open_flags>(), FLAG_OPEN, origin.x, origin.y,
+                            origin.z, origin.x + last, origin.y + last, origin.z + last, rows);
+        for (int i = 0; i < NAV_SECTION_SIZE * NAV_SECTION_SIZE; i++) {
+            s.open[i] = static_cast<std::uint16_t>(rows[i] >> origin.x);
+        }
+    }
+
+    void nav_graph::relabel(section& s) {
+        // The blocks around come from the neighbouring sections, or read as air where none is
+        // loaded, as in the world.
+        open_grid grid;
+        const section* around[3][3][3];
+        for (int y = -1; y <= 1; y++) {
+            for (int z = -1; z <= 1; z++) {
+                for (int x = -1; x <= 1; x++) {
+                    around[y + 1][z + 1][x + 1] = find(s.pos + glm::ivec3(x, y, z));
+                }
+            }
+        }
+        for (int y = -open_grid::BELOW; y < NAV_SECTION_SIZE + 2; y++) {
+            const int sy = y < 0 ? 0 : y < NAV_SECTION_SIZE ? 1 : 2;
+            const int ly = y & (NAV_SECTION_SIZE - 1);
+            for (int z = -1; z <= NAV_SECTION_SIZE; z++) {
+                const int sz = z < 0 ? 0 : z < NAV_SECTION_SIZE ? 1 : 2;
+                const int lz = z & (NAV_SECTION_SIZE - 1);
+                for (int x = -1; x <= NAV_SECTION_SIZE; x++) {
+                    const int sx = x < 0 ? 0 : x < NAV_SECTION_SIZE ? 1 : 2;
+                    const section* n = around[sy][sz][sx];
+                    const int lx = x & (NAV_SECTION_SIZE - 1);
+                    grid.set(x, y, z,
+                             n == nullptr || (n->open[ly * NAV_SECTION_SIZE + lz] >> lx & 1) != 0);
+                }
+            }
+        }
+
+        s.labels.assign(NAV_SECTION_VOLUME, 0);
+        s.moves.assign(NAV_SECTION_VOLUME, 0);
+        s.regions.clear();
+        bool any = false;
+        for (int i = 0; i < NAV_SECTION_VOLUME; i++) {
+            const glm::ivec3 p = cell_of(i);
+            if (!grid.stand(p.x, p.y, p.z)) {
+                continue;
+            }
+            // Tells standing spots without moves apart from blocks that cannot be stood in.
+            s.labels[i] = 1;
+            any = true;
+            std::uint16_t moves = 0;
+            for (int d = 0; d < DIRECTION_COUNT; d++) {
+                moves |= static_cast<std::uint16_t>(grid.move(p.x, p.y, p.z, DIRECTIONS[d])
+                                                    << (MOVE_BITS * d));
+            }
+            s.moves[i] = moves;
+        }
+        if (!any) {
+            std::vector<std::uint16_t>().swap(s.labels);
+            std::vector<std::uint16_t>().swap(s.moves);
+            return;
+        }
+
+        // Flood fill over the moves that can be undone, so every region reaches all of itself.
+        std::vector<std::uint16_t> queue;
+        for (int i = 0; i < NAV_SECTION_VOLUME; i++) {
+            if (s.labels[i] != 1) {
+                continue;
+            }
+            // Labels are region + 1, with 1 also marking spots not reached yet, so regions are
+            // numbered from 1 here and shifted down once the fill is done.
+            const std::uint16_t label = static_cast<std::uint16_t>(s.regions.size() + 2);
+            region r;
+            glm::vec3 sum(0.0f);
+            s.labels[i] = label;
+            queue.assign(1, static_cast<std::uint16_t>(i));
+            while (!queue.empty()) {
+                const int c = queue.back();
+                queue.pop_back();
+                const glm::ivec3 p = cell_of(c);
+                sum += glm::vec3(p);
+                r.cells++;
+                for (int d = 0; d < DIRECTION_COUNT; d++) {
+                    const int move = s.moves[c] >> (MOVE_BITS * d) & ((1 << MOVE_BITS) - 1);
+                    if (!reversible(move)) {
+                        continue;
+                    }
+                    const glm::ivec3 q = p + DIRECTIONS[d] + glm::ivec3(0, move_rise(move), 0);
+                    if (!inside_section(q)) {
+                        continue;
+                    }
+                    const int t = cell_index(q);
+                    if (s.labels[t] == 1) {
+                        s.labels[t] = label;
+                        queue.push_back(static_cast<std::uint16_t>(t));
+                    }
+                }
+            }
+            r.center = glm::vec3(s.pos * NAV_SECTION_SIZE) + sum / static_cast<float>(r.cells);
+            s.regions.push_back(r);
+        }
+        for (std::uint16_t& label : s.labels) {
+            label = label == 0 ? 0 : static_cast<std::uint16_t>(label - 1);
+        }
+    }
+
+    void nav_graph::rebuild_edges(section& s) {
+        s.edges.clear();
+        if (s.labels.empty()) {
+            return;
+        }
+        const section* around[3][3][3];
+        for (int y = -1; y <= 1; y++) {
+            for (int z = -1; z <= 1; z++) {
+                for (int x = -1; x <= 1; x++) {
+                    around[y + 1][z + 1][x + 1] = find(s.pos + glm::ivec3(x, y, z));
+                }
+            }
+        }
+
+        for (int i = 0; i < NAV_SECTION_VOLUME; i++) {
+            if (s.labels[i] == 0) {
+                continue;
+            }
+            const glm::ivec3 p = cell_of(i);
+            for (int d = 0; d < DIRECTION_COUNT; d++) {
+                const int move = s.moves[i] >> (MOVE_BITS * d) & ((1 << MOVE_BITS) - 1);
+                if (move == MOVE_NONE) {
+                    continue;
+                }
+                const glm::ivec3 q = p + DIRECTIONS[d] + glm::ivec3(0, move_rise(move), 0);
+                const glm::ivec3 offset = section_of(q);
+                const section* n = around[offset.y + 1][offset.z + 1][offset.x + 1];
+                if (n == nullptr || n->labels.empty()) {
+                    continue;
+                }
+                const std::uint16_t to = n->labels[cell_index(section_local(q))];
+                if (to != 0 && (n != &s || to != s.labels[i])) {
+                    s.edges.push_back({n, static_cast<std::uint16_t>(s.labels[i] - 1),
+                                       static_cast<std::uint16_t>(to - 1), 0.0f});
+                }
+            }
+        }
+
+        // By position rather than address, so searches expand edges in the same order however
+        // the sections were allocated.
+        const auto order = [](const edge& a, const edge& b) {
+            const glm::ivec3& p = a.target->pos;
+            const glm::ivec3& q = b.target->pos;
+            return std::tie(a.from, p.x, p.y, p.z, a.to) < std::tie(b.from, q.x, q.y, q.z, b.to);
+        };
+        const auto same = [](const edge& a, const edge& b) {
+            return a.from == b.from && a.target == b.target && a.to == b.to;
+        };
+        std::sort(s.edges.begin(), s.edges.end(), order);
+        s.edges.erase(std::unique(s.edges.begin(), s.edges.end(), same), s.edges.end());
+
+        for (region& r : s.regions) {
+            r.edge_count = 0;
+        }
+        for (std::size_t e = s.edges.size(); e-- > 0;) {
+            edge& out = s.edges[e];
+            region& r = s.regions[out.from];
+            r.first_edge = static_cast<std::uint32_t>(e);
+            r.edge_count++;
+            // Walking distance between the middles, which the coarse search estimates with.
+            const glm::vec3 d = out.target->regions[out.to].center - r.center;
+            out.cost = std::max(std::abs(d.x) + std::abs(d.z), 1.0f);
+        }
+    }
+
+    bool nav_graph::walkable(const glm::ivec3& v) const {
+        const section* s = find(section_of(v));
+        return s != nullptr && !s->labels.empty() && s->labels[cell_index(section_local(v))] != 0;
+    }
+
+    std::size_t nav_graph::region_count() const {
+        std::size_t count = 0;
+        for (const auto& entry : m_sections) {
+            count += entry.second->regions.size();
+        }
+        return count;
+    }
+
+    std::size_t nav_graph::edge_count() const {
+        std::size_t count = 0;
+        for (const auto& entry : m_sections) {
+            count += entry.second->edges.size();
+        }
+        return count;
+    }
+
+    path_finder::path_finder(const nav_graph& graph) : m_graph(graph) {
+    }
+
+    bool path_finder::find(const glm::ivec3& from, const glm::ivec3& to,
+                           std::vector<glm::ivec3>& path) {
+        path.clear();
+        m_regions_expanded = 0;
+        m_blocks_expanded = 0;
+        if (!m_graph.walkable(from) || !m_graph.walkable(to)) {
+            return false;
+        }
+        const section* start = m_graph.find(section_of(from));
+        const section* goal = m_graph.find(section_of(to));
+        const node_key start_key{start, static_cast<std::uint16_t>(
+                                            start->labels[cell_index(section_local(from))] - 1)};
+        const node_key goal_key{goal, static_cast<std::uint16_t>(
+                                          goal->labels[cell_index(section_local(to))] - 1)};
+        return plan(start_key, goal_key, to) && walk(from, to, path);
+    }
+
+    bool path_finder::plan(const node_key& start, const node_key& goal, const glm::ivec3& to) {
+        m_corridor.clear();
+        if (start == goal) {
+            m_corridor.push_back(start);
+            return true;
+        }
+
+        const glm::vec3 target(to);
+        const auto estimate = [&](const node_key& key) {
+            const glm::vec3 d = key.s->regions[key.region].center - target;
+            return std::abs(d.x) + std::abs(d.z);
+        };
+        m_nodes.clear();
+        m_node_index.clear();
+        m_open.clear();
+        m_nodes.push_back({start, 0.0f, -1, false});
+        m_node_index.emplace(start, 0);
+        m_open.push_back({estimate(start), 0});
+
+        while (!m_open.empty()) {
+            std::pop_heap(m_open.begin(), m_open.end());
+            const std::uint32_t id = m_open.back().id;
+            m_open.pop_back();
+            if (m_nodes[id].closed) {
+                continue;
+            }
+            m_nodes[id].closed = true;
+            const node_key key = m_nodes[id].key;
+            if (key == goal) {
+                for (std::int32_t n = static_cast<std::int32_t>(id); n >= 0;
+                     n = m_nodes[n].parent) {
+                    m_corridor.push_back(m_nodes[n].key);
+                }
+                return true;
+            }
+            if (++m_regions_expanded > MAX_REGIONS) {
+                return false;
+            }
+
+            const float g = m_nodes[id].g;
+            const nav_graph::region& r = key.s->regions[key.region];
+            for (std::uint32_t e = r.first_edge; e < r.first_edge + r.edge_count; e++) {
+                const nav_graph::edge& out = key.s->edges[e];
+                const node_key next{out.target, out.to};
+                const float cost = g + out.cost;
+                const auto [it, added] =
+                    m_node_index.emplace(next, static_cast<std::int32_t>(m_nodes.size()));
+                if (added) {
+                    m_nodes.push_back({next, cost, static_cast<std::int32_t>(id), false});
+                } else if (m_nodes[it->second].closed || m_nodes[it->second].g <= cost) {
+                    continue;
+                } else {
+                    m_nodes[it->second].g = cost;
+                    m_nodes[it->second].parent = static_cast<std::int32_t>(id);
+                }
+                m_open.push_back({cost + estimate(next), static_cast<std::uint32_t>(it->second)});
+                std::push_heap(m_open.begin(), m_open.end());
+            }
+        }
+        return false;
+    }
+
+    int path_finder::slot_of(const glm::ivec3& section_pos) const {
+        const auto it = m_slot_index.find(section_pos);
+        return it == m_slot_index.end() ? -1 : it->second;
+    }
+
+    bool path_finder::walk(const glm::ivec3& from, const glm::ivec3& to,
+                           std::vector<glm::ivec3>& path) {
+        // One slot per section, listing the corridor's regions in it.
+        std::sort(m_corridor.begin(), m_corridor.end(), [](const node_key& a, const node_key& b) {
+            const glm::ivec3& p = a.s->pos;
+            const glm::ivec3& q = b.s->pos;
+            return std::tie(p.x, p.y, p.z, a.region) < std::tie(q.x, q.y, q.z, b.region);
+        });
+        m_slots.clear();
+        m_slot_index.clear();
+        for (std::uint32_t i = 0; i < m_corridor.size(); i++) {
+            if (m_slots.empty() || m_slots.back().s != m_corridor[i].s) {
+                m_slot_index.emplace(m_corridor[i].s->pos, static_cast<int>(m_slots.size()));
+                m_slots.push_back({m_corridor[i].s, i, 0});
+            }
+            m_slots.back().count++;
+        }
+
+        const std::size_t cells = m_slots.size() * NAV_SECTION_VOLUME;
+        if (m_stamp.size() < cells) {
+            m_g.resize(cells);
+            m_parent.resize(cells);
+            m_stamp.resize(cells, 0);
+        }
+        if (++m_search == 0) {
+            std::fill(m_stamp.begin(), m_stamp.end(), 0);
+            m_search = 1;
+        }
+
+        const auto id_of = [](int slot, const glm::ivec3& local) {
+            return static_cast<std::uint32_t>(slot * NAV_SECTION_VOLUME + cell_index(local));
+        };
+        const auto position = [&](std::uint32_t id) {
+            return m_slots[id / NAV_SECTION_VOLUME].s->pos * NAV_SECTION_SIZE +
+                   cell_of(static_cast<int>(id % NAV_SECTION_VOLUME));
+        };
+        const auto estimate = [&](const glm::ivec3& p) {
+            return static_cast<float>(std::abs(p.x - to.x) + std::abs(p.z - to.z));
+        };
+
+        const std::uint32_t start = id_of(slot_of(section_of(from)), section_local(from));
+        const std::uint32_t goal = id_of(slot_of(section_of(to)), section_local(to));
+        m_g[start] = 0.0f;
+        m_parent[start] = start;
+        m_stamp[start] = m_search;
+        m_open.clear();
+        m_open.push_back({estimate(from), start});
+
+        while (!m_open.empty()) {
+            std::pop_heap(m_open.begin(), m_open.end());
+            const open_entry top = m_open.back();
+            m_open.pop_back();
+            const glm::ivec3 p = position(top.id);
+            // The heuristic is consistent, so an entry is stale exactly when a cheaper one for
+            // the same block came after it.
+            const float g = m_g[top.id];
+            if (top.f > g + estimate(p)) {
+                continue;
+            }
+            if (top.id == goal) {
+                for (std::uint32_t id = goal;; id = m_parent[id]) {
+                    path.push_back(position(id));
+                    if (id == start) {
+                        break;
+                    }
+                }
+                std::reverse(path.begin(), path.end());
+                return true;
+            }
+            m_blocks_expanded++;
+
+            const int from_slot = static_cast<int>(top.id / NAV_SECTION_VOLUME);
+            const section& s = *m_slots[from_slot].s;
+            const int moves = s.moves[top.id % NAV_SECTION_VOLUME];
+            const glm::ivec3 local = cell_of(static_cast<int>(top.id % NAV_SECTION_VOLUME));
+            for (int d = 0; d < DIRECTION_COUNT; d++) {
+                const int move = moves >> (MOVE_BITS * d) & ((1 << MOVE_BITS) - 1);
+                if (move == MOVE_NONE) {
+                    continue;
+                }
+                const glm::ivec3 q = local + DIRECTIONS[d] + glm::ivec3(0, move_rise(move), 0);
+                const int to_slot =
+                    inside_section(q) ? from_slot : slot_of(s.pos + section_of(q));
+                if (to_slot < 0) {
+                    continue;
+                }
+                const slot& target = m_slots[to_slot];
+                const std::uint32_t id = id_of(to_slot, section_local(q));
+                const std::uint16_t label = target.s->labels[id % NAV_SECTION_VOLUME];
+                bool allowed = false;
+                for (std::uint32_t i = target.first; i < target.first + target.count; i++) {
+                    allowed = allowed || m_corridor[i].region + 1 == label;
+                }
+                if (!allowed) {
+                    continue;
+                }
+                const float cost = g + move_cost(move);
+                if (m_stamp[id] == m_search && m_g[id] <= cost) {
+                    continue;
+                }
+                m_g[id] = cost;
+                m_parent[id] = top.id;
+                m_stamp[id] = m_search;
+                m_open.push_back({cost + estimate(p + q - local), id});
+                std::push_heap(m_open.begin(), m_open.end());
+            }
+        }
+        return false;
+    }
+}  // namespace qc
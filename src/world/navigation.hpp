@@ -0,0 +1,210 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "world/world.hpp"
+
+namespace qc {
+    // Navigation sections are 16^3 blocks, eight to a chunk.
+    constexpr int NAV_SECTION_LOG2 = 4;
+    constexpr int NAV_SECTION_SIZE = 1 << NAV_SECTION_LOG2;
+    constexpr int NAV_SECTION_VOLUME = NAV_SECTION_SIZE * NAV_SECTION_SIZE * NAV_SECTION_SIZE;
+    // Furthest a walker drops down a ledge in one move.
+    constexpr int NAV_MAX_DROP = 3;
+
+    // Where walkers two blocks tall can go, for pathfinding.
+    //
+    // A walker stands in a non-solid block with a solid block under it and room for its head
+    // above. From there it moves to the four horizontal neighbours: on the level, one block up
+    // with headroom to climb, or down a ledge of up to NAV_MAX_DROP blocks. Only the single
+    // block drop can be climbed back.
+    //
+    // Each section splits its standing spots into regions that reach each other without
+    // leaving the section, and keeps the edges from its regions to the regions moves lead into,
+    // in it or in the sections around it. The edges are the coarse graph path_finder plans over
+    // before walking blocks. Block edits dirty only the sections near them; update() rebuilds
+    // those.
+    //
+    // Changes and update() belong to one thread. Any number of path_finders may read the graph
+    // at once in between, provided neither it nor the world changes meanwhile.
+    class nav_graph {
+    public:
+        explicit nav_graph(const world& w);
+        ~nav_graph();
+
+        nav_graph(const nav_graph&) = delete;
+        nav_graph& operator=(const nav_graph&) = delete;
+
+        // The chunk at `pos` was loaded or replaced.
+        void add_chunk(const glm::ivec3& pos);
+        void remove_chunk(const glm::ivec3& pos);
+        void block_changed(const glm::ivec3& v);
+
+        // Brings the dirty sections up to date. Returns how many were rebuilt.
+        std::size_t update();
+
+        // Whether a walker can stand at `v`, as of the last update().
+        bool walkable(const glm::ivec3& v) const;
+
+        std::size_t section_count() const {
+            return m_sections.size();
+        }
+
+        // Totals over every section, as of the last update().
+        std::size_t region_count() const;
+        std::size_t edge_count() const;
+
+    private:
+        friend class path_finder;
+
+        struct region {
+            // Mean of the region's blocks, where the coarse search measures from.
+            glm::vec3 center{0.0f};
+            std::uint32_t cells = 0;
+            // This region's range of `edges`.
+            std::uint32_t first_edge = 0;
+            std::uint32_t edge_count = 0;
+        };
+
+        struct section;
+
+        // Sections live until their chunk is removed, which dirties the edges into them.
+        struct edge {
+            const section* target;
+            std::uint16_t from;
+            std::uint16_t to;
+            float cost;
+        };
+
+        struct section {
+            glm::ivec3 pos{0};
+            // Bit x of open[y * 16 + z] is set when that block is not solid.
+            std::uint16_t open[NAV_SECTION_SIZE * NAV_SECTION_SIZE] = {};
+            // Per block: the region standing there plus one, or 0 where no walker can stand.
+            // Empty when no block of the section can be stood in.
+            std::vector<std::uint16_t> labels;
+            // Per block, three bits per direction (+x, -x, +z, -z): one of the MOVE_ values.
+            std::vector<std::uint16_t> moves;
+            std::vector<region> regions;
+            // Sorted by the region they leave.
+            std::vector<edge> edges;
+            bool stale_blocks = false;
+            bool stale_labels = false;
+            bool stale_edges = false;
+        };
+
+        const section* find(const glm::ivec3& pos) const;
+        void stale_blocks(const glm::ivec3& pos);
+        // Relabels the sections whose standing spots or moves may depend on the blocks from
+        // `min_block` to `max_block`.
+        void stale_labels(const glm::ivec3& min_block, const glm::ivec3& max_block);
+        void refresh_open(section& s);
+        void relabel(section& s);
+        void rebuild_edges(section& s);
+
+        const world& m_world;
+        std::unordered_map<glm::ivec3, std::unique_ptr<section>, chunk_pos_hash> m_sections;
+        // Sections waiting for update(), by stage. May name sections since removed.
+        std::vector<glm::ivec3> m_stale_blocks;
+        std::vector<glm::ivec3> m_stale_labels;
+        std::vector<glm::ivec3> m_stale_edges;
+    };
+
+    // Finds walking paths over a nav_graph: first over the regions of the coarse graph, then
+    // block by block with A* through only the regions the coarse path crosses. Holds scratch
+    // buffers, so use one per thread.
+    class path_finder {
+    public:
+        // The coarse search gives up after this many regions.
+        static constexpr std::size_t MAX_REGIONS = 20000;
+
+        explicit path_finder(const nav_graph& graph);
+
+        // Fills `path` with the blocks a walker standing at `from` passes through to `to`, both
+        // ends included. Returns false, leaving `path` empty, if either end cannot be stood in
+        // or there is no way between them.
+        bool find(const glm::ivec3& from, const glm::ivec3& to, std::vector<glm::ivec3>& path);
+
+        // Regions and blocks the last find() took off its open lists.
+        std::size_t regions_expanded() const {
+            return m_regions_expanded;
+        }
+
+        std::size_t blocks_expanded() const {
+            return m_blocks_expanded;
+        }
+
+    private:
+        using section = nav_graph::section;
+
+        struct node_key {
+            const section* s;
+            std::uint16_t region;
+
+            bool operator==(const node_key& other) const {
+                return s == other.s && region == other.region;
+            }
+        };
+
+        struct node_key_hash {
+            std::size_t operator()(const node_key& key) const {
+                return std::hash<const section*>()(key.s) * 31 + key.region;
+            }
+        };
+
+        struct coarse_node {
+            node_key key;
+            float g;
+            std::int32_t parent;
+            bool closed;
+        };
+
+        // A section of the corridor the block search may enter, and its range of m_corridor:
+        // the regions it may use.
+        struct slot {
+            const section* s;
+            std::uint32_t first;
+            std::uint32_t count;
+        };
+
+        struct open_entry {
+            float f;
+            std::uint32_t id;
+
+            bool operator<(const open_entry& other) const {
+                return f > other.f;
+            }
+        };
+
+        // Fills m_corridor with the regions of a coarse path from `start` to `goal`.
+        bool plan(const node_key& start, const node_key& goal, const glm::ivec3& to);
+        // A* over the blocks of the corridor.
+        bool walk(const glm::ivec3& from, const glm::ivec3& to, std::vector<glm::ivec3>& path);
+        int slot_of(const glm::ivec3& section_pos) const;
+
+        const nav_graph& m_graph;
+
+        std::vector<coarse_node> m_nodes;
+        std::unordered_map<node_key, std::int32_t, node_key_hash> m_node_index;
+        std::vector<open_entry> m_open;
+
+        std::vector<node_key> m_corridor;
+        std::vector<slot> m_slots;
+        std::unordered_map<glm::ivec3, int, chunk_pos_hash> m_slot_index;
+        // Per block of the corridor, valid where m_stamp matches the current search.
+        std::vector<float> m_g;
+        std::vector<std::uint32_t> m_parent;
+        std::vector<std::uint32_t> m_stamp;
+        std::uint32_t m_search = 0;
+
+        std::size_t m_regions_expanded = 0;
+        std::size_t m_blocks_expanded = 0;
+    };
+}  // namespace qc
@@ -0,0 +1,52 @@
+#include "world/noise.hpp"
+
+#include <algorithm>
+
+#include "world/noise_kernel.hpp"
+
+namespace qc {
+    namespace {
+        // Never runs a path the CPU lacks, whatever the caller asks for.
+        simd_level usable(simd_level requested) {
+            return std::min(requested, best_simd_level());
+        }
+    }  // namespace
+
+    void simplex2(const float* x, const float* y, float* out, std::size_t count,
+                  std::uint32_t seed, simd_level level) {
+        fbm_params params;
+        params.seed = seed;
+        fbm2(x, y, out, count, params, level);
+    }
+
+    void simplex3(const float* x, const float* y, const float* z, float* out, std::size_t count,
+                  std::uint32_t seed, simd_level level) {
+        fbm_params params;
+        params.seed = seed;
+        fbm3(x, y, z, out, count, params, level);
+    }
+
+    void fbm2(const float* x, const float* y, float* out, std::size_t count,
+              const fbm_params& params, simd_level level) {
+        detail::noise2_fn fn = &fbm2_batch<scalar_lanes>;
+        level = usable(level);
+        if (level >= SIMD_AVX2 && detail::FBM2_AVX2 != nullptr) {
+            fn = detail::FBM2_AVX2;
+        } else if (level >= SIMD_SSE2 && detail::FBM2_SSE2 != nullptr) {
+            fn = detail::FBM2_SSE2;
+        }
+        fn(x, y, out, count, params);
+    }
+
+    void fbm3(const float* x, const float* y, const float* z, float* out, std::size_t count,
+              const fbm_params& params, simd_level level) {
+        detail::noise3_fn fn = &fbm3_batch<scalar_lanes>;
+        level = usable(level);
+        if (level >= SIMD_AVX2 && detail::FBM3_AVX2 != nullptr) {
+            fn = detail::FBM3_AVX2;
+        } else if (level >= SIMD_SSE2 && detail::FBM3_SSE2 != nullptr) {
+            fn = detail::FBM3_SSE2;
+        }
+        fn(x, y, z, out, count, params);
+    }
+}  // namespace qc
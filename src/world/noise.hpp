@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/simd.hpp"
+
+namespace qc {
+    // Fractal Brownian motion: `octaves` layers of simplex noise, each `lacunarity` times the
+    // frequency and `gain` times the amplitude of the last, normalized back to about [-1, 1].
+    struct fbm_params {
+        std::uint32_t seed = 0;
+        float frequency = 1.0f;
+        int octaves = 1;
+        float lacunarity = 2.0f;
+        float gain = 0.5f;
+    };
+
+    // Batched simplex noise. Every function evaluates `count` points given as separate
+    // coordinate arrays and writes one value per point to `out`, 4 or 8 points at a time on the
+    // SSE2 and AVX2 paths. All paths perform the same float operations in the same order, so
+    // their results are bit-identical: a world looks the same whichever CPU generated it.
+    void simplex2(const float* x, const float* y, float* out, std::size_t count,
+                  std::uint32_t seed, simd_level level = best_simd_level());
+    void simplex3(const float* x, const float* y, const float* z, float* out, std::size_t count,
+                  std::uint32_t seed, simd_level level = best_simd_level());
+
+    void fbm2(const float* x, const float* y, float* out, std::size_t count,
+              const fbm_params& params, simd_level level = best_simd_level());
+    void fbm3(const float* x, const float* y, const float* z, float* out, std::size_t count,
+              const fbm_params& params, simd_level level = best_simd_level());
+}  // namespace qc
@@ -0,0 +1,111 @@
+#include "world/noise_kernel.hpp"
+
+#if defined(QC_X86)
+#include <immintrin.h>
+#endif
+
+namespace qc {
+#if defined(QC_X86)
+    namespace {
+        // Built with AVX2 enabled; only called after best_simd_level() has confirmed support.
+        struct avx2_lanes {
+            static constexpr int WIDTH = 8;
+            using f = __m256;
+            using i = __m256i;
+
+            static f load(const float* p) {
+                return _mm256_loadu_ps(p);
+            }
+            static void store(float* p, f v) {
+                _mm256_storeu_ps(p, v);
+            }
+            static f set(float v) {
+                return _mm256_set1_ps(v);
+            }
+            static i seti(std::uint32_t v) {
+                return _mm256_set1_epi32(static_cast<int>(v));
+            }
+
+            static f add(f a, f b) {
+                return _mm256_add_ps(a, b);
+            }
+            static f sub(f a, f b) {
+                return _mm256_sub_ps(a, b);
+            }
+            static f mul(f a, f b) {
+                return _mm256_mul_ps(a, b);
+            }
+            static f max(f a, f b) {
+                return _mm256_max_ps(a, b);
+            }
+
+            // Deliberately not _mm256_floor_ps: the result must match the SSE2 path exactly.
+            static i floor_i(f v) {
+                const i t = _mm256_cvttps_epi32(v);
+                const f above = _mm256_cmp_ps(_mm256_cvtepi32_ps(t), v, _CMP_GT_OQ);
+                return _mm256_add_epi32(t, _mm256_castps_si256(above));
+            }
+            static f to_f(i v) {
+                return _mm256_cvtepi32_ps(v);
+            }
+
+            static i ge(f a, f b) {
+                return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GE_OQ));
+            }
+            static i gt(f a, f b) {
+                return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ));
+            }
+            static i lt_i(i a, i b) {
+                return _mm256_cmpgt_epi32(b, a);
+            }
+            static i eq_i(i a, i b) {
+                return _mm256_cmpeq_epi32(a, b);
+            }
+
+            static i add_i(i a, i b) {
+                return _mm256_add_epi32(a, b);
+            }
+            static i mul_i(i a, std::uint32_t b) {
+                return _mm256_mullo_epi32(a, _mm256_set1_epi32(static_cast<int>(b)));
+            }
+            static i and_i(i a, i b) {
+                return _mm256_and_si256(a, b);
+            }
+            static i or_i(i a, i b) {
+                return _mm256_or_si256(a, b);
+            }
+            static i xor_i(i a, i b) {
+                return _mm256_xor_si256(a, b);
+            }
+            static i andnot_i(i a, i b) {
+                return _mm256_andnot_si256(a, b);
+            }
+            template <int N>
+            static i shr(i a) {
+                return _mm256_srli_epi32(a, N);
+            }
+            template <int N>
+            static i shl(i a) {
+                return _mm256_slli_epi32(a, N);
+            }
+
+            static f select(i mask, f a, f b) {
+                return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask));
+            }
+            static f xor_bits(f v, i bits) {
+                return _mm256_xor_ps(v, _mm256_castsi256_ps(bits));
+            }
+        };
+    }  // namespace
+
+    namespace detail {
+        const noise2_fn FBM2_AVX2 = &fbm2_batch<avx2_lanes>;
+        const noise3_fn FBM3_AVX2 = &fbm3_batch<avx2_lanes>;
+    }  // namespace detail
+#else
+    namespace detail {
+        const noise2_fn FBM2_AVX2 = nullptr;
+        const noise3_fn FBM3_AVX2 = nullptr;
+    }  // namespace detail
+#endif
+}  // namespace qc
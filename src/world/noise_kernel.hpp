@@ -0,0 +1,390 @@
+#pragma once
+
+// Private to noise*.cpp. The kernels are templates over a lane type describing one instruction
+// set, and each instruction set gets its own translation unit built with its own target flags.
+// Everything here is in an anonymous namespace so that no inline function compiled for AVX2 can
+// be merged by the linker into the copy the scalar path calls.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "world/noise.hpp"
+
+namespace qc {
+    namespace detail {
+        using noise2_fn = void (*)(const float* x, const float* y, float* out, std::size_t count,
+                                   const fbm_params& params);
+        using noise3_fn = void (*)(const float* x, const float* y, const float* z, float* out,
+                                   std::size_t count, const fbm_params& params);
+
+        // Entry points of the SIMD translation units; null where the build lacks them.
+        extern const noise2_fn FBM2_SSE2;
+        extern const noise3_fn FBM3_SSE2;
+        extern const noise2_fn FBM2_AVX2;
+        extern const noise3_fn FBM3_AVX2;
+    }  // namespace detail
+
+    namespace {
+        constexpr float F2 = 0.36602540378f;  // (sqrt(3) - 1) / 2
+        constexpr float G2 = 0.21132486540f;  // (3 - sqrt(3)) / 6
+        constexpr float F3 = 1.0f / 3.0f;
+        constexpr float G3 = 1.0f / 6.0f;
+
+        // Bring each noise's extremes to roughly [-1, 1].
+        constexpr float SCALE2 = 45.0f;
+        constexpr float SCALE3 = 32.0f;
+
+        constexpr std::uint32_t PRIME_X = 0x8DA6B343u;
+        constexpr std::uint32_t PRIME_Y = 0xD8163841u;
+        constexpr std::uint32_t PRIME_Z = 0xCB1AB31Fu;
+        constexpr std::uint32_t PRIME_MIX = 0x27D4EB2Du;
+        constexpr std::uint32_t OCTAVE_SEED_STEP = 0x9E3779B9u;
+        constexpr std::uint32_t SIGN_BIT = 0x80000000u;
+
+        // One lane, and the reference every SIMD lane type must match bit for bit. Every
+        // operation maps to a single instruction on the SIMD paths, with the same operand order.
+        struct scalar_lanes {
+            static constexpr int WIDTH = 1;
+            using f = float;
+            using i = std::uint32_t;
+
+            static f load(const float* p) {
+                return *p;
+            }
+            static void store(float* p, f v) {
+                *p = v;
+            }
+            static f set(float v) {
+                return v;
+            }
+            static i seti(std::uint32_t v) {
+                return v;
+            }
+
+            static f add(f a, f b) {
+                return a + b;
+            }
+            static f sub(f a, f b) {
+                return a - b;
+            }
+            static f mul(f a, f b) {
+                return a * b;
+            }
+            // maxps semantics: b unless a is greater.
+            static f max(f a, f b) {
+                return a > b ? a : b;
+            }
+
+            // Truncates and corrects toward negative infinity, since SSE2 has no floor.
+            static i floor_i(f v) {
+                const std::int32_t t = static_cast<std::int32_t>(v);
+                return static_cast<i>(t - (static_cast<float>(t) > v ? 1 : 0));
+            }
+            static f to_f(i v) {
+                return static_cast<float>(static_cast<std::int32_t>(v));
+            }
+
+            // Comparisons produce all-ones or zero.
+            static i ge(f a, f b) {
+                return a >= b ? ~0u : 0u;
+            }
+            static i gt(f a, f b) {
+                return a > b ? ~0u : 0u;
+            }
+            static i lt_i(i a, i b) {
+                return static_cast<std::int32_t>(a) < static_cast<std::int32_t>(b) ? ~0u : 0u;
+            }
+            static i eq_i(i a, i b) {
+                return a == b ? ~0u : 0u;
+            }
+
+            static i add_i(i a, i b) {
+                return a + b;
+            }
+            static i mul_i(i a, std::uint32_t b) {
+                return a * b;
+            }
+            static i and_i(i a, i b) {
+                return a & b;
+            }
+            static i or_i(i a, i b) {
+                return a | b;
+            }
+            static i xor_i(i a, i b) {
+                return a ^ b;
+            }
+            // ~a & b, like pandn.
+            static i andnot_i(i a, i b) {
+                return ~a & b;
+            }
+            template <int N>
+            static i shr(i a) {
+                return a >> N;
+            }
+            template <int N>
+            static i shl(i a) {
+                return a << N;
+            }
+
+            static f select(i mask, f a, f b) {
+                return mask != 0 ? a : b;
+            }
+            static f xor_bits(f v, i bits) {
+                std::uint32_t raw;
+                std::memcpy(&raw, &v, sizeof(raw));
+                raw ^= bits;
+                std::memcpy(&v, &raw, sizeof(raw));
+                return v;
+            }
+        };
+
+        template <typename V>
+        typename V::i hash(typename V::i seed, typename V::i x, typename V::i y) {
+            typename V::i h = V::xor_i(seed, V::mul_i(x, PRIME_X));
+            h = V::xor_i(h, V::mul_i(y, PRIME_Y));
+            h = V::mul_i(h, PRIME_MIX);
+            return V::xor_i(h, V::template shr<15>(h));
+        }
+
+        template <typename V>
+        typename V::i hash(typename V::i seed, typename V::i x, typename V::i y,
+                           typename V::i z) {
+            typename V::i h = V::xor_i(seed, V::mul_i(x, PRIME_X));
+            h = V::xor_i(h, V::mul_i(y, PRIME_Y));
+            h = V::xor_i(h, V::mul_i(z, PRIME_Z));
+            h = V::mul_i(h, PRIME_MIX);
+            return V::xor_i(h, V::template shr<15>(h));
+        }
+
+        // Sign flips taken from bits 0 and 1 of the hash.
+        template <typename V>
+        typename V::f signed_sum(typename V::i h, typename V::f u, typename V::f v) {
+            const typename V::i sign_u = V::template shl<31>(h);
+            const typename V::i sign_v = V::and_i(V::template shl<30>(h), V::seti(SIGN_BIT));
+            return V::add(V::xor_bits(u, sign_u), V::xor_bits(v, sign_v));
+        }
+
+        // Eight gradients: (+-1, +-2) and (+-2, +-1).
+        template <typename V>
+        typename V::f grad2(typename V::i h, typename V::f x, typename V::f y) {
+            const typename V::i low = V::eq_i(V::and_i(h, V::seti(4)), V::seti(0));
+            const typename V::f u = V::select(low, x, y);
+            const typename V::f v = V::select(low, y, x);
+            return signed_sum<V>(h, u, V::add(v, v));
+        }
+
+        // The twelve cube edge gradients of improved Perlin noise, with 12..15 repeating some.
+        template <typename V>
+        typename V::f grad3(typename V::i h, typename V::f x, typename V::f y, typename V::f z) {
+            const typename V::i low = V::and_i(h, V::seti(15));
+            const typename V::f u = V::select(V::lt_i(low, V::seti(8)), x, y);
+            const typename V::i x_edge =
+                V::or_i(V::eq_i(low, V::seti(12)), V::eq_i(low, V::seti(14)));
+            const typename V::f v = V::select(V::lt_i(low, V::seti(4)), y, V::select(x_edge, x, z));
+            return signed_sum<V>(h, u, v);
+        }
+
+        template <typename V>
+        typename V::f corner2(typename V::i h, typename V::f x, typename V::f y) {
+            typename V::f t = V::sub(V::sub(V::set(0.5f), V::mul(x, x)), V::mul(y, y));
+            t = V::max(t, V::set(0.0f));
+            const typename V::f t2 = V::mul(t, t);
+            return V::mul(V::mul(t2, t2), grad2<V>(h, x, y));
+        }
+
+        template <typename V>
+        typename V::f corner3(typename V::i h, typename V::f x, typename V::f y,
+                              typename V::f z) {
+            typename V::f t =
+                V::sub(V::sub(V::sub(V::set(0.6f), V::mul(x, x)), V::mul(y, y)), V::mul(z, z));
+            t = V::max(t, V::set(0.0f));
+            const typename V::f t2 = V::mul(t, t);
+            return V::mul(V::mul(t2, t2), grad3<V>(h, x, y, z));
+        }
+
+        template <typename V>
+        typename V::f simplex2_lanes(typename V::f x, typename V::f y, typename V::i seed) {
+            using f = typename V::f;
+            using i = typename V::i;
+            const i one = V::seti(1);
+
+            // Skew into the simplex grid to find the containing cell, then unskew back.
+            const f s = V::mul(V::add(x, y), V::set(F2));
+            const i cx = V::floor_i(V::add(x, s));
+            const i cy = V::floor_i(V::add(y, s));
+            const f t = V::mul(V::to_f(V::add_i(cx, cy)), V::set(G2));
+            const f x0 = V::sub(x, V::sub(V::to_f(cx), t));
+            const f y0 = V::sub(y, V::sub(V::to_f(cy), t));
+
+            // The middle corner steps along x in the lower triangle and along y in the upper.
+            const i lower = V::gt(x0, y0);
+            const i i1 = V::and_i(lower, one);
+            const i j1 = V::andnot_i(lower, one);
+            const f x1 = V::add(V::sub(x0, V::to_f(i1)), V::set(G2));
+            const f y1 = V::add(V::sub(y0, V::to_f(j1)), V::set(G2));
+            const f x2 = V::add(V::sub(x0, V::set(1.0f)), V::set(2.0f * G2));
+            const f y2 = V::add(V::sub(y0, V::set(1.0f)), V::set(2.0f * G2));
+
+            f n = corner2<V>(hash<V>(seed, cx, cy), x0, y0);
+            n = V::add(n, corner2<V>(hash<V>(seed, V::add_i(cx, i1), V::add_i(cy, j1)), x1, y1));
+            n = V::add(n, corner2<V>(hash<V>(seed, V::add_i(cx, one), V::add_i(cy, one)), x2, y2));
+            return V::mul(n, V::set(SCALE2));
+        }
+
+        template <typename V>
+        typename V::f simplex3_lanes(typename V::f x, typename V::f y, typename V::f z,
+                                     typename V::i seed) {
+            using f = typename V::f;
+            using i = typename V::i;
+            const i one = V::seti(1);
+            const i ones = V::seti(~0u);
+
+            const f s = V::mul(V::add(V::add(x, y), z), V::set(F3));
+            const i cx = V::floor_i(V::add(x, s));
+            const i cy = V::floor_i(V::add(y, s));
+            const i cz = V::floor_i(V::add(z, s));
+            const f t = V::mul(V::to_f(V::add_i(V::add_i(cx, cy), cz)), V::set(G3));
+            const f x0 = V::sub(x, V::sub(V::to_f(cx), t));
+            const f y0 = V::sub(y, V::sub(V::to_f(cy), t));
+            const f z0 = V::sub(z, V::sub(V::to_f(cz), t));
+
+            // Rank the offsets to pick which of the six tetrahedra holds the point; branch-free
+            // form of the usual if/else ladder.
+            const i xy = V::ge(x0, y0);
+            const i yz = V::ge(y0, z0);
+            const i xz = V::ge(x0, z0);
+            const i i1 = V::and_i(V::and_i(xy, xz), one);
+            const i j1 = V::and_i(V::andnot_i(xy, yz), one);
+            const i k1 = V::andnot_i(V::or_i(xz, yz), one);
+            const i i2 = V::and_i(V::or_i(xy, xz), one);
+            const i j2 = V::and_i(V::or_i(V::xor_i(xy, ones), yz), one);
+            const i k2 = V::andnot_i(V::and_i(xz, yz), one);
+
+            const f x1 = V::add(V::sub(x0, V::to_f(i1)), V::set(G3));
+            const f y1 = V::add(V::sub(y0, V::to_f(j1)), V::set(G3));
+            const f z1 = V::add(V::sub(z0, V::to_f(k1)), V::set(G3));
+            const f x2 = V::add(V::sub(x0, V::to_f(i2)), V::set(2.0f * G3));
+            const f y2 = V::add(V::sub(y0, V::to_f(j2)), V::set(2.0f * G3));
+            const f z2 = V::add(V::sub(z0, V::to_f(k2)), V::set(2.0f * G3));
+            const f x3 = V::add(V::sub(x0, V::set(1.0f)), V::set(3.0f * G3));
+            const f y3 = V::add(V::sub(y0, V::set(1.0f)), V::set(3.0f * G3));
+            const f z3 = V::add(V::sub(z0, V::set(1.0f)), V::set(3.0f * G3));
+
+            f n = corner3<V>(hash<V>(seed, cx, cy, cz), x0, y0, z0);
+            n = V::add(n, corner3<V>(hash<V>(seed, V::add_i(cx, i1), V::add_i(cy, j1),
+                                             V::add_i(cz, k1)),
+                                     x1, y1, z1));
+            n = V::add(n, corner3<V>(hash<V>(seed, V::add_i(cx, i2), V::add_i(cy, j2),
+                                             V::add_i(cz, k2)),
+                                     x2, y2, z2));
+            n = V::add(n, corner3<V>(hash<V>(seed, V::add_i(cx, one), V::add_i(cy, one),
+                                             V::add_i(cz, one)),
+                                     x3, y3, z3));
+            return V::mul(n, V::set(SCALE3));
+        }
+
+        float fbm_normalization(const fbm_params& params) {
+            float sum = 0.0f;
+            float amplitude = 1.0f;
+            for (int octave = 0; octave < params.octaves; octave++) {
+                sum += amplitude;
+                amplitude *= params.gain;
+            }
+            return sum > 0.0f ? 1.0f / sum : 0.0f;
+        }
+
+        template <typename V>
+        typename V::f fbm2_lanes(typename V::f x, typename V::f y, const fbm_params& params,
+                                 float normalization) {
+            typename V::f total = V::set(0.0f);
+            float frequency = params.frequency;
+            float amplitude = 1.0f;
+            for (int octave = 0; octave < params.octaves; octave++) {
+                const typename V::i seed =
+                    V::seti(params.seed + static_cast<std::uint32_t>(octave) * OCTAVE_SEED_STEP);
+                const typename V::f n = simplex2_lanes<V>(V::mul(x, V::set(frequency)),
+                                                          V::mul(y, V::set(frequency)), seed);
+                total = V::add(total, V::mul(n, V::set(amplitude)));
+                frequency *= params.lacunarity;
+                amplitude *= params.gain;
+            }
+            return V::mul(total, V::set(normalization));
+        }
+
+        template <typename V>
+        typename V::f fbm3_lanes(typename V::f x, typename V::f y, typename V::f z,
+                                 const fbm_params& params, float normalization) {
+            typename V::f total = V::set(0.0f);
+            float frequency = params.frequency;
+            float amplitude = 1.0f;
+            for (int octave = 0; octave < params.octaves; octave++) {
+                const typename V::i seed =
+                    V::seti(params.seed + static_cast<std::uint32_t>(octave) * OCTAVE_SEED_STEP);
+                const typename V::f n =
+                    simplex3_lanes<V>(V::mul(x, V::set(frequency)), V::mul(y, V::set(frequency)),
+                                      V::mul(z, V::set(frequency)), seed);
+                total = V::add(total, V::mul(n, V::set(amplitude)));
+                frequency *= params.lacunarity;
+                amplitude *= params.gain;
+            }
+            return V::mul(total, V::set(normalization));
+        }
+
+        // Whole lanes straight from the arrays; the tail goes through a zero-padded copy.
+        template <typename V>
+        void fbm2_batch(const float* x, const float* y, float* out, std::size_t count,
+                        const fbm_params& params) {
+            constexpr std::size_t W = V::WIDTH;
+            const float normalization = fbm_normalization(params);
+            std::size_t n = 0;
+            for (; n + W <= count; n += W) {
+                V::store(out + n,
+                         fbm2_lanes<V>(V::load(x + n), V::load(y + n), params, normalization));
+            }
+
+            if (n < count) {
+                float tx[W] = {};
+                float ty[W] = {};
+                float to[W];
+                for (std::size_t k = 0; k < count - n; k++) {
+                    tx[k] = x[n + k];
+                    ty[k] = y[n + k];
+                }
+                V::store(to, fbm2_lanes<V>(V::load(tx), V::load(ty), params, normalization));
+                for (std::size_t k = 0; k < count - n; k++) {
+                    out[n + k] = to[k];
+                }
+            }
+        }
+
+        template <typename V>
+        void fbm3_batch(const float* x, const float* y, const float* z, float* out,
+                        std::size_t count, const fbm_params& params) {
+            constexpr std::size_t W = V::WIDTH;
+            const float normalization = fbm_normalization(params);
+            std::size_t n = 0;
+            for (; n + W <= count; n += W) {
+                V::store(out + n, fbm3_lanes<V>(V::load(x + n), V::load(y + n), V::load(z + n),
+                                                params, normalization));
+            }
+
+            if (n < count) {
+                float tx[W] = {};
+                float ty[W] = {};
+                float tz[W] = {};
+                float to[W];
+                for (std::size_t k = 0; k < count - n; k++) {
+                    tx[k] = x[n + k];
+                    ty[k] = y[n + k];
+                    tz[k] = z[n + k];
+                }
+                V::store(to, fbm3_lanes<V>(V::load(tx), V::load(ty), V::load(tz), params,
+                                           normalization));
+                for (std::size_t k = 0; k < count - n; k++) {
+                    out[n + k] = to[k];
+                }
+            }
+        }
+    }  // namespace
+}  // namespace qc
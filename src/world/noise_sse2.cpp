@@ -0,0 +1,115 @@
+#include "world/noise_kernel.hpp"
+
+#if defined(QC_X86)
+#include <emmintrin.h>
+#endif
+
+namespace qc {
+#if defined(QC_X86)
+    namespace {
+        struct sse2_lanes {
+            static constexpr int WIDTH = 4;
+            using f = __m128;
+            using i = __m128i;
+
+            static f load(const float* p) {
+                return _mm_loadu_ps(p);
+            }
+            static void store(float* p, f v) {
+                _mm_storeu_ps(p, v);
+            }
+            static f set(float v) {
+                return _mm_set1_ps(v);
+            }
+            static i seti(std::uint32_t v) {
+                return _mm_set1_epi32(static_cast<int>(v));
+            }
+
+            static f add(f a, f b) {
+                return _mm_add_ps(a, b);
+            }
+            static f sub(f a, f b) {
+                return _mm_sub_ps(a, b);
+            }
+            static f mul(f a, f b) {
+                return _mm_mul_ps(a, b);
+            }
+            static f max(f a, f b) {
+                return _mm_max_ps(a, b);
+            }
+
+            static i floor_i(f v) {
+                const i t = _mm_cvttps_epi32(v);
+                return _mm_add_epi32(t, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(t), v)));
+            }
+            static f to_f(i v) {
+                return _mm_cvtepi32_ps(v);
+            }
+
+            static i ge(f a, f b) {
+                return _mm_castps_si128(_mm_cmpge_ps(a, b));
+            }
+            static i gt(f a, f b) {
+                return _mm_castps_si128(_mm_cmpgt_ps(a, b));
+            }
+            static i lt_i(i a, i b) {
+                return _mm_cmplt_epi32(a, b);
+            }
+            static i eq_i(i a, i b) {
+                return _mm_cmpeq_epi32(a, b);
+            }
+
+            static i add_i(i a, i b) {
+                return _mm_add_epi32(a, b);
+            }
+            // SSE2 has no 32-bit multiply: multiply even and odd lanes into 64-bit products and
+            // gather the low halves back.
+            static i mul_i(i a, std::uint32_t b) {
+                const i factor = _mm_set1_epi32(static_cast<int>(b));
+                const i even = _mm_mul_epu32(a, factor);
+                const i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), factor);
+                return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+            }
+            static i and_i(i a, i b) {
+                return _mm_and_si128(a, b);
+            }
+            static i or_i(i a, i b) {
+                return _mm_or_si128(a, b);
+            }
+            static i xor_i(i a, i b) {
+                return _mm_xor_si128(a, b);
+            }
+            static i andnot_i(i a, i b) {
+                return _mm_andnot_si128(a, b);
+            }
+            template <int N>
+            static i shr(i a) {
+                return _mm_srli_epi32(a, N);
+            }
+            template <int N>
+            static i shl(i a) {
+                return _mm_slli_epi32(a, N);
+            }
+
+            static f select(i mask, f a, f b) {
+                const f m = _mm_castsi128_ps(mask);
+                return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+            }
+            static f xor_bits(f v, i bits) {
+                return _mm_xor_ps(v, _mm_castsi128_ps(bits));
+            }
+        };
+    }  // namespace
+
+    namespace detail {
+        const noise2_fn FBM2_SSE2 = &fbm2_batch<sse2_lanes>;
+        const noise3_fn FBM3_SSE2 = &fbm3_batch<sse2_lanes>;
+    }  // namespace detail
+#else
+    namespace detail {
+        const noise2_fn FBM2_SSE2 = nullptr;
+        const noise3_fn FBM3_SSE2 = nullptr;
+    }  // namespace detail
+#endif
+}  // namespace qc
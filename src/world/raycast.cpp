@@ -0,0 +1,139 @@
+#include "world/raycast.hpp"
+
+#include <glm/glm.hpp>
+
+#include <limits>
+
+namespace qc {
+    namespace {
+        constexpr float NEVER = std::numeric_limits<float>::infinity();
+
+        // The ray_mask bits of a block.
+        constexpr std::uint8_t ray_flags(block_id block) {
+            return static_cast<std::uint8_t>((block_solid(block) ? RAY_SOLID : 0) |
+                                             (block_properties(block).opaque ? RAY_OPAQUE : 0));
+        }
+
+        // The DDA state. Crossing distances are worked out from the integer voxel each time
+        // rather than accumulated, so skipping a chunk in one step lands exactly where walking
+        // it voxel by voxel would have.
+        struct ray {
+            glm::vec3 origin;
+            glm::vec3 inverse;
+            glm::ivec3 step;
+
+            // Distance to the plane a step along `axis` from voxel coordinate `v` crosses.
+            float crossing(int axis, int v) const {
+                if (step[axis] == 0) {
+                    return NEVER;
+                }
+                const int plane = step[axis] > 0 ? v + 1 : v;
+                return (static_cast<float>(plane) - origin[axis]) * inverse[axis];
+            }
+
+            // The face of the next voxel along `axis` that the ray enters through.
+            face entered(int axis) const {
+                return static_cast<face>(2 * axis + (step[axis] > 0 ? 1 : 0));
+            }
+        };
+
+        // The axis whose plane the ray crosses first, ties going to z, then y.
+        int next_axis(const glm::vec3& t) {
+            if (t.x < t.y) {
+                return t.x < t.z ? 0 : 2;
+            }
+            return t.y < t.z ? 1 : 2;
+        }
+    }  // namespace
+
+    bool raycast(const world& w, const glm::vec3& origin, const glm::vec3& direction,
+                 float max_distance, std::uint8_t mask, ray_hit& hit) {
+        const float length = glm::length(direction);
+        if (!(length > 0.0f)) {
+            return false;
+        }
+        const glm::vec3 dir = direction / length;
+        const std::uint8_t* flags = block_flag_table<ray_flags>();
+
+        ray r;
+        r.origin = origin;
+        glm::ivec3 voxel(glm::floor(origin));
+        glm::vec3 next(NEVER);
+        for (int a = 0; a < 3; a++) {
+            r.step[a] = dir[a] > 0.0f ? 1 : dir[a] < 0.0f ? -1 : 0;
+            r.inverse[a] = r.step[a] != 0 ? 1.0f / dir[a] : 0.0f;
+            next[a] = r.crossing(a, voxel[a]);
+        }
+
+        float t = 0.0f;
+        face entered = FACE_COUNT;
+        while (true) {
+            const glm::ivec3 pos = chunk_of(voxel);
+            const chunk* c = w.find(pos);
+
+            if (c == nullptr || c->is_uniform()) {
+                const block_id block = c != nullptr ? c->uniform_block() : block_id{BLOCK_AIR};
+                if ((flags[block] & mask) != 0) {
+                    hit = {voxel, block, entered, t};
+                    return true;
+                }
+
+                // Nothing to stop at in here: jump to the first voxel past the chunk. The axis
+                // leaving it is the one the voxel walk would have stepped along last, and every
+                // other axis has taken the steps whose planes come before that one.
+                glm::vec3 exit;
+                for (int a = 0; a < 3; a++) {
+                    const int last =
+                        (pos[a] << CHUNK_SIZE_LOG2) + (r.step[a] > 0 ? CHUNK_SIZE - 1 : 0);
+                    exit[a] = r.crossing(a, last);
+                }
+                const int axis = next_axis(exit);
+                t = exit[axis];
+                if (t > max_distance) {
+                    return false;
+                }
+                for (int a = 0; a < 3; a++) {
+                    if (a == axis) {
+                        continue;
+                    }
+                    while (next[a] < t || (next[a] == t && a > axis)) {
+                        voxel[a] += r.step[a];
+                        next[a] = r.crossing(a, voxel[a]);
+                    }
+                }
+                voxel[axis] = (pos[axis] << CHUNK_SIZE_LOG2) +
+                              (r.step[axis] > 0 ? CHUNK_SIZE : -1);
+                next[axis] = r.crossing(axis, voxel[axis]);
+                entered = r.entered(axis);
+                continue;
+            }
+
+            // Voxel by voxel until the ray stops or leaves the chunk.
+            glm::ivec3 local = local_of(voxel);
+            while (true) {
+                const block_id block = c->get(local.x, local.y, local.z);
+                if ((flags[block] & mask) != 0) {
+                    hit = {voxel, block, entered, t};
+                    return true;
+                }
+                const int axis = next_axis(next);
+                t = next[axis];
+                if (t > max_distance) {
+                    return false;
+                }
+                voxel[axis] += r.step[axis];
+                next[axis] = r.crossing(axis, voxel[axis]);
+                entered = r.entered(axis);
+                local[axis] += r.step[axis];
+                if (static_cast<unsigned>(local[axis]) >= static_cast<unsigned>(CHUNK_SIZE)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    bool line_of_sight(const world& w, const glm::vec3& from, const glm::vec3& to) {
+        ray_hit hit;
+        return !raycast(w, from, to - from, glm::length(to - from), RAY_OPAQUE, hit);
+    }
+}  // namespace qc
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+
+#include "world/block.hpp"
+#include "world/face.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // What a ray stops at; the values may be combined.
+    enum ray_mask : std::uint8_t {
+        // Blocks the player can point at, see block_solid().
+        RAY_SOLID = 1,
+        // Blocks that hide what is behind them, for line of sight.
+        RAY_OPAQUE = 2,
+    };
+
+    struct ray_hit {
+        glm::ivec3 voxel{0};
+        block_id block = BLOCK_AIR;
+        // The face of `voxel` the ray came in through, FACE_COUNT if the ray started inside it.
+        // The voxel the ray came from is `voxel` plus that face's offset.
+        face entered = FACE_COUNT;
+        // Along the ray from its origin, in blocks.
+        float distance = 0.0f;
+    };
+
+    // Walks the voxels along the ray with the Amanatides-Woo DDA and stops at the first block
+    // matching `mask` within `max_distance` blocks, which must be finite. Returns false if there
+    // is none, or if `direction` is zero.
+    //
+    // The chunk under the ray is looked up once on entering it rather than once per voxel, and
+    // unloaded chunks and chunks of a single block the ray passes through are crossed in one
+    // step. Unloaded chunks read as air.
+    bool raycast(const world& w, const glm::vec3& origin, const glm::vec3& direction,
+                 float max_distance, std::uint8_t mask, ray_hit& hit);
+
+    // Whether no opaque block lies between `from` and `to`.
+    bool line_of_sight(const world& w, const glm::vec3& from, const glm::vec3& to);
+}  // namespace qc
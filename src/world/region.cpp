@@ -0,0 +1,299 @@
+#include "world/region.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "core/log.hpp"
+#include "core/profile.hpp"
+
+namespace qc {
+    namespace {
+        std::size_t sector_offset(std::uint32_t location) {
+            return location >> 8;
+        }
+
+        std::size_t sector_count(std::uint32_t location) {
+            return location & 0xFF;
+        }
+
+        template <typename T>
+        void append(std::vector<std::uint8_t>& out, T value) {
+            const std::size_t at = out.size();
+            out.resize(at + sizeof(T));
+            std::memcpy(out.data() + at, &value, sizeof(T));
+        }
+    }  // namespace
+
+    std::unique_ptr<region_file> region_file::open(const std::string& path) {
+        std::unique_ptr<region_file> region(new region_file);
+        region->m_file = mapped_file::open(path);
+        if (!region->m_file) {
+            return nullptr;
+        }
+
+        if (region->m_file->size() == 0) {
+            std::vector<std::uint8_t> header(HEADER_SECTORS * SECTOR_SIZE, 0);
+            std::memcpy(header.data(), &MAGIC, sizeof(MAGIC));
+            std::memcpy(header.data() + sizeof(MAGIC), &VERSION, sizeof(VERSION));
+            if (!region->m_file->write(0, header.data(), header.size())) {
+                subsystem_logger(LOG_WORLD).error("cannot initialize region {}", path);
+                return nullptr;
+            }
+        }
+
+        // Anything else is refused rather than read as empty, which would let saves overwrite it.
+        std::uint32_t magic = 0;
+        std::uint32_t version = 0;
+        if (region->m_file->size() >= HEADER_SECTORS * SECTOR_SIZE) {
+            std::memcpy(&magic, region->m_file->data(), sizeof(magic));
+            std::memcpy(&version, region->m_file->data() + sizeof(magic), sizeof(version));
+        }
+        if (magic != MAGIC) {
+            subsystem_logger(LOG_WORLD).error("{} is not a region file", path);
+            return nullptr;
+        }
+        if (version != VERSION) {
+            subsystem_logger(LOG_WORLD)
+                .error("region {} has version {}, expected {}", path, version, VERSION);
+            return nullptr;
+        }
+
+        const std::size_t sectors = region->m_file->size() / SECTOR_SIZE;
+        region->m_used.assign(sectors, false);
+        for (std::size_t s = 0; s < HEADER_SECTORS; s++) {
+            region->m_used[s] = true;
+        }
+        std::memcpy(region->m_locations, region->m_file->data() + HEADER_SIZE,
+                    sizeof(region->m_locations));
+        for (std::uint32_t& location : region->m_locations) {
+            const std::size_t first = sector_offset(location);
+            const std::size_t count = sector_count(location);
+            if (location == 0) {
+                continue;
+            }
+            // A column sharing sectors with an earlier one would have them freed, and reused, as
+            // soon as either is rewritten.
+            bool valid = first >= HEADER_SECTORS && count != 0 && first + count <= sectors;
+            for (std::size_t s = first; valid && s < first + count; s++) {
+                valid = !region->m_used[s];
+            }
+            if (!valid) {
+                subsystem_logger(LOG_WORLD)
+                    .warn("dropping column with bad sectors in region file {}", path);
+                location = 0;
+                continue;
+            }
+            for (std::size_t s = first; s < first + count; s++) {
+                region->m_used[s] = true;
+            }
+        }
+        return region;
+    }
+
+    const std::uint8_t* region_file::read(int x, int z, std::size_t& size) const {
+        const std::uint32_t location = m_locations[z * SIZE + x];
+        if (location == 0) {
+            return nullptr;
+        }
+
+        const std::uint8_t* column = m_file->data() + sector_offset(location) * SECTOR_SIZE;
+        std::uint32_t length;
+        std::memcpy(&length, column, sizeof(length));
+        if (length > sector_count(location) * SECTOR_SIZE - sizeof(length)) {
+            return nullptr;
+        }
+        size = length;
+        return column + sizeof(length);
+    }
+
+    bool region_file::write(int x, int z, const std::uint8_t* data, std::size_t size) {
+        const std::size_t needed = (sizeof(std::uint32_t) + size + SECTOR_SIZE - 1) / SECTOR_SIZE;
+        if (needed > MAX_SECTORS) {
+            subsystem_logger(LOG_WORLD)
+                .error("column {}, {} is too large for a region file ({} bytes)", x, z, size);
+            return false;
+        }
+
+        // First fit, around the old sectors, which stay in use until the table points away from
+        // them: a write cut short leaves the old column readable. Without a large enough gap,
+        // `first` ends up at the start of the free tail (or the end of the file) and the write
+        // extends the file.
+        std::size_t first = HEADER_SECTORS;
+        std::size_t run = 0;
+        for (std::size_t s = HEADER_SECTORS; s < m_used.size() && run < needed; s++) {
+            if (m_used[s]) {
+                first = s + 1;
+                run = 0;
+            } else {
+                run++;
+            }
+        }
+
+        std::vector<std::uint8_t> sectors(needed * SECTOR_SIZE, 0);
+        const std::uint32_t length = static_cast<std::uint32_t>(size);
+        std::memcpy(sectors.data(), &length, sizeof(length));
+        std::memcpy(sectors.data() + sizeof(length), data, size);
+        if (!m_file->write(first * SECTOR_SIZE, sectors.data(), sectors.size())) {
+            return false;
+        }
+
+        // Taken before the table is written: if that fails the table may point at either run.
+        if (m_used.size() < first + needed) {
+            m_used.resize(first + needed, false);
+        }
+        for (std::size_t s = first; s < first + needed; s++) {
+            m_used[s] = true;
+        }
+
+        const std::uint32_t updated = static_cast<std::uint32_t>(first << 8 | needed);
+        if (!m_file->write(HEADER_SIZE +
+                               static_cast<std::uint64_t>(z * SIZE + x) * sizeof(std::uint32_t),
+                           &updated, sizeof(updated))) {
+            return false;
+        }
+
+        std::uint32_t& location = m_locations[z * SIZE + x];
+        for (std::size_t s = sector_offset(location);
+             s < sector_offset(location) + sector_count(location); s++) {
+            m_used[s] = false;
+        }
+        location = updated;
+        return true;
+    }
+
+    region_store::region_store(std::string directory) : m_directory(std::move(directory)) {
+    }
+
+    bool region_store::save(const world& w) {
+        // Group chunks into columns, ordered so each region file is written in one sweep.
+        std::map<std::pair<int, int>, std::pair<std::vector<const chunk*>, std::vector<int>>>
+            columns;
+        w.for_each([&](const glm::ivec3& pos, const chunk& c) {
+            auto& column = columns[{pos.x, pos.z}];
+            column.first.push_back(&c);
+            column.second.push_back(pos.y);
+        });
+
+        bool ok = true;
+        for (const auto& entry : columns) {
+            ok &= save_column(entry.first.first, entry.first.second, entry.second.first,
+                              entry.second.second);
+        }
+        return ok;
+    }
+
+    bool region_store::save_column(int chunk_x, int chunk_z,
+                                   const std::vector<const chunk*>& chunks,
+                                   const std::vector<int>& ys) {
+        QC_PROFILE_ZONE("region.save_column");
+        region_file* r = region(chunk_x >> region_file::SIZE_LOG2,
+                                chunk_z >> region_file::SIZE_LOG2, true);
+        if (r == nullptr) {
+            return false;
+        }
+
+        m_buffer.clear();
+        append(m_buffer, static_cast<std::uint16_t>(chunks.size()));
+        for (std::size_t i = 0; i < chunks.size(); i++) {
+            append(m_buffer, static_cast<std::int32_t>(ys[i]));
+            const std::size_t size_at = m_buffer.size();
+            append(m_buffer, std::uint32_t{0});
+            chunks[i]->encode(m_buffer);
+            const std::uint32_t size =
+                static_cast<std::uint32_t>(m_buffer.size() - size_at - sizeof(std::uint32_t));
+            std::memcpy(m_buffer.data() + size_at, &size, sizeof(size));
+        }
+
+        return r->write(chunk_x & (region_file::SIZE - 1), chunk_z & (region_file::SIZE - 1),
+                        m_buffer.data(), m_buffer.size());
+    }
+
+    int region_store::load_column(world& w, int chunk_x, int chunk_z) {
+        QC_PROFILE_ZONE("region.load_column");
+        const int region_x = chunk_x >> region_file::SIZE_LOG2;
+        const int region_z = chunk_z >> region_file::SIZE_LOG2;
+        region_file* r = region(region_x, region_z, false);
+        if (r == nullptr) {
+            std::error_code error;
+            return std::filesystem::exists(region_path(region_x, region_z), error) ? -1 : 0;
+        }
+
+        std::size_t size = 0;
+        const std::uint8_t* data =
+            r->read(chunk_x & (region_file::SIZE - 1), chunk_z & (region_file::SIZE - 1), size);
+        if (data == nullptr) {
+            return 0;
+        }
+
+        std::uint16_t count;
+        std::size_t at = sizeof(count);
+        if (size < at) {
+            return -1;
+        }
+        std::memcpy(&count, data, sizeof(count));
+
+        // Chunks decode straight out of the mapping; nothing is copied into a read buffer. They
+        // only go into `w` once the whole column has decoded.
+        std::vector<std::pair<int, std::unique_ptr<chunk>>> chunks;
+        chunks.reserve(count);
+        for (int i = 0; i < count; i++) {
+            std::int32_t y;
+            std::uint32_t length;
+            if (size - at < sizeof(y) + sizeof(length)) {
+                return -1;
+            }
+            std::memcpy(&y, data + at, sizeof(y));
+            std::memcpy(&length, data + at + sizeof(y), sizeof(length));
+            at += sizeof(y) + sizeof(length);
+            auto c = std::make_unique<chunk>();
+            if (size - at < length || !c->decode(data + at, length)) {
+                subsystem_logger(LOG_WORLD)
+                    .error("corrupt chunk in column {}, {}", chunk_x, chunk_z);
+                return -1;
+            }
+            chunks.emplace_back(y, std::move(c));
+            at += length;
+        }
+
+        for (auto& entry : chunks) {
+            w.insert(glm::ivec3(chunk_x, entry.first, chunk_z), std::move(entry.second));
+        }
+        return count;
+    }
+
+    std::size_t region_store::disk_usage() const {
+        std::size_t bytes = 0;
+        for (const auto& entry : m_regions) {
+            bytes += entry.second->file_size();
+        }
+        return bytes;
+    }
+
+    std::string region_store::region_path(int region_x, int region_z) const {
+        return m_directory + "/r." + std::to_string(region_x) + "." + std::to_string(region_z) +
+               ".qcr";
+    }
+
+    region_file* region_store::region(int region_x, int region_z, bool create) {
+        const glm::ivec3 key(region_x, 0, region_z);
+        const auto it = m_regions.find(key);
+        if (it != m_regions.end()) {
+            return it->second.get();
+        }
+
+        const std::string path = region_path(region_x, region_z);
+        std::error_code error;
+        if (!create && !std::filesystem::exists(path, error)) {
+            return nullptr;
+        }
+        std::filesystem::create_directories(m_directory, error);
+        std::unique_ptr<region_file> r = region_file::open(path);
+        if (!r) {
+            return nullptr;
+        }
+        return (m_regions[key] = std::move(r)).get();
+    }
+}  // namespace qc
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/mapped_file.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // One file holding a 32x32 area of chunk columns, read through a memory mapping.
+    //
+    // The file opens with MAGIC and VERSION as little-endian words, then a table of 1024 words,
+    // one per column at index z * 32 + x: the column's first sector << 8 | its sector count, or
+    // zero if absent. Together they fill the first two 4 KiB sectors. A column is a 32-bit byte
+    // length followed by its payload, padded to whole sectors. Rewritten columns go to the first
+    // run of free sectors large enough for them, and the sectors they held are only freed once
+    // the table points at the new ones.
+    class region_file {
+    public:
+        static constexpr int SIZE_LOG2 = 5;
+        static constexpr int SIZE = 1 << SIZE_LOG2;
+        static constexpr int COLUMNS = SIZE * SIZE;
+        static constexpr std::size_t SECTOR_SIZE = 4096;
+        static constexpr std::size_t MAX_SECTORS = 255;
+        static constexpr std::uint32_t MAGIC = 0x47524351;  // "QCRG"
+        static constexpr std::uint32_t VERSION = 1;
+        static constexpr std::size_t HEADER_SIZE = 2 * sizeof(std::uint32_t);
+        static constexpr std::size_t HEADER_SECTORS = 2;
+
+        // Opens or creates the region at `path`. Returns null on failure, including when the
+        // file exists but lacks the magic or has another version.
+        static std::unique_ptr<region_file> open(const std::string& path);
+
+        // Payload of column (x, z) inside the mapping, or null if none is stored. Valid until
+        // the next write().
+        const std::uint8_t* read(int x, int z, std::size_t& size) const;
+
+        bool write(int x, int z, const std::uint8_t* data, std::size_t size);
+
+        std::size_t file_size() const {
+            return m_file->size();
+        }
+
+    private:
+        region_file() = default;
+
+        std::unique_ptr<mapped_file> m_file;
+        std::uint32_t m_locations[COLUMNS] = {};
+        // One flag per sector, true when in use; the first HEADER_SECTORS hold the table.
+        std::vector<bool> m_used;
+    };
+
+    // Saves and loads a world as a directory of region files named r.<x>.<z>.qcr. A column is
+    // stored as a 16-bit chunk count followed by, per chunk, its 32-bit y, the 32-bit size of its
+    // encoding and the chunk::encode() bytes. Not synchronized.
+    class region_store {
+    public:
+        explicit region_store(std::string directory);
+
+        // Writes every chunk of `w`. Returns false if any column failed to save.
+        bool save(const world& w);
+
+        // Writes the given chunks as column (chunk_x, chunk_z), replacing what was stored.
+        bool save_column(int chunk_x, int chunk_z, const std::vector<const chunk*>& chunks,
+                         const std::vector<int>& ys);
+
+        // Decodes column (chunk_x, chunk_z) into `w`. Returns the number of chunks loaded, zero
+        // if the column was never saved, or -1 if it or its region file is corrupt. A corrupt
+        // column adds nothing to `w`, so saving `w` afterwards leaves the stored one alone.
+        int load_column(world& w, int chunk_x, int chunk_z);
+
+        // Disk bytes used by the region files opened so far.
+        std::size_t disk_usage() const;
+
+    private:
+        std::string region_path(int region_x, int region_z) const;
+
+        // Opens region files lazily; missing ones are only created when `create` is set.
+        region_file* region(int region_x, int region_z, bool create);
+
+        std::string m_directory;
+        std::unordered_map<glm::ivec3, std::unique_ptr<region_file>, chunk_pos_hash> m_regions;
+        std::vector<std::uint8_t> m_buffer;
+    };
+}  // namespace qc
@@ -0,0 +1,337 @@
+#include "world/streamer.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <memory_resource>
+#include <utility>
+
+#include "core/arena.hpp"
+#include "core/profile.hpp"
+#include "render/occlusion.hpp"
+
+namespace qc {
+    namespace {
+        // The chunk at neighbor_index() `i` from `pos`.
+        glm::ivec3 neighbor_of(const glm::ivec3& pos, int i) {
+            return pos + glm::ivec3(i % 3 - 1, i / 9 - 1, i / 3 % 3 - 1);
+        }
+
+        constexpr int CENTER = neighbor_index(0, 0, 0);
+
+        template <typename T>
+        bool more_urgent(const T* a, const T* b) {
+            return a->score < b->score;
+        }
+    }  // namespace
+
+    chunk_streamer::chunk_streamer(world& w, chunk_renderer& renderer, job_system& jobs,
+                                   std::uint32_t seed, const streaming_settings& settings)
+        : m_world(w), m_renderer(renderer), m_jobs(jobs), m_settings(settings),
+          m_max_jobs(settings.max_jobs > 0 ? settings.max_jobs
+                                           : 16 * static_cast<int>(jobs.thread_count())) {
+        for (unsigned i = 0; i < jobs.thread_count(); i++) {
+            m_generators.push_back(std::make_unique<terrain_generator>(seed));
+            m_meshers.push_back(std::make_unique<mesher>());
+        }
+    }
+
+    chunk_streamer::~chunk_streamer() {
+        m_jobs.wait_idle();
+    }
+
+    void chunk_streamer::update(const glm::vec3& eye, const glm::vec3& forward) {
+        QC_PROFILE_ZONE("stream.update");
+        m_eye = eye;
+        const glm::vec3 view = glm::length(forward) > 0.0f ? glm::normalize(forward) : m_forward;
+        const glm::ivec3 center = chunk_of(glm::ivec3(glm::floor(eye)));
+
+        drain();
+        // Scores only need refreshing once the camera has crossed into another chunk or turned
+        // noticeably; in between, the order is still good enough.
+        if (!m_started || center != m_center || glm::dot(view, m_forward) < 0.95f) {
+            m_started = true;
+            m_center = center;
+            m_forward = view;
+            retarget();
+        }
+        submit_meshes();
+        submit_generation();
+        upload();
+    }
+
+    chunk_state chunk_streamer::state(const glm::ivec3& pos) const {
+        const entry* e = find(pos);
+        return e == nullptr ? CHUNK_EVICTED : e->state;
+    }
+
+    const std::vector<aabb>& chunk_streamer::occluders(const glm::ivec3& pos) const {
+        static const std::vector<aabb> none;
+        const entry* e = find(pos);
+        return e == nullptr ? none : e->occluders;
+    }
+
+    std::size_t chunk_streamer::count(chunk_state s) const {
+        std::size_t n = 0;
+        for (const auto& it : m_entries) {
+            n += it.second->state == s ? 1 : 0;
+        }
+        return n;
+    }
+
+    bool chunk_streamer::complete() const {
+        if (!m_started || m_in_flight > 0 || !m_queue.empty() || !m_meshing.empty() ||
+            !m_uploads.empty()) {
+            return false;
+        }
+        for (const auto& it : m_entries) {
+            if (in_range(it.first, m_settings.radius) && it.second->state != CHUNK_RESIDENT) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool chunk_streamer::in_range(const glm::ivec3& pos, int radius) const {
+        const int dx = pos.x - m_center.x;
+        const int dz = pos.z - m_center.z;
+        return dx * dx + dz * dz <= radius * radius && pos.y >= 0 && pos.y < m_settings.layers;
+    }
+
+    float chunk_streamer::score(const glm::ivec3& pos) const {
+        const glm::vec3 middle =
+            (glm::vec3(pos) + glm::vec3(0.5f)) * static_cast<float>(CHUNK_SIZE);
+        const glm::vec3 offset = (middle - m_eye) / static_cast<float>(CHUNK_SIZE);
+        const float distance = glm::length(offset);
+        if (distance < 1e-3f) {
+            return 0.0f;
+        }
+        // From `view_weight` ahead down to none behind.
+        const float facing = 0.5f * (glm::dot(offset, m_forward) / distance + 1.0f);
+        return distance + m_settings.view_weight * (1.0f - facing);
+    }
+
+    job_priority chunk_streamer::priority(const entry& e) const {
+        const int level = static_cast<int>(e.score * PRIORITY_COUNT /
+                                           (m_settings.radius + m_settings.view_weight + 1.0f));
+        return static_cast<job_priority>(std::clamp(level, 0, PRIORITY_COUNT - 1));
+    }
+
+    chunk_streamer::entry* chunk_streamer::find(const glm::ivec3& pos) const {
+        const auto it = m_entries.find(pos);
+        return it == m_entries.end() ? nullptr : it->second.get();
+    }
+
+    void chunk_streamer::drain() {
+        {
+            std::lock_guard<std::mutex> lock(m_finished_mutex);
+            m_drained.swap(m_finished);
+        }
+        for (entry* e : m_drained) {
+            e->busy = false;
+            m_in_flight--;
+            if (e->state == CHUNK_GENERATING) {
+                if (!in_range(e->pos, m_settings.radius + 1)) {
+                    // Went out of range while generating; it never reached the world.
+                    m_evicted++;
+                    m_entries.erase(e->pos);
+                    continue;
+                }
+                m_world.insert(e->pos, std::move(e->blocks));
+                e->state = CHUNK_MESHING;
+                m_meshing.push_back(e);
+                mark_neighbors_stale(*e);
+            } else {
+                if (e->stale) {
+                    m_meshing.push_back(e);
+                } else {
+                    e->state = CHUNK_UPLOADING;
+                    m_uploads.push_back(e);
+                }
+            }
+        }
+        m_drained.clear();
+    }
+
+    void chunk_streamer::retarget() {
+        QC_PROFILE_ZONE("stream.retarget");
+        // Unload what fell out of range, unless a job still holds it.
+        bool evicting = false;
+        for (const auto& it : m_entries) {
+            entry& e = *it.second;
+            const bool out = !in_range(e.pos, m_settings.radius + 1) ||
+                             (e.state == CHUNK_REQUESTED && !in_range(e.pos, m_settings.radius));
+            if (out && !e.busy) {
+                e.evict = true;
+                evicting = true;
+            }
+        }
+        if (evicting) {
+            const auto evicted = [](const entry* e) { return e->evict; };
+            for (std::vector<entry*>* list : {&m_queue, &m_meshing, &m_uploads}) {
+                list->erase(std::remove_if(list->begin(), list->end(), evicted), list->end());
+            }
+            for (auto it = m_entries.begin(); it != m_entries.end();) {
+                const entry& e = *it->second;
+                if (!e.evict) {
+                    ++it;
+                    continue;
+                }
+                if (e.uploaded) {
+                    m_renderer.remove(e.pos);
+                }
+                m_occluder_bounds.erase(e.pos);
+                if (e.state != CHUNK_REQUESTED) {
+                    m_world.erase(e.pos);
+                    m_evicted++;
+                }
+                it = m_entries.erase(it);
+            }
+        }
+
+        // Request what came into range.
+        const int r = m_settings.radius;
+        for (int z = m_center.z - r; z <= m_center.z + r; z++) {
+            for (int x = m_center.x - r; x <= m_center.x + r; x++) {
+                for (int y = 0; y < m_settings.layers; y++) {
+                    const glm::ivec3 pos(x, y, z);
+                    if (!in_range(pos, r) || m_entries.count(pos) != 0) {
+                        continue;
+                    }
+                    std::unique_ptr<entry>& e = m_entries[pos];
+                    e = std::make_unique<entry>();
+                    e->pos = pos;
+                    m_queue.push_back(e.get());
+                }
+            }
+        }
+
+        for (const auto& it : m_entries) {
+            it.second->score = score(it.first);
+        }
+        std::make_heap(m_queue.begin(), m_queue.end(),
+                       [](const entry* a, const entry* b) { return more_urgent(b, a); });
+    }
+
+    void chunk_streamer::mark_neighbors_stale(const entry& e) {
+        for (int i = 0; i < NEIGHBOR_COUNT; i++) {
+            if (i == CENTER) {
+                continue;
+            }
+            entry* n = find(neighbor_of(e.pos, i));
+            // Mirroring the offset mirrors the index.
+            const int back = NEIGHBOR_COUNT - 1 - i;
+            if (n == nullptr || n->state < CHUNK_MESHING || (n->meshed_with >> back & 1) != 0) {
+                continue;
+            }
+            if (n->busy) {
+                // Its mesh job is running without this chunk; run it again once it finishes.
+                n->stale = true;
+            } else if (n->state == CHUNK_UPLOADING || n->state == CHUNK_RESIDENT) {
+                if (n->state == CHUNK_UPLOADING) {
+                    m_uploads.erase(std::find(m_uploads.begin(), m_uploads.end(), n));
+                }
+                n->state = CHUNK_MESHING;
+                m_meshing.push_back(n);
+            }
+        }
+    }
+
+    bool chunk_streamer::ready_to_mesh(const entry& e) const {
+        for (int i = 0; i < NEIGHBOR_COUNT; i++) {
+            const glm::ivec3 pos = neighbor_of(e.pos, i);
+            if (i != CENTER && in_range(pos, m_settings.radius) && !m_world.contains(pos)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void chunk_streamer::submit_meshes() {
+        std::sort(m_meshing.begin(), m_meshing.end(), more_urgent<entry>);
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < m_meshing.size(); i++) {
+            entry* e = m_meshing[i];
+            if (m_in_flight >= m_max_jobs || !ready_to_mesh(*e)) {
+                m_meshing[kept++] = e;
+                continue;
+            }
+
+            // Meshes are baked with ambient occlusion only, so the snapshot leaves light out.
+            chunk_snapshot snapshot = m_world.snapshot(e->pos, false);
+            e->meshed_with = 0;
+            for (int i = 0; i < NEIGHBOR_COUNT; i++) {
+                if (snapshot.blocks[i] != nullptr) {
+                    e->meshed_with |= std::uint32_t(1) << i;
+                }
+            }
+            e->stale = false;
+            e->busy = true;
+            m_in_flight++;
+            m_jobs.submit(
+                [this, e, snapshot = std::move(snapshot)] {
+                    // Grown on the worker's arena, then kept at its final size until upload.
+                    std::pmr::vector<packed_quad> quads(&thread_arena());
+                    m_meshers[m_jobs.current_worker()]->build(snapshot.neighborhood(), quads);
+                    e->mesh.assign(quads.begin(), quads.end());
+                    e->found_occluders.clear();
+                    find_occluders(*snapshot.blocks[CENTER], e->pos, e->found_occluders);
+                    finish(e);
+                },
+                priority(*e));
+        }
+        m_meshing.resize(kept);
+    }
+
+    void chunk_streamer::submit_generation() {
+        const auto later = [](const entry* a, const entry* b) { return more_urgent(b, a); };
+        while (m_in_flight < m_max_jobs && !m_queue.empty()) {
+            std::pop_heap(m_queue.begin(), m_queue.end(), later);
+            entry* e = m_queue.back();
+            m_queue.pop_back();
+
+            e->state = CHUNK_GENERATING;
+            e->blocks = std::make_unique<chunk>();
+            e->busy = true;
+            m_in_flight++;
+            m_jobs.submit(
+                [this, e] {
+                    m_generators[m_jobs.current_worker()]->generate(*e->blocks, e->pos);
+                    finish(e);
+                },
+                priority(*e));
+        }
+    }
+
+    void chunk_streamer::upload() {
+        QC_PROFILE_ZONE("stream.upload");
+        std::sort(m_uploads.begin(), m_uploads.end(), more_urgent<entry>);
+        std::size_t bytes = 0;
+        std::size_t done = 0;
+        for (; done < m_uploads.size(); done++) {
+            entry* e = m_uploads[done];
+            const std::size_t size = e->mesh.size() * sizeof(packed_quad);
+            if (bytes > 0 && bytes + size > m_settings.upload_budget) {
+                break;
+            }
+            bytes += size;
+            m_renderer.upload(e->pos, e->mesh);
+            e->uploaded = !e->mesh.empty();
+            e->state = CHUNK_RESIDENT;
+            std::vector<packed_quad>().swap(e->mesh);
+            e->occluders.swap(e->found_occluders);
+            if (e->occluders.empty()) {
+                m_occluder_bounds.erase(e->pos);
+            } else {
+                m_occluder_bounds.insert(e->pos, chunk_bounds(e->pos));
+            }
+        }
+        m_uploads.erase(m_uploads.begin(), m_uploads.begin() + done);
+        m_upload_bytes = bytes;
+    }
+
+    void chunk_streamer::finish(entry* e) {
+        std::lock_guard<std::mutex> lock(m_finished_mutex);
+        m_finished.push_back(e);
+    }
+}  // namespace qc
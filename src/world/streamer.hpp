@@ -0,0 +1,176 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/job_system.hpp"
+#include "mesh/mesher.hpp"
+#include "render/chunk_renderer.hpp"
+#include "render/frustum.hpp"
+#include "world/terrain.hpp"
+#include "world/world.hpp"
+
+namespace qc {
+    // Where a chunk is on its way from being wanted to being drawn.
+    enum chunk_state : std::uint8_t {
+        // Waiting in the priority queue.
+        CHUNK_REQUESTED = 0,
+        // A terrain job is filling it off to the side of the world.
+        CHUNK_GENERATING,
+        // In the world, waiting for its neighbours to load, or being meshed by a job. Resident
+        // chunks whose neighbours arrived after they were meshed come back here and stay drawn
+        // meanwhile.
+        CHUNK_MESHING,
+        // Meshed, waiting for room in a frame's upload budget.
+        CHUNK_UPLOADING,
+        CHUNK_RESIDENT,
+        // Not tracked: never requested, or unloaded again.
+        CHUNK_EVICTED,
+        CHUNK_STATE_COUNT,
+    };
+
+    struct streaming_settings {
+        // Columns within `radius` chunks of the camera are loaded, `layers` chunks high from
+        // y = 0. Chunks are unloaded one chunk further out, so walking along a border does not
+        // load and unload the same column over and over.
+        int radius = 8;
+        int layers = 3;
+        // Mesh bytes uploaded per frame. One mesh larger than this still goes through alone.
+        std::size_t upload_budget = 512 * 1024;
+        // Generation and mesh jobs in flight; 0 means 16 per worker, about a frame's work.
+        // Keeping no more in flight lets a turning camera reorder the rest.
+        int max_jobs = 0;
+        // A chunk straight ahead is served as if it were this many chunks closer than one
+        // straight behind.
+        float view_weight = 4.0f;
+    };
+
+    // Loads the chunks around a camera, meshes them and uploads the meshes, without stalling
+    // the frame. update() is called once per frame and never waits: it drains finished jobs,
+    // hands the most urgent work to the job system and uploads meshes up to the byte budget.
+    // Work is ordered by distance from the camera, weighted towards where it looks.
+    //
+    // Chunks are generated outside the world and only inserted once complete, and mesh jobs
+    // read snapshots of the world, so jobs never race the main thread and chunks may be edited
+    // or unloaded while they run. A chunk is meshed once its face, edge and corner neighbours
+    // in range are loaded; one meshed before a neighbour arrived, because the camera moved, is
+    // meshed again. Meshes carry ambient occlusion but no light, so chunks are not lit.
+    class chunk_streamer {
+    public:
+        chunk_streamer(world& w, chunk_renderer& renderer, job_system& jobs, std::uint32_t seed,
+                       const streaming_settings& settings = {});
+        // Waits for every job in `jobs`.
+        ~chunk_streamer();
+
+        chunk_streamer(const chunk_streamer&) = delete;
+        chunk_streamer& operator=(const chunk_streamer&) = delete;
+
+        // `eye` is in world space; `forward` need not be normalized.
+        void update(const glm::vec3& eye, const glm::vec3& forward);
+
+        chunk_state state(const glm::ivec3& pos) const;
+
+        // Tracked chunks in state `s`.
+        std::size_t count(chunk_state s) const;
+
+        // True when every chunk in range is resident and nothing is left to do.
+        bool complete() const;
+
+        // Bytes uploaded by the last update().
+        std::size_t last_upload_bytes() const {
+            return m_upload_bytes;
+        }
+
+        // Chunks unloaded so far.
+        std::size_t evicted() const {
+            return m_evicted;
+        }
+
+        // Chunks whose uploaded mesh came with occluders, for frustum::cull(). Solid chunks
+        // with nothing to draw are included.
+        const bounds_table& occluder_bounds() const {
+            return m_occluder_bounds;
+        }
+
+        // The find_occluders() boxes of chunk `pos` as of its uploaded mesh; empty for chunks
+        // not yet uploaded.
+        const std::vector<aabb>& occluders(const glm::ivec3& pos) const;
+
+    private:
+        struct entry {
+            glm::ivec3 pos;
+            chunk_state state = CHUNK_REQUESTED;
+            // Lower is more urgent.
+            float score = 0.0f;
+            // Filled by the terrain job, then moved into the world.
+            std::unique_ptr<chunk> blocks;
+            // Filled by the mesh job, then uploaded and freed.
+            std::vector<packed_quad> mesh;
+            // Found by the mesh job beside `mesh` and taken over by `occluders` at upload, so
+            // the boxes in use never change under a running job.
+            std::vector<aabb> found_occluders;
+            std::vector<aabb> occluders;
+            // Bits, by neighbor_index(), of the neighbours that were loaded when the chunk was
+            // last meshed. Edge and corner neighbours count too: they feed ambient occlusion.
+            std::uint32_t meshed_with = 0;
+            // A job holds the entry.
+            bool busy = false;
+            // A neighbour arrived since the mesh job was submitted.
+            bool stale = false;
+            bool uploaded = false;
+            bool evict = false;
+        };
+
+        bool in_range(const glm::ivec3& pos, int radius) const;
+        float score(const glm::ivec3& pos) const;
+        job_priority priority(const entry& e) const;
+        entry* find(const glm::ivec3& pos) const;
+
+        void drain();
+        void retarget();
+        bool ready_to_mesh(const entry& e) const;
+        void submit_meshes();
+        void submit_generation();
+        void upload();
+
+        void mark_neighbors_stale(const entry& e);
+        void finish(entry* e);
+
+        world& m_world;
+        chunk_renderer& m_renderer;
+        job_system& m_jobs;
+        streaming_settings m_settings;
+
+        // One per worker.
+        std::vector<std::unique_ptr<terrain_generator>> m_generators;
+        std::vector<std::unique_ptr<mesher>> m_meshers;
+
+        std::unordered_map<glm::ivec3, std::unique_ptr<entry>, chunk_pos_hash> m_entries;
+        // Requested chunks as a heap, most urgent at the front.
+        std::vector<entry*> m_queue;
+        std::vector<entry*> m_meshing;
+        std::vector<entry*> m_uploads;
+        bounds_table m_occluder_bounds;
+
+        // Entries whose job has finished, handed back to update().
+        std::mutex m_finished_mutex;
+        std::vector<entry*> m_finished;
+        std::vector<entry*> m_drained;
+
+        glm::vec3 m_eye{0.0f};
+        glm::vec3 m_forward{0.0f, 0.0f, 1.0f};
+        glm::ivec3 m_center{0};
+        bool m_started = false;
+
+        int m_max_jobs;
+        int m_in_flight = 0;
+        std::size_t m_upload_bytes = 0;
+        std::size_t m_evicted = 0;
+    };
+}  // namespace qc
@@ -0,0 +1,116 @@
+#include "world/terrain.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/profile.hpp"
+#include "world/noise.hpp"
+
+namespace qc {
+    namespace {
+        constexpr float BASE_HEIGHT = 56.0f;
+        constexpr float HEIGHT_RANGE = 36.0f;
+        constexpr float HEIGHT_FREQUENCY = 1.0f / 256.0f;
+        constexpr int HEIGHT_OCTAVES = 5;
+
+        constexpr float CAVE_FREQUENCY = 1.0f / 40.0f;
+        constexpr int CAVE_OCTAVES = 2;
+        constexpr float CAVE_THRESHOLD = 0.35f;
+        constexpr std::uint32_t CAVE_SEED = 0x5BD1E995u;
+
+        // Caves stay this far below the surface so hills keep their topsoil.
+        constexpr int CAVE_ROOF = 4;
+        constexpr int SOIL_DEPTH = 4;
+    }  // namespace
+
+    terrain_generator::terrain_generator(std::uint32_t seed, simd_level level)
+        : m_seed(seed),
+          m_level(level),
+          m_x(CHUNK_VOLUME),
+          m_y(CHUNK_VOLUME),
+          m_z(CHUNK_VOLUME),
+          m_noise(CHUNK_VOLUME),
+          m_blocks(CHUNK_VOLUME) {
+    }
+
+    void terrain_generator::heightmap(int chunk_x, int chunk_z, int* heights) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                m_x[z * CHUNK_SIZE + x] = static_cast<float>(chunk_x * CHUNK_SIZE + x);
+                m_z[z * CHUNK_SIZE + x] = static_cast<float>(chunk_z * CHUNK_SIZE + z);
+            }
+        }
+
+        fbm_params params;
+        params.seed = m_seed;
+        params.frequency = HEIGHT_FREQUENCY;
+        params.octaves = HEIGHT_OCTAVES;
+        fbm2(m_x.data(), m_z.data(), m_noise.data(), CHUNK_AREA, params, m_level);
+
+        for (int i = 0; i < CHUNK_AREA; i++) {
+            heights[i] = static_cast<int>(std::floor(BASE_HEIGHT + HEIGHT_RANGE * m_noise[i]));
+        }
+    }
+
+    void terrain_generator::generate(chunk& c, const glm::ivec3& pos) {
+        QC_PROFILE_ZONE("terrain.generate");
+        int heights[CHUNK_AREA];
+        heightmap(pos.x, pos.z, heights);
+
+        const int base_y = pos.y * CHUNK_SIZE;
+        const int highest = *std::max_element(heights, heights + CHUNK_AREA);
+        if (base_y > highest) {
+            c.fill(base_y >= SEA_LEVEL ? BLOCK_AIR : BLOCK_WATER);
+            if (base_y < SEA_LEVEL) {
+                c.fill(0, SEA_LEVEL - base_y, 0, CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1,
+                       BLOCK_AIR);
+            }
+            return;
+        }
+
+        // Only the layers that can hold stone need cave noise.
+        const int cave_layers = std::clamp(highest - CAVE_ROOF - base_y, 0, CHUNK_SIZE);
+        if (cave_layers > 0) {
+            for (int y = 0; y < cave_layers; y++) {
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    for (int x = 0; x < CHUNK_SIZE; x++) {
+                        const int i = chunk_index(x, y, z);
+                        m_x[i] = static_cast<float>(pos.x * CHUNK_SIZE + x);
+                        m_y[i] = static_cast<float>(base_y + y);
+                        m_z[i] = static_cast<float>(pos.z * CHUNK_SIZE + z);
+                    }
+                }
+            }
+
+            fbm_params params;
+            params.seed = m_seed ^ CAVE_SEED;
+            params.frequency = CAVE_FREQUENCY;
+            params.octaves = CAVE_OCTAVES;
+            fbm3(m_x.data(), m_y.data(), m_z.data(), m_noise.data(),
+                 static_cast<std::size_t>(cave_layers) * CHUNK_AREA, params, m_level);
+        }
+
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            const int world_y = base_y + y;
+            for (int column = 0; column < CHUNK_AREA; column++) {
+                const int height = heights[column];
+                const int i = y * CHUNK_AREA + column;
+                block_id block;
+                if (world_y > height) {
+                    block = world_y < SEA_LEVEL ? BLOCK_WATER : BLOCK_AIR;
+                } else if (world_y == height) {
+                    block = height < SEA_LEVEL ? BLOCK_SAND : BLOCK_GRASS;
+                } else if (world_y > height - SOIL_DEPTH) {
+                    block = height < SEA_LEVEL ? BLOCK_SAND : BLOCK_DIRT;
+                } else if (world_y < height - CAVE_ROOF && y < cave_layers && world_y > 0 &&
+                           m_noise[i] > CAVE_THRESHOLD) {
+                    block = BLOCK_AIR;
+                } else {
+                    block = BLOCK_STONE;
+                }
+                m_blocks[i] = block;
+            }
+        }
+        c.assign(m_blocks.data());
+    }
+}  // namespace qc
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "core/simd.hpp"
+#include "world/chunk.hpp"
+
+namespace qc {
+    // Heightmap terrain from 2D fBm with caves carved by 3D fBm. Noise is evaluated for a whole
+    // chunk at once through the batched SIMD kernels, and the output only depends on the seed,
+    // never on the instruction set. Holds scratch buffers, so use one generator per thread.
+    class terrain_generator {
+    public:
+        static constexpr int SEA_LEVEL = 48;
+
+        explicit terrain_generator(std::uint32_t seed, simd_level level = best_simd_level());
+
+        // Fills `c` as the chunk at chunk coordinate `pos`.
+        void generate(chunk& c, const glm::ivec3& pos);
+
+        // World-space surface height of every column of the chunk column at (chunk_x, chunk_z),
+        // x fastest. `heights` must hold CHUNK_AREA entries.
+        void heightmap(int chunk_x, int chunk_z, int* heights);
+
+    private:
+        std::uint32_t m_seed;
+        simd_level m_level;
+
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_z;
+        std::vector<float> m_noise;
+        std::vector<block_id> m_blocks;
+    };
+}  // namespace qc
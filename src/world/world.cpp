@@ -0,0 +1,128 @@
+#include "world/world.hpp"
+
+#include <utility>
+
+namespace qc {
+    chunk_neighborhood chunk_snapshot::neighborhood() const {
+        chunk_neighborhood n;
+        n.center = blocks[neighbor_index(0, 0, 0)].get();
+        n.center_light = light[neighbor_index(0, 0, 0)].get();
+        for (int f = 0; f < FACE_COUNT; f++) {
+            const int i =
+                neighbor_index(FACE_OFFSETS[f][0], FACE_OFFSETS[f][1], FACE_OFFSETS[f][2]);
+            n.faces[f] = blocks[i].get();
+            n.face_lights[f] = light[i].get();
+        }
+        for (int i = 0; i < NEIGHBOR_COUNT; i++) {
+            n.diagonals[i] = blocks[i].get();
+        }
+        return n;
+    }
+
+    template <typename T>
+    T* world::write(cow<T>& slot) {
+        // The reference count cannot tell whether a job has finished reading the data without
+        // synchronizing with it, so data that was ever shared is always copied.
+        if (slot.shared) {
+            slot.data = std::make_shared<T>(*slot.data);
+            slot.shared = false;
+            m_cow_copies++;
+        }
+        return slot.data.get();
+    }
+
+    chunk* world::find(const glm::ivec3& pos) {
+        const auto it = m_chunks.find(pos);
+        return it == m_chunks.end() ? nullptr : write(it->second);
+    }
+
+    const chunk* world::find(const glm::ivec3& pos) const {
+        const auto it = m_chunks.find(pos);
+        return it == m_chunks.end() ? nullptr : it->second.data.get();
+    }
+
+    chunk& world::get_or_create(const glm::ivec3& pos) {
+        cow<chunk>& slot = m_chunks[pos];
+        if (!slot.data) {
+            slot.data = std::make_shared<chunk>();
+        }
+        return *write(slot);
+    }
+
+    void world::insert(const glm::ivec3& pos, std::unique_ptr<chunk> c) {
+        m_chunks[pos] = cow<chunk>{std::move(c)};
+    }
+
+    void world::erase(const glm::ivec3& pos) {
+        m_chunks.erase(pos);
+        m_light.erase(pos);
+    }
+
+    chunk_light* world::find_light(const glm::ivec3& pos) {
+        const auto it = m_light.find(pos);
+        return it == m_light.end() ? nullptr : write(it->second);
+    }
+
+    const chunk_light* world::find_light(const glm::ivec3& pos) const {
+        const auto it = m_light.find(pos);
+        return it == m_light.end() ? nullptr : it->second.data.get();
+    }
+
+    chunk_light& world::get_or_create_light(const glm::ivec3& pos) {
+        cow<chunk_light>& slot = m_light[pos];
+        if (!slot.data) {
+            slot.data = std::make_shared<chunk_light>();
+        }
+        return *write(slot);
+    }
+
+    chunk_neighborhood world::neighborhood(const glm::ivec3& pos) const {
+        chunk_neighborhood n;
+        n.center = find(pos);
+        n.center_light = find_light(pos);
+        for (int f = 0; f < FACE_COUNT; f++) {
+            const glm::ivec3 next =
+                pos + glm::ivec3(FACE_OFFSETS[f][0], FACE_OFFSETS[f][1], FACE_OFFSETS[f][2]);
+            n.faces[f] = find(next);
+            n.face_lights[f] = find_light(next);
+        }
+        for (int i = 0; i < NEIGHBOR_COUNT; i++) {
+            n.diagonals[i] = find(pos + glm::ivec3(i % 3 - 1, i / 9 - 1, i / 3 % 3 - 1));
+        }
+        return n;
+    }
+
+    chunk_snapshot world::snapshot(const glm::ivec3& pos, bool with_light) {
+        chunk_snapshot s;
+        s.pos = pos;
+        for (int i = 0; i < NEIGHBOR_COUNT; i++) {
+            const glm::ivec3 next = pos + glm::ivec3(i % 3 - 1, i / 9 - 1, i / 3 % 3 - 1);
+            if (const auto it = m_chunks.find(next); it != m_chunks.end()) {
+                it->second.shared = true;
+                s.blocks[i] = it->second.data;
+            }
+            if (!with_light) {
+                continue;
+            }
+            if (const auto it = m_light.find(next); it != m_light.end()) {
+                it->second.shared = true;
+                s.light[i] = it->second.data;
+            }
+        }
+        return s;
+    }
+
+    block_id world::get_block(const glm::ivec3& v) const {
+        const chunk* c = find(chunk_of(v));
+        if (c == nullptr) {
+            return BLOCK_AIR;
+        }
+        const glm::ivec3 local = local_of(v);
+        return c->get(local.x, local.y, local.z);
+    }
+
+    void world::set_block(const glm::ivec3& v, block_id block) {
+        const glm::ivec3 local = local_of(v);
+        get_or_create(chunk_of(v)).set(local.x, local.y, local.z, block);
+    }
+}  // namespace qc
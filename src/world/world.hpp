@@ -0,0 +1,121 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "mesh/mesher.hpp"
+#include "world/chunk.hpp"
+#include "world/face.hpp"
+#include "world/light.hpp"
+
+namespace qc {
+    // Chunk containing world voxel `v`. Arithmetic shifts keep negative coordinates right.
+    inline glm::ivec3 chunk_of(const glm::ivec3& v) {
+        return glm::ivec3(v.x >> CHUNK_SIZE_LOG2, v.y >> CHUNK_SIZE_LOG2, v.z >> CHUNK_SIZE_LOG2);
+    }
+
+    // Position of world voxel `v` inside its chunk.
+    inline glm::ivec3 local_of(const glm::ivec3& v) {
+        return glm::ivec3(v.x & (CHUNK_SIZE - 1), v.y & (CHUNK_SIZE - 1), v.z & (CHUNK_SIZE - 1));
+    }
+
+    struct chunk_pos_hash {
+        std::size_t operator()(const glm::ivec3& p) const {
+            std::uint64_t h = static_cast<std::uint32_t>(p.x);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint32_t>(p.y);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint32_t>(p.z);
+            return static_cast<std::size_t>(h ^ (h >> 29));
+        }
+    };
+
+    // The blocks and light of a chunk and its 26 neighbours at one moment, indexed by
+    // neighbor_index(), with missing chunks left null. A snapshot never changes, so jobs may read
+    // it on any thread while the world goes on being edited.
+    struct chunk_snapshot {
+        glm::ivec3 pos{0};
+        std::shared_ptr<const chunk> blocks[NEIGHBOR_COUNT];
+        std::shared_ptr<const chunk_light> light[NEIGHBOR_COUNT];
+
+        // The neighbourhood to mesh the center with; only valid while the snapshot lives.
+        chunk_neighborhood neighborhood() const;
+    };
+
+    // The set of loaded chunks, keyed by chunk coordinate. Not synchronized: chunks are created
+    // and edited on one thread, and other threads read them through snapshots.
+    //
+    // Blocks and light are copy-on-write. Taking a snapshot shares them by reference count, and
+    // the first write access afterwards copies the chunk first. The non-const accessors count as
+    // write access, so read through a const world where possible.
+    class world {
+    public:
+        chunk* find(const glm::ivec3& pos);
+        const chunk* find(const glm::ivec3& pos) const;
+
+        bool contains(const glm::ivec3& pos) const {
+            return m_chunks.find(pos) != m_chunks.end();
+        }
+
+        chunk& get_or_create(const glm::ivec3& pos);
+
+        // Adds a chunk filled elsewhere, replacing any chunk already at `pos`.
+        void insert(const glm::ivec3& pos, std::unique_ptr<chunk> c);
+
+        // Unloads the chunk at `pos` together with its light.
+        void erase(const glm::ivec3& pos);
+
+        // Light is kept beside the blocks and filled in by light_engine.
+        chunk_light* find_light(const glm::ivec3& pos);
+        const chunk_light* find_light(const glm::ivec3& pos) const;
+        chunk_light& get_or_create_light(const glm::ivec3& pos);
+
+        // The chunk at `pos` and its 26 neighbours with the light of the center and its face
+        // neighbours, missing ones left null.
+        chunk_neighborhood neighborhood(const glm::ivec3& pos) const;
+
+        // Shares the chunk at `pos` and its 26 neighbours with the snapshot, and their light
+        // unless `with_light` is false.
+        chunk_snapshot snapshot(const glm::ivec3& pos, bool with_light = true);
+
+        // Blocks in unloaded chunks read as air; setting one creates the chunk.
+        block_id get_block(const glm::ivec3& v) const;
+        void set_block(const glm::ivec3& v, block_id block);
+
+        std::size_t chunk_count() const {
+            return m_chunks.size();
+        }
+
+        // Chunks and light copied because a snapshot had shared them when they were written.
+        std::uint64_t cow_copies() const {
+            return m_cow_copies;
+        }
+
+        // Calls fn(position, chunk) for every loaded chunk, in no particular order.
+        template <typename F>
+        void for_each(F&& fn) const {
+            for (const auto& entry : m_chunks) {
+                fn(entry.first, *entry.second.data);
+            }
+        }
+
+    private:
+        template <typename T>
+        struct cow {
+            std::shared_ptr<T> data;
+            // Set while a snapshot may hold `data`. Only touched by the owning thread, unlike
+            // the reference count.
+            bool shared = false;
+        };
+
+        // `slot`'s data, copied first if a snapshot may hold it.
+        template <typename T>
+        T* write(cow<T>& slot);
+
+        std::unordered_map<glm::ivec3, cow<chunk>, chunk_pos_hash> m_chunks;
+        std::unordered_map<glm::ivec3, cow<chunk_light>, chunk_pos_hash> m_light;
+        std::uint64_t m_cow_copies = 0;
+    };
+}  // namespace qc